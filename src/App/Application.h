@@ -283,6 +283,7 @@ private:
 
     static PyObject* sLoadFile          (PyObject *self,PyObject *args,PyObject *kwd);
     static PyObject* sOpenDocument      (PyObject *self,PyObject *args,PyObject *kwd);
+    static PyObject* sConvertDocument   (PyObject *self,PyObject *args,PyObject *kwd);
     static PyObject* sSaveDocument      (PyObject *self,PyObject *args,PyObject *kwd);
     static PyObject* sSaveDocumentAs    (PyObject *self,PyObject *args,PyObject *kwd);
     static PyObject* sNewDocument       (PyObject *self,PyObject *args,PyObject *kwd);
@@ -98,6 +98,11 @@ PyMethodDef Application::Methods[] = {
      "The string argument must point to an existing file. If the file doesn't exist\n"
      "or the file cannot be loaded an I/O exception is thrown. In this case the\n"
      "document is kept alive."},
+    {"convertDocument",(PyCFunction) Application::sConvertDocument,1,
+     "convertDocument(string=source,string=target,[bool=binary]) -> None\n\n"
+     "Convert a project file without loading it. If binary is True (default)\n"
+     "the document structure is written in the compact binary format, otherwise\n"
+     "as XML. Both formats can be opened."},
 //  {"saveDocument",   (PyCFunction) Application::sSaveDocument,   1,
 //   "saveDocument(string) -- Save the document to a file."},
 //  {"saveDocumentAs", (PyCFunction) Application::sSaveDocumentAs, 1},
@@ -198,6 +203,27 @@ PyObject* Application::sOpenDocument(PyObject * /*self*/, PyObject *args,PyObjec
     }
 }
 
+PyObject* Application::sConvertDocument(PyObject * /*self*/, PyObject *args,PyObject * /*kwd*/)
+{
+    char *source, *target;
+    PyObject *binary = Py_True;
+    if (!PyArg_ParseTuple(args, "ss|O!", &source, &target, &PyBool_Type, &binary))
+        return NULL;
+    try {
+        Document::convertFile(source, target, PyObject_IsTrue(binary) ? true : false);
+        Py_Return;
+    }
+    catch (const Base::Exception& e) {
+        PyErr_SetString(PyExc_IOError, e.what());
+        return 0L;
+    }
+    catch (const std::exception& e) {
+        // might be subclass from zipios
+        PyErr_Format(PyExc_IOError, "Invalid project file %s: %s\n", source, e.what());
+        return 0L;
+    }
+}
+
 PyObject* Application::sNewDocument(PyObject * /*self*/, PyObject *args,PyObject * /*kwd*/)
 {
     char *docName = 0;
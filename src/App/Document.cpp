@@ -41,6 +41,9 @@ user friendliness and speed (no one will wait for Undo too long).
 The FreeCAD document handles the dependencies of its DocumentObjects with
 an adjacence list. This gives the opportunity to calculate the shortest
 recompute path. Also enables more complicated dependencies beyond trees.
+The adjacence list is updated whenever a link changes or an object gets
+added or removed, so a recompute only visits the touched objects and the
+objects depending on them.
 
 
 @see App::Application
@@ -53,6 +56,7 @@ recompute path. Also enables more complicated dependencies beyond trees.
 
 #ifndef _PreComp_
 # include <algorithm>
+# include <cstring>
 # include <sstream>
 # include <climits>
 #endif
@@ -65,9 +69,15 @@ recompute path. Also enables more complicated dependencies beyond trees.
 #include <boost/bind.hpp>
 #include <boost/regex.hpp>
 #include <boost/unordered_set.hpp>
+#include <boost/unordered_map.hpp>
 
 #include <QCoreApplication>
 #include <QCryptographicHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QWaitCondition>
 
 
 #include "Document.h"
@@ -126,6 +136,8 @@ boost::listS           // class EdgeListS:
 typedef boost::graph_traits<DependencyList> Traits;
 typedef Traits::vertex_descriptor Vertex;
 typedef Traits::edge_descriptor Edge;
+typedef boost::unordered_map<const App::DocumentObject*,
+                             std::vector<App::DocumentObject*> > LinkIndex;
 
 namespace App {
 
@@ -141,15 +153,26 @@ struct DocumentP
     int iTransactionMode;
     int iTransactionCount;
     std::map<int,Transaction*> mTransactions;
-    std::map<Vertex,DocumentObject*> vertexMap;
     bool rollback;
     bool closable;
     bool keepTrailingDigits;
     int iUndoMode;
     unsigned int UndoMemSize;
     unsigned int UndoMaxStackSize;
-    DependencyList DepList;
-    std::map<DocumentObject*,Vertex> VertexObjectList;
+    // the objects of a running recompute in execution order
+    std::vector<DocumentObject*> recomputeList;
+    bool parallelRecompute;
+    bool concurrentRecompute;
+    bool deferredLoading;
+    // guards the transactions and the queued change notifications
+    // while objects are executed by worker threads
+    QMutex changeMutex;
+    // the queued changes of each object, they are emitted once the object is done
+    std::map<const DocumentObject*, std::vector<const Property*> > deferredChanges;
+    // the out list of each object of the document as it was seen the last time
+    LinkIndex outLinks;
+    // the reverse of outLinks, i.e. the objects linking to an object
+    LinkIndex inLinks;
 
     DocumentP() {
         activeObject = 0;
@@ -163,7 +186,100 @@ struct DocumentP
         iUndoMode = 0;
         UndoMemSize = 0;
         UndoMaxStackSize = 20;
+        parallelRecompute = false;
+        concurrentRecompute = false;
+        deferredLoading = false;
+    }
+};
+
+/// Outcome of a document object that was executed by a worker thread
+struct RecomputeJob
+{
+    enum State {
+        Done,
+        Aborted,
+        OutOfMemory,
+        Failed,
+        FailedStd,
+        Unknown
+    };
+
+    RecomputeJob(DocumentObject* o, std::size_t i)
+      : obj(o), index(i), ret(0), state(Done)
+    {
+    }
+
+    DocumentObject* obj;
+    std::size_t index;
+    DocumentObjectExecReturn* ret;
+    State state;
+    std::string why;
+};
+
+/// Collects the finished jobs of a parallel recompute for the main thread
+class RecomputeQueue
+{
+public:
+    void push(RecomputeJob* job)
+    {
+        QMutexLocker locker(&mutex);
+        finished.push_back(job);
+        cond.wakeOne();
+    }
+    RecomputeJob* wait()
+    {
+        QMutexLocker locker(&mutex);
+        while (finished.empty())
+            cond.wait(&mutex);
+        RecomputeJob* job = finished.front();
+        finished.pop_front();
+        return job;
+    }
+
+private:
+    QMutex mutex;
+    QWaitCondition cond;
+    std::list<RecomputeJob*> finished;
+};
+
+/// Executes a document object in a worker thread. Exceptions are only recorded
+/// because reporting them through the console is not thread-safe.
+class RecomputeTask : public QRunnable
+{
+public:
+    RecomputeTask(RecomputeJob* j, RecomputeQueue& q) : job(j), queue(q)
+    {
+    }
+    void run()
+    {
+        try {
+            job->ret = job->obj->recompute();
+        }
+        catch (const Base::AbortException& e) {
+            job->state = RecomputeJob::Aborted;
+            job->why = e.what();
+        }
+        catch (const Base::MemoryException& e) {
+            job->state = RecomputeJob::OutOfMemory;
+            job->why = e.what();
+        }
+        catch (const Base::Exception& e) {
+            job->state = RecomputeJob::Failed;
+            job->why = e.what();
+        }
+        catch (const std::exception& e) {
+            job->state = RecomputeJob::FailedStd;
+            job->why = e.what();
+        }
+        catch (...) {
+            job->state = RecomputeJob::Unknown;
+        }
+        queue.push(job);
     }
+
+private:
+    RecomputeJob* job;
+    RecomputeQueue& queue;
 };
 
 } // namespace App
@@ -513,17 +629,125 @@ void Document::onChanged(const Property* prop)
 
 void Document::onBeforeChangeProperty(const DocumentObject *Who, const Property *What)
 {
+    if (d->concurrentRecompute) {
+        QMutexLocker locker(&d->changeMutex);
+        if (d->activeUndoTransaction && !d->rollback)
+            d->activeUndoTransaction->addObjectChange(Who,What);
+        return;
+    }
+
     if (d->activeUndoTransaction && !d->rollback)
         d->activeUndoTransaction->addObjectChange(Who,What);
 }
 
+static bool isLinkProperty(const Property* prop)
+{
+    return prop->isDerivedFrom(PropertyLink::getClassTypeId()) ||
+           prop->isDerivedFrom(PropertyLinkSub::getClassTypeId()) ||
+           prop->isDerivedFrom(PropertyLinkList::getClassTypeId()) ||
+           prop->isDerivedFrom(PropertyLinkSubList::getClassTypeId());
+}
+
 void Document::onChangedProperty(const DocumentObject *Who, const Property *What)
 {
+    if (d->concurrentRecompute) {
+        // the observers are not thread-safe, so the signal is emitted later
+        // by the main thread (see _flushDeferredChanges())
+        QMutexLocker locker(&d->changeMutex);
+        if (d->activeTransaction && !d->rollback)
+            d->activeTransaction->addObjectChange(Who,What);
+        d->deferredChanges[Who].push_back(What);
+        return;
+    }
+
+    if (isLinkProperty(What))
+        _updateLinkIndex(Who);
     if (d->activeTransaction && !d->rollback)
         d->activeTransaction->addObjectChange(Who,What);
     signalChangedObject(*Who, *What);
 }
 
+void Document::_flushDeferredChanges(const DocumentObject* obj)
+{
+    std::map<const DocumentObject*, std::vector<const Property*> > changes;
+    {
+        // only take the changes of objects which are not executed any more
+        QMutexLocker locker(&d->changeMutex);
+        if (!obj) {
+            changes.swap(d->deferredChanges);
+        }
+        else {
+            std::map<const DocumentObject*, std::vector<const Property*> >::iterator it;
+            it = d->deferredChanges.find(obj);
+            if (it != d->deferredChanges.end()) {
+                changes[obj].swap(it->second);
+                d->deferredChanges.erase(it);
+            }
+        }
+    }
+
+    for (std::map<const DocumentObject*, std::vector<const Property*> >::iterator
+        it = changes.begin(); it != changes.end(); ++it) {
+        for (std::vector<const Property*>::iterator jt = it->second.begin(); jt != it->second.end(); ++jt) {
+            if (isLinkProperty(*jt))
+                _updateLinkIndex(it->first);
+            signalChangedObject(*it->first, **jt);
+        }
+    }
+}
+
+/// Replaces the links of \a obj in the reverse index with its current out list
+void Document::_updateLinkIndex(const DocumentObject* obj)
+{
+    LinkIndex::iterator it = d->outLinks.find(obj);
+    // the object is not (or no longer) part of this document
+    if (it == d->outLinks.end())
+        return;
+
+    std::vector<DocumentObject*> outList = obj->getOutList();
+    if (outList == it->second)
+        return;
+
+    DocumentObject* self = const_cast<DocumentObject*>(obj);
+    for (std::vector<DocumentObject*>::iterator jt = it->second.begin(); jt != it->second.end(); ++jt) {
+        std::vector<DocumentObject*>& inList = d->inLinks[*jt];
+        std::vector<DocumentObject*>::reverse_iterator kt = std::find(inList.rbegin(), inList.rend(), self);
+        if (kt != inList.rend())
+            inList.erase(--(kt.base()));
+        if (inList.empty())
+            d->inLinks.erase(*jt);
+    }
+    for (std::vector<DocumentObject*>::iterator jt = outList.begin(); jt != outList.end(); ++jt)
+        d->inLinks[*jt].push_back(self);
+    it->second.swap(outList);
+}
+
+/// Adds \a obj to the link index, it must be called when the object is added to the document
+void Document::_addToLinkIndex(const DocumentObject* obj)
+{
+    d->outLinks.insert(std::make_pair(obj, std::vector<DocumentObject*>()));
+    _updateLinkIndex(obj);
+}
+
+/// Drops the links of \a obj from the index, it must be called when the object is removed from the document
+void Document::_removeFromLinkIndex(const DocumentObject* obj)
+{
+    LinkIndex::iterator it = d->outLinks.find(obj);
+    if (it == d->outLinks.end())
+        return;
+
+    DocumentObject* self = const_cast<DocumentObject*>(obj);
+    for (std::vector<DocumentObject*>::iterator jt = it->second.begin(); jt != it->second.end(); ++jt) {
+        std::vector<DocumentObject*>& inList = d->inLinks[*jt];
+        std::vector<DocumentObject*>::iterator kt = std::find(inList.begin(), inList.end(), self);
+        if (kt != inList.end())
+            inList.erase(kt);
+        if (inList.empty())
+            d->inLinks.erase(*jt);
+    }
+    d->outLinks.erase(it);
+}
+
 void Document::setTransactionMode(int iMode)
 {
     /*  if(_iTransactionMode == 0 && iMode == 1)
@@ -593,6 +817,8 @@ Document::Document(void)
     // have to care about ref counting any more.
     DocumentPythonObject = Py::Object(new DocumentPy(this), true);
     d = new DocumentP;
+    d->deferredLoading = GetApplication().GetParameterGroupByPath
+        ("User parameter:BaseApp/Preferences/Document")->GetBool("LazyLoading",false);
 
 #ifdef FC_LOGUPDATECHAIN
     Console().Log("+App::Document: %p\n",this);
@@ -638,6 +864,8 @@ Document::~Document()
 #endif
 
     d->objectArray.clear();
+    d->outLinks.clear();
+    d->inLinks.clear();
     for (it = d->objectMap.begin(); it != d->objectMap.end(); ++it) {
         delete(it->second);
     }
@@ -881,6 +1109,11 @@ Document::readObjects(Base::XMLReader& reader)
     }
     reader.readEndElement("ObjectData");
 
+    // make sure the link index is up-to-date, even if an object
+    // has restored its links without notification
+    for (std::vector<DocumentObject*>::iterator it = objs.begin(); it != objs.end(); ++it)
+        _updateLinkIndex(*it);
+
     return objs;
 }
 
@@ -949,6 +1182,10 @@ bool Document::save (void)
 {
     int compression = App::GetApplication().GetParameterGroupByPath
         ("User parameter:BaseApp/Preferences/Document")->GetInt("CompressionLevel",3);
+    bool parallel = App::GetApplication().GetParameterGroupByPath
+        ("User parameter:BaseApp/Preferences/Document")->GetBool("SaveParallel",true);
+    bool binary = App::GetApplication().GetParameterGroupByPath
+        ("User parameter:BaseApp/Preferences/Document")->GetBool("SaveBinary",false);
 
     if (*(FileName.getValue()) != '\0') {
         LastModifiedDate.setValue(Base::TimeInfo::currentDateTimeString());
@@ -967,7 +1204,11 @@ bool Document::save (void)
 
             writer.setComment("FreeCAD Document");
             writer.setLevel(compression);
-            writer.putNextEntry("Document.xml");
+            writer.setParallel(parallel);
+            if (binary)
+                writer.putNextBinaryEntry("Document.fcb");
+            else
+                writer.putNextEntry("Document.xml");
 
             Document::Save(writer);
 
@@ -1055,6 +1296,8 @@ void Document::restore (void)
     }
     d->objectArray.clear();
     d->objectMap.clear();
+    d->outLinks.clear();
+    d->inLinks.clear();
     d->activeObject = 0;
 
     Base::FileInfo fi(FileName.getValue());
@@ -1070,6 +1313,7 @@ void Document::restore (void)
 
     if (!reader.isValid())
         throw Base::FileException("Error reading compression file",FileName.getValue());
+    reader.setDeferredLoading(d->deferredLoading);
 
     GetApplication().signalStartRestoreDocument(*this);
 
@@ -1096,6 +1340,62 @@ void Document::restore (void)
     GetApplication().signalFinishRestoreDocument(*this);
 }
 
+void Document::convertFile(const char* source, const char* target, bool binary)
+{
+    Base::FileInfo fi(source);
+    Base::ifstream file(fi, std::ios::in | std::ios::binary);
+    if (!file)
+        throw Base::FileException("Cannot open project file", source);
+    zipios::ZipInputStream zipstream(file);
+    Base::XMLReader reader(source, zipstream);
+    if (!reader.isValid())
+        throw Base::FileException("Error reading compression file", source);
+
+    Base::FileInfo to(target);
+    if (to.filePath() == fi.filePath())
+        throw Base::FileException("Cannot convert a project file into itself", target);
+    Base::ofstream out(to, std::ios::out | std::ios::binary);
+    if (!out)
+        throw Base::FileException("Cannot create project file", target);
+
+    // open extra scope to close ZipWriter properly
+    {
+        Base::ZipWriter writer(out);
+        writer.setComment("FreeCAD Document");
+        writer.setLevel(App::GetApplication().GetParameterGroupByPath
+            ("User parameter:BaseApp/Preferences/Document")->GetInt("CompressionLevel",3));
+        writer.putNextEntry(binary ? "Document.fcb" : "Document.xml");
+        reader.convert(writer.Stream(), binary);
+
+        // all the other files are copied as they are
+        for (;;) {
+            zipios::ConstEntryPointer entry;
+            try {
+                entry = zipstream.getNextEntry();
+            }
+            catch (const std::exception&) {
+                break;
+            }
+            if (!entry->isValid())
+                break;
+            writer.putNextEntry(entry->getName().c_str());
+            // an empty file would set the fail bit of the output stream
+            if (zipstream.peek() != EOF)
+                writer.Stream() << zipstream.rdbuf();
+        }
+    }
+}
+
+void Document::setDeferredLoading(bool on)
+{
+    d->deferredLoading = on;
+}
+
+bool Document::isDeferredLoading() const
+{
+    return d->deferredLoading;
+}
+
 bool Document::isSaved() const
 {
     std::string name = FileName.getValue();
@@ -1161,20 +1461,22 @@ int Document::countObjects(void) const
    return static_cast<int>(d->objectArray.size());
 }
 
+static bool nameLess(const DocumentObject* a, const DocumentObject* b)
+{
+    return strcmp(a->getNameInDocument(), b->getNameInDocument()) < 0;
+}
+
 std::vector<App::DocumentObject*> Document::getInList(const DocumentObject* me) const
 {
-    // result list
-    std::vector<App::DocumentObject*> result;
-    // go through all objects
-    for (std::map<std::string,DocumentObject*>::const_iterator It = d->objectMap.begin(); It != d->objectMap.end();++It) {
-        // get the outList and search if me is in that list
-        std::vector<DocumentObject*> OutList = It->second->getOutList();
-        for (std::vector<DocumentObject*>::const_iterator It2=OutList.begin();It2!=OutList.end();++It2)
-            if (*It2 && *It2 == me)
-                // add the parent object
-                result.push_back(It->second);
+    // the reverse index is kept up-to-date when links change
+    std::vector<App::DocumentObject*> inList;
+    LinkIndex::const_iterator it = d->inLinks.find(me);
+    if (it != d->inLinks.end()) {
+        // keep the order of the object map as before the index existed
+        inList = it->second;
+        std::sort(inList.begin(), inList.end(), nameLess);
     }
-    return result;
+    return inList;
 }
 
 std::vector<App::DocumentObject*>
@@ -1229,23 +1531,88 @@ Document::getDependencyList(const std::vector<App::DocumentObject*>& objs) const
     return ary;
 }
 
-void Document::_rebuildDependencyList(void)
+/**
+ * Collects the objects which must be checked by the next recompute, i.e. the touched
+ * objects and all objects depending on them, in the order they have to be executed.
+ * Only the affected part of the dependency graph is visited because the links are
+ * taken from the index which is maintained when links change.
+ * Returns false if there is a cyclic dependency.
+ */
+bool Document::_buildRecomputeList(std::vector<DocumentObject*>& order) const
 {
-    d->VertexObjectList.clear();
-    d->DepList.clear();
-    // Filling up the adjacency List
-    for (std::map<std::string,DocumentObject*>::const_iterator It = d->objectMap.begin(); It != d->objectMap.end();++It) {
-        // add the object as Vertex and remember the index
-        d->VertexObjectList[It->second] = add_vertex(d->DepList);
+    // the touched objects are the roots
+    std::vector<DocumentObject*> closure;
+    boost::unordered_set<const DocumentObject*> visited;
+    for (std::vector<DocumentObject*>::const_iterator it = d->objectArray.begin(); it != d->objectArray.end(); ++it) {
+        if ((*it)->isTouched() || (*it)->mustExecute() == 1) {
+            if (visited.insert(*it).second)
+                closure.push_back(*it);
+        }
     }
-    // add the edges
-    for (std::map<std::string,DocumentObject*>::const_iterator It = d->objectMap.begin(); It != d->objectMap.end();++It) {
-        std::vector<DocumentObject*> OutList = It->second->getOutList();
-        for (std::vector<DocumentObject*>::const_iterator It2=OutList.begin();It2!=OutList.end();++It2) {
-            if (*It2)
-                add_edge(d->VertexObjectList[It->second],d->VertexObjectList[*It2],d->DepList);
+
+    // add everything downstream of them
+    for (std::size_t i = 0; i < closure.size(); i++) {
+        LinkIndex::const_iterator it = d->inLinks.find(closure[i]);
+        if (it == d->inLinks.end())
+            continue;
+        for (std::vector<DocumentObject*>::const_iterator jt = it->second.begin(); jt != it->second.end(); ++jt) {
+            if (visited.insert(*jt).second)
+                closure.push_back(*jt);
+        }
+    }
+
+    // topological sort of the sub-graph: an object is ready when all its
+    // dependencies inside the sub-graph are ordered
+    boost::unordered_map<const DocumentObject*, int> pending;
+    std::vector<DocumentObject*> ready;
+    for (std::vector<DocumentObject*>::iterator it = closure.begin(); it != closure.end(); ++it) {
+        int count = 0;
+        LinkIndex::const_iterator jt = d->outLinks.find(*it);
+        if (jt != d->outLinks.end()) {
+            for (std::vector<DocumentObject*>::const_iterator kt = jt->second.begin(); kt != jt->second.end(); ++kt) {
+                if (visited.find(*kt) != visited.end())
+                    count++;
+            }
+        }
+        pending[*it] = count;
+        if (count == 0)
+            ready.push_back(*it);
+    }
+
+    order.clear();
+    order.reserve(closure.size());
+    for (std::size_t i = 0; i < ready.size(); i++) {
+        order.push_back(ready[i]);
+        LinkIndex::const_iterator it = d->inLinks.find(ready[i]);
+        if (it == d->inLinks.end())
+            continue;
+        for (std::vector<DocumentObject*>::const_iterator jt = it->second.begin(); jt != it->second.end(); ++jt) {
+            if (--pending[*jt] == 0)
+                ready.push_back(*jt);
         }
     }
+
+    return order.size() == closure.size();
+}
+
+/// Checks if \a obj must be executed. All its dependencies must be done.
+static bool mustRecompute(const DocumentP* d, const DocumentObject* obj)
+{
+    if (!obj)
+        return false;
+    if (obj->mustExecute() == 1)
+        return true;
+
+    // update if one of the dependencies is touched
+    LinkIndex::const_iterator it = d->outLinks.find(obj);
+    if (it == d->outLinks.end())
+        return false;
+    for (std::vector<DocumentObject*>::const_iterator jt = it->second.begin(); jt != it->second.end(); ++jt) {
+        if ((*jt)->isTouched())
+            return true;
+    }
+
+    return false;
 }
 
 void Document::recompute()
@@ -1255,76 +1622,196 @@ void Document::recompute()
         delete *it;
     _RecomputeLog.clear();
 
-    // updates the dependency graph
-    _rebuildDependencyList();
-
-    std::list<Vertex> make_order;
-    DependencyList::out_edge_iterator j, jend;
-
-    try {
-        // this sort gives the execute
-        boost::topological_sort(d->DepList, std::front_inserter(make_order));
-    }
-    catch (const std::exception& e) {
-        std::cerr << "Document::recompute: " << e.what() << std::endl;
+    // get the affected part of the dependency graph
+    if (!_buildRecomputeList(d->recomputeList)) {
+        std::cerr << "Document::recompute: The graph must be a DAG." << std::endl;
+        d->recomputeList.clear();
         return;
     }
 
-    // caching vertex to DocObject
-    for (std::map<DocumentObject*,Vertex>::const_iterator It1= d->VertexObjectList.begin();It1 != d->VertexObjectList.end(); ++It1)
-        d->vertexMap[It1->second] = It1->first;
-
+    if (d->parallelRecompute) {
+        if (_recomputeConcurrently()) {
+            // if somthing happen break execution of recompute
+            d->recomputeList.clear();
+            return;
+        }
+    }
+    else {
 #ifdef FC_LOGFEATUREUPDATE
-    std::clog << "make ordering: " << std::endl;
+        std::clog << "make ordering: " << std::endl;
 #endif
 
-    for (std::list<Vertex>::reverse_iterator i = make_order.rbegin();i != make_order.rend(); ++i) {
-        DocumentObject* Cur = d->vertexMap[*i];
-        if (!Cur) continue;
+        // Note: objects may get removed while recomputing, their entry is nullified then
+        for (std::size_t i = 0; i < d->recomputeList.size(); i++) {
+            DocumentObject* Cur = d->recomputeList[i];
+            if (!Cur) continue;
 #ifdef FC_LOGFEATUREUPDATE
-        std::clog << Cur->getNameInDocument() << " dep on: " ;
+            std::clog << Cur->getNameInDocument() << std::endl;
 #endif
-        bool NeedUpdate = false;
-
-        // ask the object if it should be recomputed
-        if (Cur->mustExecute() == 1)
-            NeedUpdate = true;
-        else {// if (Cur->mustExecute() == -1)
-            // update if one of the dependencies is touched
-            for (boost::tie(j, jend) = out_edges(*i, d->DepList); j != jend; ++j) {
-                DocumentObject* Test = d->vertexMap[target(*j, d->DepList)];
-                if (!Test) continue;
+            // if one touched recompute
+            if (mustRecompute(d, Cur)) {
 #ifdef FC_LOGFEATUREUPDATE
-                std::clog << Test->getNameInDocument() << ", " ;
+                std::clog << "Recompute" << std::endl;
 #endif
-                if (Test->isTouched()) {
-                    NeedUpdate = true;
-                    break;
+                if (_recomputeFeature(Cur)) {
+                    // if somthing happen break execution of recompute
+                    d->recomputeList.clear();
+                    return;
                 }
             }
-#ifdef FC_LOGFEATUREUPDATE
-            std::clog << std::endl;
-#endif
         }
-        // if one touched recompute
-        if (NeedUpdate) {
-#ifdef FC_LOGFEATUREUPDATE
-            std::clog << "Recompute" << std::endl;
-#endif
-            if (_recomputeFeature(Cur)) {
-                // if somthing happen break execution of recompute
-                d->vertexMap.clear();
-                return;
+    }
+
+    // reset all touched
+    for (std::vector<DocumentObject*>::iterator it = d->recomputeList.begin(); it != d->recomputeList.end(); ++it) {
+        if (*it)
+            (*it)->purgeTouched();
+    }
+    d->recomputeList.clear();
+}
+
+/**
+ * Recomputes the touched objects as a task graph. An object gets scheduled as soon as all
+ * objects of its OutList are done. Objects which declare their execute() as thread-safe
+ * run in the global thread pool, all others run in the calling thread while the workers
+ * are busy. Returns true if the recompute was aborted.
+ */
+bool Document::_recomputeConcurrently()
+{
+    const std::vector<DocumentObject*>& order = d->recomputeList;
+    boost::unordered_map<const DocumentObject*, std::size_t> position;
+    for (std::size_t i = 0; i < order.size(); i++)
+        position[order[i]] = i;
+
+    // the dependents of each object inside the recompute list
+    std::vector<int> pending(order.size(), 0);
+    std::vector< std::vector<std::size_t> > dependents(order.size());
+    for (std::size_t i = 0; i < order.size(); i++) {
+        LinkIndex::const_iterator it = d->outLinks.find(order[i]);
+        if (it == d->outLinks.end())
+            continue;
+        for (std::vector<DocumentObject*>::const_iterator jt = it->second.begin(); jt != it->second.end(); ++jt) {
+            boost::unordered_map<const DocumentObject*, std::size_t>::iterator kt = position.find(*jt);
+            if (kt != position.end()) {
+                pending[i]++;
+                dependents[kt->second].push_back(i);
             }
         }
     }
 
-    // reset all touched
-    for (std::map<Vertex,DocumentObject*>::iterator it = d->vertexMap.begin(); it != d->vertexMap.end(); ++it) {
-        if (it->second)
-            it->second->purgeTouched();
+    std::list<std::size_t> ready;
+    for (std::size_t i = 0; i < order.size(); i++) {
+        if (pending[i] == 0)
+            ready.push_back(i);
     }
-    d->vertexMap.clear();
+
+    RecomputeQueue queue;
+    int running = 0;
+    bool abort = false;
+    d->concurrentRecompute = true;
+
+    while (!ready.empty() || running > 0) {
+        while (!abort && !ready.empty()) {
+            std::size_t index = ready.front();
+            ready.pop_front();
+            // the object may have been removed meanwhile
+            DocumentObject* Cur = order[index];
+            if (!mustRecompute(d, Cur)) {
+                // nothing to do, release the objects waiting for this one
+            }
+            else if (Cur->isExecuteThreadSafe()) {
+                QThreadPool::globalInstance()->start(new RecomputeTask(new RecomputeJob(Cur, index), queue));
+                running++;
+                continue;
+            }
+            else {
+                abort = _recomputeFeature(Cur);
+                _flushDeferredChanges(Cur);
+            }
+
+            for (std::vector<std::size_t>::iterator jt = dependents[index].begin(); jt != dependents[index].end(); ++jt) {
+                if (--pending[*jt] == 0)
+                    ready.push_back(*jt);
+            }
+        }
+
+        if (running == 0)
+            break;
+
+        RecomputeJob* job = queue.wait();
+        running--;
+        _flushDeferredChanges(job->obj);
+        if (_finishConcurrentFeature(*job))
+            abort = true;
+        for (std::vector<std::size_t>::iterator jt = dependents[job->index].begin(); jt != dependents[job->index].end(); ++jt) {
+            if (--pending[*jt] == 0)
+                ready.push_back(*jt);
+        }
+        delete job;
+    }
+
+    d->concurrentRecompute = false;
+    _flushDeferredChanges();
+    return abort;
+}
+
+/// Reports the outcome of a job executed by a worker thread like _recomputeFeature() does
+bool Document::_finishConcurrentFeature(RecomputeJob& job)
+{
+    DocumentObject* Feat = job.obj;
+    switch (job.state) {
+    case RecomputeJob::Aborted:
+        Base::Console().Error("Exception (%s): %s \n",Console().Time(),job.why.c_str());
+        _RecomputeLog.push_back(new DocumentObjectExecReturn("User abort",Feat));
+        Feat->setError();
+        return true;
+    case RecomputeJob::OutOfMemory:
+        Base::Console().Error("Memory exception in feature '%s' thrown: %s\n",Feat->getNameInDocument(),job.why.c_str());
+        _RecomputeLog.push_back(new DocumentObjectExecReturn("Out of memory exception",Feat));
+        Feat->setError();
+        return true;
+    case RecomputeJob::Failed:
+        Base::Console().Error("Exception (%s): %s \n",Console().Time(),job.why.c_str());
+        _RecomputeLog.push_back(new DocumentObjectExecReturn(job.why,Feat));
+        Feat->setError();
+        return false;
+    case RecomputeJob::FailedStd:
+        Base::Console().Warning("exception in Feature \"%s\" thrown: %s\n",Feat->getNameInDocument(),job.why.c_str());
+        _RecomputeLog.push_back(new DocumentObjectExecReturn(job.why,Feat));
+        Feat->setError();
+        return false;
+    case RecomputeJob::Unknown:
+        Base::Console().Error("App::Document::_RecomputeFeature(): Unknown exception in Feature \"%s\" thrown\n",Feat->getNameInDocument());
+        _RecomputeLog.push_back(new DocumentObjectExecReturn("Unknown exeption!"));
+        Feat->setError();
+        return true;
+    default:
+        break;
+    }
+
+    // error code
+    if (job.ret == DocumentObject::StdReturn) {
+        Feat->resetError();
+    }
+    else {
+        job.ret->Which = Feat;
+        _RecomputeLog.push_back(job.ret);
+#ifdef FC_DEBUG
+        Base::Console().Error("%s\n",job.ret->Why.c_str());
+#endif
+        Feat->setError();
+    }
+    return false;
+}
+
+void Document::setParallelRecompute(bool on)
+{
+    d->parallelRecompute = on;
+}
+
+bool Document::isParallelRecompute() const
+{
+    return d->parallelRecompute;
 }
 
 const char * Document::getErrorDescription(const App::DocumentObject*Obj) const
@@ -1448,6 +1935,7 @@ DocumentObject * Document::addObject(const char* sType, const char* pObjectName)
     d->objectArray.push_back(pcObject);
     // insert in the adjacence list and referenc through the ConectionMap
     //_DepConMap[pcObject] = add_vertex(_DepList);
+    _addToLinkIndex(pcObject);
 
     pcObject->Label.setValue( ObjectName );
 
@@ -1466,6 +1954,7 @@ void Document::_addObject(DocumentObject* pcObject, const char* pObjectName)
     d->objectArray.push_back(pcObject);
     // cache the pointer to the name string in the Object (for performance of DocumentObject::getNameInDocument())
     pcObject->pcNameInDocument = &(d->objectMap.find(pObjectName)->first);
+    _addToLinkIndex(pcObject);
 
     // do no transactions if we do a rollback!
     if(!d->rollback){
@@ -1495,11 +1984,11 @@ void Document::remObject(const char* sName)
         d->activeObject = 0;
 
     signalDeletedObject(*(pos->second));
-    if (!d->vertexMap.empty()) {
+    if (!d->recomputeList.empty()) {
         // recompute of document is running
-        for (std::map<Vertex,DocumentObject*>::iterator it = d->vertexMap.begin(); it != d->vertexMap.end(); ++it) {
-            if (it->second == pos->second) {
-                it->second = 0; // just nullify the pointer
+        for (std::vector<DocumentObject*>::iterator it = d->recomputeList.begin(); it != d->recomputeList.end(); ++it) {
+            if (*it == pos->second) {
+                *it = 0; // just nullify the pointer
                 break;
             }
         }
@@ -1507,6 +1996,7 @@ void Document::remObject(const char* sName)
 
     // Before deleting we must nullify all dependant objects
     breakDependency(pos->second, true);
+    _removeFromLinkIndex(pos->second);
 
     // do no transactions if we do a rollback!
     if(!d->rollback){
@@ -1563,6 +2053,7 @@ void Document::_remObject(DocumentObject* pcObject)
     }
     // remove from map
     d->objectMap.erase(pos);
+    _removeFromLinkIndex(pcObject);
     //// set name cache false
     //pcObject->pcNameInDocument = 0;
 
@@ -1576,10 +2067,18 @@ void Document::_remObject(DocumentObject* pcObject)
 
 void Document::breakDependency(DocumentObject* pcObject, bool clear)
 {
+    // Only the objects linking to pcObject and, if the links are to be cleared,
+    // pcObject itself can be affected. Take a copy because the in list changes.
+    std::vector<DocumentObject*> objs = getInList(pcObject);
+    std::sort(objs.begin(), objs.end());
+    objs.erase(std::unique(objs.begin(), objs.end()), objs.end());
+    if (clear)
+        objs.push_back(pcObject);
+
     // Nullify all dependant objects
-    for (std::map<std::string,DocumentObject*>::iterator it = d->objectMap.begin(); it != d->objectMap.end(); ++it) {
+    for (std::vector<DocumentObject*>::iterator it = objs.begin(); it != objs.end(); ++it) {
         std::map<std::string,App::Property*> Map;
-        it->second->getPropertyMap(Map);
+        (*it)->getPropertyMap(Map);
         // search for all properties that could have a link to the object
         for (std::map<std::string,App::Property*>::iterator pt = Map.begin(); pt != Map.end(); ++pt) {
             if (pt->second->getTypeId().isDerivedFrom(PropertyLink::getClassTypeId())) {
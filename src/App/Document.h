@@ -51,6 +51,7 @@ namespace App
     class DocumentPy; // the python document class
     class Application;
     class Transaction;
+    struct RecomputeJob;
 }
 
 namespace App
@@ -136,6 +137,21 @@ public:
     bool saveAs(const char* file);
     /// Restore the document from the file in Property Path
     void restore (void);
+    /** Postpone reading the big data files of the objects, e.g. meshes or shapes,
+     * in restore() until their data is accessed the first time. This makes opening
+     * a document cheap if only a few objects are needed. It is meant for scripting
+     * because the view providers of the GUI need all the data right away.
+     * The default is taken from the "LazyLoading" document preference.
+     */
+    void setDeferredLoading(bool);
+    /// check whether the reading of data files is postponed
+    bool isDeferredLoading() const;
+    /** Converts the project file \a source to \a target. If \a binary is true the
+     * document structure is written in the compact binary format (see Base::BinaryXMLWriter),
+     * otherwise as XML. All other files of the project are copied unchanged.
+     * To save documents in the binary format set the "SaveBinary" document preference.
+     */
+    static void convertFile(const char* source, const char* target, bool binary);
     void exportObjects(const std::vector<App::DocumentObject*>&, std::ostream&);
     void exportGraphviz(std::ostream&);
     std::vector<App::DocumentObject*> importObjects(Base::XMLReader& reader);
@@ -210,6 +226,13 @@ public:
     void recompute();
     /// Recompute only one feature
     void recomputeFeature(DocumentObject* Feat);
+    /** Enables the parallel recompute of the document. Independent objects whose
+     * execute() is declared thread-safe (see DocumentObject::isExecuteThreadSafe())
+     * then get executed by a thread pool. By default this is off.
+     */
+    void setParallelRecompute(bool);
+    /// check whether the parallel recompute is enabled
+    bool isParallelRecompute() const;
     /// get the error log from the recompute run
     const std::vector<App::DocumentObjectExecReturn*> &getRecomputeLog(void)const{return _RecomputeLog;}
     /// get the text of the error of a spezified object
@@ -305,9 +328,20 @@ protected:
     void onChangedProperty(const DocumentObject *Who, const Property *What);
     /// helper which Recompute only this feature
     bool _recomputeFeature(DocumentObject* Feat);
+    /// helper which recomputes the touched features with a thread pool
+    bool _recomputeConcurrently();
+    bool _finishConcurrentFeature(RecomputeJob&);
+    /// emit the property changes of \a obj (or of all objects if 0) made while objects were executed concurrently
+    void _flushDeferredChanges(const DocumentObject* obj=0);
+    /** @name maintenance of the reverse dependency index used by getInList() */
+    //@{
+    void _updateLinkIndex(const DocumentObject*);
+    void _addToLinkIndex(const DocumentObject*);
+    void _removeFromLinkIndex(const DocumentObject*);
+    //@}
     void _clearRedos();
-    /// refresh the internal dependency graph
-    void _rebuildDependencyList(void);
+    /// get the touched objects and their dependents in execution order
+    bool _buildRecomputeList(std::vector<DocumentObject*>&) const;
     std::string getTransientDirectoryName(const std::string& uuid, const std::string& filename) const;
 
 
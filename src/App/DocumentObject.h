@@ -137,6 +137,13 @@ public:
      * -1: the document examine all links of this object and if one is touched -> recompute
      */
     virtual short mustExecute(void) const;
+    /** Returns true if execute() only reads the linked objects and writes the own
+     * properties of this object. Then it can be executed in a worker thread when
+     * the document does a parallel recompute. The default is false.
+     */
+    virtual bool isExecuteThreadSafe(void) const {
+        return false;
+    }
 
     /// get the status Message
     const char *getStatusString(void) const;
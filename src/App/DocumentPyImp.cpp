@@ -432,6 +432,16 @@ void  DocumentPy::setUndoMode(Py::Int arg)
     getDocumentPtr()->setUndoMode(arg); 
 }
 
+Py::Boolean DocumentPy::getParallelRecompute(void) const
+{
+    return Py::Boolean(getDocumentPtr()->isParallelRecompute());
+}
+
+void  DocumentPy::setParallelRecompute(Py::Boolean arg)
+{
+    getDocumentPtr()->setParallelRecompute(arg);
+}
+
 Py::Int DocumentPy::getUndoRedoMemSize(void) const
 {
     return Py::Int((long)getDocumentPtr()->getUndoMemSize());
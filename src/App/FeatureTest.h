@@ -102,6 +102,10 @@ public:
   //@{
   /// recalculate the Feature
   virtual DocumentObjectExecReturn *execute(void);
+  /// the feature only changes its own properties
+  virtual bool isExecuteThreadSafe(void) const {
+    return true;
+  }
   /// returns the type name of the ViewProvider
   //FIXME: Propably it makes sense to have a view provider for unittests (e.g. Gui::ViewProviderTest)
   virtual const char* getViewProviderName(void) const {
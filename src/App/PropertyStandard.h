@@ -543,6 +543,7 @@ public:
     virtual void Restore(Base::XMLReader &reader);
     
     virtual void SaveDocFile (Base::Writer &writer) const;
+    virtual bool isSaveDocFileThreadSafe (void) const { return true; }
     virtual void RestoreDocFile(Base::Reader &reader);
     
     virtual Property *Copy(void) const;
@@ -874,6 +875,7 @@ public:
     virtual void Restore(Base::XMLReader &reader);
     
     virtual void SaveDocFile (Base::Writer &writer) const;
+    virtual bool isSaveDocFileThreadSafe (void) const { return true; }
     virtual void RestoreDocFile(Base::Reader &reader);
     
     virtual Property *Copy(void) const;
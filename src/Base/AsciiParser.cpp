@@ -0,0 +1,235 @@
+/***************************************************************************
+ *   Copyright (c) 2026 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <cstring>
+# include <istream>
+#endif
+
+#include "AsciiParser.h"
+
+
+using namespace Base;
+
+namespace {
+// Powers of ten that are exactly representable as double
+const double exactPowers[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+inline bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+}
+
+const char* AsciiParser::lineEnd(const char* pos, const char* end)
+{
+    const char* eol = static_cast<const char*>(std::memchr(pos, '\n', end - pos));
+    return eol ? eol : end;
+}
+
+const char* AsciiParser::parseDouble(const char* pos, const char* end, double& value)
+{
+    pos = skipBlanks(pos, end);
+
+    bool negative = false;
+    if (pos != end && (*pos == '+' || *pos == '-')) {
+        negative = (*pos == '-');
+        ++pos;
+    }
+
+    // Collect up to 19 significant digits, they always fit into 64 bits
+    unsigned long long mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool valid = false;
+    for (; pos != end && isDigit(*pos); ++pos) {
+        valid = true;
+        if (digits < 19) {
+            mantissa = 10 * mantissa + (*pos - '0');
+            if (mantissa > 0)
+                digits++;
+        }
+        else {
+            exponent++;
+        }
+    }
+
+    if (pos != end && *pos == '.') {
+        for (++pos; pos != end && isDigit(*pos); ++pos) {
+            valid = true;
+            if (digits < 19) {
+                mantissa = 10 * mantissa + (*pos - '0');
+                if (mantissa > 0)
+                    digits++;
+                exponent--;
+            }
+        }
+    }
+
+    if (!valid)
+        return 0;
+
+    if (pos != end && (*pos == 'e' || *pos == 'E')) {
+        const char* exp = pos + 1;
+        bool negexp = false;
+        if (exp != end && (*exp == '+' || *exp == '-')) {
+            negexp = (*exp == '-');
+            ++exp;
+        }
+        if (exp != end && isDigit(*exp)) {
+            int e = 0;
+            for (; exp != end && isDigit(*exp); ++exp) {
+                if (e < 10000)
+                    e = 10 * e + (*exp - '0');
+            }
+            exponent += negexp ? -e : e;
+            pos = exp;
+        }
+    }
+
+    double v = static_cast<double>(mantissa);
+    if (v != 0.0) {
+        while (exponent > 22 && v < 1e308) {
+            v *= 1e22;
+            exponent -= 22;
+        }
+        while (exponent < -22 && v > 0.0) {
+            v /= 1e22;
+            exponent += 22;
+        }
+        if (exponent > 22)
+            v *= 1e22; // overflow
+        else if (exponent < -22)
+            v = 0.0;   // underflow
+        else if (exponent > 0)
+            v *= exactPowers[exponent];
+        else if (exponent < 0)
+            v /= exactPowers[-exponent];
+    }
+
+    value = negative ? -v : v;
+    return pos;
+}
+
+const char* AsciiParser::parseFloat(const char* pos, const char* end, float& value)
+{
+    double v;
+    pos = parseDouble(pos, end, v);
+    if (pos)
+        value = static_cast<float>(v);
+    return pos;
+}
+
+const char* AsciiParser::parseUnsigned(const char* pos, const char* end, unsigned long& value)
+{
+    pos = skipBlanks(pos, end);
+    if (pos == end || !isDigit(*pos))
+        return 0;
+
+    unsigned long v = 0;
+    for (; pos != end && isDigit(*pos); ++pos)
+        v = 10 * v + (*pos - '0');
+    value = v;
+    return pos;
+}
+
+void AsciiParser::splitLines(const char* begin, const char* end, int parts,
+                             std::vector<std::pair<const char*, const char*> >& pieces)
+{
+    pieces.clear();
+    if (parts < 1)
+        parts = 1;
+
+    const char* start = begin;
+    std::size_t size = end - begin;
+    for (int i = 1; i < parts && start != end; i++) {
+        const char* cut = begin + (size * i) / parts;
+        if (cut < start)
+            cut = start;
+        cut = lineEnd(cut, end);
+        if (cut != end)
+            ++cut;
+        if (cut != start)
+            pieces.push_back(std::make_pair(start, cut));
+        start = cut;
+    }
+
+    if (start != end)
+        pieces.push_back(std::make_pair(start, end));
+}
+
+// ----------------------------------------------------------------------------
+
+AsciiBlockReader::AsciiBlockReader(std::istream& str, std::size_t blockSize)
+  : _str(str), _blockSize(blockSize > 0 ? blockSize : 1), _filled(0), _used(0)
+{
+}
+
+AsciiBlockReader::~AsciiBlockReader()
+{
+}
+
+bool AsciiBlockReader::next()
+{
+    // keep the incomplete line at the end of the previous block
+    std::size_t rest = _filled - _used;
+    if (rest > 0 && _used > 0)
+        std::memmove(&_data[0], &_data[_used], rest);
+    _filled = rest;
+    _used = 0;
+    if (_data.size() < _blockSize)
+        _data.resize(_blockSize);
+
+    for (;;) {
+        // a single line is longer than a block
+        if (_filled == _data.size())
+            _data.resize(2 * _data.size());
+
+        std::size_t start = _filled;
+        std::size_t count = 0;
+        if (_str) {
+            _str.read(&_data[_filled], static_cast<std::streamsize>(_data.size() - _filled));
+            count = static_cast<std::size_t>(_str.gcount());
+        }
+        _filled += count;
+
+        // the carried over part doesn't contain a line break
+        for (std::size_t i = _filled; i > start; --i) {
+            if (_data[i-1] == '\n') {
+                _used = i;
+                return true;
+            }
+        }
+
+        if (count == 0 || !_str) {
+            // last line without line break
+            _used = _filled;
+            return _used > 0;
+        }
+    }
+}
@@ -0,0 +1,111 @@
+/***************************************************************************
+ *   Copyright (c) 2026 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef BASE_ASCIIPARSER_H
+#define BASE_ASCIIPARSER_H
+
+#include <cstddef>
+#include <iosfwd>
+#include <utility>
+#include <vector>
+
+namespace Base
+{
+
+/**
+ * Helper functions to parse numbers of ASCII files much faster than with regular
+ * expressions or the C library. The parsing doesn't depend on the locale.
+ * All functions work on the range [pos, end) and don't need a terminating zero.
+ */
+struct BaseExport AsciiParser
+{
+    /** How the readers of ASCII formats parse a file. The parsers based on regular
+     * expressions are kept as fallback.
+     */
+    enum Mode {
+        Regex,      /**< Regular expressions, line by line */
+        Sequential, /**< Hand-written parser in one thread */
+        Parallel    /**< Hand-written parser with the file split over several threads */
+    };
+
+    /// Skips blanks, tabs and carriage returns.
+    static const char* skipBlanks(const char* pos, const char* end)
+    {
+        while (pos != end && (*pos == ' ' || *pos == '\t' || *pos == '\r'))
+            ++pos;
+        return pos;
+    }
+    /// Returns a pointer to the line break that ends the current line or \a end.
+    static const char* lineEnd(const char* pos, const char* end);
+    /** Parses a floating point number after optional blanks. On success the position
+     * behind the number is returned, otherwise 0. For up to 15 significant digits and
+     * decimal exponents up to 22 the result is correctly rounded, otherwise it may
+     * deviate by a few units in the last place.
+     */
+    static const char* parseDouble(const char* pos, const char* end, double& value);
+    /// The same as parseDouble() for float.
+    static const char* parseFloat(const char* pos, const char* end, float& value);
+    /** Parses an unsigned integer after optional blanks. On success the position behind
+     * the number is returned, otherwise 0.
+     */
+    static const char* parseUnsigned(const char* pos, const char* end, unsigned long& value);
+    /** Splits the range [begin, end) into at most \a parts pieces of about the same size
+     * that end at a line break. So, they can be parsed independently, e.g. in several threads.
+     */
+    static void splitLines(const char* begin, const char* end, int parts,
+                           std::vector<std::pair<const char*, const char*> >& pieces);
+};
+
+/**
+ * Reads a stream in large blocks that always end at a line break. Unlike reading
+ * the stream line by line this avoids a call into the stream for every line and
+ * the parsing of a block can be split over several threads.
+ */
+class BaseExport AsciiBlockReader
+{
+public:
+    AsciiBlockReader(std::istream&, std::size_t blockSize = 0x1000000);
+    ~AsciiBlockReader();
+
+    /** Reads the next block of complete lines and returns false if the end
+     * of the stream is reached.
+     */
+    bool next();
+    /// Start of the current block
+    const char* begin() const
+    { return _data.empty() ? 0 : &_data[0]; }
+    /// End of the current block
+    const char* end() const
+    { return begin() + _used; }
+
+private:
+    std::istream& _str;
+    std::vector<char> _data;
+    std::size_t _blockSize;
+    std::size_t _filled; /**< Number of characters read from the stream. */
+    std::size_t _used;   /**< Number of characters of the current block. */
+};
+
+} // namespace Base
+
+#endif // BASE_ASCIIPARSER_H
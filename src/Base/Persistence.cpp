@@ -26,8 +26,16 @@
 #ifndef _PreComp_
 #endif
 
+#include <QMutex>
+
 /// Here the FreeCAD includes sorted by Base,App,Gui......
 #include "Persistence.h"
+#include "Console.h"
+#include "FileInfo.h"
+#include "Reader.h"
+
+#include <zipios++/zipios-config.h>
+#include <zipios++/zipinputstream.h>
 
 using namespace Base;
 
@@ -68,3 +76,73 @@ void Persistence::SaveDocFile (Writer &/*writer*/) const
 void Persistence::RestoreDocFile(Reader &/*reader*/)
 {
 }
+
+void Persistence::setDeferredDocFile(const DeferredFile &/*file*/)
+{
+}
+
+// ----------------------------------------------------------------------------
+
+namespace Base {
+// All deferred files share one lock. Reading them is rare enough that there
+// is no point in letting several threads read from the same archive at once.
+static QMutex deferredMutex(QMutex::Recursive);
+}
+
+DeferredFile::DeferredFile()
+  : _offset(0), _fileVersion(0), _size(0), _pending(false)
+{
+}
+
+DeferredFile::DeferredFile(const std::string& archive, const std::string& fileName,
+                           std::streamoff offset, int version)
+  : _archive(archive), _fileName(fileName), _offset(offset), _fileVersion(version)
+  , _pending(true)
+{
+    // remember the state of the archive to detect if it gets overwritten
+    FileInfo fi(archive);
+    _modified = fi.lastModified();
+    _size = fi.size();
+}
+
+bool DeferredFile::isPending() const
+{
+    QMutexLocker locker(&deferredMutex);
+    return _pending;
+}
+
+const std::string& DeferredFile::getFileName() const
+{
+    return _fileName;
+}
+
+void DeferredFile::clear()
+{
+    QMutexLocker locker(&deferredMutex);
+    _pending = false;
+}
+
+void DeferredFile::restore(const boost::function<void (Reader&)>& read)
+{
+    QMutexLocker locker(&deferredMutex);
+    if (!_pending)
+        return;
+    // reset the flag first so that accessing the data while reading doesn't recurse
+    _pending = false;
+
+    FileInfo fi(_archive);
+    if (!fi.exists() || fi.lastModified() != _modified || fi.size() != _size) {
+        Console().Error("Cannot read embedded file %s because %s has been modified\n",
+            _fileName.c_str(), _archive.c_str());
+        return;
+    }
+
+    try {
+        zipios::ZipInputStream zipstream(_archive, _offset);
+        Reader reader(zipstream, _fileVersion);
+        read(reader);
+    }
+    catch (...) {
+        Console().Error("Reading failed from embedded file: %s\n", _fileName.c_str());
+    }
+}
@@ -28,14 +28,18 @@
 
 
 #include <assert.h>
+#include <string>
+#include <boost/function.hpp>
 
 #include "BaseClass.h"
+#include "TimeInfo.h"
 
 namespace Base
 {
 class Reader;
 class Writer;
 class XMLReader;
+class DeferredFile;
 
 /// Persistence class and root of the type system
 class BaseExport Persistence : public BaseClass
@@ -116,6 +120,14 @@ public:
      * In this method you can simply stream your content to the file (Base::Writer inheriting from ostream).
      */
     virtual void SaveDocFile (Writer &/*writer*/) const;
+    /** Returns true if SaveDocFile() only reads data of this object and doesn't
+     * use anything else than the stream of the passed writer. Then the writer is
+     * allowed to serialize and compress the file in a worker thread into a buffer
+     * while other files are written. The default is false.
+     */
+    virtual bool isSaveDocFileThreadSafe (void) const {
+        return false;
+    }
     /** This method is used to restore large amounts of data from a file
      * In this method you simply stream in your with SaveDocFile() saved data.
      * Again you have to apply for the call of this method in the Restore() call:
@@ -146,6 +158,55 @@ public:
      * @see Base::Reader,Base::XMLReader
      */
     virtual void RestoreDocFile(Reader &/*reader*/);
+    /** Returns true if RestoreDocFile() can be postponed until the data is
+     * accessed the first time. If the reader runs in deferred mode it then
+     * passes a handle to the file with setDeferredDocFile() instead of calling
+     * RestoreDocFile(), and the object must read it on its own with
+     * DeferredFile::restore() as soon as its data is needed. The default is false.
+     * @see Base::DeferredFile
+     */
+    virtual bool isRestoreDocFileDeferrable (void) const {
+        return false;
+    }
+    /// Takes the handle of a postponed file, see isRestoreDocFileDeferrable()
+    virtual void setDeferredDocFile(const DeferredFile &/*file*/);
+};
+
+/** The deferred file class
+ * It is a handle to a file of a project archive whose reading has been postponed
+ * by XMLReader::readFiles(). It keeps the archive name and the offset of the
+ * entry inside the archive so that the file can be read directly when its owner
+ * needs the data the first time.
+ * \see Persistence::isRestoreDocFileDeferrable()
+ */
+class BaseExport DeferredFile
+{
+public:
+    DeferredFile();
+    DeferredFile(const std::string& archive, const std::string& fileName,
+                 std::streamoff offset, int version);
+
+    /// check whether the file still must be read
+    bool isPending() const;
+    /// get the name of the file inside the archive
+    const std::string& getFileName() const;
+    /// drop the request, e.g. if the owner got a new value in the meantime
+    void clear();
+    /** Read the file with \a read and drop the request. Only the first call
+     * reads the file, concurrent calls from other threads wait until it's done.
+     * If the archive has been modified since the request was made nothing is
+     * read and an error is reported.
+     */
+    void restore(const boost::function<void (Reader&)>& read);
+
+private:
+    std::string _archive;
+    std::string _fileName;
+    std::streamoff _offset;
+    int _fileVersion;
+    TimeInfo _modified;
+    unsigned int _size;
+    bool _pending;
 };
 
 } //namespace Base
@@ -30,7 +30,9 @@
 # include <xercesc/sax2/SAX2XMLReader.hpp>
 #endif
 
+#include <cstring>
 #include <locale>
+#include <memory>
 
 /// Here the FreeCAD includes sorted by Base,App,Gui......
 #include "Reader.h"
@@ -43,11 +45,14 @@
 
 #include <zipios++/zipios-config.h>
 #include <zipios++/zipfile.h>
+#include <zipios++/ziphead.h>
 #include <zipios++/zipinputstream.h>
 #include <zipios++/zipoutputstream.h>
 #include <zipios++/meta-iostreams.h>
 
 #include "XMLTools.h"
+#include "Stream.h"
+#include "Swap.h"
 
 XERCES_CPP_NAMESPACE_USE
 
@@ -60,7 +65,8 @@ using namespace std;
 // ---------------------------------------------------------------------------
 
 Base::XMLReader::XMLReader(const char* FileName, std::istream& str) 
-  : DocumentSchema(0), ProgramVersion(""), FileVersion(0), Level(0), _File(FileName)
+  : DocumentSchema(0), ProgramVersion(""), FileVersion(0), Level(0), _File(FileName), _deferred(false)
+  , _binary(0)
 {
 #ifdef _MSC_VER
     str.imbue(std::locale::empty());
@@ -69,6 +75,21 @@ Base::XMLReader::XMLReader(const char* FileName, std::istream& str)
     str.imbue(std::locale::classic());
 #endif
 
+    // the compact binary format doesn't need the XML parser
+    if (str.peek() == static_cast<unsigned char>(BinaryXMLWriter::Magic[0])) {
+        parser = 0;
+        _binary = &str;
+        try {
+            _valid = readBinaryHeader();
+        }
+        catch (...) {
+            _valid = false;
+        }
+        if (!_valid)
+            cerr << "Invalid binary document " << _File.filePath() << "\n";
+        return;
+    }
+
     // create the parser
     parser = XMLReaderFactory::createXMLReader();
     //parser->setFeature(XMLUni::fgSAX2CoreNameSpaces, false);
@@ -182,6 +203,8 @@ bool Base::XMLReader::hasAttribute (const char* AttrName) const
 bool Base::XMLReader::read(void)
 {
     ReadType = None;
+    if (_binary)
+        return readBinary();
 
     try {
         parser->parseNext(token);
@@ -226,6 +249,218 @@ bool Base::XMLReader::read(void)
     return true;
 }
 
+bool Base::XMLReader::readBinaryHeader(void)
+{
+    char magic[sizeof(BinaryXMLWriter::Magic)];
+    _binary->read(magic, sizeof(magic));
+    if (!*_binary || memcmp(magic, BinaryXMLWriter::Magic, sizeof(magic)) != 0)
+        return false;
+
+    Base::InputStream str(*_binary);
+    if (Base::SwapOrder() != LOW_ENDIAN)
+        str.setByteOrder(Base::Stream::BigEndian);
+    uint32_t version = 0, count = 0, size = 0;
+    str >> version;
+    if (version > BinaryXMLWriter::Version)
+        return false;
+    str >> count >> size;
+    if (!*_binary)
+        return false;
+
+    _binaryOffsets.resize(count);
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t offset;
+        str >> offset;
+        if (offset >= size)
+            return false;
+        _binaryOffsets[i] = offset;
+    }
+    _binaryStrings.resize(size);
+    if (size > 0)
+        _binary->read(&_binaryStrings[0], size);
+    // all strings must be terminated
+    if (!*_binary || (size > 0 && _binaryStrings.back() != '\0'))
+        return false;
+    return true;
+}
+
+const char* Base::XMLReader::binaryString(unsigned long index) const
+{
+    if (index >= _binaryOffsets.size())
+        throw Base::XMLParseException("Invalid string index in binary document");
+    return &_binaryStrings[_binaryOffsets[index]];
+}
+
+bool Base::XMLReader::readBinary(void)
+{
+    Base::InputStream str(*_binary);
+    if (Base::SwapOrder() != LOW_ENDIAN)
+        str.setByteOrder(Base::Stream::BigEndian);
+    uint32_t type = BinaryXMLWriter::End;
+    uint32_t name, text, count;
+    str >> type;
+    if (!*_binary)
+        throw Base::XMLParseException("Unexpected end of binary document");
+
+    switch (type) {
+    case BinaryXMLWriter::StartElement:
+    case BinaryXMLWriter::StartEndElement:
+        str >> name >> count;
+        LocalName = binaryString(name);
+        AttrMap.clear();
+        for (uint32_t i = 0; i < count && *_binary; i++) {
+            uint32_t key, value;
+            str >> key >> value;
+            AttrMap[binaryString(key)] = binaryString(value);
+        }
+        // an empty element opens and closes its scope at once
+        if (type == BinaryXMLWriter::StartElement) {
+            Level++;
+            ReadType = StartElement;
+        }
+        else {
+            ReadType = StartEndElement;
+        }
+        break;
+    case BinaryXMLWriter::EndElement:
+        str >> name;
+        Level--;
+        LocalName = binaryString(name);
+        ReadType = EndElement;
+        break;
+    case BinaryXMLWriter::Characters:
+        str >> text;
+        Characters = binaryString(text);
+        CharacterCount += Characters.size();
+        ReadType = Chars;
+        break;
+    case BinaryXMLWriter::CDATA:
+        // like the XML parser report the whole section at once
+        str >> text;
+        Characters = binaryString(text);
+        CharacterCount += Characters.size();
+        ReadType = EndCDATA;
+        break;
+    case BinaryXMLWriter::End:
+        return false;
+    default:
+        throw Base::XMLParseException("Invalid record in binary document");
+    }
+
+    if (!*_binary)
+        throw Base::XMLParseException("Unexpected end of binary document");
+    return true;
+}
+
+static std::string encodeXML(const std::string& str, bool attribute)
+{
+    std::string tmp;
+    for (std::string::const_iterator it = str.begin(); it != str.end(); ++it) {
+        if (*it == '<')
+            tmp += "&lt;";
+        else if (*it == '&')
+            tmp += "&amp;";
+        else if (*it == '>')
+            tmp += "&gt;";
+        else if (attribute && *it == '"')
+            tmp += "&quot;";
+        else if (attribute && *it == '\r')
+            tmp += "&#xD;";
+        else if (attribute && *it == '\n')
+            tmp += "&#xA;";
+        else if (attribute && *it == '\t')
+            tmp += "&#x9;";
+        else
+            tmp += *it;
+    }
+
+    return tmp;
+}
+
+static void writeXMLElement(std::ostream& out, const std::string& name,
+                            const std::map<std::string,std::string>& attrs, bool empty)
+{
+    out << "<" << name;
+    for (std::map<std::string,std::string>::const_iterator it = attrs.begin(); it != attrs.end(); ++it)
+        out << " " << it->first << "=\"" << encodeXML(it->second, true) << "\"";
+    out << (empty ? "/>" : ">");
+}
+
+void Base::XMLReader::convert(std::ostream& out, bool binary)
+{
+    BinaryXMLWriter bin;
+    if (!binary)
+        out << "<?xml version='1.0' encoding='utf-8'?>";
+
+    // Whitespace between the elements is dropped, for XML the elements are
+    // indented again unless they are part of character data.
+    bool started = false;
+    bool text = false;
+    while (!started || Level > 0) {
+        int level = Level;
+        if (!read())
+            break;
+        switch (ReadType) {
+        case StartElement:
+        case StartEndElement:
+            started = true;
+            if (binary) {
+                bin.startElement(LocalName, AttrMap, ReadType == StartEndElement);
+            }
+            else {
+                if (!text)
+                    out << std::endl << std::string(4 * level, ' ');
+                writeXMLElement(out, LocalName, AttrMap, ReadType == StartEndElement);
+            }
+            text = false;
+            break;
+        case EndElement:
+            if (binary) {
+                bin.endElement(LocalName);
+            }
+            else {
+                if (!text)
+                    out << std::endl << std::string(4 * Level, ' ');
+                out << "</" << LocalName << ">";
+            }
+            text = false;
+            break;
+        case Chars:
+            if (!text && Characters.find_first_not_of(" \t\r\n") == std::string::npos)
+                break;
+            if (binary)
+                bin.characters(Characters, false);
+            else
+                out << encodeXML(Characters, false);
+            text = true;
+            break;
+        case EndCDATA:
+            if (binary) {
+                bin.characters(Characters, true);
+            }
+            else {
+                // a section cannot contain its end marker, so split it there
+                std::string cdata = Characters;
+                std::string::size_type pos = 0;
+                while ((pos = cdata.find("]]>", pos)) != std::string::npos) {
+                    cdata.replace(pos, 3, "]]]]><![CDATA[>");
+                    pos += 15;
+                }
+                out << "<![CDATA[" << cdata << "]]>";
+            }
+            text = true;
+            break;
+        default:
+            break;
+        }
+    }
+
+    if (binary)
+        bin.write(out);
+    else
+        out << std::endl;
+}
+
 void Base::XMLReader::readElement(const char* ElementName)
 {
     bool ok;
@@ -292,6 +527,21 @@ void Base::XMLReader::readFiles(zipios::ZipInputStream &zipstream) const
         // project file was created without GUI
         return;
     }
+    // In deferred mode the central directory of the archive tells where the
+    // entries start so that they can be read later on without the stream.
+    std::auto_ptr<zipios::ZipFile> archive;
+    if (_deferred) {
+        try {
+            archive.reset(new zipios::ZipFile(_File.filePath()));
+            if (!archive->isValid())
+                archive.reset();
+        }
+        catch (const std::exception&) {
+            // read all files immediately then
+            archive.reset();
+        }
+    }
+
     std::vector<FileEntry>::const_iterator it = FileList.begin();
     Base::SequencerLauncher seq("Importing project files...", FileList.size());
     while (entry->isValid() && it != FileList.end()) {
@@ -303,7 +553,16 @@ void Base::XMLReader::readFiles(zipios::ZipInputStream &zipstream) const
         // If this condition is true both file names match and we can read-in the data, otherwise
         // no file name for the current entry in the zip was registered.
         if (jt != FileList.end()) {
-            try {
+            zipios::ConstEntryPointer cdir;
+            if (archive.get() && jt->Object->isRestoreDocFileDeferrable())
+                cdir = archive->getEntry(entry->getName());
+            if (cdir) {
+                std::streamoff offset = static_cast<const zipios::ZipCDirEntry*>
+                    (cdir.get())->getLocalHeaderOffset();
+                jt->Object->setDeferredDocFile(DeferredFile(_File.filePath(),
+                    entry->getName(), offset, DocumentSchema));
+            }
+            else try {
                 Base::Reader reader(zipstream,DocumentSchema);
                 jt->Object->RestoreDocFile(reader);
             }
@@ -332,6 +591,16 @@ void Base::XMLReader::readFiles(zipios::ZipInputStream &zipstream) const
     }
 }
 
+void Base::XMLReader::setDeferredLoading(bool on)
+{
+    _deferred = on;
+}
+
+bool Base::XMLReader::isDeferredLoading() const
+{
+    return _deferred;
+}
+
 const char *Base::XMLReader::addFile(const char* Name, Base::Persistence *Object)
 {
     FileEntry temp;
@@ -120,6 +120,8 @@ public:
     ~XMLReader();
 
     bool isValid() const { return _valid; }
+    /// check whether the document is read from the compact binary format
+    bool isBinary() const { return _binary != 0; }
 
     /** @name Parser handling */
     //@{
@@ -156,6 +158,21 @@ public:
     const char *addFile(const char* Name, Base::Persistence *Object);
     /// process the requested file writes
     void readFiles(zipios::ZipInputStream &zipstream) const;
+    /** Postpone the reading of files whose objects support it, see
+     * Persistence::isRestoreDocFileDeferrable(). This requires that the reader
+     * was created with the file name of the project archive.
+     */
+    void setDeferredLoading(bool on);
+    bool isDeferredLoading() const;
+    //@}
+
+    /** @name Conversion */
+    //@{
+    /** Write the document the reader is opened on to \a out. If \a binary is true
+     * the compact binary format of BinaryXMLWriter is written, otherwise XML. As the
+     * reader accepts both formats this converts in either direction.
+     */
+    void convert(std::ostream& out, bool binary);
     /// get all registered file names
     const std::vector<std::string>& getFilenames() const;
     bool isRegistered(Base::Persistence *Object) const;
@@ -174,6 +191,10 @@ public:
 protected:
     /// read the next element
     bool read(void);
+    /// read the next record of the compact binary format
+    bool readBinary(void);
+    bool readBinaryHeader(void);
+    const char* binaryString(unsigned long) const;
 
     // -----------------------------------------------------------------------
     //  Handlers for the SAX ContentHandler interface
@@ -224,6 +245,12 @@ protected:
     XERCES_CPP_NAMESPACE_QUALIFIER SAX2XMLReader* parser;
     XERCES_CPP_NAMESPACE_QUALIFIER XMLPScanToken token;
     bool _valid;
+    bool _deferred;
+
+    // set if the compact binary format is read
+    std::istream* _binary;
+    std::vector<unsigned long> _binaryOffsets;
+    std::vector<char> _binaryStrings;
 
     struct FileEntry {
         std::string FileName;
@@ -28,15 +28,24 @@
 
 /// Here the FreeCAD includes sorted by Base,App,Gui......
 #include "Writer.h"
+#include "Reader.h"
 #include "Persistence.h"
 #include "Exception.h"
 #include "Base64.h"
 #include "FileInfo.h"
 #include "Stream.h"
+#include "Swap.h"
 #include "Tools.h"
+#include "Console.h"
 
 #include <algorithm>
 #include <locale>
+#include <map>
+#include <zlib.h>
+
+#include <QFuture>
+#include <QThread>
+#include <QtConcurrentRun>
 
 using namespace Base;
 using namespace std;
@@ -179,45 +188,358 @@ void Writer::decInd(void)
 }
 
 ZipWriter::ZipWriter(const char* FileName) 
-  : ZipStream(FileName)
+  : ZipStream(FileName), compressionLevel(Z_DEFAULT_COMPRESSION), parallel(false)
+  , binaryEntry(false)
 {
-#ifdef _MSC_VER
-    ZipStream.imbue(std::locale::empty());
-#else
-    //FIXME: Check whether this is correct
-    ZipStream.imbue(std::locale::classic());
-#endif
-    ZipStream.precision(12);
-    ZipStream.setf(ios::fixed,ios::floatfield);
+    setupStream(ZipStream);
 }
 
 ZipWriter::ZipWriter(std::ostream& os) 
-  : ZipStream(os)
+  : ZipStream(os), compressionLevel(Z_DEFAULT_COMPRESSION), parallel(false)
+  , binaryEntry(false)
+{
+    setupStream(ZipStream);
+}
+
+void ZipWriter::setupStream(std::ostream& str)
 {
 #ifdef _MSC_VER
-    ZipStream.imbue(std::locale::empty());
+    str.imbue(std::locale::empty());
 #else
     //FIXME: Check whether this is correct
-    ZipStream.imbue(std::locale::classic());
+    str.imbue(std::locale::classic());
 #endif
-    ZipStream.precision(12);
-    ZipStream.setf(ios::fixed,ios::floatfield);
+    str.precision(12);
+    str.setf(ios::fixed,ios::floatfield);
+}
+
+void ZipWriter::putNextBinaryEntry(const char* str)
+{
+    putNextEntry(str);
+    XmlBuffer.str(std::string());
+    XmlBuffer.clear();
+    setupStream(XmlBuffer);
+    binaryEntry = true;
+}
+
+void ZipWriter::flushBinaryEntry()
+{
+    if (!binaryEntry)
+        return;
+    binaryEntry = false;
+    XMLReader reader("Document.xml", XmlBuffer);
+    if (!reader.isValid())
+        throw Base::Exception("ZipWriter: Cannot convert invalid XML to binary format");
+    reader.convert(ZipStream, true);
+    XmlBuffer.str(std::string());
+}
+
+namespace Base {
+// zip archives without the Zip64 extension store the sizes in 32 bits
+const size_t ZipSizeLimit = 0xFFFFFFFFUL;
+// the largest piece of data that is passed to zlib at once
+const size_t ZlibChunkSize = 1UL << 30;
+// the size of the deflated files that may wait to be written while further files are started
+const size_t MaxPendingBytes = 256UL << 20;
+
+/// Stream buffer that collects the bytes in a vector which can be handed over without a copy
+class VectorStreambuf : public std::streambuf
+{
+public:
+    std::vector<char> data;
+
+protected:
+    virtual int_type overflow(int_type c)
+    {
+        if (!traits_type::eq_int_type(c, traits_type::eof()))
+            data.push_back(traits_type::to_char_type(c));
+        return traits_type::not_eof(c);
+    }
+    virtual std::streamsize xsputn(const char* s, std::streamsize n)
+    {
+        data.insert(data.end(), s, s + n);
+        return n;
+    }
+};
+
+/// Writer used by the worker threads of ZipWriter to save a file into memory
+class BufferWriter : public Writer
+{
+public:
+    BufferWriter(int version) : Buffer(&Data) { setFileVersion(version); }
+    virtual std::ostream &Stream(void){return Buffer;}
+    virtual void writeFiles(void){assert(0);}
+    VectorStreambuf Data;
+    std::ostream Buffer;
+};
+
+/// A file saved and deflated by a worker thread
+struct DeflatedFile
+{
+    DeflatedFile(int version) : writer(version), crc(0), size(0), failed(false) {}
+    QFuture<void> future;
+    BufferWriter writer;
+    std::vector<char> data;
+    unsigned long crc;
+    unsigned long size;
+    bool failed;
+    std::string error;
+};
+}
+
+static void deflateDocFile(const Base::Persistence* object, int level, Base::DeflatedFile* file)
+{
+    try {
+        object->SaveDocFile(file->writer);
+    }
+    catch (const Base::Exception& e) {
+        file->failed = true;
+        file->error = e.what();
+        return;
+    }
+    catch (const std::exception& e) {
+        file->failed = true;
+        file->error = e.what();
+        return;
+    }
+    catch (...) {
+        file->failed = true;
+        file->error = "Unknown exception while saving file";
+        return;
+    }
+
+    // take over the buffer of the stream, it's freed when the function returns
+    std::vector<char> buf;
+    buf.swap(file->writer.Data.data);
+    if (buf.size() > ZipSizeLimit) {
+        file->failed = true;
+        file->error = "File exceeds the 4 GB limit of the zip format";
+        return;
+    }
+
+    // zlib takes the lengths as uInt, so the data is passed in pieces
+    Bytef* in = buf.empty() ? 0 : reinterpret_cast<Bytef*>(&buf[0]);
+    file->size = buf.size();
+    file->crc = crc32(0, Z_NULL, 0);
+    for (size_t pos = 0; pos < buf.size(); pos += ZlibChunkSize) {
+        uInt len = static_cast<uInt>(std::min<size_t>(ZlibChunkSize, buf.size() - pos));
+        file->crc = crc32(file->crc, in + pos, len);
+    }
+
+    // use the same settings as zipios++ does, i.e. a raw deflate stream
+    z_stream zs;
+    zs.zalloc = Z_NULL;
+    zs.zfree  = Z_NULL;
+    zs.opaque = Z_NULL;
+    if (deflateInit2(&zs, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        file->failed = true;
+        file->error = "Failed to initialize the compression";
+        return;
+    }
+
+    std::vector<char> out(1 << 18);
+    size_t left = buf.size();
+    zs.next_in = in;
+    zs.avail_in = 0;
+    int err;
+    do {
+        if (zs.avail_in == 0 && left > 0) {
+            zs.avail_in = static_cast<uInt>(std::min<size_t>(ZlibChunkSize, left));
+            left -= zs.avail_in;
+        }
+        zs.next_out = reinterpret_cast<Bytef*>(&out[0]);
+        zs.avail_out = static_cast<uInt>(out.size());
+        err = deflate(&zs, left == 0 ? Z_FINISH : Z_NO_FLUSH);
+        file->data.insert(file->data.end(), out.begin(), out.end() - zs.avail_out);
+    }
+    while (err == Z_OK);
+    deflateEnd(&zs);
+    if (err != Z_STREAM_END) {
+        file->failed = true;
+        file->error = "Failed to compress file";
+    }
+    else if (file->data.size() > ZipSizeLimit) {
+        file->failed = true;
+        file->error = "File exceeds the 4 GB limit of the zip format";
+    }
 }
 
 void ZipWriter::writeFiles(void)
 {
+    flushBinaryEntry();
+
     // use a while loop because it is possible that while
     // processing the files new ones can be added
     size_t index = 0;
+    if (!parallel) {
+        while (index < FileList.size()) {
+            FileEntry entry = FileList.begin()[index];
+            ZipStream.putNextEntry(entry.FileName);
+            entry.Object->SaveDocFile(*this);
+            index++;
+        }
+        return;
+    }
+
+    // Files with a thread-safe SaveDocFile() are deflated by the thread pool ahead of the
+    // one to be written. To limit the memory usage no further file is started as long as
+    // the finished files that wait to be written hold more than MaxPendingBytes.
+    const size_t window = static_cast<size_t>(std::max<int>(2, 2 * QThread::idealThreadCount()));
+    std::map<size_t, DeflatedFile*> jobs;
+    size_t launched = 0;
+    std::string error;
+
     while (index < FileList.size()) {
+        size_t pending = 0;
+        for (std::map<size_t, DeflatedFile*>::iterator it = jobs.begin(); it != jobs.end(); ++it) {
+            if (it->second->future.isFinished())
+                pending += it->second->data.size();
+        }
+        for (; launched < FileList.size() && launched < index + window &&
+               (launched == index || pending < MaxPendingBytes); launched++) {
+            const FileEntry& entry = FileList[launched];
+            if (entry.Object->isSaveDocFileThreadSafe()) {
+                DeflatedFile* file = new DeflatedFile(getFileVersion());
+                file->writer.ObjectName = ObjectName;
+                setupStream(file->writer.Buffer);
+                file->future = QtConcurrent::run(deflateDocFile, entry.Object, compressionLevel, file);
+                jobs[launched] = file;
+            }
+        }
+
         FileEntry entry = FileList.begin()[index];
-        ZipStream.putNextEntry(entry.FileName);
-        entry.Object->SaveDocFile(*this);
+        std::map<size_t, DeflatedFile*>::iterator it = jobs.find(index);
+        if (it == jobs.end()) {
+            ZipStream.putNextEntry(entry.FileName);
+            try {
+                entry.Object->SaveDocFile(*this);
+            }
+            catch (...) {
+                // wait for the running jobs because they refer to the buffers
+                for (it = jobs.begin(); it != jobs.end(); ++it) {
+                    it->second->future.waitForFinished();
+                    delete it->second;
+                }
+                throw;
+            }
+        }
+        else {
+            DeflatedFile* file = it->second;
+            file->future.waitForFinished();
+            if (file->failed) {
+                error = file->error;
+            }
+            else {
+                ZipStream.putRawEntry(entry.FileName, file->data.empty() ? "" : &file->data[0],
+                    static_cast<zipios::uint32>(file->data.size()), static_cast<zipios::uint32>(file->crc),
+                    static_cast<zipios::uint32>(file->size));
+            }
+            delete file;
+            jobs.erase(it);
+            if (!error.empty())
+                break;
+        }
         index++;
     }
+
+    if (!error.empty()) {
+        for (std::map<size_t, DeflatedFile*>::iterator it = jobs.begin(); it != jobs.end(); ++it) {
+            it->second->future.waitForFinished();
+            delete it->second;
+        }
+        throw Base::Exception(error);
+    }
 }
 
 ZipWriter::~ZipWriter()
 {
+    // a destructor must not throw, but a lost binary entry must not go unnoticed
+    try {
+        flushBinaryEntry();
+    }
+    catch (const Base::Exception& e) {
+        Base::Console().Error("ZipWriter: %s\n", e.what());
+    }
+    catch (const std::exception& e) {
+        Base::Console().Error("ZipWriter: %s\n", e.what());
+    }
+    catch (...) {
+        Base::Console().Error("ZipWriter: unknown error while writing the binary entry\n");
+    }
     ZipStream.close();
 }
+
+// ---------------------------------------------------------------------------
+
+const char BinaryXMLWriter::Magic[4] = { '\x89', 'F', 'C', 'B' };
+const unsigned long BinaryXMLWriter::Version = 1;
+
+BinaryXMLWriter::BinaryXMLWriter()
+{
+}
+
+BinaryXMLWriter::~BinaryXMLWriter()
+{
+}
+
+unsigned long BinaryXMLWriter::addString(const std::string& str)
+{
+    // the keys of the map don't move, so the table can refer to them
+    std::pair<std::map<std::string, unsigned long>::iterator, bool> it =
+        stringIndex.insert(std::make_pair(str, static_cast<unsigned long>(strings.size())));
+    if (it.second)
+        strings.push_back(&it.first->first);
+    return it.first->second;
+}
+
+void BinaryXMLWriter::startElement(const std::string& name,
+                                   const std::map<std::string,std::string>& attrs, bool empty)
+{
+    records.push_back(empty ? StartEndElement : StartElement);
+    records.push_back(addString(name));
+    records.push_back(attrs.size());
+    for (std::map<std::string,std::string>::const_iterator it = attrs.begin(); it != attrs.end(); ++it) {
+        records.push_back(addString(it->first));
+        records.push_back(addString(it->second));
+    }
+}
+
+void BinaryXMLWriter::endElement(const std::string& name)
+{
+    records.push_back(EndElement);
+    records.push_back(addString(name));
+}
+
+void BinaryXMLWriter::characters(const std::string& text, bool cdata)
+{
+    records.push_back(cdata ? CDATA : Characters);
+    records.push_back(addString(text));
+}
+
+void BinaryXMLWriter::write(std::ostream& out) const
+{
+    Base::OutputStream str(out);
+    // the stream writes native order, swap on big endian hosts
+    if (Base::SwapOrder() != LOW_ENDIAN)
+        str.setByteOrder(Base::Stream::BigEndian);
+    out.write(Magic, sizeof(Magic));
+    str << static_cast<uint32_t>(Version);
+
+    uint32_t size = 0;
+    std::vector<const std::string*>::const_iterator it;
+    for (it = strings.begin(); it != strings.end(); ++it)
+        size += static_cast<uint32_t>((*it)->size() + 1);
+    str << static_cast<uint32_t>(strings.size()) << size;
+
+    uint32_t offset = 0;
+    for (it = strings.begin(); it != strings.end(); ++it) {
+        str << offset;
+        offset += static_cast<uint32_t>((*it)->size() + 1);
+    }
+    for (it = strings.begin(); it != strings.end(); ++it)
+        out.write((*it)->c_str(), (*it)->size() + 1);
+
+    for (std::vector<unsigned long>::const_iterator jt = records.begin(); jt != records.end(); ++jt)
+        str << static_cast<uint32_t>(*jt);
+    str << static_cast<uint32_t>(End);
+}
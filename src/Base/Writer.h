@@ -27,6 +27,7 @@
 #include <string>
 #include <sstream>
 #include <vector>
+#include <map>
 #include <cassert>
 
 #include <zipios++/zipios-config.h>
@@ -128,14 +129,35 @@ public:
 
     virtual void writeFiles(void);
 
-    virtual std::ostream &Stream(void){return ZipStream;}
+    virtual std::ostream &Stream(void){
+        if (binaryEntry) return XmlBuffer;
+        return ZipStream;
+    }
 
     void setComment(const char* str){ZipStream.setComment(str);}
-    void setLevel(int level){ZipStream.setLevel( level );}
-    void putNextEntry(const char* str){ZipStream.putNextEntry(str);}
+    void setLevel(int level){ZipStream.setLevel( level ); compressionLevel = level;}
+    void putNextEntry(const char* str){flushBinaryEntry(); ZipStream.putNextEntry(str);}
+    /** Starts a new entry like putNextEntry() but the XML written to Stream() is
+     * stored in the compact binary format of BinaryXMLWriter. The XML is collected
+     * and converted when the next entry is started or the files get written.
+     */
+    void putNextBinaryEntry(const char* str);
+    /** If enabled the files of objects with a thread-safe SaveDocFile() are
+     * serialized and compressed by a thread pool into memory buffers and then
+     * written to the archive in the order they were added. By default it's off.
+     */
+    void setParallel(bool on){parallel = on;}
+
+private:
+    void setupStream(std::ostream&);
+    void flushBinaryEntry();
 
 private:
     zipios::ZipOutputStream ZipStream;
+    std::stringstream XmlBuffer;
+    int compressionLevel;
+    bool parallel;
+    bool binaryEntry;
 };
 
 /** The StringWriter class 
@@ -156,6 +178,61 @@ private:
     std::stringstream StrStream;
 };
 
+/** The BinaryXMLWriter class
+ * It writes the compact binary alternative to the XML of a document which can
+ * be read by XMLReader like XML. The elements are stored as typed records and
+ * all names, attribute values and character data go into one string table in
+ * front of the records. So, reading needs neither parsing nor transcoding and
+ * the strings can be used in place.
+ * All numbers are 32 bit unsigned integers in little endian order:
+ * \code
+ * magic "\x89FCB", format version
+ * number of strings n, size of the string block in bytes
+ * n offsets into the string block
+ * string block with 0-terminated UTF-8 strings
+ * records: the type followed by string indices, the End record closes the list
+ *   StartElement, StartEndElement: name, number of attributes, (name, value) pairs
+ *   EndElement: name
+ *   Characters, CDATA: text
+ * \endcode
+ * \see XMLReader::convert()
+ */
+class BaseExport BinaryXMLWriter
+{
+public:
+    enum Record {
+        End = 0,
+        StartElement,
+        StartEndElement,
+        EndElement,
+        Characters,
+        CDATA
+    };
+    /// the first bytes of the binary format
+    static const char Magic[4];
+    /// the current version of the format
+    static const unsigned long Version;
+
+    BinaryXMLWriter();
+    ~BinaryXMLWriter();
+
+    /// start an element, if \a empty is true it has no content and needs no end
+    void startElement(const std::string& name,
+                      const std::map<std::string,std::string>& attrs, bool empty);
+    void endElement(const std::string& name);
+    void characters(const std::string& text, bool cdata);
+    /// write the string table and the records to \a out
+    void write(std::ostream& out) const;
+
+private:
+    unsigned long addString(const std::string&);
+
+private:
+    std::map<std::string, unsigned long> stringIndex;
+    std::vector<const std::string*> strings;
+    std::vector<unsigned long> records;
+};
+
 
 }  //namespace Base
 
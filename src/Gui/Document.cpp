@@ -115,6 +115,9 @@ Document::Document(App::Document* pcDocument,Application * app)
     d->_pcDocument = pcDocument;
     d->_pcInEdit = 0;
 
+    // the view providers are built from the data while the document is restored
+    pcDocument->setDeferredLoading(false);
+
     // Setup the connections
     d->connectNewObject = pcDocument->signalNewObject.connect
         (boost::bind(&Gui::Document::slotNewObject, this, _1));
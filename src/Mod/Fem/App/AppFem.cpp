@@ -33,6 +33,7 @@
 #include "FemMeshPy.h"
 #include "FemMesh.h"
 #include "FemMeshProperty.h"
+#include "FemResultProperty.h"
 #include "FemAnalysis.h"
 #include "FemMeshObject.h"
 #include "FemMeshShapeObject.h"
@@ -124,6 +125,8 @@ void AppFemExport initFem()
     Fem::FemMeshShapeObject         ::init();
     Fem::FemMeshShapeNetgenObject   ::init();
     Fem::PropertyFemMesh            ::init();
+    Fem::FemResultData              ::init();
+    Fem::PropertyFemResult          ::init();
 
     Fem::FemSetObject               ::init();
     Fem::FemSetElementsObject       ::init();
@@ -28,6 +28,8 @@
 #endif
 
 #include <Base/Console.h>
+#include <Base/FileInfo.h>
+#include <Base/Stream.h>
 #include <Base/Tools.h>
 #include <Base/VectorPy.h>
 #include <Base/PlacementPy.h>
@@ -62,6 +64,8 @@
 #include "FemMesh.h"
 #include "FemMeshObject.h"
 #include "FemMeshPy.h"
+#include "FemResultValue.h"
+#include "FemResultVector.h"
 
 #include <cstdlib>
 
@@ -557,6 +561,77 @@ static PyObject * exporter(PyObject *self, PyObject *args)
     Py_Return;
 }
 
+static PyObject * readFrdResult(PyObject *self, PyObject *args)
+{
+    const char* Name;
+    PyObject* object;
+    const char* BlockName;
+    if (!PyArg_ParseTuple(args, "sO!s",&Name,&(App::DocumentObjectPy::Type),&object,&BlockName))
+        return NULL;
+
+    PY_TRY {
+        App::DocumentObject* obj = static_cast<App::DocumentObjectPy*>(object)->getDocumentObjectPtr();
+        if (!obj->getTypeId().isDerivedFrom(FemResultObject::getClassTypeId())) {
+            PyErr_SetString(PyExc_TypeError, "Result object expected");
+            return NULL;
+        }
+
+        Base::FileInfo file(Name);
+        if (!file.isReadable()) {
+            PyErr_Format(PyExc_IOError, "Cannot open file '%s'", Name);
+            return NULL;
+        }
+
+        // the steps are copied into a file owned by the result, the result file can be overwritten
+        Base::Reference<FemResultData> data(new FemResultData);
+        if (!data->readFrd(file.filePath(), BlockName))
+            return Py::new_reference_to(Py::Boolean(false));
+
+        FemResultObject* result = static_cast<FemResultObject*>(obj);
+        result->Result.setValuePtr(data);
+
+        // the lists of the result object hold the values of the last step
+        const FemResultData& values = *data;
+        unsigned long step = values.countSteps() - 1;
+        int components = values.countComponents();
+        std::vector<long> nodes;
+        std::vector<double> scalars;
+        std::vector<Base::Vector3d> vectors;
+        for (unsigned long i = 0; i < values.countNodes(); i++) {
+            long nodeId = values.getFirstNodeId() + (long)i;
+            const float* v = values.getNodeValues(step, nodeId);
+            if (v[0] != v[0]) // NaN, the node has no values
+                continue;
+            nodes.push_back(nodeId);
+            if (components == 3)
+                vectors.push_back(Base::Vector3d(v[0], v[1], v[2]));
+            else if (components == 6)
+                scalars.push_back(FemResultData::getVonMisesStress(v));
+            else
+                scalars.push_back(v[0]);
+        }
+
+        if (obj->getTypeId().isDerivedFrom(FemResultVector::getClassTypeId())) {
+            if (components != 3) {
+                PyErr_SetString(PyExc_ValueError, "Result has no vector values");
+                return NULL;
+            }
+            static_cast<FemResultVector*>(obj)->Values.setValues(vectors);
+        }
+        else if (obj->getTypeId().isDerivedFrom(FemResultValue::getClassTypeId())) {
+            if (components == 3) {
+                for (std::vector<Base::Vector3d>::iterator it = vectors.begin(); it != vectors.end(); ++it)
+                    scalars.push_back(it->Length());
+            }
+            static_cast<FemResultValue*>(obj)->Values.setValues(scalars);
+        }
+        result->ElementNumbers.setValues(nodes);
+        return Py::new_reference_to(Py::Boolean(true));
+    } PY_CATCH;
+
+    Py_Return;
+}
+
 // ----------------------------------------------------------------------------
 
 PyDoc_STRVAR(open_doc,
@@ -574,6 +649,10 @@ struct PyMethodDef Fem_methods[] = {
     {"insert"     ,importer,    METH_VARARGS, inst_doc},
     {"export"     ,exporter,    METH_VARARGS, export_doc},
     {"read"       ,read,        Py_NEWARGS,   "Read a mesh from a file and returns a Mesh object."},
+    {"readFrdResult",readFrdResult,METH_VARARGS,
+       "readFrdResult(string,result,string) -- Read the result blocks with the given name, e.g. DISP or STRESS,\n"
+       "of a CalculiX result file into the result object. Each block becomes a time step, the values of\n"
+       "the last step are set to the Values of the object. Returns False if the file has no such result."},
     {"show"       ,show      ,METH_VARARGS,
        "show(shape) -- Add the shape to the active document or create one if no document exists."},
     {NULL, NULL}  /* sentinel */
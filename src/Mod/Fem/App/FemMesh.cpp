@@ -24,6 +24,7 @@
 #include "PreCompiled.h"
 
 #ifndef _PreComp_
+# include <algorithm>
 # include <cstdlib>
 # include <memory>
 # include <strstream>
@@ -32,12 +33,17 @@
 # include <BRepExtrema_DistShapeShape.hxx>
 # include <TopoDS_Vertex.hxx>
 # include <BRepBuilderAPI_MakeVertex.hxx>
+# include <BRepBuilderAPI_Copy.hxx>
+# include <TopoDS.hxx>
+# include <Standard.hxx>
 # include <gp_Pnt.hxx>
+# include <Standard_Failure.hxx>
 #endif
 
 #include <Base/Writer.h>
 #include <Base/Reader.h>
 #include <Base/Stream.h>
+#include <Base/Swap.h>
 #include <Base/Exception.h>
 #include <Base/FileInfo.h>
 #include <Base/TimeInfo.h>
@@ -48,9 +54,13 @@
 #include <Mod/Mesh/App/Core/Iterator.h>
 
 #include "FemMesh.h"
+#include "FemNodeIndex.h"
 
 #include <SMESH_Gen.hxx>
 #include <SMESH_Mesh.hxx>
+#include <SMESH_Group.hxx>
+#include <SMESHDS_Group.hxx>
+#include <SMESHDS_Mesh.hxx>
 #include <SMDS_PolyhedralVolumeOfNodes.hxx>
 #include <SMDS_VolumeTool.hxx>
 #include <StdMeshers_MaxLength.hxx>
@@ -68,6 +78,10 @@
 
 //to simplify parsing input files we use the boost lib
 #include <boost/tokenizer.hpp>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QtConcurrentMap>
 
 
 using namespace Fem;
@@ -75,6 +89,8 @@ using namespace Base;
 using namespace boost;
 
 static int StatCount = 0;
+// guards the lazily built node index of all meshes
+static QMutex nodeIndexMutex;
 
 TYPESYSTEM_SOURCE(Fem::FemMesh , Base::Persistence);
 
@@ -129,6 +145,7 @@ void FemMesh::copyMeshData(const FemMesh& mesh)
     //int numHedr = info.NbPolyhedrons();
 
     _Mtrx = mesh._Mtrx;
+    clearNodeIndex();
 
     SMESHDS_Mesh* meshds = this->myMesh->GetMeshDS();
     meshds->ClearMesh();
@@ -326,6 +343,7 @@ const SMESH_Mesh* FemMesh::getSMesh() const
 
 SMESH_Mesh* FemMesh::getSMesh()
 {
+    // a caller that changes the nodes must call clearNodeIndex()
     return myMesh;
 }
 
@@ -387,6 +405,7 @@ void FemMesh::setStanardHypotheses()
 
 void FemMesh::compute()
 {
+    clearNodeIndex();
     myGen->Compute(*myMesh, myMesh->GetShapeToMesh());
 }
 
@@ -402,45 +421,144 @@ std::set<long> FemMesh::getSurfaceNodes(long ElemId,short FaceId, float Angle) c
     return result;
 }
 
+namespace Fem {
+// candidate nodes of getSurfaceNodes() measured by one thread
+struct FemMesh_FaceNodes
+{
+    TopoDS_Face face;
+    double limit;
+    const std::vector<int>* ids;
+    const std::vector<Base::Vector3d>* points;
+    std::size_t begin, end;
+    std::vector<int> found;
+    bool failed;
+};
+
+static void FemMesh_MeasureFaceNodes(FemMesh_FaceNodes& job)
+{
+    try {
+        for (std::size_t i = job.begin; i < job.end; i++) {
+            const Base::Vector3d& vec = (*job.points)[i];
+            // create a Vertex
+            BRepBuilderAPI_MakeVertex aBuilder(gp_Pnt(vec.x,vec.y,vec.z));
+            TopoDS_Shape s = aBuilder.Vertex();
+            // measure distance
+            BRepExtrema_DistShapeShape measure(job.face,s);
+            measure.Perform();
+            if (!measure.IsDone() || measure.NbSolution() < 1)
+                continue;
+
+            if (measure.Value() < job.limit)
+                job.found.push_back((*job.ids)[i]);
+        }
+    }
+    catch (Standard_Failure) {
+        job.failed = true;
+    }
+}
+}
+
 std::set<long> FemMesh::getSurfaceNodes(const TopoDS_Face &face)const
 {
 
     std::set<long> result;
-    const SMESHDS_Mesh* data = myMesh->GetMeshDS();
 
     Bnd_Box box;
     BRepBndLib::Add(face, box);
+    if (box.IsVoid())
+        return result;
     // limit where the mesh node belongs to the face:
     double limit = box.SquareExtent()/10000.0;
     box.Enlarge(limit);
 
-    // get the actuall transform of the FemMesh
-    const Base::Matrix4D Mtrx(getTransform());
+    // only the nodes inside the box of the face are measured
+    Standard_Real xMin, yMin, zMin, xMax, yMax, zMax;
+    box.Get(xMin, yMin, zMin, xMax, yMax, zMax);
+    std::vector<int> ids;
+    std::vector<Base::Vector3d> points;
+    findNodes(Base::BoundBox3d(xMin, yMin, zMin, xMax, yMax, zMax), ids, points);
+    if (ids.empty())
+        return result;
+
+    // The distance computation dominates, so the candidates are split over the threads.
+    // Each thread works on its own copy of the face.
+    Standard::SetReentrant(Standard_True);
+    std::size_t numThreads = std::max<int>(1, QThread::idealThreadCount());
+    std::size_t chunk = std::max<std::size_t>(64, (ids.size() + numThreads - 1) / numThreads);
+    std::vector<FemMesh_FaceNodes> jobs;
+    for (std::size_t i = 0; i < ids.size(); i += chunk) {
+        FemMesh_FaceNodes job;
+        job.face = jobs.empty() ? face : TopoDS::Face(BRepBuilderAPI_Copy(face).Shape());
+        job.limit = limit;
+        job.ids = &ids;
+        job.points = &points;
+        job.begin = i;
+        job.end = std::min<std::size_t>(i + chunk, ids.size());
+        job.failed = false;
+        jobs.push_back(job);
+    }
 
-    SMDS_NodeIteratorPtr aNodeIter = myMesh->GetMeshDS()->nodesIterator();
-	for (int i=0;aNodeIter->more();i++) {
-		const SMDS_MeshNode* aNode = aNodeIter->next();
-        Base::Vector3d vec(aNode->X(),aNode->Y(),aNode->Z());
-        // Apply the matrix to hold the BoundBox in absolute space. 
-        vec = Mtrx * vec;
+    if (jobs.size() > 1)
+        QtConcurrent::blockingMap(jobs, &FemMesh_MeasureFaceNodes);
+    else
+        FemMesh_MeasureFaceNodes(jobs.front());
 
-        if(!box.IsOut(gp_Pnt(vec.x,vec.y,vec.z))){
-            // create a Vertex
-            BRepBuilderAPI_MakeVertex aBuilder(gp_Pnt(vec.x,vec.y,vec.z));
-            TopoDS_Shape s = aBuilder.Vertex();
-            // measure distance
-            BRepExtrema_DistShapeShape measure(face,s);
-            measure.Perform();
-            if (!measure.IsDone() || measure.NbSolution() < 1)
-                continue;
-            
-            if(measure.Value() < limit)         
-                result.insert(aNode->GetID());
+    for (std::vector<FemMesh_FaceNodes>::iterator it = jobs.begin(); it != jobs.end(); ++it) {
+        if (it->failed)
+            throw Base::Exception("Failed to measure the distance of the nodes to the face");
+        result.insert(it->found.begin(), it->found.end());
+    }
+
+    return result;
+}
+
+std::set<long> FemMesh::getNodesByBox(const Base::BoundBox3d &box)const
+{
+    std::vector<int> ids;
+    std::vector<Base::Vector3d> points;
+    findNodes(box, ids, points);
+    return std::set<long>(ids.begin(), ids.end());
+}
+
+boost::shared_ptr<const FemNodeIndex> FemMesh::getNodeIndex() const
+{
+    // The index is only replaced under the lock, an index still used by another thread
+    // is kept alive by its shared pointer. The node count additionally catches changes
+    // that were not followed by clearNodeIndex().
+    QMutexLocker locker(&nodeIndexMutex);
+    const SMESHDS_Mesh* data = myMesh->GetMeshDS();
+    if (nodeIndex && nodeIndex->countNodes() != static_cast<unsigned long>(data->NbNodes()))
+        nodeIndex.reset();
+    if (!nodeIndex)
+        nodeIndex.reset(new FemNodeIndex(data));
+    return nodeIndex;
+}
 
+void FemMesh::findNodes(const Base::BoundBox3d& box, std::vector<int>& ids,
+                        std::vector<Base::Vector3d>& points) const
+{
+    // the index is in mesh coordinates, hence search with the box transformed back
+    Base::Matrix4D inverse(_Mtrx);
+    inverse.inverseGauss();
+    Base::BoundBox3d local = box.Transformed(inverse);
+    local.Enlarge(1.0e-6 * local.CalcDiagonalLength());
+
+    std::vector<int> candIds;
+    std::vector<Base::Vector3d> candPoints;
+    getNodeIndex()->search(local, candIds, candPoints);
+    for (std::size_t i = 0; i < candIds.size(); i++) {
+        Base::Vector3d vec = _Mtrx * candPoints[i];
+        if (box.IsInBox(vec)) {
+            ids.push_back(candIds[i]);
+            points.push_back(vec);
         }
-	}
+    }
+}
 
-    return result;
+void FemMesh::clearNodeIndex() const
+{
+    QMutexLocker locker(&nodeIndexMutex);
+    nodeIndex.reset();
 }
 
 
@@ -624,6 +742,7 @@ void FemMesh::read(const char *FileName)
 {
     Base::FileInfo File(FileName);
     _Mtrx = Base::Matrix4D();
+    clearNodeIndex();
   
     // checking on the file
     if (!File.isReadable())
@@ -755,7 +874,7 @@ void FemMesh::Save (Base::Writer &writer) const
 {
     //See SaveDocFile(), RestoreDocFile()
     writer.Stream() << writer.ind() << "<FemMesh file=\"" ;
-    writer.Stream() << writer.addFile("FemMesh.unv", this) << "\"";
+    writer.Stream() << writer.addFile("FemMesh.bin", this) << "\"";
     writer.Stream() << " a11=\"" <<  _Mtrx[0][0] << "\" a12=\"" <<  _Mtrx[0][1] << "\" a13=\"" <<  _Mtrx[0][2] << "\" a14=\"" <<  _Mtrx[0][3] << "\"";
     writer.Stream() << " a21=\"" <<  _Mtrx[1][0] << "\" a22=\"" <<  _Mtrx[1][1] << "\" a23=\"" <<  _Mtrx[1][2] << "\" a24=\"" <<  _Mtrx[1][3] << "\"";
     writer.Stream() << " a31=\"" <<  _Mtrx[2][0] << "\" a32=\"" <<  _Mtrx[2][1] << "\" a33=\"" <<  _Mtrx[2][2] << "\" a34=\"" <<  _Mtrx[2][3] << "\"";
@@ -798,42 +917,343 @@ void FemMesh::Restore(Base::XMLReader &reader)
     }
 }
 
-void FemMesh::SaveDocFile (Base::Writer &writer) const
+namespace Fem {
+
+// The binary format of the mesh stores the arrays in blocks of this number of values
+// instead of streaming every single value
+const unsigned long FemMesh_BlockSize = 0x30000;
+// The first bytes of the binary format, an UNV file starts with blanks
+const uint32_t FemMesh_Magic = 0xF0E0D0C0;
+const uint32_t FemMesh_Version = 0x010000;
+
+template <class T>
+void FemMesh_ReadBlock(std::istream& rclIn, std::vector<T>& rBlock, unsigned long ulCount, bool bSwap)
 {
-    // create a temporary file and copy the content to the zip stream
-    Base::FileInfo fi(Base::FileInfo::getTempFileName().c_str());
+    rBlock.resize(ulCount);
+    if (ulCount > 0 && !rclIn.read(reinterpret_cast<char*>(&rBlock[0]), ulCount * sizeof(T)))
+        throw Base::Exception("Reading from stream failed");
+    if (bSwap) {
+        for (typename std::vector<T>::iterator it = rBlock.begin(); it != rBlock.end(); ++it)
+            Base::SwapEndian(*it);
+    }
+}
 
-    myMesh->ExportUNV(fi.filePath().c_str());
- 
-    Base::ifstream file(fi, std::ios::in | std::ios::binary);
-    if (file){
-        unsigned long ulSize = 0; 
-        std::streambuf* buf = file.rdbuf();
-        if (buf) {
-            unsigned long ulCurr;
-            ulCurr = buf->pubseekoff(0, std::ios::cur, std::ios::in);
-            ulSize = buf->pubseekoff(0, std::ios::end, std::ios::in);
-            buf->pubseekoff(ulCurr, std::ios::beg, std::ios::in);
+template <class T>
+void FemMesh_WriteBlock(std::ostream& rclOut, const std::vector<T>& rBlock)
+{
+    if (!rBlock.empty())
+        rclOut.write(reinterpret_cast<const char*>(&rBlock[0]), rBlock.size() * sizeof(T));
+}
+
+/// Writes the elements of one type grouped by their number of nodes
+template <class IteratorPtr>
+void FemMesh_WriteElements(std::ostream& rclOut, SMESHDS_Mesh* meshds, SMDSAbs_ElementType type,
+                           IteratorPtr (SMDS_Mesh::*elements)() const)
+{
+    Base::OutputStream str(rclOut);
+
+    // polygons and polyhedrons are counted with zero nodes
+    std::map<int, uint32_t> groups;
+    IteratorPtr aIter = (meshds->*elements)();
+    while (aIter->more()) {
+        const SMDS_MeshElement* aElem = aIter->next();
+        groups[aElem->IsPoly() ? 0 : aElem->NbNodes()]++;
+    }
+
+    str << (uint32_t)groups.size();
+    std::vector<int32_t> block;
+    for (std::map<int, uint32_t>::iterator it = groups.begin(); it != groups.end(); ++it) {
+        int numNodes = it->first;
+        str << (int32_t)type << (int32_t)numNodes << it->second;
+
+        // the element id followed by the node ids, a polygon or polyhedron additionally
+        // stores its number of nodes and the number of nodes of each of its faces
+        block.clear();
+        aIter = (meshds->*elements)();
+        while (aIter->more()) {
+            const SMDS_MeshElement* aElem = aIter->next();
+            if ((aElem->IsPoly() ? 0 : aElem->NbNodes()) != numNodes)
+                continue;
+            block.push_back(aElem->GetID());
+            if (numNodes == 0)
+                block.push_back(aElem->NbNodes());
+            for (int i = 0; i < aElem->NbNodes(); i++)
+                block.push_back(aElem->GetNode(i)->GetID());
+            if (numNodes == 0) {
+                const SMDS_PolyhedralVolumeOfNodes* aPolyVol =
+                    dynamic_cast<const SMDS_PolyhedralVolumeOfNodes*>(aElem);
+                if (aPolyVol) {
+                    const std::vector<int>& quantities = aPolyVol->GetQuanities();
+                    block.push_back((int32_t)quantities.size());
+                    block.insert(block.end(), quantities.begin(), quantities.end());
+                }
+                else {
+                    block.push_back(0);
+                }
+            }
+            if (block.size() >= FemMesh_BlockSize) {
+                FemMesh_WriteBlock(rclOut, block);
+                block.clear();
+            }
         }
+        FemMesh_WriteBlock(rclOut, block);
+    }
+}
 
-        // read in the ASCII file and write back to the stream
-        std::strstreambuf sbuf(ulSize);
-        file >> &sbuf;
-        writer.Stream() << &sbuf;
+/// Adds an element with a fixed number of nodes, returns false if the number is not supported
+bool FemMesh_AddElement(SMESHDS_Mesh* meshds, int type, const int32_t* n, int numNodes, int id)
+{
+    SMDS_MeshElement* aElem = 0;
+    if (type == SMDSAbs_Edge) {
+        switch (numNodes) {
+        case 2:
+            aElem = meshds->AddEdgeWithID(n[0], n[1], id);
+            break;
+        case 3:
+            aElem = meshds->AddEdgeWithID(n[0], n[1], n[2], id);
+            break;
+        }
+    }
+    else if (type == SMDSAbs_Face) {
+        switch (numNodes) {
+        case 3:
+            aElem = meshds->AddFaceWithID(n[0], n[1], n[2], id);
+            break;
+        case 4:
+            aElem = meshds->AddFaceWithID(n[0], n[1], n[2], n[3], id);
+            break;
+        case 6:
+            aElem = meshds->AddFaceWithID(n[0], n[1], n[2], n[3], n[4], n[5], id);
+            break;
+        case 8:
+            aElem = meshds->AddFaceWithID(n[0], n[1], n[2], n[3], n[4], n[5], n[6], n[7], id);
+            break;
+        }
     }
+    else if (type == SMDSAbs_Volume) {
+        switch (numNodes) {
+        case 4:
+            aElem = meshds->AddVolumeWithID(n[0], n[1], n[2], n[3], id);
+            break;
+        case 5:
+            aElem = meshds->AddVolumeWithID(n[0], n[1], n[2], n[3], n[4], id);
+            break;
+        case 6:
+            aElem = meshds->AddVolumeWithID(n[0], n[1], n[2], n[3], n[4], n[5], id);
+            break;
+        case 8:
+            aElem = meshds->AddVolumeWithID(n[0], n[1], n[2], n[3], n[4], n[5], n[6], n[7], id);
+            break;
+        case 10:
+            aElem = meshds->AddVolumeWithID(n[0], n[1], n[2], n[3], n[4], n[5], n[6], n[7],
+                                            n[8], n[9], id);
+            break;
+        case 13:
+            aElem = meshds->AddVolumeWithID(n[0], n[1], n[2], n[3], n[4], n[5], n[6], n[7],
+                                            n[8], n[9], n[10], n[11], n[12], id);
+            break;
+        case 15:
+            aElem = meshds->AddVolumeWithID(n[0], n[1], n[2], n[3], n[4], n[5], n[6], n[7],
+                                            n[8], n[9], n[10], n[11], n[12], n[13], n[14], id);
+            break;
+        case 20:
+            aElem = meshds->AddVolumeWithID(n[0], n[1], n[2], n[3], n[4], n[5], n[6], n[7],
+                                            n[8], n[9], n[10], n[11], n[12], n[13], n[14], n[15],
+                                            n[16], n[17], n[18], n[19], id);
+            break;
+        }
+    }
+    return aElem != 0;
+}
 
-    file.close();
-    // remove temp file
-    fi.deleteFile();
+}
+
+void FemMesh::writeBinary(std::ostream& out) const
+{
+    Base::OutputStream str(out);
+    SMESHDS_Mesh* meshds = myMesh->GetMeshDS();
+
+    // the data is written in native byte order, the reader swaps it if needed
+    str << FemMesh_Magic << FemMesh_Version;
+
+    // the nodes as blocks of ids and coordinates
+    str << (uint32_t)meshds->NbNodes();
+    std::vector<int32_t> ids;
+    std::vector<double> coords;
+    SMDS_NodeIteratorPtr aNodeIter = meshds->nodesIterator();
+    while (aNodeIter->more()) {
+        const SMDS_MeshNode* aNode = aNodeIter->next();
+        ids.push_back(aNode->GetID());
+        coords.push_back(aNode->X());
+        coords.push_back(aNode->Y());
+        coords.push_back(aNode->Z());
+        if (ids.size() == FemMesh_BlockSize) {
+            FemMesh_WriteBlock(out, ids);
+            FemMesh_WriteBlock(out, coords);
+            ids.clear();
+            coords.clear();
+        }
+    }
+    FemMesh_WriteBlock(out, ids);
+    FemMesh_WriteBlock(out, coords);
+
+    FemMesh_WriteElements(out, meshds, SMDSAbs_Edge, &SMDS_Mesh::edgesIterator);
+    FemMesh_WriteElements(out, meshds, SMDSAbs_Face, &SMDS_Mesh::facesIterator);
+    FemMesh_WriteElements(out, meshds, SMDSAbs_Volume, &SMDS_Mesh::volumesIterator);
+
+    // the groups with their name, type and element ids
+    std::list<int> groupIds = myMesh->GetGroupIds();
+    str << (uint32_t)groupIds.size();
+    for (std::list<int>::iterator it = groupIds.begin(); it != groupIds.end(); ++it) {
+        SMESH_Group* group = myMesh->GetGroup(*it);
+        SMESHDS_GroupBase* groupDS = group->GetGroupDS();
+        std::string name = group->GetName();
+        str << (uint32_t)name.size();
+        out.write(name.c_str(), name.size());
+        str << (int32_t)groupDS->GetType();
+
+        ids.clear();
+        SMDS_ElemIteratorPtr aElemIter = groupDS->GetElements();
+        while (aElemIter->more())
+            ids.push_back(aElemIter->next()->GetID());
+        str << (uint32_t)ids.size();
+        FemMesh_WriteBlock(out, ids);
+    }
+}
+
+void FemMesh::readBinary(std::istream& in, bool swap)
+{
+    Base::InputStream str(in);
+    if (swap)
+        str.setByteOrder(Base::Stream::BigEndian);
+
+    uint32_t version = 0;
+    str >> version;
+    if (version != FemMesh_Version)
+        throw Base::Exception("Unsupported version of the binary FEM mesh");
+
+    SMESHDS_Mesh* meshds = myMesh->GetMeshDS();
+    meshds->ClearMesh();
+
+    try {
+        uint32_t numNodes = 0;
+        str >> numNodes;
+        std::vector<int32_t> ids;
+        std::vector<double> coords;
+        for (unsigned long i = 0; i < numNodes; i += FemMesh_BlockSize) {
+            unsigned long ulCount = std::min<unsigned long>(numNodes - i, FemMesh_BlockSize);
+            FemMesh_ReadBlock(in, ids, ulCount, swap);
+            FemMesh_ReadBlock(in, coords, 3 * ulCount, swap);
+            for (unsigned long j = 0; j < ulCount; j++)
+                meshds->AddNodeWithID(coords[3*j], coords[3*j+1], coords[3*j+2], ids[j]);
+        }
+
+        // edges, faces and volumes
+        std::vector<int32_t> block;
+        for (int k = 0; k < 3; k++) {
+            uint32_t numGroups = 0;
+            str >> numGroups;
+            for (uint32_t g = 0; g < numGroups; g++) {
+                int32_t type = 0, nodesPerElement = 0;
+                uint32_t numElements = 0;
+                str >> type >> nodesPerElement >> numElements;
+                if (nodesPerElement > 0) {
+                    unsigned long ulStride = nodesPerElement + 1;
+                    for (unsigned long i = 0; i < numElements; i += FemMesh_BlockSize) {
+                        unsigned long ulCount = std::min<unsigned long>(numElements - i, FemMesh_BlockSize);
+                        FemMesh_ReadBlock(in, block, ulStride * ulCount, swap);
+                        for (unsigned long j = 0; j < ulCount; j++) {
+                            const int32_t* elem = &block[ulStride * j];
+                            if (!FemMesh_AddElement(meshds, type, elem + 1, nodesPerElement, elem[0]))
+                                throw Base::Exception("Unsupported element in binary FEM mesh");
+                        }
+                    }
+                }
+                else {
+                    for (uint32_t i = 0; i < numElements; i++) {
+                        int32_t id = 0, count = 0;
+                        str >> id >> count;
+                        if (count < 0)
+                            throw Base::Exception("Reading from stream failed");
+                        std::vector<int> nodes(count);
+                        for (int32_t j = 0; j < count; j++)
+                            str >> nodes[j];
+                        str >> count;
+                        if (count < 0)
+                            throw Base::Exception("Reading from stream failed");
+                        std::vector<int> quantities(count);
+                        for (int32_t j = 0; j < count; j++)
+                            str >> quantities[j];
+                        if (type == SMDSAbs_Face)
+                            meshds->AddPolygonalFaceWithID(nodes, id);
+                        else if (type == SMDSAbs_Volume)
+                            meshds->AddPolyhedralVolumeWithID(nodes, quantities, id);
+                    }
+                }
+            }
+        }
+
+        uint32_t numGroups = 0;
+        str >> numGroups;
+        for (uint32_t g = 0; g < numGroups; g++) {
+            uint32_t len = 0;
+            str >> len;
+            std::string name(len, '\0');
+            if (len > 0)
+                in.read(&name[0], len);
+            int32_t type = 0;
+            uint32_t numElements = 0;
+            str >> type >> numElements;
+            FemMesh_ReadBlock(in, ids, numElements, swap);
+
+            int aId;
+            SMESH_Group* group = myMesh->AddGroup((SMDSAbs_ElementType)type, name.c_str(), aId);
+            SMESHDS_Group* groupDS = dynamic_cast<SMESHDS_Group*>(group->GetGroupDS());
+            if (groupDS) {
+                for (std::vector<int32_t>::iterator it = ids.begin(); it != ids.end(); ++it)
+                    groupDS->Add(*it);
+            }
+        }
+
+        if (!in)
+            throw Base::Exception("Reading from stream failed");
+    }
+    catch (const Base::Exception&) {
+        meshds->ClearMesh();
+        throw;
+    }
+    catch (std::exception&) {
+        // Special handling of std::length_error
+        meshds->ClearMesh();
+        throw Base::Exception("Reading from stream failed");
+    }
+}
+
+void FemMesh::SaveDocFile (Base::Writer &writer) const
+{
+    // the mesh is written directly into the zip stream, UNV is only used as export format
+    writeBinary(writer.Stream());
 }
 
 void FemMesh::RestoreDocFile(Base::Reader &reader)
 {
+    clearNodeIndex();
+    uint32_t magic = 0, swap_magic;
+    reader.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+    std::streamsize head = reader.gcount();
+    swap_magic = magic; Base::SwapEndian(swap_magic);
+    if (head == sizeof(magic) && (magic == FemMesh_Magic || swap_magic == FemMesh_Magic)) {
+        readBinary(reader, magic != FemMesh_Magic);
+        return;
+    }
+
+    // Projects of older versions contain an UNV file.
     // create a temporary file and copy the content from the zip stream
     Base::FileInfo fi(Base::FileInfo::getTempFileName().c_str());
 
     // read in the ASCII file and write back to the file stream
     Base::ofstream file(fi, std::ios::out | std::ios::binary);
+    file.write(reinterpret_cast<const char*>(&magic), head);
     if (reader)
         reader >> file.rdbuf();
     file.close();
@@ -848,6 +1268,7 @@ void FemMesh::RestoreDocFile(Base::Reader &reader)
 void FemMesh::transformGeometry(const Base::Matrix4D& rclTrf)
 {
 	//We perform a translation and rotation of the current active Mesh object
+	clearNodeIndex();
 	Base::Matrix4D clMatrix(rclTrf);
 	SMDS_NodeIteratorPtr aNodeIter = myMesh->GetMeshDS()->nodesIterator();
 	Base::Vector3d current_node;
@@ -41,6 +41,8 @@ class TopoDS_Face;
 namespace Fem
 {
 
+class FemNodeIndex;
+
 typedef boost::shared_ptr<SMESH_Hypothesis> SMESH_HypothesisPtr;
 
 /** The representation of a FemMesh
@@ -87,6 +89,15 @@ public:
     std::set<long> getSurfaceNodes(long ElemId,short FaceId, float Angle=360)const;
     /// retrivinb by face
     std::set<long> getSurfaceNodes(const TopoDS_Face &face)const;
+    /// retrieving by a box in absolute coordinates
+    std::set<long> getNodesByBox(const Base::BoundBox3d &box)const;
+    /** Spatial index of the nodes in mesh coordinates, it is built on first use.
+     * The returned index stays valid while it is held, even if the mesh is changed
+     * meanwhile, so several threads can use it.
+     */
+    boost::shared_ptr<const FemNodeIndex> getNodeIndex() const;
+    /// must be called after nodes were added, moved or removed through getSMesh()
+    void clearNodeIndex() const;
     //@}
 
     /** @name Placement control */
@@ -132,6 +143,13 @@ public:
 private:
     void copyMeshData(const FemMesh&);
     void readNastran(const std::string &Filename);
+    /// writes the nodes, elements and groups in the binary format of the project file
+    void writeBinary(std::ostream&) const;
+    /// reads the binary format after its magic number, \a swap is true for the other byte order
+    void readBinary(std::istream&, bool swap);
+    /// nodes inside \a box with their absolute positions
+    void findNodes(const Base::BoundBox3d& box, std::vector<int>& ids,
+                   std::vector<Base::Vector3d>& points) const;
 
 private:
     /// positioning matrix
@@ -140,6 +158,7 @@ private:
     SMESH_Mesh *myMesh;
 
     std::list<SMESH_HypothesisPtr> hypoth;
+    mutable boost::shared_ptr<const FemNodeIndex> nodeIndex;
 };
 
 } //namespace Part
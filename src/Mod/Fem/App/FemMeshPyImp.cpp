@@ -36,6 +36,7 @@
 #include <Base/MatrixPy.h>
 #include <Base/PlacementPy.h>
 #include <Base/QuantityPy.h>
+#include <Base/BoundBoxPy.h>
 
 #include <Mod/Part/App/TopoShapePy.h>
 #include <Mod/Part/App/TopoShapeFacePy.h>
@@ -110,6 +111,7 @@ PyObject* FemMeshPy::setShape(PyObject *args)
     try {
         TopoDS_Shape shape = static_cast<Part::TopoShapePy*>(pcObj)->getTopoShapePtr()->_Shape;
         getFemMeshPtr()->getSMesh()->ShapeToMesh(shape);
+        getFemMeshPtr()->clearNodeIndex();
     }
     catch (const std::exception& e) {
         PyErr_SetString(PyExc_Exception, e.what());
@@ -190,6 +192,7 @@ PyObject* FemMeshPy::addNode(PyObject *args)
             SMDS_MeshNode* node = meshDS->AddNode(x,y,z);
             if (!node)
                 throw std::runtime_error("Failed to add node");
+            getFemMeshPtr()->clearNodeIndex();
             return Py::new_reference_to(Py::Int(node->GetID()));
         }
         catch (const std::exception& e) {
@@ -206,6 +209,7 @@ PyObject* FemMeshPy::addNode(PyObject *args)
             SMDS_MeshNode* node = meshDS->AddNodeWithID(x,y,z,i);
             if (!node)
                 throw std::runtime_error("Failed to add node");
+            getFemMeshPtr()->clearNodeIndex();
             return Py::new_reference_to(Py::Int(node->GetID()));
         }
         catch (const std::exception& e) {
@@ -553,9 +557,28 @@ PyObject* FemMeshPy::getNodesByFace(PyObject *args)
         PyErr_SetString(PyExc_Exception, e->GetMessageString());
         return 0;
     }
+    catch (const Base::Exception& e) {
+        PyErr_SetString(PyExc_Exception, e.what());
+        return 0;
+    }
   
 }
 
+PyObject* FemMeshPy::getNodesByBox(PyObject *args)
+{
+    PyObject *pB;
+    if (!PyArg_ParseTuple(args, "O!", &(Base::BoundBoxPy::Type), &pB))
+         return 0;
+
+    Base::BoundBox3d box = *static_cast<Base::BoundBoxPy*>(pB)->getBoundBoxPtr();
+    Py::List ret;
+    std::set<long> resultSet = getFemMeshPtr()->getNodesByBox(box);
+    for( std::set<long>::const_iterator it = resultSet.begin();it!=resultSet.end();++it)
+        ret.append(Py::Int(*it));
+
+    return Py::new_reference_to(ret);
+}
+
 
 
 // ===== Atributes ============================================================
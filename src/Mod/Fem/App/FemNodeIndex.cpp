@@ -0,0 +1,133 @@
+/***************************************************************************
+ *   Copyright (c) 2026 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <algorithm>
+# include <cmath>
+#endif
+
+#include <SMESHDS_Mesh.hxx>
+#include <SMDS_MeshNode.hxx>
+
+#include "FemNodeIndex.h"
+
+using namespace Fem;
+
+FemNodeIndex::FemNodeIndex(const SMESHDS_Mesh* meshds)
+{
+    std::vector<int> nodeIds;
+    std::vector<Base::Vector3d> nodePoints;
+    nodeIds.reserve(meshds->NbNodes());
+    nodePoints.reserve(meshds->NbNodes());
+    SMDS_NodeIteratorPtr aNodeIter = meshds->nodesIterator();
+    while (aNodeIter->more()) {
+        const SMDS_MeshNode* aNode = aNodeIter->next();
+        Base::Vector3d vec(aNode->X(), aNode->Y(), aNode->Z());
+        nodeIds.push_back(aNode->GetID());
+        nodePoints.push_back(vec);
+        bbox.Add(vec);
+    }
+
+    // about four nodes per cell, a flat mesh gets a single layer of cells
+    std::size_t numNodes = nodeIds.size();
+    double extent[3] = {0.0, 0.0, 0.0};
+    if (numNodes > 0) {
+        extent[0] = bbox.MaxX - bbox.MinX;
+        extent[1] = bbox.MaxY - bbox.MinY;
+        extent[2] = bbox.MaxZ - bbox.MinZ;
+    }
+    double maxExtent = std::max<double>(extent[0], std::max<double>(extent[1], extent[2]));
+    double minExtent = maxExtent > 0.0 ? 1.0e-3 * maxExtent : 1.0;
+    double volume = 1.0;
+    for (int i = 0; i < 3; i++)
+        volume *= std::max<double>(extent[i], minExtent);
+    double targetCells = std::max<double>(1.0, numNodes / 4.0);
+    double size = std::pow(volume / targetCells, 1.0 / 3.0);
+    for (int i = 0; i < 3; i++) {
+        numCells[i] = std::min<int>(512, std::max<int>(1, static_cast<int>(extent[i] / size) + 1));
+        cellSize[i] = extent[i] > 0.0 ? extent[i] / numCells[i] : 1.0;
+    }
+
+    // count the nodes per cell and sort them by their cell
+    std::size_t totalCells = static_cast<std::size_t>(numCells[0]) * numCells[1] * numCells[2];
+    std::vector<unsigned long> cells(numNodes);
+    cellStart.resize(totalCells + 1, 0);
+    for (std::size_t i = 0; i < numNodes; i++) {
+        const Base::Vector3d& p = nodePoints[i];
+        std::size_t cell = (static_cast<std::size_t>(cellIndex(p.z, 2)) * numCells[1] +
+                            cellIndex(p.y, 1)) * numCells[0] + cellIndex(p.x, 0);
+        cells[i] = cell;
+        cellStart[cell + 1]++;
+    }
+    for (std::size_t i = 0; i < totalCells; i++)
+        cellStart[i + 1] += cellStart[i];
+
+    std::vector<unsigned long> next(cellStart.begin(), cellStart.end() - 1);
+    ids.resize(numNodes);
+    points.resize(numNodes);
+    for (std::size_t i = 0; i < numNodes; i++) {
+        unsigned long pos = next[cells[i]]++;
+        ids[pos] = nodeIds[i];
+        points[pos] = nodePoints[i];
+    }
+}
+
+FemNodeIndex::~FemNodeIndex()
+{
+}
+
+int FemNodeIndex::cellIndex(double value, int axis) const
+{
+    double min = axis == 0 ? bbox.MinX : (axis == 1 ? bbox.MinY : bbox.MinZ);
+    int index = static_cast<int>((value - min) / cellSize[axis]);
+    return std::min<int>(std::max<int>(index, 0), numCells[axis] - 1);
+}
+
+void FemNodeIndex::search(const Base::BoundBox3d& box, std::vector<int>& nodeIds,
+                          std::vector<Base::Vector3d>& nodePoints) const
+{
+    if (ids.empty() || !box.IsValid())
+        return;
+    if (box.MaxX < bbox.MinX || box.MinX > bbox.MaxX ||
+        box.MaxY < bbox.MinY || box.MinY > bbox.MaxY ||
+        box.MaxZ < bbox.MinZ || box.MinZ > bbox.MaxZ)
+        return;
+
+    int x0 = cellIndex(box.MinX, 0), x1 = cellIndex(box.MaxX, 0);
+    int y0 = cellIndex(box.MinY, 1), y1 = cellIndex(box.MaxY, 1);
+    int z0 = cellIndex(box.MinZ, 2), z1 = cellIndex(box.MaxZ, 2);
+    for (int z = z0; z <= z1; z++) {
+        for (int y = y0; y <= y1; y++) {
+            std::size_t row = (static_cast<std::size_t>(z) * numCells[1] + y) * numCells[0];
+            for (unsigned long i = cellStart[row + x0]; i < cellStart[row + x1 + 1]; i++) {
+                if (box.IsInBox(points[i])) {
+                    nodeIds.push_back(ids[i]);
+                    nodePoints.push_back(points[i]);
+                }
+            }
+        }
+    }
+}
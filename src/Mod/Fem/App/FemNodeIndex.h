@@ -0,0 +1,76 @@
+/***************************************************************************
+ *   Copyright (c) 2026 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#ifndef FEM_FEMNODEINDEX_H
+#define FEM_FEMNODEINDEX_H
+
+#include <vector>
+#include <Base/BoundBox.h>
+#include <Base/Vector3D.h>
+
+class SMESHDS_Mesh;
+
+namespace Fem
+{
+
+/**
+ * The FemNodeIndex class is a regular grid over the nodes of a FEM mesh to find the nodes
+ * inside a box without checking every node of the mesh. The nodes are sorted by their cell so
+ * that the grid only needs an array with the start of each cell. The coordinates are in the
+ * coordinate system of the mesh, i.e. without its placement.
+ * @see FemMesh::getNodeIndex()
+ */
+class AppFemExport FemNodeIndex
+{
+public:
+    /// Builds the index over all nodes of the mesh.
+    FemNodeIndex(const SMESHDS_Mesh*);
+    ~FemNodeIndex();
+
+    /// Returns the number of indexed nodes.
+    unsigned long countNodes() const
+    { return ids.size(); }
+    /// Returns the bounding box of all nodes.
+    const Base::BoundBox3d& getBoundBox() const
+    { return bbox; }
+    /// Appends the ids and positions of the nodes inside \a box.
+    void search(const Base::BoundBox3d& box, std::vector<int>& nodeIds,
+                std::vector<Base::Vector3d>& nodePoints) const;
+
+private:
+    int cellIndex(double value, int axis) const;
+
+private:
+    Base::BoundBox3d bbox;
+    int numCells[3];
+    double cellSize[3];
+    std::vector<unsigned long> cellStart;
+    std::vector<int> ids;
+    std::vector<Base::Vector3d> points;
+};
+
+} //namespace Fem
+
+
+#endif // FEM_FEMNODEINDEX_H
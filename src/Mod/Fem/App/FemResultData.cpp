@@ -0,0 +1,486 @@
+/***************************************************************************
+ *   Copyright (c) 2026 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <algorithm>
+# include <cmath>
+# include <cstdlib>
+# include <istream>
+# include <limits>
+# include <boost/bind.hpp>
+#endif
+
+#include <Base/Writer.h>
+#include <Base/Reader.h>
+#include <Base/FileInfo.h>
+#include <Base/Stream.h>
+#include <Base/Swap.h>
+#include <Base/Exception.h>
+
+#include "FemResultData.h"
+
+using namespace Fem;
+
+namespace Fem {
+
+// The first bytes of the binary format
+const uint32_t FemResultData_Magic = 0xF0E0D1C0;
+const uint32_t FemResultData_Version = 0x010000;
+
+static float FemResultData_Missing()
+{
+    return std::numeric_limits<float>::quiet_NaN();
+}
+
+// Returns the number in the fixed width field of a line of a frd file
+static double FemResultData_Field(const std::string& line, std::string::size_type pos,
+                                  std::string::size_type len)
+{
+    if (pos >= line.size())
+        return 0.0;
+    std::string field = line.substr(pos, len);
+    return std::strtod(field.c_str(), 0);
+}
+
+// Reads the next line of a frd file without the carriage return
+static bool FemResultData_GetLine(std::istream& in, std::string& line)
+{
+    if (!std::getline(in, line))
+        return false;
+    if (!line.empty() && line[line.size()-1] == '\r')
+        line.resize(line.size()-1);
+    return true;
+}
+
+/**
+ * The steps of a result that are not held in memory. They are appended to a temporary
+ * file which is removed again with the last result using it. Once all steps are written
+ * the file is only read, so copies of a result can share it.
+ */
+class FemResultStore
+{
+public:
+    FemResultStore()
+      : file(Base::FileInfo::getTempFileName())
+      , out(file, std::ios::out | std::ios::trunc | std::ios::binary)
+    {
+        if (!out)
+            throw Base::FileException("Cannot create temporary result file", file);
+    }
+    ~FemResultStore()
+    {
+        out.close();
+        file.deleteFile();
+    }
+    /// writes the values of a step and returns their position in the file
+    std::streamoff append(const std::vector<float>& data)
+    {
+        std::streamoff pos = out.tellp();
+        if (!data.empty())
+            out.write(reinterpret_cast<const char*>(&data[0]), data.size() * sizeof(float));
+        if (!out)
+            throw Base::FileException("Cannot write temporary result file", file);
+        return pos;
+    }
+    /// closes the file after the last step
+    void finish()
+    {
+        out.close();
+    }
+    void read(std::streamoff pos, std::vector<float>& data) const
+    {
+        Base::ifstream in(file, std::ios::in | std::ios::binary);
+        if (!in || !in.seekg(pos))
+            throw Base::FileException("Cannot read temporary result file", file);
+        if (!data.empty() && !in.read(reinterpret_cast<char*>(&data[0]), data.size() * sizeof(float)))
+            throw Base::FileException("Cannot read temporary result file", file);
+    }
+
+private:
+    Base::FileInfo file;
+    Base::ofstream out;
+};
+
+}
+
+TYPESYSTEM_SOURCE(Fem::FemResultData , Base::Persistence);
+
+FemResultData::FemResultData()
+  : components(1), firstNodeId(0), numNodes(0), cachedStep(-1)
+{
+}
+
+FemResultData::~FemResultData()
+{
+}
+
+void FemResultData::setLayout(int components, long firstNodeId, unsigned long numNodes)
+{
+    if (components < 1)
+        throw Base::ValueError("A result needs at least one component");
+    this->components = components;
+    this->firstNodeId = firstNodeId;
+    this->numNodes = numNodes;
+    times.clear();
+    values.clear();
+    offsets.clear();
+    store.reset();
+    cachedStep = -1;
+    cache.clear();
+    deferred.clear();
+}
+
+unsigned long FemResultData::addStep(double time)
+{
+    restoreDeferred();
+    times.push_back(time);
+    offsets.push_back(-1);
+    values.push_back(std::vector<float>());
+    values.back().resize(numNodes * components, FemResultData_Missing());
+    return times.size() - 1;
+}
+
+void FemResultData::clear()
+{
+    setLayout(1, 0, 0);
+}
+
+const std::vector<float>& FemResultData::getStepValues(unsigned long step) const
+{
+    restoreDeferred();
+    if (offsets[step] < 0)
+        return values[step];
+    if (cachedStep != (long)step) {
+        cachedStep = -1;
+        loadStep(step, cache);
+        cachedStep = (long)step;
+    }
+    return cache;
+}
+
+const float* FemResultData::getNodeValues(unsigned long step, long nodeId) const
+{
+    if (step >= countSteps() || !hasNode(nodeId))
+        return 0;
+    return &getStepValues(step)[(nodeId - firstNodeId) * components];
+}
+
+void FemResultData::setNodeValues(unsigned long step, long nodeId, const float* nodeValues)
+{
+    if (step >= countSteps())
+        throw Base::ValueError("Step index out of range");
+    if (!hasNode(nodeId))
+        throw Base::ValueError("Node id out of range");
+    if (offsets[step] >= 0) {
+        // the modified step is kept in memory, the store is shared with the copies
+        loadStep(step, values[step]);
+        offsets[step] = -1;
+        if (cachedStep == (long)step) {
+            cachedStep = -1;
+            cache.clear();
+        }
+    }
+    std::copy(nodeValues, nodeValues + components, &values[step][(nodeId - firstNodeId) * components]);
+}
+
+double FemResultData::getVonMisesStress(const float* s)
+{
+    // the same formula as used by the Python import of CalculiX results
+    return std::sqrt(std::pow(s[0] - s[1], 2) + std::pow(s[1] - s[2], 2) + std::pow(s[2] - s[0], 2) +
+                     6.0 * (std::pow(s[3], 2) + std::pow(s[4], 2) + std::pow(s[5], 2)));
+}
+
+void FemResultData::addNode(long nodeId)
+{
+    if (numNodes == 0) {
+        firstNodeId = nodeId;
+        numNodes = 1;
+    }
+    else if (nodeId < firstNodeId) {
+        numNodes += firstNodeId - nodeId;
+        firstNodeId = nodeId;
+    }
+    else if (nodeId >= firstNodeId + (long)numNodes) {
+        numNodes = nodeId - firstNodeId + 1;
+    }
+}
+
+bool FemResultData::readFrd(const std::string& fileName, const char* name)
+{
+    // The short format of CalculiX result files has fixed width fields. A block starts with
+    // a line whose sixth character is 'C', the nodal results are in blocks headed by a '-4'
+    // line with the name of the result followed by a '-5' line for each component. The values
+    // of a node are in a '-1' line and, if there are more than six, in '-2' lines. Each block
+    // ends with a '-3' line.
+    // The node range is only known at the end of the file, so a first pass determines it
+    // together with the position of the blocks and a second pass converts the blocks one
+    // after another into the store.
+    Base::FileInfo fi(fileName);
+    Base::ifstream in(fi, std::ios::in);
+    if (!in)
+        throw Base::FileException("Cannot open result file", fi);
+
+    enum { None, Nodes, Header, Values } state = None;
+    std::string line;
+    double time = 0.0;
+    int blockComponents = 0;
+    int resultComponents = 0;
+    std::vector<double> stepTimes;
+    std::vector<std::streamoff> blockOffsets;
+
+    // the values of a block start after its header, asking the stream for the position of
+    // every line would slow down the scan
+    std::streamoff valuesPos = -1;
+
+    clear();
+    while (FemResultData_GetLine(in, line)) {
+        if (line.size() < 3)
+            continue;
+
+        if (line.size() > 5 && line[5] == 'C') {
+            int code = std::atoi(line.substr(0, 5).c_str());
+            if (code == 2)
+                state = Nodes;
+            else if (code == 100)
+                time = FemResultData_Field(line, 12, 12);
+            else
+                state = None;
+        }
+        else if (line.compare(0, 3, " -4") == 0) {
+            std::string block = line.size() > 5 ? line.substr(5, 8) : std::string();
+            block.erase(block.find_last_not_of(' ') + 1);
+            state = (block == name) ? Header : None;
+            blockComponents = 0;
+            if (state == Header)
+                valuesPos = in.tellg();
+        }
+        else if (line.compare(0, 3, " -5") == 0) {
+            // the pseudo component ALL is not part of the values
+            if (state == Header && line.size() > 5 && line.compare(5, 3, "ALL") != 0)
+                blockComponents++;
+            if (state == Header)
+                valuesPos = in.tellg();
+        }
+        else if (line.compare(0, 3, " -1") == 0) {
+            if (state == Header) {
+                if (blockComponents == 0)
+                    throw Base::Exception("Result block without components");
+                if (resultComponents == 0)
+                    resultComponents = blockComponents;
+                else if (blockComponents != resultComponents)
+                    throw Base::Exception("Inconsistent number of components in result blocks");
+                stepTimes.push_back(time);
+                blockOffsets.push_back(valuesPos);
+                state = Values;
+            }
+            // the node range covers the nodes of the mesh and of the result blocks
+            if (state == Nodes || state == Values)
+                addNode(std::atol(line.substr(3, 10).c_str()));
+        }
+        else if (line.compare(0, 3, " -3") == 0) {
+            state = None;
+        }
+    }
+
+    if (stepTimes.empty()) {
+        clear();
+        return false;
+    }
+
+    components = resultComponents;
+    try {
+        boost::shared_ptr<FemResultStore> blocks(new FemResultStore());
+        std::vector<float> data;
+        for (std::size_t i = 0; i < blockOffsets.size(); i++) {
+            in.clear();
+            if (!in.seekg(blockOffsets[i]))
+                throw Base::FileException("Cannot read the result file", fi);
+
+            data.assign(numNodes * components, FemResultData_Missing());
+            float* nodeData = 0;
+            int nodeComponent = 0;
+            while (FemResultData_GetLine(in, line)) {
+                if (line.compare(0, 3, " -1") == 0) {
+                    long nodeId = std::atol(line.substr(3, 10).c_str());
+                    nodeData = &data[(nodeId - firstNodeId) * components];
+                    nodeComponent = std::min(components, 6);
+                    for (int j = 0; j < nodeComponent; j++)
+                        nodeData[j] = (float)FemResultData_Field(line, 13 + 12 * j, 12);
+                }
+                else if (line.compare(0, 3, " -2") == 0) {
+                    if (nodeData && nodeComponent < components) {
+                        int count = std::min(components - nodeComponent, 6);
+                        for (int j = 0; j < count; j++)
+                            nodeData[nodeComponent + j] = (float)FemResultData_Field(line, 13 + 12 * j, 12);
+                        nodeComponent += count;
+                    }
+                }
+                else if (line.compare(0, 3, " -3") == 0) {
+                    break;
+                }
+            }
+
+            offsets.push_back(blocks->append(data));
+        }
+        blocks->finish();
+
+        times.swap(stepTimes);
+        values.resize(times.size());
+        store = blocks;
+    }
+    catch (const Base::Exception&) {
+        clear();
+        throw;
+    }
+    return true;
+}
+
+void FemResultData::loadStep(unsigned long step, std::vector<float>& data) const
+{
+    data.resize(numNodes * components);
+    store->read(offsets[step], data);
+}
+
+// ==== Base class implementer ==============================================================
+
+unsigned int FemResultData::getMemSize (void) const
+{
+    std::size_t size = cache.size();
+    for (std::deque< std::vector<float> >::const_iterator it = values.begin(); it != values.end(); ++it)
+        size += it->size();
+    return (unsigned int)(size * sizeof(float));
+}
+
+void FemResultData::Save (Base::Writer &writer) const
+{
+    //See SaveDocFile(), RestoreDocFile()
+    writer.Stream() << writer.ind() << "<FemResult file=\"";
+    if (countSteps() > 0)
+        writer.Stream() << writer.addFile("FemResult.bin", this);
+    writer.Stream() << "\"/>" << std::endl;
+}
+
+void FemResultData::Restore(Base::XMLReader &reader)
+{
+    reader.readElement("FemResult");
+    std::string file (reader.getAttribute("file") );
+
+    clear();
+    if (!file.empty()) {
+        // initate a file read
+        reader.addFile(file.c_str(),this);
+    }
+}
+
+void FemResultData::SaveDocFile (Base::Writer &writer) const
+{
+    restoreDeferred();
+
+    // the data is written in native byte order, the reader swaps it if needed
+    std::ostream& out = writer.Stream();
+    Base::OutputStream str(out);
+    str << FemResultData_Magic << FemResultData_Version;
+    str << (int32_t)components << (int32_t)firstNodeId << (uint32_t)numNodes << (uint32_t)times.size();
+
+    // the steps of the store are read one after another into a buffer of their own
+    std::vector<float> buffer;
+    for (unsigned long i = 0; i < times.size(); i++) {
+        str << times[i];
+        const std::vector<float>* step = &values[i];
+        if (offsets[i] >= 0) {
+            loadStep(i, buffer);
+            step = &buffer;
+        }
+        if (!step->empty())
+            out.write(reinterpret_cast<const char*>(&(*step)[0]), step->size() * sizeof(float));
+    }
+}
+
+void FemResultData::RestoreDocFile(Base::Reader &reader)
+{
+    clear();
+    uint32_t magic = 0, swap_magic;
+    reader.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+    swap_magic = magic; Base::SwapEndian(swap_magic);
+    if (magic != FemResultData_Magic && swap_magic != FemResultData_Magic)
+        throw Base::Exception("Unknown format of FEM result");
+
+    bool swap = (magic != FemResultData_Magic);
+    Base::InputStream str(reader);
+    if (swap)
+        str.setByteOrder(Base::Stream::BigEndian);
+
+    try {
+        uint32_t version = 0;
+        str >> version;
+        if (version != FemResultData_Version)
+            throw Base::Exception("Unsupported version of the FEM result");
+
+        int32_t numComponents = 0, firstId = 0;
+        uint32_t count = 0, numSteps = 0;
+        str >> numComponents >> firstId >> count >> numSteps;
+        if (!reader)
+            throw Base::Exception("Reading from stream failed");
+        setLayout(numComponents, firstId, count);
+
+        // the steps are copied into the store one after another, so only one of them is
+        // in memory at a time
+        boost::shared_ptr<FemResultStore> steps(new FemResultStore());
+        std::vector<float> data(numNodes * components);
+        for (uint32_t i = 0; i < numSteps; i++) {
+            double time = 0.0;
+            str >> time;
+            if (!data.empty() && !reader.read(reinterpret_cast<char*>(&data[0]), data.size() * sizeof(float)))
+                throw Base::Exception("Reading from stream failed");
+            if (swap) {
+                for (std::vector<float>::iterator it = data.begin(); it != data.end(); ++it)
+                    Base::SwapEndian(*it);
+            }
+            times.push_back(time);
+            values.push_back(std::vector<float>());
+            offsets.push_back(steps->append(data));
+        }
+        steps->finish();
+        store = steps;
+    }
+    catch (const std::exception&) {
+        clear();
+        throw Base::Exception("Reading from stream failed");
+    }
+    catch (const Base::Exception&) {
+        clear();
+        throw;
+    }
+}
+
+void FemResultData::setDeferredDocFile(const Base::DeferredFile &file)
+{
+    // the project file is read when the result is accessed the first time
+    deferred = file;
+}
+
+void FemResultData::restoreDeferred() const
+{
+    if (deferred.isPending())
+        deferred.restore(boost::bind(&FemResultData::RestoreDocFile, const_cast<FemResultData*>(this), _1));
+}
@@ -0,0 +1,144 @@
+/***************************************************************************
+ *   Copyright (c) 2026 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#ifndef FEM_FEMRESULTDATA_H
+#define FEM_FEMRESULTDATA_H
+
+#include <deque>
+#include <ios>
+#include <string>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <Base/Handle.h>
+#include <Base/Persistence.h>
+
+namespace Fem
+{
+
+class FemResultStore;
+
+/**
+ * The FemResultData class holds the values of one result quantity, e.g. the displacement or the
+ * stress, for the nodes of a mesh over any number of time steps. Each step is a dense array of
+ * floats with a fixed number of components per node, indexed by the node id minus the first node
+ * id. Nodes without a value in a step are NaN.
+ * The steps of a CalculiX result file or of a project file are not kept in memory. They are
+ * copied into a temporary file owned by the result, and shared by its copies, from which a step
+ * is read again when it is accessed. In a project that is loaded lazily this copy is only made
+ * when the result is accessed the first time.
+ */
+class AppFemExport FemResultData : public Base::Persistence, public Base::Handled
+{
+    TYPESYSTEM_HEADER();
+
+public:
+    FemResultData();
+    ~FemResultData();
+
+    /** @name Layout */
+    //@{
+    /// Sets the number of values per node and the range of node ids, all steps are removed
+    void setLayout(int components, long firstNodeId, unsigned long numNodes);
+    int countComponents() const
+    { restoreDeferred(); return components; }
+    long getFirstNodeId() const
+    { restoreDeferred(); return firstNodeId; }
+    /// Returns the size of the node id range
+    unsigned long countNodes() const
+    { restoreDeferred(); return numNodes; }
+    bool hasNode(long nodeId) const
+    { restoreDeferred(); return nodeId >= firstNodeId && nodeId < firstNodeId + (long)numNodes; }
+    //@}
+
+    /** @name Time steps */
+    //@{
+    /// Appends a step with all values set to NaN and returns its index
+    unsigned long addStep(double time);
+    unsigned long countSteps() const
+    { restoreDeferred(); return times.size(); }
+    double getStepTime(unsigned long step) const
+    { restoreDeferred(); return times[step]; }
+    /** The values of a step, the components of a node are stored consecutively.
+     * A step that is not in memory is read on demand and only the last one read is kept, so
+     * the returned values are valid until another step is accessed.
+     */
+    const std::vector<float>& getStepValues(unsigned long step) const;
+    //@}
+
+    /// Returns the values of a node in a step, or 0 if the node is out of range
+    const float* getNodeValues(unsigned long step, long nodeId) const;
+    /// Sets the values of a node in a step, the node must be in the range of the layout
+    void setNodeValues(unsigned long step, long nodeId, const float* nodeValues);
+    /// Returns the von Mises stress of the six components of a stress tensor
+    static double getVonMisesStress(const float* stress);
+    void clear();
+
+    /** @name Reading result files */
+    //@{
+    /** Reads the result blocks called \a name, e.g. DISP or STRESS, of a CalculiX result file.
+     * The file is scanned line by line for the node range, then each block becomes a step of
+     * this object and is converted into the temporary file of the result one after another.
+     * The result file isn't needed afterwards.
+     * Returns false if the file has no block with this name.
+     */
+    bool readFrd(const std::string& fileName, const char* name);
+    //@}
+
+    // from base class
+    virtual unsigned int getMemSize (void) const;
+    virtual void Save (Base::Writer &/*writer*/) const;
+    virtual void Restore(Base::XMLReader &/*reader*/);
+    void SaveDocFile (Base::Writer &writer) const;
+    void RestoreDocFile(Base::Reader &reader);
+    virtual bool isRestoreDocFileDeferrable (void) const
+    { return true; }
+    virtual void setDeferredDocFile(const Base::DeferredFile &file);
+
+private:
+    /// widens the node id range so that it includes \a nodeId, the steps are not resized
+    void addNode(long nodeId);
+    /// reads the values of a step that is not in memory
+    void loadStep(unsigned long step, std::vector<float>& data) const;
+    /// reads the postponed project file
+    void restoreDeferred() const;
+
+private:
+    int components;
+    long firstNodeId;
+    unsigned long numNodes;
+    std::vector<double> times;
+    // a deque does not copy the steps when it grows, the steps in the store are empty
+    std::deque< std::vector<float> > values;
+    // the position of each step in the store, -1 if in memory
+    std::vector<std::streamoff> offsets;
+    boost::shared_ptr<FemResultStore> store;
+    mutable long cachedStep;
+    mutable std::vector<float> cache;
+    mutable Base::DeferredFile deferred;
+};
+
+} //namespace Fem
+
+
+#endif // FEM_FEMRESULTDATA_H
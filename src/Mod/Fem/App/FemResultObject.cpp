@@ -40,6 +40,7 @@ FemResultObject::FemResultObject()
     ADD_PROPERTY_TYPE(DataType,(""), "General",Prop_None,"Type identifier of the result data");
     ADD_PROPERTY_TYPE(Unit,(0), "General",Prop_None,"Unit of the data");
     ADD_PROPERTY_TYPE(ElementNumbers,(0), "Data",Prop_None,"Numbers of the result elements");
+    ADD_PROPERTY_TYPE(Result,(), "Data",Prop_None,"Nodal values of all time steps");
     ADD_PROPERTY_TYPE(Mesh,(0), "General",Prop_None,"Link to the corosbonding mesh");
 }
 
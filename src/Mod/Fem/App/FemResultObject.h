@@ -28,7 +28,7 @@
 #include <App/PropertyUnits.h>
 #include <App/PropertyStandard.h>
 #include <App/FeaturePython.h>
-#include "FemResultObject.h"
+#include "FemResultProperty.h"
 
 namespace Fem
 {
@@ -48,6 +48,8 @@ public:
     App::PropertyQuantity Unit;
     /// List of element numbers in this result object
     App::PropertyIntegerList ElementNumbers;
+    /// Nodal values of all time steps, indexed by the node number
+    PropertyFemResult Result;
     /// Link to the corosbonding mesh
     App::PropertyLink Mesh;
 
@@ -0,0 +1,126 @@
+/***************************************************************************
+ *   Copyright (c) 2026 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#include "PreCompiled.h"
+
+#include <CXX/Objects.hxx>
+#include <Base/Writer.h>
+#include <Base/Reader.h>
+#include <Base/Exception.h>
+
+#include "FemResultProperty.h"
+
+using namespace Fem;
+
+TYPESYSTEM_SOURCE(Fem::PropertyFemResult , App::Property);
+
+PropertyFemResult::PropertyFemResult() : _Result(new FemResultData)
+{
+}
+
+PropertyFemResult::~PropertyFemResult()
+{
+}
+
+void PropertyFemResult::setValuePtr(FemResultData* result)
+{
+    // use the tmp. object to guarantee that the referenced data is not destroyed
+    // before calling hasSetValue()
+    Base::Reference<FemResultData> tmp(_Result);
+    aboutToSetValue();
+    _Result = result;
+    hasSetValue();
+}
+
+void PropertyFemResult::setValue(const FemResultData& result)
+{
+    // other properties may share the data
+    setValuePtr(new FemResultData(result));
+}
+
+const FemResultData &PropertyFemResult::getValue(void) const
+{
+    return *_Result;
+}
+
+PyObject *PropertyFemResult::getPyObject(void)
+{
+    Py::Dict dict;
+    dict.setItem("Components", Py::Int(_Result->countComponents()));
+    dict.setItem("FirstNode", Py::Int(_Result->getFirstNodeId()));
+    dict.setItem("Nodes", Py::Long(_Result->countNodes()));
+    Py::List times;
+    for (unsigned long i = 0; i < _Result->countSteps(); i++)
+        times.append(Py::Float(_Result->getStepTime(i)));
+    dict.setItem("Times", times);
+    return Py::new_reference_to(dict);
+}
+
+void PropertyFemResult::setPyObject(PyObject * /*value*/)
+{
+    throw Base::TypeError("The result data is read-only, use Fem.readFrdResult() to load it");
+}
+
+App::Property *PropertyFemResult::Copy(void) const
+{
+    PropertyFemResult *prop = new PropertyFemResult();
+    prop->_Result = this->_Result;
+    return prop;
+}
+
+void PropertyFemResult::Paste(const App::Property &from)
+{
+    aboutToSetValue();
+    _Result = dynamic_cast<const PropertyFemResult&>(from)._Result;
+    hasSetValue();
+}
+
+unsigned int PropertyFemResult::getMemSize (void) const
+{
+    return _Result->getMemSize();
+}
+
+void PropertyFemResult::Save (Base::Writer &writer) const
+{
+    _Result->Save(writer);
+}
+
+void PropertyFemResult::Restore(Base::XMLReader &reader)
+{
+    // the data may be shared with a copy of this property
+    setValuePtr(new FemResultData);
+    _Result->Restore(reader);
+}
+
+void PropertyFemResult::SaveDocFile (Base::Writer &writer) const
+{
+    _Result->SaveDocFile(writer);
+}
+
+void PropertyFemResult::RestoreDocFile(Base::Reader &reader )
+{
+    aboutToSetValue();
+    _Result->RestoreDocFile(reader);
+    hasSetValue();
+}
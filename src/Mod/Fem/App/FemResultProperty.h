@@ -0,0 +1,81 @@
+/***************************************************************************
+ *   Copyright (c) 2026 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#ifndef Fem_PropertyFemResult_H
+#define Fem_PropertyFemResult_H
+
+#include "FemResultData.h"
+#include <App/Property.h>
+
+namespace Fem
+{
+
+/** The property class for the nodal values of a FEM result.
+ * Copies of the property share the data, it is only written once into a project file.
+ */
+class AppFemExport PropertyFemResult : public App::Property
+{
+    TYPESYSTEM_HEADER();
+
+public:
+    PropertyFemResult();
+    ~PropertyFemResult();
+
+    /** @name Getter/setter */
+    //@{
+    void setValuePtr(FemResultData* result);
+    /// set the result data
+    void setValue(const FemResultData&);
+    /// does nothing, for add property macro
+    void setValue(void){}
+    /// get the result data
+    const FemResultData &getValue(void) const;
+    //@}
+
+    /** @name Python interface */
+    //@{
+    PyObject* getPyObject(void);
+    void setPyObject(PyObject *value);
+    //@}
+
+    /** @name Save/restore */
+    //@{
+    void Save (Base::Writer &writer) const;
+    void Restore(Base::XMLReader &reader);
+    void SaveDocFile (Base::Writer &writer) const;
+    void RestoreDocFile(Base::Reader &reader);
+
+    App::Property *Copy(void) const;
+    void Paste(const App::Property &from);
+    unsigned int getMemSize (void) const;
+    //@}
+
+private:
+    Base::Reference<FemResultData> _Result;
+};
+
+} //namespace Fem
+
+
+#endif // Fem_PropertyFemResult_H
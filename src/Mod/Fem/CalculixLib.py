@@ -33,7 +33,9 @@ if open.__module__ == '__builtin__':
     pyopen = open # because we'll redefine open below
 
 # read a calculix result file and extract the nodes, displacement vectores and stress values.
-def readResult(frd_input) :
+# With results=False only the nodes and elements are read, the results are then read with
+# Fem.readFrdResult() which copies the time steps into a file owned by the result.
+def readResult(frd_input,results=True) :
     input = pyopen(frd_input,"r")
     nodes = {}
     disp  = {}
@@ -78,7 +80,7 @@ def readResult(frd_input) :
             node_id_10 = int(line[93:103])
             elements[elem] = (node_id_1,node_id_2,node_id_3,node_id_4,node_id_5,node_id_6,node_id_7,node_id_8,node_id_9,node_id_10)
         #Check if we found displacement section
-        if line[5:9] == "DISP":
+        if results and line[5:9] == "DISP":
             disp_found = True
         #we found a displacement line in the frd file
         if disp_found and (line[1:3] == "-1"):
@@ -87,7 +89,7 @@ def readResult(frd_input) :
             disp_y = float(line[25:37])
             disp_z = float(line[37:49])
             disp[elem] = FreeCAD.Vector(disp_x,disp_y,disp_z)
-        if line[5:11] == "STRESS":
+        if results and line[5:11] == "STRESS":
             stress_found = True
         #we found a displacement line in the frd file
         if stress_found and (line[1:3] == "-1"):
@@ -114,7 +116,7 @@ def readResult(frd_input) :
 
 
 def importFrd(filename,Analysis=None):
-    m = readResult(filename);
+    m = readResult(filename,False);
     MeshObject = None
     if(len(m) > 0): 
         import Fem
@@ -140,31 +142,24 @@ def importFrd(filename,Analysis=None):
                 MeshObject.FemMesh = mesh
                 AnalysisObject.Member = AnalysisObject.Member + [MeshObject]
             
-        if(m.has_key('Displacement')):
-            disp =  m['Displacement']
-            if len(disp)>0:
-                o = FreeCAD.ActiveDocument.addObject('Fem::FemResultVector','Displacement')
-                o.Values = disp.values()
-                o.DataType = 'Displacement'
-                o.ElementNumbers = disp.keys()
-                if(MeshObject):
-                    o.Mesh = MeshObject
-                AnalysisObject.Member = AnalysisObject.Member + [o]
-        if(m.has_key('Stress')):
-            stress =  m['Stress']
-            if len(stress)>0:
-                o = FreeCAD.ActiveDocument.addObject('Fem::FemResultValue','MisesStress')
-                mstress = []
-                for i in stress.values():
-                    # van mises stress (http://en.wikipedia.org/wiki/Von_Mises_yield_criterion)
-                    mstress.append( sqrt( pow( i[0] - i[1] ,2) + pow( i[1] - i[2] ,2) + pow( i[2] - i[0] ,2) + 6 * (pow(i[3],2)+pow(i[4],2)+pow(i[5],2)  )  ) )
-                
-                o.Values = mstress
-                o.DataType = 'VanMisesStress'
-                o.ElementNumbers = stress.keys()
-                if(MeshObject):
-                    o.Mesh = MeshObject
-                AnalysisObject.Member = AnalysisObject.Member + [o]
+        # the results of all time steps are read into the objects, the Values hold the last step
+        o = FreeCAD.ActiveDocument.addObject('Fem::FemResultVector','Displacement')
+        if Fem.readFrdResult(filename,o,'DISP'):
+            o.DataType = 'Displacement'
+            if(MeshObject):
+                o.Mesh = MeshObject
+            AnalysisObject.Member = AnalysisObject.Member + [o]
+        else:
+            FreeCAD.ActiveDocument.removeObject(o.Name)
+        o = FreeCAD.ActiveDocument.addObject('Fem::FemResultValue','MisesStress')
+        # the van mises stress is computed from the stress tensor (http://en.wikipedia.org/wiki/Von_Mises_yield_criterion)
+        if Fem.readFrdResult(filename,o,'STRESS'):
+            o.DataType = 'VanMisesStress'
+            if(MeshObject):
+                o.Mesh = MeshObject
+            AnalysisObject.Member = AnalysisObject.Member + [o]
+        else:
+            FreeCAD.ActiveDocument.removeObject(o.Name)
         if(FreeCAD.GuiUp):
             import FemGui, FreeCADGui
             if FreeCADGui.activeWorkbench().name() != 'FemWorkbench':
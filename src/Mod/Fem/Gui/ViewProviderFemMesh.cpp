@@ -63,11 +63,15 @@
 #include <Base/TimeInfo.h>
 #include <Base/BoundBox.h>
 #include <sstream>
+#include <functional>
 
 #include <SMESH_Mesh.hxx>
 #include <SMESHDS_Mesh.hxx>
 #include <SMDSAbs_ElementType.hxx>
 
+#include <QThread>
+#include <QtConcurrentMap>
+
 using namespace FemGui;
 
 
@@ -83,16 +87,15 @@ struct FemFace
 	unsigned short Size;
 	unsigned short FaceNo;
     bool hide;
-    Base::Vector3d getFirstNodePoint(void) {
-        return Base::Vector3d(Nodes[0]->X(),Nodes[0]->Y(),Nodes[0]->Z());
-    }
-	
-	Base::Vector3d set(short size,const SMDS_MeshElement* element,unsigned short id, short faceNo, const SMDS_MeshNode* n1,const SMDS_MeshNode* n2,const SMDS_MeshNode* n3,const SMDS_MeshNode* n4=0,const SMDS_MeshNode* n5=0,const SMDS_MeshNode* n6=0,const SMDS_MeshNode* n7=0,const SMDS_MeshNode* n8=0);
+    unsigned long Hash;
+
+	void set(short size,const SMDS_MeshElement* element,unsigned long id, short faceNo, const SMDS_MeshNode* n1,const SMDS_MeshNode* n2,const SMDS_MeshNode* n3,const SMDS_MeshNode* n4=0,const SMDS_MeshNode* n5=0,const SMDS_MeshNode* n6=0,const SMDS_MeshNode* n7=0,const SMDS_MeshNode* n8=0);
 	
-	bool isSameFace (FemFace &face);
+	bool isSameFace (const FemFace &face) const;
+	bool isLess (const FemFace &face) const;
 };
 
-Base::Vector3d FemFace::set(short size,const SMDS_MeshElement* element,unsigned short id,short faceNo, const SMDS_MeshNode* n1,const SMDS_MeshNode* n2,const SMDS_MeshNode* n3,const SMDS_MeshNode* n4,const SMDS_MeshNode* n5,const SMDS_MeshNode* n6,const SMDS_MeshNode* n7,const SMDS_MeshNode* n8)
+void FemFace::set(short size,const SMDS_MeshElement* element,unsigned long id,short faceNo, const SMDS_MeshNode* n1,const SMDS_MeshNode* n2,const SMDS_MeshNode* n3,const SMDS_MeshNode* n4,const SMDS_MeshNode* n5,const SMDS_MeshNode* n6,const SMDS_MeshNode* n7,const SMDS_MeshNode* n8)
 {
 	Nodes[0] = n1;
 	Nodes[1] = n2;
@@ -109,34 +112,16 @@ Base::Vector3d FemFace::set(short size,const SMDS_MeshElement* element,unsigned
     FaceNo          = faceNo;
     hide            = false;
 
-	// sorting the nodes for later easier comparison (bubble sort)
-    int i, j, flag = 1;    // set flag to 1 to start first pass
-	const SMDS_MeshNode* temp;   // holding variable
-	
-	for(i = 1; (i <= size) && flag; i++)
-	{
-		flag = 0;
-		for (j=0; j < (size -1); j++)
-		{
-			if (Nodes[j+1] > Nodes[j])      // ascending order simply changes to <
-			{ 
-				temp = Nodes[j];             // swap elements
-				Nodes[j] = Nodes[j+1];
-				Nodes[j+1] = temp;
-				flag = 1;               // indicates that a swap occurred.
-			}
-		}
-	}
-
-    return Base::Vector3d(Nodes[0]->X(),Nodes[0]->Y(),Nodes[0]->Z());
-};
+	// sorting the nodes for later easier comparison, the unused slots are 0 and stay at the end
+    std::sort(Nodes, Nodes + size, std::greater<const SMDS_MeshNode*>());
 
-class FemFaceGridItem :public std::vector<FemFace*>{
-public:
-    //FemFaceGridItem(void){reserve(200);}
+    // the hash only depends on the node set, so a shared face gets the same hash for both elements
+    Hash = size;
+    for (int i = 0; i < size; i++)
+        Hash = Hash * 31 + static_cast<unsigned long>(Nodes[i]->GetID());
 };
 
-bool FemFace::isSameFace (FemFace &face) 
+bool FemFace::isSameFace (const FemFace &face) const
 {
     // the same element can not have the same face
     if(face.ElementNumber == ElementNumber)
@@ -144,22 +129,63 @@ bool FemFace::isSameFace (FemFace &face)
 	if(face.Size != Size)
         return false;
 	// if the same face size just compare if the sorted nodes are the same
-	if( Nodes[0] == face.Nodes[0] &&
-	    Nodes[1] == face.Nodes[1] &&
-		Nodes[2] == face.Nodes[2] &&
-		Nodes[3] == face.Nodes[3] &&
-		Nodes[4] == face.Nodes[4] &&
-		Nodes[5] == face.Nodes[5] &&
-		Nodes[6] == face.Nodes[6] &&
-        Nodes[7] == face.Nodes[7] ){
-            hide = true;
-            face.hide = true;
-            return true;
-    }
+    return std::equal(Nodes, Nodes + 8, face.Nodes);
+};
 
+bool FemFace::isLess (const FemFace &face) const
+{
+	if(face.Size != Size)
+        return Size < face.Size;
+    for (int i = 0; i < 8; i++) {
+        if (Nodes[i] != face.Nodes[i])
+            return std::less<const SMDS_MeshNode*>()(Nodes[i], face.Nodes[i]);
+    }
     return false;
+}
+
+// A bucket of element faces with the same hash modulo the bucket count. Shared faces always end
+// up in the same bucket, so the buckets can be processed by different threads.
+struct FemFaceBucket
+{
+    std::vector<FemFace>* faces;
+    std::vector<int>::iterator begin, end;
+};
+
+struct FemFaceIndexLess
+{
+    const std::vector<FemFace>* faces;
+    bool operator()(int a, int b) const {
+        const FemFace& fa = (*faces)[a];
+        const FemFace& fb = (*faces)[b];
+        if (fa.isLess(fb))
+            return true;
+        if (fb.isLess(fa))
+            return false;
+        return a < b;
+    }
 };
 
+// sort the faces of the bucket by their nodes and hide those which are shared by two elements
+static void FemFaceBucket_HideInner(FemFaceBucket& bucket)
+{
+    std::vector<FemFace>& faces = *bucket.faces;
+    FemFaceIndexLess less;
+    less.faces = &faces;
+    std::sort(bucket.begin, bucket.end, less);
+
+    std::vector<int>::iterator it = bucket.begin;
+    while (it != bucket.end) {
+        std::vector<int>::iterator next = it + 1;
+        while (next != bucket.end && faces[*it].isSameFace(faces[*next]))
+            ++next;
+        if (next - it > 1) {
+            for (std::vector<int>::iterator jt = it; jt != next; ++jt)
+                faces[*jt].hide = true;
+        }
+        it = next;
+    }
+}
+
 PROPERTY_SOURCE(FemGui::ViewProviderFemMesh, Gui::ViewProviderGeometryObject)
 
 App::PropertyFloatConstraint::Constraints ViewProviderFemMesh::floatRange = {1.0,64.0,1.0};
@@ -365,6 +391,7 @@ void ViewProviderFemMesh::updateData(const App::Property* prop)
         resetColorByNodeId();
         resetDisplacementByNodeId();
         builder.createMesh(prop, pcCoords, pcFaces, pcLines,vFaceElementIdx,vNodeElementIdx, ShowInner.getValue());
+        updateSkinNodeIndex();
     }
     Gui::ViewProviderGeometryObject::updateData(prop);
 }
@@ -390,7 +417,10 @@ void ViewProviderFemMesh::onChanged(const App::Property* prop)
     else if (prop == &ShowInner) {
         // recalc mesh with new settings
         ViewProviderFEMMeshBuilder builder;
+        resetColorByNodeId();
+        resetDisplacementByNodeId();
         builder.createMesh(&(dynamic_cast<Fem::FemMeshObject*>(this->pcObject)->FemMesh), pcCoords, pcFaces, pcLines,vFaceElementIdx,vNodeElementIdx, ShowInner.getValue());
+        updateSkinNodeIndex();
     }
     else if (prop == &LineWidth) {
         pcDrawStyle->lineWidth = LineWidth.getValue();
@@ -494,48 +524,50 @@ PyObject * ViewProviderFemMesh::getPyObject()
     return Py::new_reference_to(PythonObject); 
 }
 
-void ViewProviderFemMesh::setColorByNodeId(const std::map<long,App::Color> &NodeColorMap)
-{
-    long startId = NodeColorMap.begin()->first;
-    long endId = (--NodeColorMap.end())->first;
-
-    std::vector<App::Color> colorVec(endId-startId+2,App::Color(0,1,0));
-    for(std::map<long,App::Color>::const_iterator it=NodeColorMap.begin();it!=NodeColorMap.end();++it)
-        colorVec[it->first-startId] = it->second;
-
-    setColorByNodeIdHelper(colorVec);
-
-}
-void ViewProviderFemMesh::setColorByNodeId(const std::vector<long> &NodeIds,const std::vector<App::Color> &NodeColors)
+void ViewProviderFemMesh::updateSkinNodeIndex(void)
 {
+    // the result updates only touch the nodes of the skin, so map the node ids once per mesh
+    unsigned long maxId = 0;
+    for(std::vector<unsigned long>::const_iterator it=vNodeElementIdx.begin();it!=vNodeElementIdx.end();++it)
+        maxId = std::max<unsigned long>(maxId, *it);
 
-    long startId = *(std::min_element(NodeIds.begin(), NodeIds.end()));     
-    long endId   = *(std::max_element(NodeIds.begin(), NodeIds.end()));
-
-    std::vector<App::Color> colorVec(endId-startId+2,App::Color(0,1,0));
+    vNodeSkinIdx.assign(vNodeElementIdx.empty() ? 0 : maxId+1, -1);
     long i=0;
-    for(std::vector<long>::const_iterator it=NodeIds.begin();it!=NodeIds.end();++it,i++)
-        colorVec[*it-startId] = NodeColors[i];
-
+    for(std::vector<unsigned long>::const_iterator it=vNodeElementIdx.begin();it!=vNodeElementIdx.end();++it,i++)
+        vNodeSkinIdx[*it] = i;
+}
 
-    setColorByNodeIdHelper(colorVec);
+void ViewProviderFemMesh::setColorByNodeId(const std::map<long,App::Color> &NodeColorMap)
+{
+    std::vector<long> NodeIds;
+    std::vector<App::Color> NodeColors;
+    NodeIds.reserve(NodeColorMap.size());
+    NodeColors.reserve(NodeColorMap.size());
+    for(std::map<long,App::Color>::const_iterator it=NodeColorMap.begin();it!=NodeColorMap.end();++it){
+        NodeIds.push_back(it->first);
+        NodeColors.push_back(it->second);
+    }
 
+    setColorByNodeId(NodeIds,NodeColors);
 }
 
-void ViewProviderFemMesh::setColorByNodeIdHelper(const std::vector<App::Color> &colorVec)
+void ViewProviderFemMesh::setColorByNodeId(const std::vector<long> &NodeIds,const std::vector<App::Color> &NodeColors)
 {
     pcMatBinding->value = SoMaterialBinding::PER_VERTEX_INDEXED;
 
-    // resizing and writing the color vector:
+    // resizing and writing the color vector, nodes without a value are green
     pcShapeMaterial->diffuseColor.setNum(vNodeElementIdx.size());
     SbColor* colors = pcShapeMaterial->diffuseColor.startEditing();
-
-    long i=0;
-    for(std::vector<unsigned long>::const_iterator it=vNodeElementIdx.begin()
-            ;it!=vNodeElementIdx.end()
-            ;++it,i++)
-       colors[i] = SbColor(colorVec[*it-1].r,colorVec[*it-1].g,colorVec[*it-1].b);
-
+    for(std::size_t i=0;i<vNodeElementIdx.size();i++)
+        colors[i] = SbColor(0,1,0);
+
+    long size = vNodeSkinIdx.size();
+    for(std::size_t i=0;i<NodeIds.size();i++){
+        long id = NodeIds[i];
+        if(id < 0 || id >= size || vNodeSkinIdx[id] < 0)
+            continue;
+        colors[vNodeSkinIdx[id]] = SbColor(NodeColors[i].r,NodeColors[i].g,NodeColors[i].b);
+    }
 
     pcShapeMaterial->diffuseColor.finishEditing();
 }
@@ -551,46 +583,40 @@ void ViewProviderFemMesh::resetColorByNodeId(void)
 
 void ViewProviderFemMesh::setDisplacementByNodeId(const std::map<long,Base::Vector3d> &NodeDispMap)
 {
-    long startId = NodeDispMap.begin()->first;
-    long endId = (--NodeDispMap.end())->first;
-
-    std::vector<Base::Vector3d> vecVec(endId-startId+2,Base::Vector3d());
-
-    for(std::map<long,Base::Vector3d>::const_iterator it=NodeDispMap.begin();it!=NodeDispMap.end();++it)
-        vecVec[it->first-startId] = it->second;
+    std::vector<long> NodeIds;
+    std::vector<Base::Vector3d> NodeDisps;
+    NodeIds.reserve(NodeDispMap.size());
+    NodeDisps.reserve(NodeDispMap.size());
+    for(std::map<long,Base::Vector3d>::const_iterator it=NodeDispMap.begin();it!=NodeDispMap.end();++it){
+        NodeIds.push_back(it->first);
+        NodeDisps.push_back(it->second);
+    }
 
-    setDisplacementByNodeIdHelper(vecVec,startId);
+    setDisplacementByNodeId(NodeIds,NodeDisps);
 }
 
 void ViewProviderFemMesh::setDisplacementByNodeId(const std::vector<long> &NodeIds,const std::vector<Base::Vector3d> &NodeDisps)
 {
-    long startId = *(std::min_element(NodeIds.begin(), NodeIds.end()));     
-    long endId   = *(std::max_element(NodeIds.begin(), NodeIds.end()));
-
-    std::vector<Base::Vector3d> vecVec(endId-startId+2,Base::Vector3d());
-
-    long i=0;
-    for(std::vector<long>::const_iterator it=NodeIds.begin();it!=NodeIds.end();++it,i++)
-        vecVec[*it-startId] = NodeDisps[i];
-
-    setDisplacementByNodeIdHelper(vecVec,startId);
-}
-
-void ViewProviderFemMesh::setDisplacementByNodeIdHelper(const std::vector<Base::Vector3d>& DispVector,long startId)
-{
-    DisplacementVector.resize(vNodeElementIdx.size());
-    int i=0;
-    for(std::vector<unsigned long>::const_iterator it=vNodeElementIdx.begin();it!=vNodeElementIdx.end();++it,i++)
-        DisplacementVector[i] = DispVector[*it-startId];
+    // undo the current displacement before it gets replaced
+    animateNodes(0.0);
+    DisplacementVector.assign(vNodeElementIdx.size(),Base::Vector3d());
+
+    long size = vNodeSkinIdx.size();
+    for(std::size_t i=0;i<NodeIds.size();i++){
+        long id = NodeIds[i];
+        if(id < 0 || id >= size || vNodeSkinIdx[id] < 0)
+            continue;
+        DisplacementVector[vNodeSkinIdx[id]] = NodeDisps[i];
+    }
     animateNodes(1.0);
 
 }
-
+
 void ViewProviderFemMesh::resetDisplacementByNodeId(void)
 {
     animateNodes(0.0);
     DisplacementVector.clear();
-}
+}
 /// reaply the node displacement with a certain factor and do a redraw
 void ViewProviderFemMesh::animateNodes(double factor)
 {
@@ -684,12 +710,12 @@ void ViewProviderFEMMeshBuilder::buildNodes(const App::Property* prop, std::vect
     }
 }
 
-inline void insEdgeVec(std::map<int,std::set<int> > &map, int n1, int n2)
+inline void insEdgeVec(std::vector<std::pair<int,int> > &vec, int n1, int n2)
 {
     if(n1<n2)
-        map[n2].insert(n1);
+        vec.push_back(std::make_pair(n1,n2));
     else
-        map[n2].insert(n1);
+        vec.push_back(std::make_pair(n2,n1));
 };
 
 inline unsigned long ElemFold(unsigned long Element,unsigned long FaceNbr)
@@ -738,7 +764,6 @@ void ViewProviderFEMMeshBuilder::createMesh(const App::Property* prop, SoCoordin
     std::vector<FemFace> facesHelper(numTries);
 
     Base::Console().Log("    %f: Start build up %i face helper\n",Base::TimeInfo::diffTimeF(Start,Base::TimeInfo()),facesHelper.size());
-    Base::BoundBox3d BndBox;
 
     int i=0;
 
@@ -751,7 +776,7 @@ void ViewProviderFEMMeshBuilder::createMesh(const App::Property* prop, SoCoordin
             switch(num){
                 
                 case 4:// quad face
-                    BndBox.Add(facesHelper[i++].set(4,aFace,aFace->GetID(),0,aFace->GetNode(0),aFace->GetNode(1),aFace->GetNode(2),aFace->GetNode(3)));
+                    facesHelper[i++].set(4,aFace,aFace->GetID(),0,aFace->GetNode(0),aFace->GetNode(1),aFace->GetNode(2),aFace->GetNode(3));
                     break;
                     
                 //unknown case
@@ -770,39 +795,39 @@ void ViewProviderFEMMeshBuilder::createMesh(const App::Property* prop, SoCoordin
             // tet 4 element 
             case 4:
                 // face 1
-                BndBox.Add(facesHelper[i++].set(3,aVol,aVol->GetID(),1,aVol->GetNode(0),aVol->GetNode(1),aVol->GetNode(2)));
+                facesHelper[i++].set(3,aVol,aVol->GetID(),1,aVol->GetNode(0),aVol->GetNode(1),aVol->GetNode(2));
                 // face 2
-                BndBox.Add(facesHelper[i++].set(3,aVol,aVol->GetID(),2,aVol->GetNode(0),aVol->GetNode(3),aVol->GetNode(1)));
+                facesHelper[i++].set(3,aVol,aVol->GetID(),2,aVol->GetNode(0),aVol->GetNode(3),aVol->GetNode(1));
                 // face 3
-                BndBox.Add(facesHelper[i++].set(3,aVol,aVol->GetID(),3,aVol->GetNode(1),aVol->GetNode(3),aVol->GetNode(2)));
+                facesHelper[i++].set(3,aVol,aVol->GetID(),3,aVol->GetNode(1),aVol->GetNode(3),aVol->GetNode(2));
                 // face 4
-                BndBox.Add(facesHelper[i++].set(3,aVol,aVol->GetID(),4,aVol->GetNode(2),aVol->GetNode(3),aVol->GetNode(0)));
+                facesHelper[i++].set(3,aVol,aVol->GetID(),4,aVol->GetNode(2),aVol->GetNode(3),aVol->GetNode(0));
                 break;
                 //unknown case
             case 8:
                 // face 1
-                BndBox.Add(facesHelper[i++].set(4,aVol,aVol->GetID(),1,aVol->GetNode(0),aVol->GetNode(1),aVol->GetNode(2),aVol->GetNode(3)));
+                facesHelper[i++].set(4,aVol,aVol->GetID(),1,aVol->GetNode(0),aVol->GetNode(1),aVol->GetNode(2),aVol->GetNode(3));
                 // face 2
-                BndBox.Add(facesHelper[i++].set(4,aVol,aVol->GetID(),2,aVol->GetNode(4),aVol->GetNode(5),aVol->GetNode(6),aVol->GetNode(7)));
+                facesHelper[i++].set(4,aVol,aVol->GetID(),2,aVol->GetNode(4),aVol->GetNode(5),aVol->GetNode(6),aVol->GetNode(7));
                 // face 3
-                BndBox.Add(facesHelper[i++].set(4,aVol,aVol->GetID(),3,aVol->GetNode(0),aVol->GetNode(1),aVol->GetNode(4),aVol->GetNode(5)));
+                facesHelper[i++].set(4,aVol,aVol->GetID(),3,aVol->GetNode(0),aVol->GetNode(1),aVol->GetNode(4),aVol->GetNode(5));
                 // face 4
-                BndBox.Add(facesHelper[i++].set(4,aVol,aVol->GetID(),4,aVol->GetNode(1),aVol->GetNode(2),aVol->GetNode(5),aVol->GetNode(6)));
+                facesHelper[i++].set(4,aVol,aVol->GetID(),4,aVol->GetNode(1),aVol->GetNode(2),aVol->GetNode(5),aVol->GetNode(6));
                 // face 5
-                BndBox.Add(facesHelper[i++].set(4,aVol,aVol->GetID(),5,aVol->GetNode(2),aVol->GetNode(3),aVol->GetNode(6),aVol->GetNode(7)));
+                facesHelper[i++].set(4,aVol,aVol->GetID(),5,aVol->GetNode(2),aVol->GetNode(3),aVol->GetNode(6),aVol->GetNode(7));
                 // face 6
-                BndBox.Add(facesHelper[i++].set(4,aVol,aVol->GetID(),6,aVol->GetNode(0),aVol->GetNode(3),aVol->GetNode(4),aVol->GetNode(7)));
+                facesHelper[i++].set(4,aVol,aVol->GetID(),6,aVol->GetNode(0),aVol->GetNode(3),aVol->GetNode(4),aVol->GetNode(7));
                 break;
                 //unknown case
             case 10:
                 // face 1
-                BndBox.Add(facesHelper[i++].set(6,aVol,aVol->GetID(),1,aVol->GetNode(0),aVol->GetNode(1),aVol->GetNode(2),aVol->GetNode(4),aVol->GetNode(5),aVol->GetNode(6)));
+                facesHelper[i++].set(6,aVol,aVol->GetID(),1,aVol->GetNode(0),aVol->GetNode(1),aVol->GetNode(2),aVol->GetNode(4),aVol->GetNode(5),aVol->GetNode(6));
                 // face 2
-                BndBox.Add(facesHelper[i++].set(6,aVol,aVol->GetID(),2,aVol->GetNode(0),aVol->GetNode(3),aVol->GetNode(1),aVol->GetNode(7),aVol->GetNode(8),aVol->GetNode(4)));
+                facesHelper[i++].set(6,aVol,aVol->GetID(),2,aVol->GetNode(0),aVol->GetNode(3),aVol->GetNode(1),aVol->GetNode(7),aVol->GetNode(8),aVol->GetNode(4));
                 // face 3
-                BndBox.Add(facesHelper[i++].set(6,aVol,aVol->GetID(),3,aVol->GetNode(1),aVol->GetNode(3),aVol->GetNode(2),aVol->GetNode(8),aVol->GetNode(9),aVol->GetNode(5)));
+                facesHelper[i++].set(6,aVol,aVol->GetID(),3,aVol->GetNode(1),aVol->GetNode(3),aVol->GetNode(2),aVol->GetNode(8),aVol->GetNode(9),aVol->GetNode(5));
                 // face 4
-                BndBox.Add(facesHelper[i++].set(6,aVol,aVol->GetID(),4,aVol->GetNode(2),aVol->GetNode(3),aVol->GetNode(0),aVol->GetNode(9),aVol->GetNode(7),aVol->GetNode(6)));
+                facesHelper[i++].set(6,aVol,aVol->GetID(),4,aVol->GetNode(2),aVol->GetNode(3),aVol->GetNode(0),aVol->GetNode(9),aVol->GetNode(7),aVol->GetNode(6));
                 break;
                 //unknown case
             default: assert(0);
@@ -811,111 +836,61 @@ void ViewProviderFEMMeshBuilder::createMesh(const App::Property* prop, SoCoordin
 
     int FaceSize = facesHelper.size();
 
-
-    if( FaceSize < 5000){
-        Base::Console().Log("    %f: Start eliminate internal faces SIMPLE\n",Base::TimeInfo::diffTimeF(Start,Base::TimeInfo()));
-        
-        // search for double (inside) faces and hide them
-        if(!ShowInner){
-            for(int l=0; l< FaceSize;l++){
-                if(! facesHelper[l].hide){
-                    for(int i=l+1; i<FaceSize; i++){
-                        if(facesHelper[l].isSameFace(facesHelper[i]) ){
-                            break;
-                        }
-                    }
-                }
-            }
+    if(!ShowInner){
+        Base::Console().Log("    %f: Start eliminate internal faces\n",Base::TimeInfo::diffTimeF(Start,Base::TimeInfo()));
+
+        // distribute the faces over the buckets by their hash
+        std::size_t numBuckets = 16 * std::max<int>(1, QThread::idealThreadCount());
+        std::vector<int> bucketStart(numBuckets + 1, 0);
+        for(int l=0; l< FaceSize;l++)
+            bucketStart[facesHelper[l].Hash % numBuckets + 1]++;
+        for(std::size_t b=0; b< numBuckets;b++)
+            bucketStart[b+1] += bucketStart[b];
+        std::vector<int> bucketFaces(FaceSize);
+        std::vector<int> next(bucketStart.begin(), bucketStart.end() - 1);
+        for(int l=0; l< FaceSize;l++)
+            bucketFaces[next[facesHelper[l].Hash % numBuckets]++] = l;
+
+        std::vector<FemFaceBucket> buckets(numBuckets);
+        for(std::size_t b=0; b< numBuckets;b++){
+            buckets[b].faces = &facesHelper;
+            buckets[b].begin = bucketFaces.begin() + bucketStart[b];
+            buckets[b].end   = bucketFaces.begin() + bucketStart[b+1];
         }
-    }else{
-        Base::Console().Log("    %f: Start eliminate internal faces GRID\n",Base::TimeInfo::diffTimeF(Start,Base::TimeInfo()));
-        BndBox.Enlarge(BndBox.CalcDiagonalLength()/10000.0);
-        // calculate grid properties
-        double edge = pow(FaceSize,1.0/3.0);
-        double edgeL = BndBox.LengthX() + BndBox.LengthY() + BndBox.LengthZ();
-        double gridFactor = 5.0;
-        double size = ( edgeL /(3*edge) )*gridFactor;
-
-        unsigned int NbrX = (unsigned int)(BndBox.LengthX()/size)+1;
-        unsigned int NbrY = (unsigned int)(BndBox.LengthY()/size)+1;
-        unsigned int NbrZ = (unsigned int)(BndBox.LengthZ()/size)+1;
-        Base::Console().Log("      Size:F:%f,  X:%i  ,Y:%i  ,Z:%i\n",gridFactor,NbrX,NbrY,NbrZ);
-
-        double Xmin = BndBox.MinX;
-        double Ymin = BndBox.MinY;
-        double Zmin = BndBox.MinZ;
-        double Xln  = BndBox.LengthX() / NbrX;
-        double Yln  = BndBox.LengthY() / NbrY;
-        double Zln  = BndBox.LengthZ() / NbrZ;
-
-        std::vector<FemFaceGridItem> Grid(NbrX*NbrY*NbrZ);
-
-
-        unsigned int iX = 0;
-        unsigned int iY = 0;
-        unsigned int iZ = 0;
-
-        for(int l=0; l< FaceSize;l++){
-            Base::Vector3d point(facesHelper[l].getFirstNodePoint());
-            double x = (point.x - Xmin) / Xln;
-            double y = (point.y - Ymin) / Yln;
-            double z = (point.z - Zmin) / Zln;
-
-            iX = x;
-            iY = y;
-            iZ = z;
-
-            if(iX >= NbrX || iY >= NbrY || iZ >= NbrZ)
-                Base::Console().Log("      Outof range!\n");
-            
-            Grid[iX + iY*NbrX + iZ*NbrX*NbrY].push_back(&facesHelper[l]);
-        }
-
-        unsigned int max =0, avg = 0;
-        for(std::vector<FemFaceGridItem>::iterator it=Grid.begin();it!=Grid.end();++it){
-            for(unsigned int l=0; l< it->size();l++){
-                if(! it->operator[](l)->hide){
-                    for(unsigned int i=l+1; i<it->size(); i++){
-                        if(it->operator[](l)->isSameFace(*(it->operator[](i))) ){
-                            break;
-                        }
-                    }
-                }
-            }
-            if(it->size() > max)max=it->size();
-            avg += it->size();
-        }
-        avg = avg/Grid.size();
-         
-        Base::Console().Log("      VoxelSize: Max:%i ,Average:%i\n",max,avg);
-
-    } //if( FaceSize < 1000)
-
+        QtConcurrent::blockingMap(buckets, &FemFaceBucket_HideInner);
+    }
 
     Base::Console().Log("    %f: Start build up node map\n",Base::TimeInfo::diffTimeF(Start,Base::TimeInfo()));
 
-    // sort out double nodes and build up index map
-    std::map<const SMDS_MeshNode*, int> mapNodeIndex;
+    // sort out double nodes and build up a flat index by node id
+    std::vector<const SMDS_MeshNode*> nodeById(data->MaxNodeID()+1, 0);
     for(int l=0; l< FaceSize;l++){
         if(!facesHelper[l].hide)
             for(int i=0; i<8;i++)
                 if(facesHelper[l].Nodes[i])
-                    mapNodeIndex[facesHelper[l].Nodes[i]]=0;
+                    nodeById[facesHelper[l].Nodes[i]->GetID()] = facesHelper[l].Nodes[i];
                 else
                     break;
     }
+    std::vector<int> nodeIndex(nodeById.size(), -1);
+    int numVisibleNodes = 0;
+    for(std::size_t id=0; id< nodeById.size();id++)
+        if(nodeById[id])
+            nodeIndex[id] = numVisibleNodes++;
     Base::Console().Log("    %f: Start set point vector\n",Base::TimeInfo::diffTimeF(Start,Base::TimeInfo()));
 
     // set the point coordinates
-    coords->point.setNum(mapNodeIndex.size());
-    vNodeElementIdx.resize(mapNodeIndex.size() );
-    std::map<const SMDS_MeshNode*, int>::iterator it=  mapNodeIndex.begin();
+    coords->point.setNum(numVisibleNodes);
+    vNodeElementIdx.resize(numVisibleNodes);
     SbVec3f* verts = coords->point.startEditing();
-    for (int i=0;it != mapNodeIndex.end() ;++it,i++) {
-        verts[i].setValue((float)it->first->X(),(float)it->first->Y(),(float)it->first->Z());
-        it->second = i;
+    for (std::size_t id=0; id< nodeById.size();id++) {
+        const SMDS_MeshNode* node = nodeById[id];
+        if (!node)
+            continue;
+        int i = nodeIndex[id];
+        verts[i].setValue((float)node->X(),(float)node->Y(),(float)node->Z());
         // set selection idx
-        vNodeElementIdx[i] = it->first->GetID();
+        vNodeElementIdx[i] = node->GetID();
     }
     coords->point.finishEditing();
 
@@ -932,8 +907,9 @@ void ViewProviderFEMMeshBuilder::createMesh(const App::Property* prop, SoCoordin
                 default: assert(0);
         }
 
-    // edge map collect and sort edges of the faces to be shown. 
-    std::map<int,std::set<int> > EdgeMap;
+    // collect the edges of the faces to be shown, they get sorted and made unique afterwards
+    std::vector<std::pair<int,int> > EdgeVec;
+    EdgeVec.reserve(3*triangleCount);
 
     Base::Console().Log("    %f: Start build up triangle vector\n",Base::TimeInfo::diffTimeF(Start,Base::TimeInfo()));
     // set the triangle face indices
@@ -948,75 +924,75 @@ void ViewProviderFEMMeshBuilder::createMesh(const App::Property* prop, SoCoordin
                 case 4: // Tet 4
                     switch(facesHelper[l].FaceNo){
                         case 0: { // case for quad faces
-                            int nIdx0 = mapNodeIndex[facesHelper[l].Element->GetNode(0)];
-                            int nIdx1 = mapNodeIndex[facesHelper[l].Element->GetNode(1)];
-                            int nIdx2 = mapNodeIndex[facesHelper[l].Element->GetNode(2)];
-                            int nIdx3 = mapNodeIndex[facesHelper[l].Element->GetNode(3)];
+                            int nIdx0 = nodeIndex[facesHelper[l].Element->GetNode(0)->GetID()];
+                            int nIdx1 = nodeIndex[facesHelper[l].Element->GetNode(1)->GetID()];
+                            int nIdx2 = nodeIndex[facesHelper[l].Element->GetNode(2)->GetID()];
+                            int nIdx3 = nodeIndex[facesHelper[l].Element->GetNode(3)->GetID()];
                             indices[index++] = nIdx2;
                             indices[index++] = nIdx0;
                             indices[index++] = nIdx1;
                             indices[index++] = SO_END_FACE_INDEX;
-                            insEdgeVec(EdgeMap,nIdx0,nIdx1);
-                            insEdgeVec(EdgeMap,nIdx1,nIdx2);
+                            insEdgeVec(EdgeVec,nIdx0,nIdx1);
+                            insEdgeVec(EdgeVec,nIdx1,nIdx2);
                             vFaceElementIdx[indexIdx++] = ElemFold(facesHelper[l].ElementNumber,0);
                             indices[index++] = nIdx3;
                             indices[index++] = nIdx0;
                             indices[index++] = nIdx2;
                             indices[index++] = SO_END_FACE_INDEX;
-                            insEdgeVec(EdgeMap,nIdx2,nIdx3);
-                            insEdgeVec(EdgeMap,nIdx3,nIdx0);
+                            insEdgeVec(EdgeVec,nIdx2,nIdx3);
+                            insEdgeVec(EdgeVec,nIdx3,nIdx0);
                             vFaceElementIdx[indexIdx++] = ElemFold(facesHelper[l].ElementNumber,0);
                             break;    }
                         case 1: { // face 1 of Tet10
-                            int nIdx0 = mapNodeIndex[facesHelper[l].Element->GetNode(0)];
-                            int nIdx1 = mapNodeIndex[facesHelper[l].Element->GetNode(1)];
-                            int nIdx2 = mapNodeIndex[facesHelper[l].Element->GetNode(2)];
+                            int nIdx0 = nodeIndex[facesHelper[l].Element->GetNode(0)->GetID()];
+                            int nIdx1 = nodeIndex[facesHelper[l].Element->GetNode(1)->GetID()];
+                            int nIdx2 = nodeIndex[facesHelper[l].Element->GetNode(2)->GetID()];
                             indices[index++] = nIdx2;     
                             indices[index++] = nIdx0;     
                             indices[index++] = nIdx1;     
                             indices[index++] = SO_END_FACE_INDEX;
-                            insEdgeVec(EdgeMap,nIdx0,nIdx1);
-                            insEdgeVec(EdgeMap,nIdx0,nIdx2);
-                            insEdgeVec(EdgeMap,nIdx1,nIdx2);
+                            insEdgeVec(EdgeVec,nIdx0,nIdx1);
+                            insEdgeVec(EdgeVec,nIdx0,nIdx2);
+                            insEdgeVec(EdgeVec,nIdx1,nIdx2);
                             vFaceElementIdx[indexIdx++] = ElemFold(facesHelper[l].ElementNumber,0);
                             break;    }
                         case 2: {
-                            int nIdx0 = mapNodeIndex[facesHelper[l].Element->GetNode(0)];
-                            int nIdx1 = mapNodeIndex[facesHelper[l].Element->GetNode(1)];
-                            int nIdx3 = mapNodeIndex[facesHelper[l].Element->GetNode(3)];
+                            int nIdx0 = nodeIndex[facesHelper[l].Element->GetNode(0)->GetID()];
+                            int nIdx1 = nodeIndex[facesHelper[l].Element->GetNode(1)->GetID()];
+                            int nIdx3 = nodeIndex[facesHelper[l].Element->GetNode(3)->GetID()];
                             indices[index++] = nIdx1;   
                             indices[index++] = nIdx0;   
                             indices[index++] = nIdx3;   
                             indices[index++] = SO_END_FACE_INDEX;
-                            insEdgeVec(EdgeMap,nIdx0,nIdx1);
-                            insEdgeVec(EdgeMap,nIdx0,nIdx3);
-                            insEdgeVec(EdgeMap,nIdx1,nIdx3);
+                            insEdgeVec(EdgeVec,nIdx0,nIdx1);
+                            insEdgeVec(EdgeVec,nIdx0,nIdx3);
+                            insEdgeVec(EdgeVec,nIdx1,nIdx3);
                             vFaceElementIdx[indexIdx++] = ElemFold(facesHelper[l].ElementNumber,1);
                             break;    }
                         case 3: {
-                            int nIdx1 = mapNodeIndex[facesHelper[l].Element->GetNode(1)];
-                            int nIdx2 = mapNodeIndex[facesHelper[l].Element->GetNode(2)];
-                            int nIdx3 = mapNodeIndex[facesHelper[l].Element->GetNode(3)];
+                            int nIdx1 = nodeIndex[facesHelper[l].Element->GetNode(1)->GetID()];
+                            int nIdx2 = nodeIndex[facesHelper[l].Element->GetNode(2)->GetID()];
+                            int nIdx3 = nodeIndex[facesHelper[l].Element->GetNode(3)->GetID()];
                             indices[index++] = nIdx2;
                             indices[index++] = nIdx1;
                             indices[index++] = nIdx3;
                             indices[index++] = SO_END_FACE_INDEX;
-                            insEdgeVec(EdgeMap,nIdx1,nIdx2);
-                            insEdgeVec(EdgeMap,nIdx1,nIdx3);
-                            insEdgeVec(EdgeMap,nIdx2,nIdx3);
+                            insEdgeVec(EdgeVec,nIdx1,nIdx2);
+                            insEdgeVec(EdgeVec,nIdx1,nIdx3);
+                            insEdgeVec(EdgeVec,nIdx2,nIdx3);
                             vFaceElementIdx[indexIdx++] = ElemFold(facesHelper[l].ElementNumber,2);
                             break;    }
                         case 4: {
-                            int nIdx0 = mapNodeIndex[facesHelper[l].Element->GetNode(0)];
-                            int nIdx2 = mapNodeIndex[facesHelper[l].Element->GetNode(2)];
-                            int nIdx3 = mapNodeIndex[facesHelper[l].Element->GetNode(3)];
+                            int nIdx0 = nodeIndex[facesHelper[l].Element->GetNode(0)->GetID()];
+                            int nIdx2 = nodeIndex[facesHelper[l].Element->GetNode(2)->GetID()];
+                            int nIdx3 = nodeIndex[facesHelper[l].Element->GetNode(3)->GetID()];
                             indices[index++] = nIdx3;
                             indices[index++] = nIdx0;
                             indices[index++] = nIdx2;
                             indices[index++] = SO_END_FACE_INDEX;
-                            insEdgeVec(EdgeMap,nIdx0,nIdx2);
-                            insEdgeVec(EdgeMap,nIdx0,nIdx3);
-                            insEdgeVec(EdgeMap,nIdx3,nIdx2);
+                            insEdgeVec(EdgeVec,nIdx0,nIdx2);
+                            insEdgeVec(EdgeVec,nIdx0,nIdx3);
+                            insEdgeVec(EdgeVec,nIdx3,nIdx2);
                             vFaceElementIdx[indexIdx++] = ElemFold(facesHelper[l].ElementNumber,3);
                             break;    }
                         default: assert(0);
@@ -1026,123 +1002,123 @@ void ViewProviderFEMMeshBuilder::createMesh(const App::Property* prop, SoCoordin
                 case 8: // Hex 8
                     switch(facesHelper[l].FaceNo){
                         case 1: {
-                            int nIdx0 = mapNodeIndex[facesHelper[l].Element->GetNode(0)];
-                            int nIdx1 = mapNodeIndex[facesHelper[l].Element->GetNode(1)];
-                            int nIdx2 = mapNodeIndex[facesHelper[l].Element->GetNode(2)];
-                            int nIdx3 = mapNodeIndex[facesHelper[l].Element->GetNode(3)];
+                            int nIdx0 = nodeIndex[facesHelper[l].Element->GetNode(0)->GetID()];
+                            int nIdx1 = nodeIndex[facesHelper[l].Element->GetNode(1)->GetID()];
+                            int nIdx2 = nodeIndex[facesHelper[l].Element->GetNode(2)->GetID()];
+                            int nIdx3 = nodeIndex[facesHelper[l].Element->GetNode(3)->GetID()];
                             indices[index++] = nIdx0;
                             indices[index++] = nIdx1;
                             indices[index++] = nIdx3;
                             indices[index++] = SO_END_FACE_INDEX;
-                            insEdgeVec(EdgeMap,nIdx0,nIdx1);
-                            insEdgeVec(EdgeMap,nIdx0,nIdx3);
+                            insEdgeVec(EdgeVec,nIdx0,nIdx1);
+                            insEdgeVec(EdgeVec,nIdx0,nIdx3);
                             vFaceElementIdx[indexIdx++] = ElemFold(facesHelper[l].ElementNumber,0);
                             indices[index++] = nIdx2;
                             indices[index++] = nIdx3;
                             indices[index++] = nIdx1;
                             indices[index++] = SO_END_FACE_INDEX;
-                            insEdgeVec(EdgeMap,nIdx2,nIdx1);
-                            insEdgeVec(EdgeMap,nIdx2,nIdx3);
+                            insEdgeVec(EdgeVec,nIdx2,nIdx1);
+                            insEdgeVec(EdgeVec,nIdx2,nIdx3);
                             vFaceElementIdx[indexIdx++] = ElemFold(facesHelper[l].ElementNumber,0);
                             break;    }
                         case 2: {
-                            int nIdx4 = mapNodeIndex[facesHelper[l].Element->GetNode(4)];
-                            int nIdx5 = mapNodeIndex[facesHelper[l].Element->GetNode(5)];
-                            int nIdx6 = mapNodeIndex[facesHelper[l].Element->GetNode(6)];
-                            int nIdx7 = mapNodeIndex[facesHelper[l].Element->GetNode(7)];
+                            int nIdx4 = nodeIndex[facesHelper[l].Element->GetNode(4)->GetID()];
+                            int nIdx5 = nodeIndex[facesHelper[l].Element->GetNode(5)->GetID()];
+                            int nIdx6 = nodeIndex[facesHelper[l].Element->GetNode(6)->GetID()];
+                            int nIdx7 = nodeIndex[facesHelper[l].Element->GetNode(7)->GetID()];
                             indices[index++] = nIdx5;
                             indices[index++] = nIdx4;
                             indices[index++] = nIdx7;
                             indices[index++] = SO_END_FACE_INDEX;
-                            insEdgeVec(EdgeMap,nIdx4,nIdx5);
-                            insEdgeVec(EdgeMap,nIdx4,nIdx7);
+                            insEdgeVec(EdgeVec,nIdx4,nIdx5);
+                            insEdgeVec(EdgeVec,nIdx4,nIdx7);
                             vFaceElementIdx[indexIdx++] = ElemFold(facesHelper[l].ElementNumber,1);
                             indices[index++] = nIdx6;
                             indices[index++] = nIdx5;
                             indices[index++] = nIdx7;
                             indices[index++] = SO_END_FACE_INDEX;
-                            insEdgeVec(EdgeMap,nIdx6,nIdx5);
-                            insEdgeVec(EdgeMap,nIdx6,nIdx7);
+                            insEdgeVec(EdgeVec,nIdx6,nIdx5);
+                            insEdgeVec(EdgeVec,nIdx6,nIdx7);
                             vFaceElementIdx[indexIdx++] = ElemFold(facesHelper[l].ElementNumber,1);
                             break;    }
                         case 3: {
-                            int nIdx0 = mapNodeIndex[facesHelper[l].Element->GetNode(0)];
-                            int nIdx1 = mapNodeIndex[facesHelper[l].Element->GetNode(1)];
-                            int nIdx4 = mapNodeIndex[facesHelper[l].Element->GetNode(4)];
-                            int nIdx5 = mapNodeIndex[facesHelper[l].Element->GetNode(5)];
+                            int nIdx0 = nodeIndex[facesHelper[l].Element->GetNode(0)->GetID()];
+                            int nIdx1 = nodeIndex[facesHelper[l].Element->GetNode(1)->GetID()];
+                            int nIdx4 = nodeIndex[facesHelper[l].Element->GetNode(4)->GetID()];
+                            int nIdx5 = nodeIndex[facesHelper[l].Element->GetNode(5)->GetID()];
                             indices[index++] = nIdx1;
                             indices[index++] = nIdx0;
                             indices[index++] = nIdx5;
                             indices[index++] = SO_END_FACE_INDEX;
-                            insEdgeVec(EdgeMap,nIdx1,nIdx0);
-                            insEdgeVec(EdgeMap,nIdx1,nIdx5);
+                            insEdgeVec(EdgeVec,nIdx1,nIdx0);
+                            insEdgeVec(EdgeVec,nIdx1,nIdx5);
                             vFaceElementIdx[indexIdx++] = ElemFold(facesHelper[l].ElementNumber,2);
                             indices[index++] = nIdx5;
                             indices[index++] = nIdx0;
                             indices[index++] = nIdx4;
                             indices[index++] = SO_END_FACE_INDEX;
-                            insEdgeVec(EdgeMap,nIdx4,nIdx0);
-                            insEdgeVec(EdgeMap,nIdx4,nIdx5);
+                            insEdgeVec(EdgeVec,nIdx4,nIdx0);
+                            insEdgeVec(EdgeVec,nIdx4,nIdx5);
                             vFaceElementIdx[indexIdx++] = ElemFold(facesHelper[l].ElementNumber,2);
                             break;    }
                         case 4: {
-                            int nIdx1 = mapNodeIndex[facesHelper[l].Element->GetNode(1)];
-                            int nIdx2 = mapNodeIndex[facesHelper[l].Element->GetNode(2)];
-                            int nIdx5 = mapNodeIndex[facesHelper[l].Element->GetNode(5)];
-                            int nIdx6 = mapNodeIndex[facesHelper[l].Element->GetNode(6)];
+                            int nIdx1 = nodeIndex[facesHelper[l].Element->GetNode(1)->GetID()];
+                            int nIdx2 = nodeIndex[facesHelper[l].Element->GetNode(2)->GetID()];
+                            int nIdx5 = nodeIndex[facesHelper[l].Element->GetNode(5)->GetID()];
+                            int nIdx6 = nodeIndex[facesHelper[l].Element->GetNode(6)->GetID()];
                             indices[index++] = nIdx1;
                             indices[index++] = nIdx5;
                             indices[index++] = nIdx2;
                             indices[index++] = SO_END_FACE_INDEX;
-                            insEdgeVec(EdgeMap,nIdx1,nIdx5);
-                            insEdgeVec(EdgeMap,nIdx1,nIdx2);
+                            insEdgeVec(EdgeVec,nIdx1,nIdx5);
+                            insEdgeVec(EdgeVec,nIdx1,nIdx2);
                             vFaceElementIdx[indexIdx++] = ElemFold(facesHelper[l].ElementNumber,3);
                             indices[index++] = nIdx2;
                             indices[index++] = nIdx5;
                             indices[index++] = nIdx6;
                             indices[index++] = SO_END_FACE_INDEX;
-                            insEdgeVec(EdgeMap,nIdx6,nIdx5);
-                            insEdgeVec(EdgeMap,nIdx6,nIdx2);
+                            insEdgeVec(EdgeVec,nIdx6,nIdx5);
+                            insEdgeVec(EdgeVec,nIdx6,nIdx2);
                             vFaceElementIdx[indexIdx++] = ElemFold(facesHelper[l].ElementNumber,3);
                             break;    }
                         case 5: {
-                            int nIdx2 = mapNodeIndex[facesHelper[l].Element->GetNode(2)];
-                            int nIdx3 = mapNodeIndex[facesHelper[l].Element->GetNode(3)];
-                            int nIdx6 = mapNodeIndex[facesHelper[l].Element->GetNode(6)];
-                            int nIdx7 = mapNodeIndex[facesHelper[l].Element->GetNode(7)];
+                            int nIdx2 = nodeIndex[facesHelper[l].Element->GetNode(2)->GetID()];
+                            int nIdx3 = nodeIndex[facesHelper[l].Element->GetNode(3)->GetID()];
+                            int nIdx6 = nodeIndex[facesHelper[l].Element->GetNode(6)->GetID()];
+                            int nIdx7 = nodeIndex[facesHelper[l].Element->GetNode(7)->GetID()];
                             indices[index++] = nIdx3;
                             indices[index++] = nIdx2;
                             indices[index++] = nIdx7;
                             indices[index++] = SO_END_FACE_INDEX;
-                            insEdgeVec(EdgeMap,nIdx3,nIdx2);
-                            insEdgeVec(EdgeMap,nIdx3,nIdx7);
+                            insEdgeVec(EdgeVec,nIdx3,nIdx2);
+                            insEdgeVec(EdgeVec,nIdx3,nIdx7);
                             vFaceElementIdx[indexIdx++] = ElemFold(facesHelper[l].ElementNumber,4);
                             indices[index++] = nIdx7;
                             indices[index++] = nIdx2;
                             indices[index++] = nIdx6;
                             indices[index++] = SO_END_FACE_INDEX;
-                            insEdgeVec(EdgeMap,nIdx6,nIdx2);
-                            insEdgeVec(EdgeMap,nIdx6,nIdx7);
+                            insEdgeVec(EdgeVec,nIdx6,nIdx2);
+                            insEdgeVec(EdgeVec,nIdx6,nIdx7);
                             vFaceElementIdx[indexIdx++] = ElemFold(facesHelper[l].ElementNumber,4);
                             break;    }
                         case 6: {
-                            int nIdx0 = mapNodeIndex[facesHelper[l].Element->GetNode(0)];
-                            int nIdx3 = mapNodeIndex[facesHelper[l].Element->GetNode(3)];
-                            int nIdx4 = mapNodeIndex[facesHelper[l].Element->GetNode(4)];
-                            int nIdx7 = mapNodeIndex[facesHelper[l].Element->GetNode(7)];
+                            int nIdx0 = nodeIndex[facesHelper[l].Element->GetNode(0)->GetID()];
+                            int nIdx3 = nodeIndex[facesHelper[l].Element->GetNode(3)->GetID()];
+                            int nIdx4 = nodeIndex[facesHelper[l].Element->GetNode(4)->GetID()];
+                            int nIdx7 = nodeIndex[facesHelper[l].Element->GetNode(7)->GetID()];
                             indices[index++] = nIdx0;
                             indices[index++] = nIdx3;
                             indices[index++] = nIdx4;
                             indices[index++] = SO_END_FACE_INDEX;
-                            insEdgeVec(EdgeMap,nIdx0,nIdx4);
-                            insEdgeVec(EdgeMap,nIdx0,nIdx3);
+                            insEdgeVec(EdgeVec,nIdx0,nIdx4);
+                            insEdgeVec(EdgeVec,nIdx0,nIdx3);
                             vFaceElementIdx[indexIdx++] = ElemFold(facesHelper[l].ElementNumber,5);
                             indices[index++] = nIdx4;
                             indices[index++] = nIdx3;
                             indices[index++] = nIdx7;
                             indices[index++] = SO_END_FACE_INDEX;
-                            insEdgeVec(EdgeMap,nIdx7,nIdx4);
-                            insEdgeVec(EdgeMap,nIdx7,nIdx3);
+                            insEdgeVec(EdgeVec,nIdx7,nIdx4);
+                            insEdgeVec(EdgeVec,nIdx7,nIdx3);
                             vFaceElementIdx[indexIdx++] = ElemFold(facesHelper[l].ElementNumber,5);
                             break;    }
                     }
@@ -1151,12 +1127,12 @@ void ViewProviderFEMMeshBuilder::createMesh(const App::Property* prop, SoCoordin
                     switch(facesHelper[l].FaceNo){
                         case 1: { // element face number 1
                             // prefeche all node indexes of this face
-                            int nIdx0 = mapNodeIndex[facesHelper[l].Element->GetNode(0)];
-                            int nIdx1 = mapNodeIndex[facesHelper[l].Element->GetNode(1)];
-                            int nIdx2 = mapNodeIndex[facesHelper[l].Element->GetNode(2)];
-                            int nIdx4 = mapNodeIndex[facesHelper[l].Element->GetNode(4)];
-                            int nIdx5 = mapNodeIndex[facesHelper[l].Element->GetNode(5)];
-                            int nIdx6 = mapNodeIndex[facesHelper[l].Element->GetNode(6)];
+                            int nIdx0 = nodeIndex[facesHelper[l].Element->GetNode(0)->GetID()];
+                            int nIdx1 = nodeIndex[facesHelper[l].Element->GetNode(1)->GetID()];
+                            int nIdx2 = nodeIndex[facesHelper[l].Element->GetNode(2)->GetID()];
+                            int nIdx4 = nodeIndex[facesHelper[l].Element->GetNode(4)->GetID()];
+                            int nIdx5 = nodeIndex[facesHelper[l].Element->GetNode(5)->GetID()];
+                            int nIdx6 = nodeIndex[facesHelper[l].Element->GetNode(6)->GetID()];
                             // create triangle number 1 ----------------------------------------------
                             // fill in the node indexes in CLOCKWISE order
                             indices[index++] = nIdx6;
@@ -1164,8 +1140,8 @@ void ViewProviderFEMMeshBuilder::createMesh(const App::Property* prop, SoCoordin
                             indices[index++] = nIdx4;
                             indices[index++] = SO_END_FACE_INDEX;
                             // add the two edge segments for that triangle
-                            insEdgeVec(EdgeMap,nIdx0,nIdx6);
-                            insEdgeVec(EdgeMap,nIdx0,nIdx4);
+                            insEdgeVec(EdgeVec,nIdx0,nIdx6);
+                            insEdgeVec(EdgeVec,nIdx0,nIdx4);
                             // rember the element and face number for that triangle
                             vFaceElementIdx[indexIdx++] = ElemFold(facesHelper[l].ElementNumber,0);
                             // create triangle number 2 ----------------------------------------------
@@ -1173,16 +1149,16 @@ void ViewProviderFEMMeshBuilder::createMesh(const App::Property* prop, SoCoordin
                             indices[index++] = nIdx6;
                             indices[index++] = nIdx5;
                             indices[index++] = SO_END_FACE_INDEX;
-                            insEdgeVec(EdgeMap,nIdx2,nIdx6);
-                            insEdgeVec(EdgeMap,nIdx2,nIdx5);
+                            insEdgeVec(EdgeVec,nIdx2,nIdx6);
+                            insEdgeVec(EdgeVec,nIdx2,nIdx5);
                             vFaceElementIdx[indexIdx++] = ElemFold(facesHelper[l].ElementNumber,0);
                             // create triangle number 3 ----------------------------------------------
                             indices[index++] = nIdx1;
                             indices[index++] = nIdx5;
                             indices[index++] = nIdx4;
                             indices[index++] = SO_END_FACE_INDEX;
-                            insEdgeVec(EdgeMap,nIdx1,nIdx5);
-                            insEdgeVec(EdgeMap,nIdx1,nIdx4);
+                            insEdgeVec(EdgeVec,nIdx1,nIdx5);
+                            insEdgeVec(EdgeVec,nIdx1,nIdx4);
                             vFaceElementIdx[indexIdx++] = ElemFold(facesHelper[l].ElementNumber,0);
                             // create triangle number 4 ----------------------------------------------
                             indices[index++] = nIdx6;
@@ -1192,32 +1168,32 @@ void ViewProviderFEMMeshBuilder::createMesh(const App::Property* prop, SoCoordin
                             // this triangle has no edge (inner triangle).
                             break;    }
                         case 2: {
-                            int nIdx0 = mapNodeIndex[facesHelper[l].Element->GetNode(0)];
-                            int nIdx1 = mapNodeIndex[facesHelper[l].Element->GetNode(1)];
-                            int nIdx3 = mapNodeIndex[facesHelper[l].Element->GetNode(3)];
-                            int nIdx4 = mapNodeIndex[facesHelper[l].Element->GetNode(4)];
-                            int nIdx7 = mapNodeIndex[facesHelper[l].Element->GetNode(7)];
-                            int nIdx8 = mapNodeIndex[facesHelper[l].Element->GetNode(8)];
+                            int nIdx0 = nodeIndex[facesHelper[l].Element->GetNode(0)->GetID()];
+                            int nIdx1 = nodeIndex[facesHelper[l].Element->GetNode(1)->GetID()];
+                            int nIdx3 = nodeIndex[facesHelper[l].Element->GetNode(3)->GetID()];
+                            int nIdx4 = nodeIndex[facesHelper[l].Element->GetNode(4)->GetID()];
+                            int nIdx7 = nodeIndex[facesHelper[l].Element->GetNode(7)->GetID()];
+                            int nIdx8 = nodeIndex[facesHelper[l].Element->GetNode(8)->GetID()];
                             indices[index++] = nIdx4;
                             indices[index++] = nIdx0;
                             indices[index++] = nIdx7;
                             indices[index++] = SO_END_FACE_INDEX;
-                            insEdgeVec(EdgeMap,nIdx0,nIdx7);
-                            insEdgeVec(EdgeMap,nIdx0,nIdx4);
+                            insEdgeVec(EdgeVec,nIdx0,nIdx7);
+                            insEdgeVec(EdgeVec,nIdx0,nIdx4);
                             vFaceElementIdx[indexIdx++] = ElemFold(facesHelper[l].ElementNumber,1);
                             indices[index++] = nIdx1;
                             indices[index++] = nIdx4;
                             indices[index++] = nIdx8;
                             indices[index++] = SO_END_FACE_INDEX;
-                            insEdgeVec(EdgeMap,nIdx1,nIdx8);
-                            insEdgeVec(EdgeMap,nIdx1,nIdx4);
+                            insEdgeVec(EdgeVec,nIdx1,nIdx8);
+                            insEdgeVec(EdgeVec,nIdx1,nIdx4);
                             vFaceElementIdx[indexIdx++] = ElemFold(facesHelper[l].ElementNumber,1);
                             indices[index++] = nIdx3;
                             indices[index++] = nIdx8;
                             indices[index++] = nIdx7;
                             indices[index++] = SO_END_FACE_INDEX;
-                            insEdgeVec(EdgeMap,nIdx3,nIdx7);
-                            insEdgeVec(EdgeMap,nIdx3,nIdx8);
+                            insEdgeVec(EdgeVec,nIdx3,nIdx7);
+                            insEdgeVec(EdgeVec,nIdx3,nIdx8);
                             vFaceElementIdx[indexIdx++] = ElemFold(facesHelper[l].ElementNumber,1);
                             indices[index++] = nIdx8;
                             indices[index++] = nIdx4;
@@ -1226,32 +1202,32 @@ void ViewProviderFEMMeshBuilder::createMesh(const App::Property* prop, SoCoordin
                             vFaceElementIdx[indexIdx++] = ElemFold(facesHelper[l].ElementNumber,1);
                             break;    }
                         case 3: {
-                            int nIdx1 = mapNodeIndex[facesHelper[l].Element->GetNode(1)];
-                            int nIdx2 = mapNodeIndex[facesHelper[l].Element->GetNode(2)];
-                            int nIdx3 = mapNodeIndex[facesHelper[l].Element->GetNode(3)];
-                            int nIdx5 = mapNodeIndex[facesHelper[l].Element->GetNode(5)];
-                            int nIdx8 = mapNodeIndex[facesHelper[l].Element->GetNode(8)];
-                            int nIdx9 = mapNodeIndex[facesHelper[l].Element->GetNode(9)];
+                            int nIdx1 = nodeIndex[facesHelper[l].Element->GetNode(1)->GetID()];
+                            int nIdx2 = nodeIndex[facesHelper[l].Element->GetNode(2)->GetID()];
+                            int nIdx3 = nodeIndex[facesHelper[l].Element->GetNode(3)->GetID()];
+                            int nIdx5 = nodeIndex[facesHelper[l].Element->GetNode(5)->GetID()];
+                            int nIdx8 = nodeIndex[facesHelper[l].Element->GetNode(8)->GetID()];
+                            int nIdx9 = nodeIndex[facesHelper[l].Element->GetNode(9)->GetID()];
                             indices[index++] = nIdx5;
                             indices[index++] = nIdx1;
                             indices[index++] = nIdx8;
                             indices[index++] = SO_END_FACE_INDEX;
-                            insEdgeVec(EdgeMap,nIdx1,nIdx5);
-                            insEdgeVec(EdgeMap,nIdx1,nIdx8);
+                            insEdgeVec(EdgeVec,nIdx1,nIdx5);
+                            insEdgeVec(EdgeVec,nIdx1,nIdx8);
                             vFaceElementIdx[indexIdx++] = ElemFold(facesHelper[l].ElementNumber,2);
                             indices[index++] = nIdx2;
                             indices[index++] = nIdx5;
                             indices[index++] = nIdx9;
                             indices[index++] = SO_END_FACE_INDEX;
-                            insEdgeVec(EdgeMap,nIdx2,nIdx5);
-                            insEdgeVec(EdgeMap,nIdx2,nIdx9);
+                            insEdgeVec(EdgeVec,nIdx2,nIdx5);
+                            insEdgeVec(EdgeVec,nIdx2,nIdx9);
                             vFaceElementIdx[indexIdx++] = ElemFold(facesHelper[l].ElementNumber,2);
                             indices[index++] = nIdx3;
                             indices[index++] = nIdx9;
                             indices[index++] = nIdx8;
                             indices[index++] = SO_END_FACE_INDEX;
-                            insEdgeVec(EdgeMap,nIdx3,nIdx9);
-                            insEdgeVec(EdgeMap,nIdx3,nIdx8);
+                            insEdgeVec(EdgeVec,nIdx3,nIdx9);
+                            insEdgeVec(EdgeVec,nIdx3,nIdx8);
                             vFaceElementIdx[indexIdx++] = ElemFold(facesHelper[l].ElementNumber,2);
                             indices[index++] = nIdx9;
                             indices[index++] = nIdx5;
@@ -1260,32 +1236,32 @@ void ViewProviderFEMMeshBuilder::createMesh(const App::Property* prop, SoCoordin
                             vFaceElementIdx[indexIdx++] = ElemFold(facesHelper[l].ElementNumber,2);
                             break;    }
                         case 4: {
-                            int nIdx0 = mapNodeIndex[facesHelper[l].Element->GetNode(0)];
-                            int nIdx2 = mapNodeIndex[facesHelper[l].Element->GetNode(2)];
-                            int nIdx3 = mapNodeIndex[facesHelper[l].Element->GetNode(3)];
-                            int nIdx6 = mapNodeIndex[facesHelper[l].Element->GetNode(6)];
-                            int nIdx7 = mapNodeIndex[facesHelper[l].Element->GetNode(7)];
-                            int nIdx9 = mapNodeIndex[facesHelper[l].Element->GetNode(9)];
+                            int nIdx0 = nodeIndex[facesHelper[l].Element->GetNode(0)->GetID()];
+                            int nIdx2 = nodeIndex[facesHelper[l].Element->GetNode(2)->GetID()];
+                            int nIdx3 = nodeIndex[facesHelper[l].Element->GetNode(3)->GetID()];
+                            int nIdx6 = nodeIndex[facesHelper[l].Element->GetNode(6)->GetID()];
+                            int nIdx7 = nodeIndex[facesHelper[l].Element->GetNode(7)->GetID()];
+                            int nIdx9 = nodeIndex[facesHelper[l].Element->GetNode(9)->GetID()];
                             indices[index++] = nIdx0;
                             indices[index++] = nIdx6;
                             indices[index++] = nIdx7;
                             indices[index++] = SO_END_FACE_INDEX;
-                            insEdgeVec(EdgeMap,nIdx0,nIdx6);
-                            insEdgeVec(EdgeMap,nIdx0,nIdx7);
+                            insEdgeVec(EdgeVec,nIdx0,nIdx6);
+                            insEdgeVec(EdgeVec,nIdx0,nIdx7);
                             vFaceElementIdx[indexIdx++] = ElemFold(facesHelper[l].ElementNumber,3);
                             indices[index++] = nIdx6;
                             indices[index++] = nIdx2;
                             indices[index++] = nIdx9;
                             indices[index++] = SO_END_FACE_INDEX;
-                            insEdgeVec(EdgeMap,nIdx2,nIdx6);
-                            insEdgeVec(EdgeMap,nIdx2,nIdx9);
+                            insEdgeVec(EdgeVec,nIdx2,nIdx6);
+                            insEdgeVec(EdgeVec,nIdx2,nIdx9);
                             vFaceElementIdx[indexIdx++] = ElemFold(facesHelper[l].ElementNumber,3);
                             indices[index++] = nIdx7;
                             indices[index++] = nIdx9;
                             indices[index++] = nIdx3;
                             indices[index++] = SO_END_FACE_INDEX;
-                            insEdgeVec(EdgeMap,nIdx3,nIdx9);
-                            insEdgeVec(EdgeMap,nIdx3,nIdx7);
+                            insEdgeVec(EdgeVec,nIdx3,nIdx9);
+                            insEdgeVec(EdgeVec,nIdx3,nIdx7);
                             vFaceElementIdx[indexIdx++] = ElemFold(facesHelper[l].ElementNumber,3);
                             indices[index++] = nIdx7;
                             indices[index++] = nIdx6;
@@ -1306,23 +1282,20 @@ void ViewProviderFEMMeshBuilder::createMesh(const App::Property* prop, SoCoordin
     faces->coordIndex.finishEditing();
 
     Base::Console().Log("    %f: Start build up edge vector\n",Base::TimeInfo::diffTimeF(Start,Base::TimeInfo()));
-    // std::map<int,std::set<int> > EdgeMap;
-    // count edges
-    int EdgeSize = 0;
-    for(std::map<int,std::set<int> >::const_iterator it= EdgeMap.begin();it!= EdgeMap.end();++it)
-        EdgeSize += it->second.size();
+    // remove the edges shared by neighbouring faces
+    std::sort(EdgeVec.begin(), EdgeVec.end());
+    EdgeVec.erase(std::unique(EdgeVec.begin(), EdgeVec.end()), EdgeVec.end());
+    int EdgeSize = EdgeVec.size();
 
     // set the triangle face indices
     lines->coordIndex.setNum(3*EdgeSize);
     index=0;
     indices = lines->coordIndex.startEditing();
 
-    for(std::map<int,std::set<int> >::const_iterator it= EdgeMap.begin();it!= EdgeMap.end();++it){
-        for(std::set<int>::const_iterator it2=it->second.begin();it2!=it->second.end();++it2){
-            indices[index++] = it->first;
-            indices[index++] = *it2;
-            indices[index++] = -1;
-        }
+    for(std::vector<std::pair<int,int> >::const_iterator it= EdgeVec.begin();it!= EdgeVec.end();++it){
+        indices[index++] = it->first;
+        indices[index++] = it->second;
+        indices[index++] = -1;
     }
 
     lines->coordIndex.finishEditing();
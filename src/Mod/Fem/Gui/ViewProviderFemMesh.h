@@ -138,11 +138,13 @@ protected:
     /// get called by the container whenever a property has been changed
     virtual void onChanged(const App::Property* prop);
 
-    void setColorByNodeIdHelper(const std::vector<App::Color> &);
-    void setDisplacementByNodeIdHelper(const std::vector<Base::Vector3d>& DispVector,long startId);
+    /// rebuilds vNodeSkinIdx after the mesh has been created
+    void updateSkinNodeIndex(void);
     /// index of elements to their triangles
     std::vector<unsigned long> vFaceElementIdx;
     std::vector<unsigned long> vNodeElementIdx;
+    /// position of a node id in vNodeElementIdx, -1 if the node is not shown
+    std::vector<long> vNodeSkinIdx;
 
     std::vector<Base::Vector3d> DisplacementVector;
     double                      DisplacementFactor;
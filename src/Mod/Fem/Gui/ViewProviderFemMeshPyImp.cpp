@@ -9,6 +9,7 @@
 #include "Mod/Fem/Gui/ViewProviderFemMesh.h"
 #include "Mod/Fem/App/FemResultVector.h"
 #include "Mod/Fem/App/FemResultValue.h"
+#include "Mod/Fem/App/FemResultData.h"
 
 // inclusion of the generated files (generated out of ViewProviderFemMeshPy.xml)
 #include "ViewProviderFemMeshPy.h"
@@ -57,6 +58,45 @@ App::Color calcColor(double value,double min, double max)
 }
 
 
+// collects the nodes with values of a time step of the result data
+static bool getResultStep(const Fem::FemResultData& data, int step,
+                          std::vector<long>& ids, std::vector<double>& values)
+{
+    if (step < 0 || step >= (int)data.countSteps())
+        return false;
+    int components = data.countComponents();
+    for (unsigned long i = 0; i < data.countNodes(); i++) {
+        long nodeId = data.getFirstNodeId() + (long)i;
+        const float* v = data.getNodeValues(step, nodeId);
+        if (v[0] != v[0]) // NaN, the node has no values
+            continue;
+        ids.push_back(nodeId);
+        if (components == 6)
+            values.push_back(Fem::FemResultData::getVonMisesStress(v));
+        else if (components == 3)
+            values.push_back(Base::Vector3d(v[0], v[1], v[2]).Length());
+        else
+            values.push_back(v[0]);
+    }
+    return true;
+}
+
+static bool getResultStep(const Fem::FemResultData& data, int step,
+                          std::vector<long>& ids, std::vector<Base::Vector3d>& vectors)
+{
+    if (step < 0 || step >= (int)data.countSteps() || data.countComponents() != 3)
+        return false;
+    for (unsigned long i = 0; i < data.countNodes(); i++) {
+        long nodeId = data.getFirstNodeId() + (long)i;
+        const float* v = data.getNodeValues(step, nodeId);
+        if (v[0] != v[0]) // NaN, the node has no values
+            continue;
+        ids.push_back(nodeId);
+        vectors.push_back(Base::Vector3d(v[0], v[1], v[2]));
+    }
+    return true;
+}
+
 PyObject* ViewProviderFemMeshPy::setNodeColorByResult(PyObject *args)
 {
 	// statistical values get collected and returned
@@ -66,12 +106,19 @@ PyObject* ViewProviderFemMeshPy::setNodeColorByResult(PyObject *args)
 
     PyObject *object=0;
     int type = 0;
-    if (PyArg_ParseTuple(args,"O!|i",&(App::DocumentObjectPy::Type), &object, &type)) {
+    int step = -1;
+    if (PyArg_ParseTuple(args,"O!|ii",&(App::DocumentObjectPy::Type), &object, &type, &step)) {
         App::DocumentObject* obj = static_cast<App::DocumentObjectPy*>(object)->getDocumentObjectPtr();
         if (obj && obj->getTypeId().isDerivedFrom(Fem::FemResultValue::getClassTypeId())){
             Fem::FemResultValue *result = static_cast<Fem::FemResultValue*>(obj);
-            const std::vector<long> & Ids = result->ElementNumbers.getValues() ;
-            const std::vector<double> & Vals = result->Values.getValues() ;
+            std::vector<long> StepIds;
+            std::vector<double> StepVals;
+            if (step >= 0 && !getResultStep(result->Result.getValue(), step, StepIds, StepVals)) {
+                PyErr_SetString(PyExc_IndexError, "Result has no such time step");
+                return 0;
+            }
+            const std::vector<long> & Ids = step >= 0 ? StepIds : result->ElementNumbers.getValues() ;
+            const std::vector<double> & Vals = step >= 0 ? StepVals : result->Values.getValues() ;
             std::vector<App::Color> NodeColors(Vals.size());
 			for(std::vector<double>::const_iterator it= Vals.begin();it!=Vals.end();++it){
                 if(*it > max)
@@ -93,8 +140,14 @@ PyObject* ViewProviderFemMeshPy::setNodeColorByResult(PyObject *args)
 
         }else if (obj && obj->getTypeId().isDerivedFrom(Fem::FemResultVector::getClassTypeId())){
             Fem::FemResultVector *result = static_cast<Fem::FemResultVector*>(obj);
-            const std::vector<long> & Ids = result->ElementNumbers.getValues() ;
-            const std::vector<Base::Vector3d> & Vecs = result->Values.getValues() ;
+            std::vector<long> StepIds;
+            std::vector<Base::Vector3d> StepVecs;
+            if (step >= 0 && !getResultStep(result->Result.getValue(), step, StepIds, StepVecs)) {
+                PyErr_SetString(PyExc_IndexError, "Result has no such time step");
+                return 0;
+            }
+            const std::vector<long> & Ids = step >= 0 ? StepIds : result->ElementNumbers.getValues() ;
+            const std::vector<Base::Vector3d> & Vecs = step >= 0 ? StepVecs : result->Values.getValues() ;
             std::vector<App::Color> NodeColors(Vecs.size());
 
 			for(std::vector<Base::Vector3d>::const_iterator it= Vecs.begin();it!=Vecs.end();++it){
@@ -154,12 +207,19 @@ PyObject* ViewProviderFemMeshPy::setNodeColorByResult(PyObject *args)
 PyObject* ViewProviderFemMeshPy::setNodeDisplacementByResult(PyObject *args)
 {
     PyObject *object=0;
-    if (PyArg_ParseTuple(args,"O!",&(App::DocumentObjectPy::Type), &object)) {
+    int step = -1;
+    if (PyArg_ParseTuple(args,"O!|i",&(App::DocumentObjectPy::Type), &object, &step)) {
         App::DocumentObject* obj = static_cast<App::DocumentObjectPy*>(object)->getDocumentObjectPtr();
         if (obj && obj->getTypeId().isDerivedFrom(Fem::FemResultVector::getClassTypeId())){
             Fem::FemResultVector *result = static_cast<Fem::FemResultVector*>(obj);
-            const std::vector<long> & Ids = result->ElementNumbers.getValues() ;
-            const std::vector<Base::Vector3d> & Vecs = result->Values.getValues() ;
+            std::vector<long> StepIds;
+            std::vector<Base::Vector3d> StepVecs;
+            if (step >= 0 && !getResultStep(result->Result.getValue(), step, StepIds, StepVecs)) {
+                PyErr_SetString(PyExc_IndexError, "Result has no such time step");
+                return 0;
+            }
+            const std::vector<long> & Ids = step >= 0 ? StepIds : result->ElementNumbers.getValues() ;
+            const std::vector<Base::Vector3d> & Vecs = step >= 0 ? StepVecs : result->Values.getValues() ;
             // set the displacement to the view-provider 
             this->getViewProviderFemMeshPtr()->setDisplacementByNodeId(Ids,Vecs);
 
@@ -30,9 +30,45 @@
 #include <Base/Console.h>
 #include <Base/PyObjectBase.h>
 #include <Base/Exception.h>
+#include <Base/GeometryPyCXX.h>
+#include <CXX/Objects.hxx>
+#include <Mod/Mesh/App/MeshPy.h>
 
+#include "InspectionFeature.h"
+
+
+static PyObject *
+fastMeshDistances(PyObject *self, PyObject *args)
+{
+    PyObject* mesh;
+    PyObject* points;
+    float searchRadius = 0.05f;
+    if (!PyArg_ParseTuple(args, "O!O|f", &(Mesh::MeshPy::Type), &mesh, &points, &searchRadius))
+        return NULL;
+
+    PY_TRY {
+        Inspection::InspectNominalFastMesh nominal(*static_cast<Mesh::MeshPy*>(mesh)->getMeshObjectPtr(),
+                                                   searchRadius);
+        Py::Sequence list(points);
+        Py::List distances;
+        for (Py::Sequence::iterator it = list.begin(); it != list.end(); ++it) {
+            Base::Vector3d pnt = Py::Vector(*it).toVector();
+            float dist = nominal.getDistance(Base::convertTo<Base::Vector3f>(pnt));
+            distances.append(Py::Float(dist));
+        }
+        return Py::new_reference_to(distances);
+    } PY_CATCH;
+}
+
+PyDoc_STRVAR(fastMeshDistances_doc,
+"fastMeshDistances(mesh,points,[searchRadius=0.05]) -- Return the signed distances of the points to the mesh.\n"
+"The distances are computed like InspectNominalFastMesh does, i.e. only facets in grid elements\n"
+"near a point are taken into account. Points farther than searchRadius from the bounding box of\n"
+"the mesh get the largest float value.\n"
+);
 
 /* registration table  */
 struct PyMethodDef Inspection_methods[] = {
+    {"fastMeshDistances",fastMeshDistances, METH_VARARGS, fastMeshDistances_doc},
     {NULL, NULL}        /* end of table marker */
 };
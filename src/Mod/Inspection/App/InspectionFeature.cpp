@@ -26,18 +26,19 @@
 #include <BRepExtrema_DistShapeShape.hxx>
 #include <BRepBuilderAPI_MakeVertex.hxx>
 #include <TopoDS_Vertex.hxx>
+#include <Standard.hxx>
 
-#include <QEventLoop>
+#include <QAtomicInt>
 #include <QFuture>
-#include <QFutureWatcher>
-#include <QtConcurrentMap>
+#include <QList>
+#include <QThread>
+#include <QtConcurrentRun>
 
 #include <boost/signals.hpp>
 #include <boost/bind.hpp>
 
 #include <Base/Console.h>
 #include <Base/Exception.h>
-#include <Base/FutureWatcherProgress.h>
 #include <Base/Parameter.h>
 #include <Base/Sequencer.h>
 #include <Base/Tools.h>
@@ -45,6 +46,8 @@
 #include <Mod/Mesh/App/Mesh.h>
 #include <Mod/Mesh/App/MeshFeature.h>
 #include <Mod/Mesh/App/Core/Algorithm.h>
+#include <Mod/Mesh/App/Core/BVH.h>
+#include <Mod/Mesh/App/Core/FacetBatch.h>
 #include <Mod/Mesh/App/Core/Grid.h>
 #include <Mod/Mesh/App/Core/Iterator.h>
 #include <Mod/Mesh/App/Core/MeshKernel.h>
@@ -74,8 +77,10 @@ unsigned long InspectActualMesh::countPoints() const
 
 Base::Vector3f InspectActualMesh::getPoint(unsigned long index)
 {
-    _iter.Set(index);
-    return *_iter;
+    // use a copy of the iterator to be thread-safe
+    MeshCore::MeshPointIterator iter(_iter);
+    iter.Set(index);
+    return *iter;
 }
 
 // ----------------------------------------------------------------
@@ -176,7 +181,7 @@ namespace Inspection {
             assert((rulX < _ulCtGridsX) && (rulY < _ulCtGridsY) && (rulZ < _ulCtGridsZ));
         }
 
-        void AddFacet (const MeshCore::MeshGeomFacet &rclFacet, unsigned long ulFacetIndex)
+        void AddFacet (const MeshCore::MeshGeomFacet &rclFacet, unsigned long ulFacetIndex, GridEntries &raclEntries) const
         {
             unsigned long ulX, ulY, ulZ;
             unsigned long ulX1, ulY1, ulZ1, ulX2, ulY2, ulZ2;
@@ -195,19 +200,27 @@ namespace Inspection {
                     for (ulY = ulY1; ulY <= ulY2; ulY++) {
                         for (ulZ = ulZ1; ulZ <= ulZ2; ulZ++) {
                             if (rclFacet.IntersectBoundingBox(GetBoundBox(ulX, ulY, ulZ)))
-                                _aulGrid[ulX][ulY][ulZ].insert(ulFacetIndex);
+                                raclEntries.push_back(std::make_pair(GridIndex(ulX, ulY, ulZ), ulFacetIndex));
                         }
                     }
                 }
             }
             else
-                _aulGrid[ulX1][ulY1][ulZ1].insert(ulFacetIndex);
+                raclEntries.push_back(std::make_pair(GridIndex(ulX1, ulY1, ulZ1), ulFacetIndex));
         }
 
-        void InitGrid (void)
+        void CollectElements (unsigned long ulBegin, unsigned long ulEnd, GridEntries &raclEntries) const
         {
-            unsigned long i, j;
+            MeshCore::MeshFacetIterator clFIter(*_pclMesh);
+            clFIter.Transform(_transform);
+            for (unsigned long i = ulBegin; i < ulEnd; i++) {
+                clFIter.Set(i);
+                AddFacet(*clFIter, i, raclEntries);
+            }
+        }
 
+        void InitGrid (void)
+        {
             Base::BoundBox3f clBBMesh = _pclMesh->GetBoundBox().Transformed(_transform);
 
             float fLengthX = clBBMesh.LengthX(); 
@@ -223,26 +236,15 @@ namespace Inspection {
             _fGridLenZ = (1.0f + fLengthZ) / float(_ulCtGridsZ);
             _fMinZ = clBBMesh.MinZ - 0.5f;
 
-            _aulGrid.clear();
-            _aulGrid.resize(_ulCtGridsX);
-            for (i = 0; i < _ulCtGridsX; i++) {
-                _aulGrid[i].resize(_ulCtGridsY);
-                for (j = 0; j < _ulCtGridsY; j++)
-                    _aulGrid[i][j].resize(_ulCtGridsZ);
-            }
+            _aulGridOffsets.assign(_ulCtGridsX * _ulCtGridsY * _ulCtGridsZ + 1, 0);
+            std::vector<unsigned long>().swap(_aulGridElements);
         }
 
         void RebuildGrid (void)
         {
             _ulCtElements = _pclMesh->CountFacets();
             InitGrid();
- 
-            unsigned long i = 0;
-            MeshCore::MeshFacetIterator clFIter(*_pclMesh);
-            clFIter.Transform(_transform);
-            for (clFIter.Init(); clFIter.More(); clFIter.Next()) {
-                AddFacet(*clFIter, i++);
-            }
+            FillGrid();
         }
 
     private:
@@ -255,29 +257,16 @@ InspectNominalMesh::InspectNominalMesh(const Mesh::MeshObject& rMesh, float offs
     const MeshCore::MeshKernel& kernel = rMesh.getKernel();
     _iter.Transform(rMesh.getTransform());
 
-    // Max. limit of grid elements
-    float fMaxGridElements=8000000.0f;
-    Base::BoundBox3f box = kernel.GetBoundBox().Transformed(rMesh.getTransform());
-
-    // estimate the minimum allowed grid length
-    float fMinGridLen = (float)pow((box.LengthX()*box.LengthY()*box.LengthZ()/fMaxGridElements), 0.3333f);
-    float fGridLen = 5.0f * MeshCore::MeshAlgorithm(kernel).GetAverageEdgeLength();
-
-    // We want to avoid to get too small grid elements otherwise building up the grid structure would take
-    // too much time and memory. 
-    // Having quite a dense grid speeds up more the following algorithms extremely. Due to the issue above it's
-    // always a compromise between speed and memory usage.
-    fGridLen = std::max<float>(fMinGridLen, fGridLen);
-
-    // build up grid structure to speed up algorithms
-    _pGrid = new MeshInspectGrid(kernel, fGridLen, rMesh.getTransform());
-    _box = box;
+    // The hierarchy adapts to the density of the mesh so, unlike a grid, it doesn't
+    // need a cell size that is a compromise between speed and memory usage.
+    _pBVH = new MeshCore::MeshFacetBVH(kernel, rMesh.getTransform());
+    _box = _pBVH->GetBoundBox();
     _box.Enlarge(offset);
 }
 
 InspectNominalMesh::~InspectNominalMesh()
 {
-    delete this->_pGrid;
+    delete this->_pBVH;
 }
 
 float InspectNominalMesh::getDistance(const Base::Vector3f& point)
@@ -285,26 +274,15 @@ float InspectNominalMesh::getDistance(const Base::Vector3f& point)
     if (!_box.IsInBox(point))
         return FLT_MAX; // must be inside bbox
 
-    std::vector<unsigned long> indices;
-    //_pGrid->GetElements(point, indices);
-    if (indices.empty()) {
-        std::set<unsigned long> inds;
-        _pGrid->MeshGrid::SearchNearestFromPoint(point, inds);
-        indices.insert(indices.begin(), inds.begin(), inds.end());
-    }
+    Base::Vector3f res;
+    unsigned long index;
+    if (!_pBVH->NearestFacetToPoint(point, res, index))
+        return FLT_MAX;
 
-    float fMinDist=FLT_MAX;
-    bool positive = true;
-    for (std::vector<unsigned long>::iterator it = indices.begin(); it != indices.end(); ++it) {
-        _iter.Set(*it);
-        float fDist = _iter->DistanceToPoint(point);
-        if (fabs(fDist) < fabs(fMinDist)) {
-            fMinDist = fDist;
-            positive = point.DistanceToPlane(_iter->_aclPoints[0], _iter->GetNormal()) > 0;
-        }
-    }
-
-    if (!positive)
+    float fMinDist = Base::Distance(point, res);
+    MeshCore::MeshFacetIterator iter(_iter);
+    iter.Set(index);
+    if (point.DistanceToPlane(iter->_aclPoints[0], iter->GetNormal()) <= 0)
         fMinDist = -fMinDist;
     return fMinDist;
 }
@@ -368,12 +346,20 @@ float InspectNominalFastMesh::getDistance(const Base::Vector3f& point)
 
     float fMinDist=FLT_MAX;
     bool positive = true;
-    for (std::set<unsigned long>::iterator it = indices.begin(); it != indices.end(); ++it) {
-        _iter.Set(*it);
-        float fDist = _iter->DistanceToPoint(point);
+    MeshCore::MeshFacetIterator iter(_iter);
+
+    // compute the exact distance only for facets that may be the nearest ones
+    std::vector<unsigned long> facets(indices.begin(), indices.end());
+    std::vector<unsigned long> positions;
+    MeshCore::MeshFacetBatch batch;
+    batch.Assign(iter, facets);
+    batch.FilterNearestToPoint(point, FLT_MAX, positions);
+    for (std::vector<unsigned long>::iterator it = positions.begin(); it != positions.end(); ++it) {
+        iter.Set(facets[*it]);
+        float fDist = iter->DistanceToPoint(point);
         if (fabs(fDist) < fabs(fMinDist)) {
             fMinDist = fDist;
-            positive = point.DistanceToPlane(_iter->_aclPoints[0], _iter->GetNormal()) > 0;
+            positive = point.DistanceToPlane(iter->_aclPoints[0], iter->GetNormal()) > 0;
         }
     }
 
@@ -397,23 +383,15 @@ InspectNominalPoints::~InspectNominalPoints()
 
 float InspectNominalPoints::getDistance(const Base::Vector3f& point)
 {
-    //TODO: Make faster
-    std::set<unsigned long> indices;
-    unsigned long x,y,z;
+    // the search also looks into the neighbour grids, so the nearest point is found
+    // even if the grid of the given point is empty
+    std::vector<unsigned long> indices;
+    std::vector<double> distances;
     Base::Vector3d pointd(point.x,point.y,point.z);
-    _pGrid->Position(pointd, x, y, z);
-    _pGrid->GetElements(x,y,z,indices);
-
-    double fMinDist=DBL_MAX;
-    for (std::set<unsigned long>::iterator it = indices.begin(); it != indices.end(); ++it) {
-        Base::Vector3d pt = _rKernel.getPoint(*it);
-        double fDist = Base::Distance(pointd, pt);
-        if (fDist < fMinDist) {
-            fMinDist = fDist;
-        }
-    }
+    if (_pGrid->SearchNearest(pointd, 1, indices, distances) == 0)
+        return FLT_MAX;
 
-    return (float)fMinDist;
+    return (float)distances.front();
 }
 
 // ----------------------------------------------------------------
@@ -440,6 +418,12 @@ float InspectNominalShape::getDistance(const Base::Vector3f& point)
     return fMinDist;
 }
 
+InspectNominalGeometry* InspectNominalShape::createQuery() const
+{
+    // the distance algorithm keeps the vertex and the solutions of the last query
+    return new InspectNominalShape(_rShape, 0.0f);
+}
+
 // ----------------------------------------------------------------
 
 TYPESYSTEM_SOURCE(Inspection::PropertyDistanceList, App::PropertyLists);
@@ -587,21 +571,107 @@ unsigned int PropertyDistanceList::getMemSize (void) const
 
 // ----------------------------------------------------------------
 
-// helper class to use Qt's concurrent framework
-struct DistanceInspection
+namespace Inspection {
+/**
+ * Computes the distances of the actual points to the nominals in several threads.
+ * The points are split into chunks that are handed out to the threads on demand.
+ * Each thread uses its own query objects for nominals that cannot be shared and
+ * writes its results directly into the output array. Thus, the result doesn't
+ * depend on the order in which the chunks are processed.
+ */
+class DistanceInspection
 {
+public:
+    /// The nominals as seen from one thread
+    class Queries
+    {
+    public:
+        Queries(const std::vector<InspectNominalGeometry*>& n)
+        {
+            for (std::vector<InspectNominalGeometry*>::const_iterator it = n.begin(); it != n.end(); ++it) {
+                InspectNominalGeometry* query = (*it)->createQuery();
+                if (query)
+                    owned.push_back(query);
+                nominal.push_back(query ? query : *it);
+            }
+        }
+        ~Queries()
+        {
+            for (std::vector<InspectNominalGeometry*>::iterator it = owned.begin(); it != owned.end(); ++it)
+                delete *it;
+        }
+
+        std::vector<InspectNominalGeometry*> nominal;
+
+    private:
+        std::vector<InspectNominalGeometry*> owned;
+    };
+
+    DistanceInspection(float radius, InspectActualGeometry* a,
+                       const std::vector<InspectNominalGeometry*>& n,
+                       std::vector<float>& v)
+      : radius(radius), actual(a), nominal(n), values(v)
+      , nextChunk(0), doneChunks(0), canceled(0), failed(0)
+    {
+        numChunks = static_cast<int>((values.size() + ChunkSize - 1) / ChunkSize);
+    }
+
+    int countChunks() const
+    {
+        return numChunks;
+    }
+    int countDoneChunks() const
+    {
+        return (int)doneChunks;
+    }
+    void cancel()
+    {
+        canceled = 1;
+    }
+    bool hasFailed() const
+    {
+        return (int)failed != 0;
+    }
+
+    /// Processes the next chunk and returns false if there is nothing left to do.
+    bool processChunk(Queries& queries)
+    {
+        if ((int)canceled)
+            return false;
+        int chunk = nextChunk.fetchAndAddRelaxed(1);
+        if (chunk >= numChunks)
+            return false;
+
+        unsigned long begin = (unsigned long)chunk * ChunkSize;
+        unsigned long end = std::min<unsigned long>(begin + ChunkSize, values.size());
+        for (unsigned long index = begin; index < end; index++)
+            values[index] = distance(queries, index);
+        doneChunks.ref();
+        return true;
+    }
 
-    DistanceInspection(float radius, InspectActualGeometry*  a,
-                       std::vector<InspectNominalGeometry*> n)
-                    : radius(radius), actual(a), nominal(n)
+    /// Worker thread
+    void run()
     {
+        try {
+            Queries queries(nominal);
+            while (processChunk(queries)) {
+            }
+        }
+        catch (...) {
+            // exceptions must not leave the worker thread
+            failed = 1;
+            canceled = 1;
+        }
     }
-    float mapped(unsigned long index)
+
+private:
+    float distance(Queries& queries, unsigned long index) const
     {
         Base::Vector3f pnt = actual->getPoint(index);
 
         float fMinDist=FLT_MAX;
-        for (std::vector<InspectNominalGeometry*>::iterator it = nominal.begin(); it != nominal.end(); ++it) {
+        for (std::vector<InspectNominalGeometry*>::iterator it = queries.nominal.begin(); it != queries.nominal.end(); ++it) {
             float fDist = (*it)->getDistance(pnt);
             if (fabs(fDist) < fabs(fMinDist))
                 fMinDist = fDist;
@@ -615,10 +685,20 @@ struct DistanceInspection
         return fMinDist;
     }
 
+private:
+    static const unsigned long ChunkSize = 1024;
+
     float radius;
-    InspectActualGeometry*  actual;
-    std::vector<InspectNominalGeometry*> nominal;
+    InspectActualGeometry* actual;
+    const std::vector<InspectNominalGeometry*>& nominal;
+    std::vector<float>& values;
+    int numChunks;
+    QAtomicInt nextChunk;
+    QAtomicInt doneChunks;
+    QAtomicInt canceled;
+    QAtomicInt failed;
 };
+}
 
 PROPERTY_SOURCE(Inspection::Feature, App::DocumentObject)
 
@@ -693,52 +773,51 @@ App::DocumentObjectExecReturn* Feature::execute(void)
             inspectNominal.push_back(nominal);
     }
 
-#if 0 // test with some huge data sets
+    // OCC's memory manager must be thread-safe if shapes are involved
     Standard::SetReentrant(Standard_True);
-    std::vector<unsigned long> index(actual->countPoints());
-    std::generate(index.begin(), index.end(), Base::iotaGen<unsigned long>(0));
-    DistanceInspection check(this->SearchRadius.getValue(), actual, inspectNominal);
-    QFuture<float> future = QtConcurrent::mapped
-        (index, boost::bind(&DistanceInspection::mapped, &check, _1));
-    //future.waitForFinished(); // blocks the GUI
-    Base::FutureWatcherProgress progress("Inspecting...", actual->countPoints());
-    QFutureWatcher<float> watcher;
-    QObject::connect(&watcher, SIGNAL(progressValueChanged(int)),
-                     &progress, SLOT(progressValueChanged(int)));
-    watcher.setFuture(future);
-
-    // keep it responsive during computation
-    QEventLoop loop;
-    QObject::connect(&watcher, SIGNAL(finished()), &loop, SLOT(quit()));
-    loop.exec();
-
-    std::vector<float> vals;
-    vals.insert(vals.end(), future.begin(), future.end());
-#else
-    unsigned long count = actual->countPoints();
-    std::stringstream str;
-    str << "Inspecting " << this->Label.getValue() << "...";
-    Base::SequencerLauncher seq(str.str().c_str(), count);
 
+    unsigned long count = actual->countPoints();
     std::vector<float> vals(count);
-    for (unsigned long index = 0; index < count; index++) {
-        Base::Vector3f pnt = actual->getPoint(index);
+    DistanceInspection check(this->SearchRadius.getValue(), actual, inspectNominal, vals);
 
-        float fMinDist=FLT_MAX;
-        for (std::vector<InspectNominalGeometry*>::iterator it = inspectNominal.begin(); it != inspectNominal.end(); ++it) {
-            float fDist = (*it)->getDistance(pnt);
-            if (fabs(fDist) < fabs(fMinDist))
-                fMinDist = fDist;
+    // the calling thread takes part in the computation and reports the progress
+    int numThreads = std::max<int>(1, QThread::idealThreadCount());
+    numThreads = std::min<int>(numThreads, check.countChunks());
+    QList< QFuture<void> > workers;
+    for (int i = 1; i < numThreads; i++)
+        workers.append(QtConcurrent::run(boost::bind(&DistanceInspection::run, &check)));
+
+    std::stringstream str;
+    str << "Inspecting " << this->Label.getValue() << "...";
+    Base::SequencerLauncher seq(str.str().c_str(), check.countChunks());
+
+    try {
+        DistanceInspection::Queries queries(inspectNominal);
+        int reported = 0;
+        while (check.processChunk(queries)) {
+            for (int done = check.countDoneChunks(); reported < done; reported++)
+                seq.next(true);
         }
+    }
+    catch (...) {
+        check.cancel();
+        for (QList< QFuture<void> >::iterator it = workers.begin(); it != workers.end(); ++it)
+            it->waitForFinished();
+        delete actual;
+        for (std::vector<InspectNominalGeometry*>::iterator it = inspectNominal.begin(); it != inspectNominal.end(); ++it)
+            delete *it;
+        throw;
+    }
 
-        if (fMinDist > this->SearchRadius.getValue())
-            fMinDist = FLT_MAX;
-        else if (-fMinDist > this->SearchRadius.getValue())
-            fMinDist = -FLT_MAX;
-        vals[index] = fMinDist;
-        seq.next();
+    for (QList< QFuture<void> >::iterator it = workers.begin(); it != workers.end(); ++it)
+        it->waitForFinished();
+
+    if (check.hasFailed()) {
+        delete actual;
+        for (std::vector<InspectNominalGeometry*>::iterator it = inspectNominal.begin(); it != inspectNominal.end(); ++it)
+            delete *it;
+        throw Base::Exception("Failed to compute the distances to the nominal geometry");
     }
-#endif
 
     Distances.setValues(vals);
 
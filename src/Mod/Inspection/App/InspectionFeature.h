@@ -37,6 +37,7 @@ class BRepExtrema_DistShapeShape;
 namespace MeshCore {
 class MeshKernel;
 class MeshGrid;
+class MeshFacetBVH;
 }
 
 namespace Mesh   { class MeshObject; }
@@ -46,7 +47,9 @@ namespace Part   { class TopoShape;  }
 namespace Inspection
 {
 
-/** Delivers the number of points to be checked and returns the appropriate point to an index. */
+/** Delivers the number of points to be checked and returns the appropriate point to an index.
+ * getPoint() may be called from several threads at the same time.
+ */
 class InspectionExport InspectActualGeometry
 {
 public:
@@ -100,6 +103,11 @@ public:
     InspectNominalGeometry() {}
     virtual ~InspectNominalGeometry() {}
     virtual float getDistance(const Base::Vector3f&) = 0;
+    /** Creates an object with its own query state to compute distances in a further thread.
+     * The default implementation returns 0 which means that getDistance() can be called
+     * from several threads at the same time and this object can be shared.
+     */
+    virtual InspectNominalGeometry* createQuery() const { return 0; }
 };
 
 class InspectionExport InspectNominalMesh : public InspectNominalGeometry
@@ -111,7 +119,7 @@ public:
 
 private:
     MeshCore::MeshFacetIterator _iter;
-    MeshCore::MeshGrid* _pGrid;
+    MeshCore::MeshFacetBVH* _pBVH;
     Base::BoundBox3f _box;
 };
 
@@ -147,6 +155,7 @@ public:
     InspectNominalShape(const TopoDS_Shape&, float offset);
     ~InspectNominalShape();
     virtual float getDistance(const Base::Vector3f&);
+    virtual InspectNominalGeometry* createQuery() const;
 
 private:
     BRepExtrema_DistShapeShape* distss;
@@ -193,6 +202,7 @@ public:
     virtual void Restore(Base::XMLReader &reader);
     
     virtual void SaveDocFile (Base::Writer &writer) const;
+    virtual bool isSaveDocFileThreadSafe (void) const { return true; }
     virtual void RestoreDocFile(Base::Reader &reader);
     
     virtual Property *Copy(void) const;
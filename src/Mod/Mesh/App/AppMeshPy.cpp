@@ -32,6 +32,7 @@
 #include <App/DocumentObjectPy.h>
 #include <App/Property.h>
 #include <Base/PlacementPy.h>
+#include <Base/MatrixPy.h>
 
 #include <CXX/Objects.hxx>
 #include <Base/VectorPy.h>
@@ -39,7 +40,9 @@
 #include "Core/MeshKernel.h"
 #include "Core/MeshIO.h"
 #include "Core/Evaluation.h"
+#include "Core/FacetBatch.h"
 #include "Core/Iterator.h"
+#include "Core/MeshStream.h"
 
 #include "MeshPy.h"
 #include "Mesh.h"
@@ -431,6 +434,70 @@ calculateEigenTransform(PyObject *self, PyObject *args)
 }
 
 
+static PyObject * 
+processOutOfCore(PyObject *self, PyObject *args)
+{
+    const char* input;
+    const char* output;
+    int budget = 512;
+    const char* smoothing = "";
+    int iterations = 0;
+    PyObject* matrix = 0;
+    if (!PyArg_ParseTuple(args, "sz|isiO!",&input,&output,&budget,&smoothing,&iterations,
+                                          &(Base::MatrixPy::Type),&matrix))
+        return NULL;
+
+    MeshCore::MeshStreamProcessor::Smoothing type;
+    if (strcmp(smoothing, "") == 0)
+        type = MeshCore::MeshStreamProcessor::None;
+    else if (strcmp(smoothing, "Laplace") == 0)
+        type = MeshCore::MeshStreamProcessor::Laplace;
+    else if (strcmp(smoothing, "Taubin") == 0)
+        type = MeshCore::MeshStreamProcessor::Taubin;
+    else {
+        PyErr_SetString(PyExc_Exception, "Smoothing must be '', 'Laplace' or 'Taubin'");
+        return NULL;
+    }
+
+    PY_TRY {
+        MeshCore::MeshStreamProcessor proc;
+        proc.SetMemoryBudget((unsigned long)std::max<int>(budget, 1) * 0x100000);
+        proc.SetSmoothing(type, (unsigned int)std::max<int>(iterations, 0));
+        if (matrix)
+            proc.SetTransform(static_cast<Base::MatrixPy*>(matrix)->value());
+        proc.SetEvaluation(true);
+        proc.Process(input, output);
+
+        Py::Dict dict;
+        dict.setItem("Facets", Py::Long(proc.CountFacets()));
+        dict.setItem("Tiles", Py::Long(proc.CountTiles()));
+        dict.setItem("DuplicatedPoints", Py::Long(proc.CountDuplicatedPoints()));
+        dict.setItem("DegeneratedFacets", Py::Long(proc.CountDegeneratedFacets()));
+        return Py::new_reference_to(dict);
+    } PY_CATCH;
+}
+
+static PyObject *
+setAccelerated(PyObject *self, PyObject *args)
+{
+    PyObject* on;
+    if (!PyArg_ParseTuple(args, "O!",&PyBool_Type,&on))
+        return NULL;
+
+    MeshCore::MeshFacetBatch::SetAccelerated(on == Py_True);
+    Py_Return;
+}
+
+static PyObject *
+isAccelerated(PyObject *self, PyObject *args)
+{
+    if (!PyArg_ParseTuple(args, ""))
+        return NULL;
+
+    bool ok = MeshCore::MeshFacetBatch::IsAccelerated();
+    return Py_BuildValue("O", (ok ? Py_True : Py_False));
+}
+
 PyDoc_STRVAR(open_doc,
 "open(string) -- Create a new document and a Mesh::Import feature to load the file into the document.");
 
@@ -448,6 +515,25 @@ PyDoc_STRVAR(calculateEigenTransform_doc,
 "The local coordinate system is right-handed.\n"
 );
 
+PyDoc_STRVAR(processOutOfCore_doc,
+"processOutOfCore(input,output,[budget=512,smoothing='',iterations=0,matrix]) -- Process a binary STL file tile by tile.\n"
+"The file is split into spatial tiles so that a tile needs at most about 'budget' MB of memory.\n"
+"Each tile is smoothed ('Laplace' or 'Taubin'), transformed and written as binary STL to\n"
+"'output' which may be None for evaluation only. Returns a dict with the number of facets,\n"
+"tiles, duplicated points and degenerated facets.\n"
+);
+
+PyDoc_STRVAR(setAccelerated_doc,
+"setAccelerated(bool) -- Switch the SSE2 filters of the intersection and distance tests on or off.\n"
+"The results are the same either way, switching them off allows to compare them with the\n"
+"plain code. It must not be called while another thread runs one of these tests.\n"
+);
+
+PyDoc_STRVAR(isAccelerated_doc,
+"isAccelerated() -- Return True if the intersection and distance tests use SSE2 filters.\n"
+"This is False if the CPU lacks SSE2 or the filters have been switched off.\n"
+);
+
 /* List of functions defined in the module */
 
 struct PyMethodDef Mesh_Import_methods[] = { 
@@ -464,5 +550,8 @@ struct PyMethodDef Mesh_Import_methods[] = {
     {"createCone",createCone, Py_NEWARGS,   "Create a tessellated cone"},
     {"createTorus",createTorus, Py_NEWARGS,   "Create a tessellated torus"},
     {"calculateEigenTransform",calculateEigenTransform, METH_VARARGS,   calculateEigenTransform_doc},
+    {"processOutOfCore",processOutOfCore, METH_VARARGS,   processOutOfCore_doc},
+    {"setAccelerated",setAccelerated, METH_VARARGS,   setAccelerated_doc},
+    {"isAccelerated",isAccelerated, METH_VARARGS,   isAccelerated_doc},
     {NULL, NULL}  /* sentinel */
 };
@@ -0,0 +1,193 @@
+/***************************************************************************
+ *   Copyright (c) 2026 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <algorithm>
+#endif
+
+#include "Adjacency.h"
+#include "Algorithm.h"
+#include "MeshKernel.h"
+
+using namespace MeshCore;
+
+MeshAdjacency::MeshAdjacency(const MeshKernel& mesh)
+  : _mesh(mesh), _countPoints(0), _countFacets(0)
+{
+    Rebuild();
+}
+
+MeshAdjacency::~MeshAdjacency()
+{
+}
+
+void MeshAdjacency::Rebuild()
+{
+    const MeshFacetArray& rFacets = _mesh.GetFacets();
+    _countPoints = _mesh.CountPoints();
+    _countFacets = _mesh.CountFacets();
+
+    // count the facets of each point, a facet referencing a point twice is counted once
+    _facetOffsets.assign(_countPoints + 1, 0);
+    for (MeshFacetArray::_TConstIterator it = rFacets.begin(); it != rFacets.end(); ++it) {
+        const unsigned long* p = it->_aulPoints;
+        _facetOffsets[p[0] + 1]++;
+        if (p[1] != p[0])
+            _facetOffsets[p[1] + 1]++;
+        if (p[2] != p[0] && p[2] != p[1])
+            _facetOffsets[p[2] + 1]++;
+    }
+
+    for (unsigned long i = 0; i < _countPoints; i++)
+        _facetOffsets[i + 1] += _facetOffsets[i];
+
+    // the facets are visited in ascending order so that each row is sorted
+    _facets.resize(_facetOffsets[_countPoints]);
+    std::vector<unsigned long> next(_facetOffsets.begin(), _facetOffsets.end() - 1);
+    MeshFacetArray::_TConstIterator pFBegin = rFacets.begin();
+    for (MeshFacetArray::_TConstIterator it = rFacets.begin(); it != rFacets.end(); ++it) {
+        const unsigned long* p = it->_aulPoints;
+        unsigned long index = it - pFBegin;
+        _facets[next[p[0]]++] = index;
+        if (p[1] != p[0])
+            _facets[next[p[1]]++] = index;
+        if (p[2] != p[0] && p[2] != p[1])
+            _facets[next[p[2]]++] = index;
+    }
+
+    // the neighbour points are the other points of the facets of a point
+    _pointOffsets.resize(_countPoints + 1);
+    _points.clear();
+    _points.reserve(2 * _facets.size());
+    for (unsigned long pos = 0; pos < _countPoints; pos++) {
+        unsigned long start = _points.size();
+        _pointOffsets[pos] = start;
+        for (unsigned long i = _facetOffsets[pos]; i < _facetOffsets[pos + 1]; i++) {
+            const MeshFacet& face = rFacets[_facets[i]];
+            for (int j = 0; j < 3; j++) {
+                if (face._aulPoints[j] != pos)
+                    _points.push_back(face._aulPoints[j]);
+            }
+        }
+
+        std::sort(_points.begin() + start, _points.end());
+        _points.erase(std::unique(_points.begin() + start, _points.end()), _points.end());
+    }
+    _pointOffsets[_countPoints] = _points.size();
+}
+
+bool MeshAdjacency::IsValid() const
+{
+    return _countPoints == _mesh.CountPoints() && _countFacets == _mesh.CountFacets();
+}
+
+Base::Vector3f MeshAdjacency::GetNormal(unsigned long pos) const
+{
+    Range n = PointFacets(pos);
+    Base::Vector3f normal;
+    MeshGeomFacet f;
+    for (Range::const_iterator it = n.begin(); it != n.end(); ++it) {
+        f = _mesh.GetFacet(*it);
+        normal += f.Area() * f.GetNormal();
+    }
+
+    normal.Normalize();
+    return normal;
+}
+
+float MeshAdjacency::GetAverageEdgeLength(unsigned long index) const
+{
+    const MeshPointArray& rPoints = _mesh.GetPoints();
+    float len=0.0f;
+    Range n = PointPoints(index);
+    const Base::Vector3f& p = rPoints[index];
+    for (Range::const_iterator it = n.begin(); it != n.end(); ++it) {
+        len += Base::Distance(p, rPoints[*it]);
+    }
+    return (len/n.size());
+}
+
+std::set<unsigned long> MeshAdjacency::NeighbourPoints(const std::vector<unsigned long>& pt, int level) const
+{
+    std::set<unsigned long> cp,nb,lp;
+    cp.insert(pt.begin(), pt.end());
+    lp.insert(pt.begin(), pt.end());
+    MeshFacetArray::_TConstIterator f_it = _mesh.GetFacets().begin();
+    for (int i=0; i < level; i++) {
+        std::set<unsigned long> cur;
+        for (std::set<unsigned long>::iterator it = lp.begin(); it != lp.end(); ++it) {
+            Range ft = PointFacets(*it);
+            for (Range::const_iterator jt = ft.begin(); jt != ft.end(); ++jt) {
+                for (int j = 0; j < 3; j++) {
+                    unsigned long index = f_it[*jt]._aulPoints[j];
+                    if (cp.find(index) == cp.end() && nb.find(index) == nb.end()) {
+                        nb.insert(index);
+                        cur.insert(index);
+                    }
+                }
+            }
+        }
+
+        lp = cur;
+        if (lp.empty())
+            break;
+    }
+    return nb;
+}
+
+void MeshAdjacency::Neighbours(unsigned long ulFacetInd, float fMaxDist, MeshCollector& collect) const
+{
+    const MeshFacetArray& rFacets = _mesh.GetFacets();
+    Base::Vector3f clCenter = _mesh.GetFacet(ulFacetInd).GetGravityPoint();
+    float fMaxDist2 = fMaxDist * fMaxDist;
+
+    // depth-first search with an explicit stack instead of recursion, the facets are
+    // pushed in reverse order so that they are visited in the same order as with
+    // MeshRefPointToFacets::Neighbours()
+    std::set<unsigned long> visited;
+    std::vector<unsigned long> stack;
+    stack.push_back(ulFacetInd);
+    while (!stack.empty()) {
+        unsigned long index = stack.back();
+        stack.pop_back();
+        if (visited.find(index) != visited.end())
+            continue;
+
+        const MeshFacet& face = rFacets[index];
+        if (Base::DistanceP2(clCenter, _mesh.GetFacet(face).GetGravityPoint()) > fMaxDist2)
+            continue;
+
+        visited.insert(index);
+        collect.Append(_mesh, index);
+        for (int i = 2; i >= 0; i--) {
+            Range f = PointFacets(face._aulPoints[i]);
+            for (Range::const_iterator j = f.end(); j != f.begin(); ) {
+                --j;
+                if (visited.find(*j) == visited.end())
+                    stack.push_back(*j);
+            }
+        }
+    }
+}
@@ -0,0 +1,133 @@
+/***************************************************************************
+ *   Copyright (c) 2026 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef MESHCORE_ADJACENCY_H
+#define MESHCORE_ADJACENCY_H
+
+#include <set>
+#include <vector>
+#include <Base/Vector3D.h>
+
+namespace MeshCore {
+
+class MeshKernel;
+class MeshCollector;
+
+/**
+ * The MeshAdjacency class holds the facets and the neighbour points of all points of a mesh.
+ * It provides the same information as MeshRefPointToFacets and MeshRefPointToPoints but stores
+ * it in compressed rows, i.e. the indices of all points are kept in one array and a second
+ * array holds the offset of each point. The indices of each point are sorted so that they are
+ * iterated in the same order as the sets of the other classes.
+ *
+ * Only the topology is stored. Thus, moving points doesn't invalidate the structure but adding
+ * or removing points or facets does. Mesh::MeshObject keeps an instance of this class that is
+ * shared by the algorithms working on the same mesh.
+ */
+class MeshExport MeshAdjacency
+{
+public:
+    /** The indices of the facets or neighbour points of one point. */
+    class Range
+    {
+    public:
+        typedef const unsigned long* const_iterator;
+
+        Range(const_iterator b, const_iterator e) : _begin(b), _end(e)
+        { }
+        const_iterator begin() const
+        { return _begin; }
+        const_iterator end() const
+        { return _end; }
+        unsigned long size() const
+        { return static_cast<unsigned long>(_end - _begin); }
+        bool empty() const
+        { return _begin == _end; }
+        unsigned long operator[] (unsigned long pos) const
+        { return _begin[pos]; }
+
+    private:
+        const_iterator _begin, _end;
+    };
+
+    /// Construction
+    MeshAdjacency(const MeshKernel& mesh);
+    /// Destruction
+    ~MeshAdjacency();
+
+    /// Rebuilds up the data structure
+    void Rebuild();
+    /** Returns false if the number of points or facets of the mesh has changed since the
+     * last rebuild. This cannot detect all topological changes, it's only a sanity check.
+     */
+    bool IsValid() const;
+    /// Returns the underlying mesh kernel.
+    const MeshKernel& GetKernel() const
+    { return _mesh; }
+
+    /// Returns the sorted indices of the facets referencing the point with index \a pos.
+    Range PointFacets(unsigned long pos) const
+    {
+        const unsigned long* data = _facets.empty() ? 0 : &_facets[0];
+        return Range(data + _facetOffsets[pos], data + _facetOffsets[pos+1]);
+    }
+    /// Returns the sorted indices of the points sharing an edge with the point with index \a pos.
+    Range PointPoints(unsigned long pos) const
+    {
+        const unsigned long* data = _points.empty() ? 0 : &_points[0];
+        return Range(data + _pointOffsets[pos], data + _pointOffsets[pos+1]);
+    }
+    /// Returns true if the point with index \a pos lies at the boundary of the mesh.
+    bool IsBoundaryPoint(unsigned long pos) const
+    { return PointFacets(pos).size() != PointPoints(pos).size(); }
+
+    /// Returns the area weighted average of the normals of the facets of the point \a pos.
+    Base::Vector3f GetNormal(unsigned long pos) const;
+    /// Returns the average length of the edges of the point \a index.
+    float GetAverageEdgeLength(unsigned long index) const;
+    /** Returns the points that can be reached from the points \a pt over at most \a level
+     * facets. The points \a pt themselves are not part of the result.
+     */
+    std::set<unsigned long> NeighbourPoints(const std::vector<unsigned long>& pt, int level) const;
+    /** Passes all facets to \a collect that are connected to the facet \a ulFacetInd and
+     * whose center of gravity has a distance of at most \a fMaxDist to the center of
+     * gravity of this facet.
+     */
+    void Neighbours(unsigned long ulFacetInd, float fMaxDist, MeshCollector& collect) const;
+
+private:
+    MeshAdjacency(const MeshAdjacency&);
+    void operator = (const MeshAdjacency&);
+
+    const MeshKernel& _mesh;
+    unsigned long _countPoints;
+    unsigned long _countFacets;
+    std::vector<unsigned long> _facetOffsets;
+    std::vector<unsigned long> _facets;
+    std::vector<unsigned long> _pointOffsets;
+    std::vector<unsigned long> _points;
+};
+
+} // namespace MeshCore
+
+#endif // MESHCORE_ADJACENCY_H
@@ -28,10 +28,13 @@
 #endif
 
 #include "Algorithm.h"
+#include "Adjacency.h"
 #include "Approximation.h"
 #include "Elements.h"
+#include "FacetBatch.h"
 #include "Iterator.h"
 #include "Grid.h"
+#include "BVH.h"
 #include "Triangulation.h"
 
 #include <Base/Console.h>
@@ -122,6 +125,12 @@ bool MeshAlgorithm::NearestFacetOnRay (const Base::Vector3f &rclPt, const Base::
     return false;
 }
 
+bool MeshAlgorithm::NearestFacetOnRay (const Base::Vector3f &rclPt, const Base::Vector3f &rclDir, const MeshFacetBVH &rclBVH,
+                                       Base::Vector3f &rclRes, unsigned long &rulFacet) const
+{
+    return rclBVH.NearestFacetOnRay(rclPt, rclDir, rclRes, rulFacet);
+}
+
 bool MeshAlgorithm::NearestFacetOnRay (const Base::Vector3f &rclPt, const Base::Vector3f &rclDir, float fMaxSearchArea,
                                        const MeshFacetGrid &rclGrid, Base::Vector3f &rclRes, unsigned long &rulFacet) const
 {
@@ -150,18 +159,25 @@ bool MeshAlgorithm::NearestFacetOnRay (const Base::Vector3f &rclPt, const Base::
     bool bSol = false;
     unsigned long ulInd = 0;
 
-    for (std::vector<unsigned long>::const_iterator pI = raulFacets.begin(); pI != raulFacets.end(); pI++) {
-        MeshGeomFacet rclSFacet = _rclMesh.GetFacet(*pI);
+    // only the facets the line may pierce need the exact test
+    MeshFacetBatch batch;
+    batch.Assign(_rclMesh, raulFacets);
+    std::vector<unsigned long> positions;
+    batch.FilterLineIntersections(rclPt, rclDir, positions);
+
+    for (std::vector<unsigned long>::iterator pP = positions.begin(); pP != positions.end(); ++pP) {
+        unsigned long ulFacet = raulFacets[*pP];
+        MeshGeomFacet rclSFacet = _rclMesh.GetFacet(ulFacet);
         if (rclSFacet.Foraminate(rclPt, rclDir, clRes) == true) {
             if (bSol == false) {// erste Loesung
                 bSol   = true;
                 clProj = clRes;
-                ulInd  = *pI;
+                ulInd  = ulFacet;
             }
             else {  // liegt Punkt naeher
                 if ((clRes - rclPt).Length() < (clProj - rclPt).Length()) {
                     clProj = clRes;
-                    ulInd  = *pI;
+                    ulInd  = ulFacet;
                 }
             }
         }
@@ -182,17 +198,24 @@ bool MeshAlgorithm::RayNearestField (const Base::Vector3f &rclPt, const Base::Ve
     bool bSol = false;
     unsigned long ulInd = 0;
 
-    for (std::vector<unsigned long>::const_iterator pF = raulFacets.begin(); pF != raulFacets.end(); pF++) {
-        if (_rclMesh.GetFacet(*pF).Foraminate(rclPt, rclDir, clRes/*, fMaxAngle*/) == true) {
+    // only the facets the line may pierce need the exact test
+    MeshFacetBatch batch;
+    batch.Assign(_rclMesh, raulFacets);
+    std::vector<unsigned long> positions;
+    batch.FilterLineIntersections(rclPt, rclDir, positions);
+
+    for (std::vector<unsigned long>::iterator pP = positions.begin(); pP != positions.end(); ++pP) {
+        unsigned long ulFacet = raulFacets[*pP];
+        if (_rclMesh.GetFacet(ulFacet).Foraminate(rclPt, rclDir, clRes/*, fMaxAngle*/) == true) {
             if (bSol == false) { // erste Loesung
                 bSol   = true;
                 clProj = clRes;
-                ulInd  = *pF;
+                ulInd  = ulFacet;
             }
             else {  // liegt Punkt naeher
                 if ((clRes - rclPt).Length() < (clProj - rclPt).Length()) {
                     clProj = clRes;
-                    ulInd  = *pF;
+                    ulInd  = ulFacet;
                 }
             }
         }
@@ -620,7 +643,7 @@ void MeshAlgorithm::SplitBoundaryLoops(const std::vector<unsigned long>& rBound,
 bool MeshAlgorithm::FillupHole(const std::vector<unsigned long>& boundary, 
                                AbstractPolygonTriangulator& cTria, 
                                MeshFacetArray& rFaces, MeshPointArray& rPoints,
-                               int level, const MeshRefPointToFacets* pP2FStructure) const
+                               int level, const MeshAdjacency* pAdjacency) const
 {
     if (boundary.front() == boundary.back()) {
         // first and last vertex are identical
@@ -636,9 +659,9 @@ bool MeshAlgorithm::FillupHole(const std::vector<unsigned long>& boundary,
     MeshFacet rFace;
     unsigned long refPoint0 = *(boundary.begin());
     unsigned long refPoint1 = *(boundary.begin()+1);
-    if (pP2FStructure) {
-        const std::set<unsigned long>& ring1 = (*pP2FStructure)[refPoint0];
-        const std::set<unsigned long>& ring2 = (*pP2FStructure)[refPoint1];
+    if (pAdjacency) {
+        MeshAdjacency::Range ring1 = pAdjacency->PointFacets(refPoint0);
+        MeshAdjacency::Range ring2 = pAdjacency->PointFacets(refPoint1);
         std::vector<unsigned long> f_int;
         std::set_intersection(ring1.begin(), ring1.end(), ring2.begin(), ring2.end(),
             std::back_insert_iterator<std::vector<unsigned long> >(f_int));
@@ -688,8 +711,8 @@ bool MeshAlgorithm::FillupHole(const std::vector<unsigned long>& boundary,
     cTria.SetIndices(bounds);
 
     std::vector<Base::Vector3f> surf_pts = cTria.GetPolygon();
-    if (pP2FStructure && level > 0) {
-        std::set<unsigned long> index = pP2FStructure->NeighbourPoints(boundary, level);
+    if (pAdjacency && level > 0) {
+        std::set<unsigned long> index = pAdjacency->NeighbourPoints(boundary, level);
         for (std::set<unsigned long>::iterator it = index.begin(); it != index.end(); ++it) {
             Base::Vector3f pt(_rclMesh._aclPointArray[*it]);
             surf_pts.push_back(pt);
@@ -1401,6 +1424,12 @@ bool MeshAlgorithm::NearestPointFromPoint (const Base::Vector3f &rclPt, const Me
   return true;
 }
 
+bool MeshAlgorithm::NearestPointFromPoint (const Base::Vector3f &rclPt, const MeshFacetBVH& rclBVH,
+                                           unsigned long &rclResFacetIndex, Base::Vector3f &rclResPoint) const
+{
+  return rclBVH.NearestFacetToPoint(rclPt, rclResPoint, rclResFacetIndex);
+}
+
 bool MeshAlgorithm::CutWithPlane (const Base::Vector3f &clBase, const Base::Vector3f &clNormal, const MeshFacetGrid &rclGrid,
                                   std::list<std::vector<Base::Vector3f> > &rclResult, float fMinEps, bool bConnectPolygons) const
 {
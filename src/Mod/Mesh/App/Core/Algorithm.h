@@ -45,8 +45,10 @@ class MeshGeomFacet;
 class MeshGeomEdge;
 class MeshKernel;
 class MeshFacetGrid;
+class MeshFacetBVH;
 class MeshFacetArray;
 class MeshRefPointToFacets;
+class MeshAdjacency;
 class AbstractPolygonTriangulator;
 
 /**
@@ -81,6 +83,17 @@ public:
    */
   bool NearestFacetOnRay (const Base::Vector3f &rclPt, const Base::Vector3f &rclDir, const MeshFacetGrid &rclGrid,
                           Base::Vector3f &rclRes, unsigned long &rulFacet) const;
+  /**
+   * Searches for the nearest facet to the ray defined by
+   * (\a rclPt, \a rclDir).
+   * The point \a rclRes holds the intersection point with the ray and the
+   * nearest facet with index \a rulFacet.
+   * \note This method is optimized by using a bounding volume hierarchy which,
+   * unlike the grid, also copes with meshes of a very uneven density. In contrast
+   * to the other methods only facets in direction of the ray are found.
+   */
+  bool NearestFacetOnRay (const Base::Vector3f &rclPt, const Base::Vector3f &rclDir, const MeshFacetBVH &rclBVH,
+                          Base::Vector3f &rclRes, unsigned long &rulFacet) const;
   /**
    * Searches for the nearest facet to the ray defined by
    * (\a rclPt, \a rclDir).
@@ -155,8 +168,9 @@ public:
   /**
    * Fills up the single boundary if it is a hole with high quality triangles and a maximum area of \a fMaxArea.
    * The triangulation information is stored in \a rFaces and \a rPoints.
-   * To speed up the calculations the optional parameter \a pStructure can be specified that holds a facet-to-points
-   * structure of the underlying mesh.
+   * To speed up the calculations the optional parameter \a pAdjacency can be specified that holds the adjacency
+   * structure of the underlying mesh. It is also needed to take the points of \a level rings around the boundary
+   * into account.
    * If the boundary is not a hole or the algorithm failed false is returned, otherwise true.
    * @note \a boundary contains the point indices of the mesh data structure. The first and last index must therefore be equal.
    * @note \a rPoints contains the geometric points of the triangulation. The number of points can be the same as or exceed
@@ -167,7 +181,7 @@ public:
   bool FillupHole(const std::vector<unsigned long>& boundary,
                   AbstractPolygonTriangulator& cTria,
                   MeshFacetArray& rFaces, MeshPointArray& rPoints,
-                  int level, const MeshRefPointToFacets* pP2FStructure=0) const;
+                  int level, const MeshAdjacency* pAdjacency=0) const;
   /** Sets to all facets in \a raulInds the properties in raulProps. 
    * \note Both arrays must have the same size.
    */
@@ -276,6 +290,8 @@ public:
                               unsigned long &rclResFacetIndex, Base::Vector3f &rclResPoint) const;
   bool NearestPointFromPoint (const Base::Vector3f &rclPt, const MeshFacetGrid& rclGrid, float fMaxSearchArea,
                               unsigned long &rclResFacetIndex, Base::Vector3f &rclResPoint) const;
+  bool NearestPointFromPoint (const Base::Vector3f &rclPt, const MeshFacetBVH& rclBVH,
+                              unsigned long &rclResFacetIndex, Base::Vector3f &rclResPoint) const;
   /** Cuts the mesh with a plane. The result is a list of polylines. */
   bool CutWithPlane (const Base::Vector3f &clBase, const Base::Vector3f &clNormal, const MeshFacetGrid &rclGrid,
                      std::list<std::vector<Base::Vector3f> > &rclResult, float fMinEps = 1.0e-2f, bool bConnectPolygons = false) const;
@@ -0,0 +1,582 @@
+/***************************************************************************
+ *   Copyright (c) 2026 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <algorithm>
+# include <climits>
+#endif
+
+#include "BVH.h"
+#include "Elements.h"
+#include "MeshKernel.h"
+
+using namespace MeshCore;
+
+namespace {
+
+const unsigned long MaxLeafSize = 4;   // preferred number of facets per leaf
+const unsigned long MaxLeafSplit = 16; // leaves up to this size are kept if splitting doesn't pay off
+const int NumBins = 12;                // number of bins to evaluate the surface area heuristic
+const int MaxSAHDepth = 64;            // below this depth nodes are split at the median
+const int StackSize = 128;
+
+inline float Coord(const Base::Vector3f& v, int axis)
+{
+    return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+}
+
+inline float HalfArea(const Base::BoundBox3f& box)
+{
+    if (!box.IsValid())
+        return 0.0f;
+    float dx = box.LengthX(), dy = box.LengthY(), dz = box.LengthZ();
+    return dx * dy + dy * dz + dz * dx;
+}
+
+struct CenterBin
+{
+    CenterBin(const std::vector<Base::Vector3f>& c, int a, float m, float s)
+      : centers(c), axis(a), minimum(m), scale(s)
+    {
+    }
+    int operator()(unsigned long facet) const
+    {
+        int bin = int((Coord(centers[facet], axis) - minimum) * scale);
+        return std::max<int>(0, std::min<int>(NumBins - 1, bin));
+    }
+    const std::vector<Base::Vector3f>& centers;
+    int axis;
+    float minimum, scale;
+};
+
+struct LeftOfBin
+{
+    LeftOfBin(const CenterBin& b, int s) : bin(b), split(s)
+    {
+    }
+    bool operator()(unsigned long facet) const
+    {
+        return bin(facet) < split;
+    }
+    CenterBin bin;
+    int split;
+};
+
+struct CenterLess
+{
+    CenterLess(const std::vector<Base::Vector3f>& c, int a) : centers(c), axis(a)
+    {
+    }
+    bool operator()(unsigned long f1, unsigned long f2) const
+    {
+        return Coord(centers[f1], axis) < Coord(centers[f2], axis);
+    }
+    const std::vector<Base::Vector3f>& centers;
+    int axis;
+};
+
+}
+
+// ----------------------------------------------------------------------------
+
+/**
+ * A packet of rays that is traced through the hierarchy at once. The data is
+ * stored lane by lane so that the loops over the rays can be vectorized.
+ */
+struct MeshFacetBVH::RayPacket
+{
+    enum { Size = 4 };
+
+    float fOrg[3][Size];
+    float fDir[3][Size];
+    float fInv[3][Size];
+    float fMaxDist[Size];
+    unsigned long ulFacet[Size];
+    bool bActive[Size];
+
+    RayPacket()
+    {
+        for (int k = 0; k < Size; k++)
+            SetInactive(k);
+    }
+
+    void SetInactive(int k)
+    {
+        for (int i = 0; i < 3; i++) {
+            fOrg[i][k] = 0.0f;
+            fDir[i][k] = 0.0f;
+            fInv[i][k] = 0.0f;
+        }
+        fMaxDist[k] = -1.0f;
+        ulFacet[k] = ULONG_MAX;
+        bActive[k] = false;
+    }
+
+    void SetRay(int k, const Base::Vector3f& rclPt, const Base::Vector3f& rclDir, float fMax)
+    {
+        Base::Vector3f dir(rclDir);
+        if (dir.Sqr() == 0.0f) {
+            SetInactive(k);
+            return;
+        }
+
+        dir.Normalize();
+        for (int i = 0; i < 3; i++) {
+            fOrg[i][k] = rclPt[i];
+            fDir[i][k] = dir[i];
+            // a zero component gives a huge inverse that keeps the slab test valid
+            fInv[i][k] = 1.0f / (dir[i] != 0.0f ? dir[i] : 1.0f / FLOAT_MAX);
+        }
+        fMaxDist[k] = fMax;
+        ulFacet[k] = ULONG_MAX;
+        bActive[k] = true;
+    }
+
+    float MaxDist() const
+    {
+        float fMax = -1.0f;
+        for (int k = 0; k < Size; k++)
+            fMax = std::max<float>(fMax, fMaxDist[k]);
+        return fMax;
+    }
+
+    bool HitBox(const Node& node, float& fNear) const
+    {
+        bool hit = false;
+        fNear = FLOAT_MAX;
+        for (int k = 0; k < Size; k++) {
+            if (!bActive[k])
+                continue;
+            float t0 = 0.0f, t1 = fMaxDist[k];
+            for (int i = 0; i < 3; i++) {
+                float ta = (node.fMin[i] - fOrg[i][k]) * fInv[i][k];
+                float tb = (node.fMax[i] - fOrg[i][k]) * fInv[i][k];
+                t0 = std::max<float>(t0, std::min<float>(ta, tb));
+                t1 = std::min<float>(t1, std::max<float>(ta, tb));
+            }
+            if (t0 <= t1) {
+                hit = true;
+                fNear = std::min<float>(fNear, t0);
+            }
+        }
+        return hit;
+    }
+
+    void HitFacet(const Base::Vector3f* pclCorners, unsigned long ulIndex)
+    {
+        // Moeller/Trumbore test of the facet against all rays of the packet
+        const Base::Vector3f& p0 = pclCorners[0];
+        float e1x = pclCorners[1].x - p0.x, e1y = pclCorners[1].y - p0.y, e1z = pclCorners[1].z - p0.z;
+        float e2x = pclCorners[2].x - p0.x, e2y = pclCorners[2].y - p0.y, e2z = pclCorners[2].z - p0.z;
+
+        for (int k = 0; k < Size; k++) {
+            float pvx = fDir[1][k] * e2z - fDir[2][k] * e2y;
+            float pvy = fDir[2][k] * e2x - fDir[0][k] * e2z;
+            float pvz = fDir[0][k] * e2y - fDir[1][k] * e2x;
+            float det = e1x * pvx + e1y * pvy + e1z * pvz;
+            float inv = 1.0f / (det != 0.0f ? det : 1.0f);
+
+            float tvx = fOrg[0][k] - p0.x, tvy = fOrg[1][k] - p0.y, tvz = fOrg[2][k] - p0.z;
+            float u = (tvx * pvx + tvy * pvy + tvz * pvz) * inv;
+
+            float qvx = tvy * e1z - tvz * e1y;
+            float qvy = tvz * e1x - tvx * e1z;
+            float qvz = tvx * e1y - tvy * e1x;
+            float v = (fDir[0][k] * qvx + fDir[1][k] * qvy + fDir[2][k] * qvz) * inv;
+            float t = (e2x * qvx + e2y * qvy + e2z * qvz) * inv;
+
+            bool hit = (det != 0.0f) & (u >= 0.0f) & (v >= 0.0f) & (u + v <= 1.0f) &
+                       (t >= 0.0f) & (t < fMaxDist[k]);
+            fMaxDist[k] = hit ? t : fMaxDist[k];
+            ulFacet[k] = hit ? ulIndex : ulFacet[k];
+        }
+    }
+
+    Base::Vector3f HitPoint(int k) const
+    {
+        return Base::Vector3f(fOrg[0][k] + fMaxDist[k] * fDir[0][k],
+                              fOrg[1][k] + fMaxDist[k] * fDir[1][k],
+                              fOrg[2][k] + fMaxDist[k] * fDir[2][k]);
+    }
+};
+
+// ----------------------------------------------------------------------------
+
+float MeshFacetBVH::Node::DistanceP2(const Base::Vector3f& rclPt) const
+{
+    float fDist = 0.0f;
+    for (int i = 0; i < 3; i++) {
+        float d = std::max<float>(0.0f, std::max<float>(fMin[i] - rclPt[i], rclPt[i] - fMax[i]));
+        fDist += d * d;
+    }
+    return fDist;
+}
+
+MeshFacetBVH::MeshFacetBVH(const MeshKernel& rclM)
+{
+    Rebuild(rclM);
+}
+
+MeshFacetBVH::MeshFacetBVH(const MeshKernel& rclM, const Base::Matrix4D& rclMat)
+{
+    Rebuild(rclM, rclMat);
+}
+
+MeshFacetBVH::~MeshFacetBVH()
+{
+}
+
+void MeshFacetBVH::Clear()
+{
+    myNodes.clear();
+    myFacets.clear();
+    myCorners.clear();
+}
+
+void MeshFacetBVH::Rebuild(const MeshKernel& rclM)
+{
+    const MeshPointArray& rPoints = rclM.GetPoints();
+    const MeshFacetArray& rFacets = rclM.GetFacets();
+
+    std::vector<Base::Vector3f> corners;
+    corners.reserve(3 * rFacets.size());
+    for (MeshFacetArray::_TConstIterator it = rFacets.begin(); it != rFacets.end(); ++it) {
+        for (int i = 0; i < 3; i++)
+            corners.push_back(rPoints[it->_aulPoints[i]]);
+    }
+
+    Build(corners);
+}
+
+void MeshFacetBVH::Rebuild(const MeshKernel& rclM, const Base::Matrix4D& rclMat)
+{
+    const MeshPointArray& rPoints = rclM.GetPoints();
+    const MeshFacetArray& rFacets = rclM.GetFacets();
+
+    std::vector<Base::Vector3f> corners;
+    corners.reserve(3 * rFacets.size());
+    for (MeshFacetArray::_TConstIterator it = rFacets.begin(); it != rFacets.end(); ++it) {
+        for (int i = 0; i < 3; i++)
+            corners.push_back(rclMat * rPoints[it->_aulPoints[i]]);
+    }
+
+    Build(corners);
+}
+
+void MeshFacetBVH::Build(const std::vector<Base::Vector3f>& raclPoints)
+{
+    Clear();
+
+    unsigned long ulCtFacets = raclPoints.size() / 3;
+    if (ulCtFacets == 0)
+        return;
+
+    std::vector<Base::BoundBox3f> boxes(ulCtFacets);
+    std::vector<Base::Vector3f> centers(ulCtFacets);
+    myFacets.resize(ulCtFacets);
+    for (unsigned long i = 0; i < ulCtFacets; i++) {
+        boxes[i] = Base::BoundBox3f(&raclPoints[3 * i], 3);
+        centers[i] = boxes[i].CalcCenter();
+        myFacets[i] = i;
+    }
+
+    myNodes.reserve(2 * (ulCtFacets / MaxLeafSize) + 1);
+    BuildNode(0, ulCtFacets, 0, boxes, centers);
+
+    // copy the corners in leaf order so that a leaf reads one contiguous block
+    myCorners.resize(3 * ulCtFacets);
+    for (unsigned long i = 0; i < ulCtFacets; i++) {
+        for (int j = 0; j < 3; j++)
+            myCorners[3 * i + j] = raclPoints[3 * myFacets[i] + j];
+    }
+}
+
+unsigned long MeshFacetBVH::BuildNode(unsigned long ulBegin, unsigned long ulEnd, int iDepth,
+                                      const std::vector<Base::BoundBox3f>& raclBoxes,
+                                      const std::vector<Base::Vector3f>& raclCenters)
+{
+    unsigned long ulNode = myNodes.size();
+    myNodes.push_back(Node());
+
+    Base::BoundBox3f box, centerBox;
+    for (unsigned long i = ulBegin; i < ulEnd; i++) {
+        box.Add(raclBoxes[myFacets[i]]);
+        centerBox.Add(raclCenters[myFacets[i]]);
+    }
+
+    Node& node = myNodes[ulNode];
+    node.fMin[0] = box.MinX; node.fMin[1] = box.MinY; node.fMin[2] = box.MinZ;
+    node.fMax[0] = box.MaxX; node.fMax[1] = box.MaxY; node.fMax[2] = box.MaxZ;
+    node.ulFirst = ulBegin;
+    node.ulCount = ulEnd - ulBegin;
+
+    unsigned long ulCount = ulEnd - ulBegin;
+    if (ulCount <= MaxLeafSize)
+        return ulNode;
+
+    // find the cheapest split plane with the binned surface area heuristic
+    float fBestCost = FLOAT_MAX;
+    int iBestAxis = -1, iBestSplit = 0;
+    float fBestMin = 0.0f, fBestScale = 0.0f;
+    Base::Vector3f cMin(centerBox.MinX, centerBox.MinY, centerBox.MinZ);
+    Base::Vector3f cMax(centerBox.MaxX, centerBox.MaxY, centerBox.MaxZ);
+    for (int axis = 0; axis < 3 && iDepth < MaxSAHDepth; axis++) {
+        float fExtent = Coord(cMax, axis) - Coord(cMin, axis);
+        if (fExtent <= 0.0f)
+            continue;
+
+        CenterBin bin(raclCenters, axis, Coord(cMin, axis), float(NumBins) / fExtent);
+        Base::BoundBox3f binBoxes[NumBins];
+        unsigned long binCounts[NumBins] = {0};
+        for (unsigned long i = ulBegin; i < ulEnd; i++) {
+            int b = bin(myFacets[i]);
+            binBoxes[b].Add(raclBoxes[myFacets[i]]);
+            binCounts[b]++;
+        }
+
+        float rightArea[NumBins];
+        unsigned long rightCount[NumBins];
+        Base::BoundBox3f accBox;
+        unsigned long accCount = 0;
+        for (int b = NumBins - 1; b > 0; b--) {
+            accBox.Add(binBoxes[b]);
+            accCount += binCounts[b];
+            rightArea[b] = HalfArea(accBox);
+            rightCount[b] = accCount;
+        }
+
+        accBox = Base::BoundBox3f();
+        accCount = 0;
+        for (int b = 0; b < NumBins - 1; b++) {
+            accBox.Add(binBoxes[b]);
+            accCount += binCounts[b];
+            if (accCount == 0 || rightCount[b + 1] == 0)
+                continue;
+            float fCost = HalfArea(accBox) * accCount + rightArea[b + 1] * rightCount[b + 1];
+            if (fCost < fBestCost) {
+                fBestCost = fCost;
+                iBestAxis = axis;
+                iBestSplit = b + 1;
+                fBestMin = Coord(cMin, axis);
+                fBestScale = float(NumBins) / fExtent;
+            }
+        }
+    }
+
+    unsigned long ulMiddle;
+    if (iBestAxis >= 0) {
+        // a leaf is cheaper if splitting costs more than testing all facets
+        float fLeafCost = HalfArea(box) * ulCount;
+        if (ulCount <= MaxLeafSplit && HalfArea(box) + fBestCost >= fLeafCost)
+            return ulNode;
+
+        CenterBin bin(raclCenters, iBestAxis, fBestMin, fBestScale);
+        ulMiddle = std::partition(myFacets.begin() + ulBegin, myFacets.begin() + ulEnd,
+                                  LeftOfBin(bin, iBestSplit)) - myFacets.begin();
+    }
+    else {
+        // all centers coincide or the tree is already very deep, split at the median
+        if (iDepth < MaxSAHDepth && ulCount <= MaxLeafSplit)
+            return ulNode;
+
+        int axis = 0;
+        if (box.LengthY() > box.LengthX())
+            axis = 1;
+        if (box.LengthZ() > std::max<float>(box.LengthX(), box.LengthY()))
+            axis = 2;
+        ulMiddle = ulBegin + ulCount / 2;
+        std::nth_element(myFacets.begin() + ulBegin, myFacets.begin() + ulMiddle,
+                         myFacets.begin() + ulEnd, CenterLess(raclCenters, axis));
+    }
+
+    // the node reference may become invalid while building the children
+    BuildNode(ulBegin, ulMiddle, iDepth + 1, raclBoxes, raclCenters);
+    unsigned long ulRight = BuildNode(ulMiddle, ulEnd, iDepth + 1, raclBoxes, raclCenters);
+    myNodes[ulNode].ulFirst = ulRight;
+    myNodes[ulNode].ulCount = 0;
+    return ulNode;
+}
+
+Base::BoundBox3f MeshFacetBVH::GetBoundBox() const
+{
+    if (myNodes.empty())
+        return Base::BoundBox3f();
+    const Node& root = myNodes.front();
+    return Base::BoundBox3f(root.fMin[0], root.fMin[1], root.fMin[2],
+                            root.fMax[0], root.fMax[1], root.fMax[2]);
+}
+
+void MeshFacetBVH::TracePacket(RayPacket& rclPacket) const
+{
+    if (myNodes.empty())
+        return;
+
+    unsigned long aulStack[StackSize];
+    float afNear[StackSize];
+    int iTop = 0;
+
+    float fNear;
+    if (!rclPacket.HitBox(myNodes[0], fNear))
+        return;
+    aulStack[iTop] = 0;
+    afNear[iTop++] = fNear;
+
+    while (iTop > 0) {
+        --iTop;
+        // a nearer hit may have been found meanwhile
+        if (afNear[iTop] > rclPacket.MaxDist())
+            continue;
+
+        unsigned long ulNode = aulStack[iTop];
+        const Node& node = myNodes[ulNode];
+        if (node.ulCount > 0) {
+            for (unsigned long i = node.ulFirst; i < node.ulFirst + node.ulCount; i++)
+                rclPacket.HitFacet(&myCorners[3 * i], myFacets[i]);
+        }
+        else {
+            unsigned long ulLeft = ulNode + 1, ulRight = node.ulFirst;
+            float fLeft, fRight;
+            bool bLeft = rclPacket.HitBox(myNodes[ulLeft], fLeft);
+            bool bRight = rclPacket.HitBox(myNodes[ulRight], fRight);
+            // push the farther child first so that the nearer one is visited first
+            if (bLeft && bRight && fLeft <= fRight) {
+                aulStack[iTop] = ulRight; afNear[iTop++] = fRight;
+                aulStack[iTop] = ulLeft;  afNear[iTop++] = fLeft;
+            }
+            else if (bLeft && bRight) {
+                aulStack[iTop] = ulLeft;  afNear[iTop++] = fLeft;
+                aulStack[iTop] = ulRight; afNear[iTop++] = fRight;
+            }
+            else if (bLeft) {
+                aulStack[iTop] = ulLeft;  afNear[iTop++] = fLeft;
+            }
+            else if (bRight) {
+                aulStack[iTop] = ulRight; afNear[iTop++] = fRight;
+            }
+        }
+    }
+}
+
+bool MeshFacetBVH::NearestFacetOnRay(const Base::Vector3f& rclPt, const Base::Vector3f& rclDir, Base::Vector3f& rclRes,
+                                     unsigned long& rulFacet, float fMaxDist) const
+{
+    RayPacket packet;
+    packet.SetRay(0, rclPt, rclDir, fMaxDist);
+    if (!packet.bActive[0])
+        return false;
+
+    TracePacket(packet);
+    if (packet.ulFacet[0] == ULONG_MAX)
+        return false;
+
+    rclRes = packet.HitPoint(0);
+    rulFacet = packet.ulFacet[0];
+    return true;
+}
+
+void MeshFacetBVH::NearestFacetsOnRays(const std::vector<Base::Vector3f>& raclPts, const std::vector<Base::Vector3f>& raclDirs,
+                                       std::vector<Base::Vector3f>& raclRes, std::vector<unsigned long>& raulFacets) const
+{
+    unsigned long ulCtRays = std::min<unsigned long>(raclPts.size(), raclDirs.size());
+    raclRes.resize(ulCtRays);
+    raulFacets.resize(ulCtRays);
+
+    for (unsigned long i = 0; i < ulCtRays; i += RayPacket::Size) {
+        RayPacket packet;
+        int iCount = int(std::min<unsigned long>(RayPacket::Size, ulCtRays - i));
+        for (int k = 0; k < iCount; k++)
+            packet.SetRay(k, raclPts[i + k], raclDirs[i + k], FLOAT_MAX);
+
+        TracePacket(packet);
+
+        for (int k = 0; k < iCount; k++) {
+            raulFacets[i + k] = packet.ulFacet[k];
+            if (packet.ulFacet[k] != ULONG_MAX)
+                raclRes[i + k] = packet.HitPoint(k);
+            else
+                raclRes[i + k] = raclPts[i + k];
+        }
+    }
+}
+
+bool MeshFacetBVH::NearestFacetToPoint(const Base::Vector3f& rclPt, Base::Vector3f& rclRes, unsigned long& rulFacet,
+                                       float fMaxDist) const
+{
+    if (myNodes.empty())
+        return false;
+
+    float fBest = fMaxDist < FLOAT_MAX ? fMaxDist * fMaxDist : FLOAT_MAX;
+    unsigned long ulBest = ULONG_MAX;
+
+    unsigned long aulStack[StackSize];
+    float afDist[StackSize];
+    int iTop = 0;
+
+    float fDist = myNodes[0].DistanceP2(rclPt);
+    if (fDist > fBest)
+        return false;
+    aulStack[iTop] = 0;
+    afDist[iTop++] = fDist;
+
+    while (iTop > 0) {
+        --iTop;
+        if (afDist[iTop] > fBest)
+            continue;
+
+        unsigned long ulNode = aulStack[iTop];
+        const Node& node = myNodes[ulNode];
+        if (node.ulCount > 0) {
+            for (unsigned long i = node.ulFirst; i < node.ulFirst + node.ulCount; i++) {
+                MeshGeomFacet facet(myCorners[3 * i], myCorners[3 * i + 1], myCorners[3 * i + 2]);
+                Base::Vector3f clPt;
+                float fFacetDist = facet.DistanceToPoint(rclPt, clPt);
+                if (fFacetDist * fFacetDist <= fBest) {
+                    fBest = fFacetDist * fFacetDist;
+                    ulBest = myFacets[i];
+                    rclRes = clPt;
+                }
+            }
+        }
+        else {
+            unsigned long ulLeft = ulNode + 1, ulRight = node.ulFirst;
+            float fLeft = myNodes[ulLeft].DistanceP2(rclPt);
+            float fRight = myNodes[ulRight].DistanceP2(rclPt);
+            // push the farther child first so that the nearer one is visited first
+            if (fLeft <= fRight) {
+                if (fRight <= fBest) { aulStack[iTop] = ulRight; afDist[iTop++] = fRight; }
+                if (fLeft <= fBest)  { aulStack[iTop] = ulLeft;  afDist[iTop++] = fLeft;  }
+            }
+            else {
+                if (fLeft <= fBest)  { aulStack[iTop] = ulLeft;  afDist[iTop++] = fLeft;  }
+                if (fRight <= fBest) { aulStack[iTop] = ulRight; afDist[iTop++] = fRight; }
+            }
+        }
+    }
+
+    if (ulBest == ULONG_MAX)
+        return false;
+    rulFacet = ulBest;
+    return true;
+}
@@ -0,0 +1,113 @@
+/***************************************************************************
+ *   Copyright (c) 2026 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef MESHCORE_BVH_H
+#define MESHCORE_BVH_H
+
+#include <vector>
+#include <Base/Vector3D.h>
+#include <Base/BoundBox.h>
+#include <Base/Matrix.h>
+
+namespace MeshCore {
+
+class MeshKernel;
+
+/**
+ * The MeshFacetBVH is a bounding volume hierarchy over the facets of a mesh.
+ * Unlike the cells of the MeshFacetGrid its nodes adapt to the distribution of
+ * the facets, so it stays efficient on meshes with a highly varying density.
+ * The hierarchy is built with the surface area heuristic.
+ *
+ * The hierarchy keeps its own copy of the facet corners and doesn't refer to
+ * the mesh kernel after construction. Thus, the search methods can be used
+ * from several threads at the same time.
+ */
+class MeshExport MeshFacetBVH
+{
+public:
+    /// Construction
+    MeshFacetBVH(const MeshKernel& rclM);
+    /// Construction with the facets transformed by \a rclMat
+    MeshFacetBVH(const MeshKernel& rclM, const Base::Matrix4D& rclMat);
+    /// Destruction
+    ~MeshFacetBVH();
+
+    /** Rebuilds the hierarchy for the given mesh. */
+    void Rebuild(const MeshKernel& rclM);
+    /** Rebuilds the hierarchy for the given mesh with its facets transformed by \a rclMat. */
+    void Rebuild(const MeshKernel& rclM, const Base::Matrix4D& rclMat);
+    /** Returns the number of facets. */
+    unsigned long CountFacets() const
+    { return myFacets.size(); }
+    /** Returns the bounding box of all facets. */
+    Base::BoundBox3f GetBoundBox() const;
+
+    /** @name Search */
+    //@{
+    /** Searches for the nearest facet hit by the ray with base \a rclPt and direction \a rclDir.
+     * Only intersections in direction of the ray that are not farther than \a fMaxDist are taken
+     * into account. If a facet is found true is returned together with the intersection point
+     * and the facet index.
+     */
+    bool NearestFacetOnRay(const Base::Vector3f& rclPt, const Base::Vector3f& rclDir, Base::Vector3f& rclRes,
+                           unsigned long& rulFacet, float fMaxDist = FLOAT_MAX) const;
+    /** Does basically the same as NearestFacetOnRay() for a whole set of rays. For each ray the facet
+     * index or ULONG_MAX if nothing was hit is written to \a raulFacets and the intersection point to
+     * \a raclRes. Neighboured rays are traced in packets of four which is much faster if they point
+     * roughly into the same direction, e.g. when they come from a camera or a scanner.
+     */
+    void NearestFacetsOnRays(const std::vector<Base::Vector3f>& raclPts, const std::vector<Base::Vector3f>& raclDirs,
+                             std::vector<Base::Vector3f>& raclRes, std::vector<unsigned long>& raulFacets) const;
+    /** Searches for the facet nearest to \a rclPt that is not farther than \a fMaxDist. If a facet is
+     * found true is returned together with the nearest point on it and the facet index.
+     */
+    bool NearestFacetToPoint(const Base::Vector3f& rclPt, Base::Vector3f& rclRes, unsigned long& rulFacet,
+                             float fMaxDist = FLOAT_MAX) const;
+    //@}
+
+private:
+    struct Node
+    {
+        float fMin[3], fMax[3];
+        unsigned long ulFirst; /**< First facet of a leaf, right child of an inner node. */
+        unsigned long ulCount; /**< Number of facets of a leaf, 0 for an inner node. */
+        float DistanceP2(const Base::Vector3f& rclPt) const;
+    };
+    struct RayPacket;
+
+    void Clear();
+    void Build(const std::vector<Base::Vector3f>& raclPoints);
+    unsigned long BuildNode(unsigned long ulBegin, unsigned long ulEnd, int iDepth,
+                            const std::vector<Base::BoundBox3f>& raclBoxes,
+                            const std::vector<Base::Vector3f>& raclCenters);
+    void TracePacket(RayPacket& rclPacket) const;
+
+private:
+    std::vector<Node> myNodes;             /**< Nodes in depth-first order, the left child follows its parent. */
+    std::vector<unsigned long> myFacets;   /**< Facet indices in leaf order. */
+    std::vector<Base::Vector3f> myCorners; /**< Three corners per facet in leaf order. */
+};
+
+} // namespace MeshCore
+
+#endif // MESHCORE_BVH_H
@@ -25,8 +25,16 @@
 
 #ifndef _PreComp_
 # include <algorithm>
+# include <cfloat>
+# include <climits>
+# include <cmath>
 #endif
 
+#include <boost/unordered_map.hpp>
+#include <boost/functional/hash.hpp>
+#include <QThread>
+#include <QtConcurrentMap>
+
 #include <Base/Sequencer.h>
 #include <Base/Exception.h>
 
@@ -36,7 +44,7 @@
 using namespace MeshCore;
 
 
-MeshBuilder::MeshBuilder (MeshKernel& kernel) : _meshKernel(kernel), _seq(0)
+MeshBuilder::MeshBuilder (MeshKernel& kernel) : _meshKernel(kernel), _seq(0), _ptIdx(0), _facetIdx(0)
 {
     _fSaveTolerance = MeshDefinitions::_fMinPointDistanceD1;
 }
@@ -54,6 +62,8 @@ void MeshBuilder::SetTolerance(float fTol)
 
 void MeshBuilder::Initialize (unsigned long ctFacets, bool deletion)
 {
+    // the arrays of the kernel get modified directly
+    _meshKernel.ClearIndex();
     if (deletion)
     {
         // Clear the mesh structure and free all memory
@@ -65,34 +75,24 @@ void MeshBuilder::Initialize (unsigned long ctFacets, bool deletion)
         //       This usually happens if its elements are added without specifying its final size. Later on it's a bit tricky to free the wasted 
         //       memory. So we're strived to avoid the wastage of memory.
         _meshKernel._aclFacetArray.reserve(ctFacets);
-
-        // Usually the number of vertices is the half of the number of facets. So we reserve this memory with 10% surcharge
-        // To save memory we hold an array with iterators that point to the right vertex (insertion order) in the set, instead of
-        // holding the vertex array twice.
-        unsigned long ctPoints = ctFacets / 2;
-        _pointsIterator.reserve((unsigned long)(float(ctPoints)*1.10f));
+        _points.reserve(3 * ctFacets);
         _ptIdx = 0;
+        _facetIdx = 0;
     }
     else
     {
-        for (MeshPointArray::_TConstIterator it1 = _meshKernel._aclPointArray.begin(); it1 != _meshKernel._aclPointArray.end(); it1++)
-        {
-            MeshPointIterator pit = _points.insert(*it1);			
-            _pointsIterator.push_back(pit);
-        }
+        // The points of the kernel keep their indices, the new points get merged with them
+        _points.reserve(_meshKernel._aclPointArray.size() + 3 * ctFacets);
+        _points.assign(_meshKernel._aclPointArray.begin(), _meshKernel._aclPointArray.end());
         _ptIdx = _points.size();
+        _facetIdx = _meshKernel._aclFacetArray.size();
 
-        // As we have a copy of our vertices in the set we must clear them from our array now  But we can keep its
-        // memory as we reuse it later on anyway.
-        _meshKernel._aclPointArray.clear();
         // additional memory
         unsigned long newCtFacets = _meshKernel._aclFacetArray.size()+ctFacets;
         _meshKernel._aclFacetArray.reserve(newCtFacets);
-        unsigned long ctPoints = newCtFacets / 2;
-        _pointsIterator.reserve((unsigned long)(float(ctPoints)*1.10f));
     }
 
-    this->_seq = new Base::SequencerLauncher("create mesh structure...", ctFacets * 2);
+    this->_seq = new Base::SequencerLauncher("create mesh structure...", ctFacets);
 }
 
 void MeshBuilder::AddFacet (const MeshGeomFacet& facet, bool takeFlag, bool takeProperty)
@@ -127,74 +127,313 @@ void MeshBuilder::AddFacet (Base::Vector3f* facetPoints, unsigned char flag, uns
     mf._ucFlag = flag;
     mf._ulProp = prop;
 
-    int i = 0;
-    for (i = 0; i < 3; i++)
+    // the point indices refer to _points until Finish() has merged the points
+    for (int i = 0; i < 3; i++)
+    {
+        mf._aulPoints[i] = _points.size();
+        _points.push_back(facetPoints[i]);
+    }
+
+    _meshKernel._aclFacetArray.push_back(mf);
+}
+
+namespace MeshCore {
+
+// Inputs with fewer points are welded in the calling thread only
+const unsigned long MeshBuilder_MinParallelPoints = 0x10000;
+
+// A spatial hash of the points merged by MeshBuilder::MergePoints(). The cells are larger
+// than the tolerance so that usually only one or two cells must be searched. The cells are
+// split into partitions by their hash value and every partition has a map of its own, so
+// that the maps can be built in several threads. Afterwards the hash is only read.
+class MeshBuilder_PointHash
+{
+public:
+    MeshBuilder_PointHash(const std::vector<Base::Vector3f>& points, float fTol, int parts)
+      : _points(points), _fTol(fTol), _fCellSize(8.0 * double(fTol)), _cells(parts)
+      , _next(points.size(), ULONG_MAX), _part(points.size(), NoPart)
+    {
+    }
+    int CountPartitions() const
+    {
+        return static_cast<int>(_cells.size());
+    }
+    /** Assigns the points in [\a begin, \a end) to the partition of their cell. Points with
+     * invalid coordinates can't be equal to any point and are left out.
+     */
+    void Assign(unsigned long begin, unsigned long end)
+    {
+        for (unsigned long i = begin; i < end; i++) {
+            const Base::Vector3f& p = _points[i];
+            if (fabs(p.x) <= FLT_MAX && fabs(p.y) <= FLT_MAX && fabs(p.z) <= FLT_MAX)
+                _part[i] = static_cast<unsigned short>(GetPartition(GetCell(p, 0.0f)));
+        }
+    }
+    /** Fills the map of partition \a part with its points. The points of a cell are chained
+     * in ascending order so that a search can stop at the first match.
+     */
+    void Build(int part)
+    {
+        CellMap& cells = _cells[part];
+        // a closed mesh has about half as many points as facets, i.e. a sixth of the corners
+        cells.rehash(_points.size() / (4 * _cells.size()));
+        for (unsigned long i = _points.size(); i-- > 0;) {
+            if (_part[i] != part)
+                continue;
+            std::pair<CellMap::iterator, bool> it = cells.insert(std::make_pair(GetCell(_points[i], 0.0f), i));
+            if (!it.second) {
+                _next[i] = it.first->second;
+                it.first->second = i;
+            }
+        }
+    }
+    /** Returns the lowest index below \a ulIndex of a point that lies within the tolerance of
+     * the point \a ulIndex in each coordinate, or ULONG_MAX. If \a index is given only the points
+     * that are kept, i.e. whose entry refers to themselves, are taken into account.
+     */
+    unsigned long FindLower(unsigned long ulIndex, const std::vector<unsigned long>* index) const
     {
-        MeshPoint pt(facetPoints[i]);			
-        std::set<MeshPoint>::iterator p = _points.find(pt);
-        if (p == _points.end())
+        unsigned long ulFound = ULONG_MAX;
+        if (_part[ulIndex] == NoPart)
+            return ulFound;
+
+        const Base::Vector3f& rPoint = _points[ulIndex];
+        Cell lo = GetCell(rPoint, -_fTol);
+        Cell hi = GetCell(rPoint,  _fTol);
+        Cell cell;
+        for (cell.x = lo.x; cell.x <= hi.x; cell.x++) {
+            for (cell.y = lo.y; cell.y <= hi.y; cell.y++) {
+                for (cell.z = lo.z; cell.z <= hi.z; cell.z++) {
+                    const CellMap& cells = _cells[GetPartition(cell)];
+                    CellMap::const_iterator it = cells.find(cell);
+                    if (it == cells.end())
+                        continue;
+                    for (unsigned long i = it->second; i < ulFound && i < ulIndex; i = _next[i]) {
+                        if (index && (*index)[i] != i)
+                            continue;
+                        const Base::Vector3f& q = _points[i];
+                        if (fabs(q.x - rPoint.x) < _fTol && fabs(q.y - rPoint.y) < _fTol &&
+                            fabs(q.z - rPoint.z) < _fTol) {
+                            ulFound = i;
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+        return ulFound;
+    }
+
+private:
+    enum { NoPart = USHRT_MAX };
+
+    struct Cell {
+        long long x, y, z;
+        bool operator == (const Cell& c) const
+        { return x == c.x && y == c.y && z == c.z; }
+    };
+    struct CellHash {
+        std::size_t operator () (const Cell& c) const
         {
-            mf._aulPoints[i] = _ptIdx;
-            pt._ulProp = _ptIdx++;
-            // keep an iterator to the right vertex
-            MeshPointIterator it = _points.insert(pt);			
-            _pointsIterator.push_back(it);
+            std::size_t seed = 0;
+            boost::hash_combine(seed, c.x);
+            boost::hash_combine(seed, c.y);
+            boost::hash_combine(seed, c.z);
+            return seed;
         }
-        else
-            mf._aulPoints[i] = p->_ulProp;
+    };
+    typedef boost::unordered_map<Cell, unsigned long, CellHash> CellMap;
+
+    int GetPartition(const Cell& cell) const
+    {
+        if (_cells.size() == 1)
+            return 0;
+        // the hash of the map picks the bucket from the low bits, the partition uses the high bits
+        std::size_t seed = CellHash()(cell);
+        return static_cast<int>((seed >> 16) % _cells.size());
+    }
+    long long GetCoordinate(float fValue, float fOffset) const
+    {
+        // very large coordinates share the outermost cells
+        const double limit = 4.0e18;
+        double cell = std::floor((double(fValue) + double(fOffset)) / _fCellSize);
+        if (!(cell > -limit))
+            cell = -limit;
+        else if (cell > limit)
+            cell = limit;
+        return static_cast<long long>(cell);
+    }
+    Cell GetCell(const Base::Vector3f& rPoint, float fOffset) const
+    {
+        Cell cell;
+        cell.x = GetCoordinate(rPoint.x, fOffset);
+        cell.y = GetCoordinate(rPoint.y, fOffset);
+        cell.z = GetCoordinate(rPoint.z, fOffset);
+        return cell;
     }
 
-    // check for degenerated facet (one edge has length 0)
-    if ((mf._aulPoints[0] == mf._aulPoints[1]) || (mf._aulPoints[0] == mf._aulPoints[2]) || (mf._aulPoints[1] == mf._aulPoints[2]))
-        return;
+    const std::vector<Base::Vector3f>& _points;
+    float _fTol;
+    double _fCellSize;
+    std::vector<CellMap> _cells; /**< One map per partition. */
+    std::vector<unsigned long> _next; /**< The next point in the same cell. */
+    std::vector<unsigned short> _part; /**< The partition of each point, NoPart if invalid. */
+};
 
-    _meshKernel._aclFacetArray.push_back(mf);
+// A part of the work of MeshBuilder::MergePoints() that runs in a thread of its own
+struct MeshBuilder_Task
+{
+    MeshBuilder_PointHash* hash;
+    std::vector<unsigned long>* index;
+    unsigned long begin;
+    unsigned long end;
+    int part;
+};
+
+void MeshBuilder_Assign(MeshBuilder_Task& task)
+{
+    task.hash->Assign(task.begin, task.end);
 }
 
-void MeshBuilder::SetNeighbourhood ()
+void MeshBuilder_Build(MeshBuilder_Task& task)
 {
-    std::set<Edge> edges;
-    int facetIdx = 0;
+    task.hash->Build(task.part);
+}
 
-    for (MeshFacetArray::_TIterator it = _meshKernel._aclFacetArray.begin(); it != _meshKernel._aclFacetArray.end(); it++)
+void MeshBuilder_FindLower(MeshBuilder_Task& task)
+{
+    std::vector<unsigned long>& index = *task.index;
+    for (unsigned long i = task.begin; i < task.end; i++) {
+        unsigned long ulFound = task.hash->FindLower(i, 0);
+        index[i] = (ulFound == ULONG_MAX) ? i : ulFound;
+    }
+}
+
+void MeshBuilder_Run(std::vector<MeshBuilder_Task>& tasks, void (*func)(MeshBuilder_Task&))
+{
+    if (tasks.size() > 1) {
+        QtConcurrent::blockingMap(tasks, func);
+    }
+    else {
+        for (std::vector<MeshBuilder_Task>::iterator it = tasks.begin(); it != tasks.end(); ++it)
+            func(*it);
+    }
+}
+
+}
+
+void MeshBuilder::MergePoints (std::vector<unsigned long>& index)
+{
+    // Every point is merged into the lowest point added before that is kept and lies within
+    // the tolerance in each coordinate. Points of the kernel are never merged with each other.
+    // Points with invalid coordinates can't be equal to any point and are kept as they are.
+    float fTol = MeshDefinitions::_fMinPointDistanceD1;
+    unsigned long ulPoints = _points.size();
+    index.resize(ulPoints);
+    for (unsigned long i = 0; i < ulPoints; i++)
+        index[i] = i;
+
+    if (fTol > 0.0f && ulPoints > _ptIdx)
     {
-        this->_seq->next(true); // allow to cancel
-        MeshFacet& mf = *it;
+        int parts = 1;
+        if (ulPoints >= MeshBuilder_MinParallelPoints)
+            parts = std::min<int>(std::max<int>(1, QThread::idealThreadCount()), 256);
+        MeshBuilder_PointHash hash(_points, fTol, parts);
+
+        MeshBuilder_Task task;
+        task.hash = &hash;
+        task.index = &index;
+        task.part = 0;
+
+        std::vector<MeshBuilder_Task> tasks;
+        for (int i = 0; i < parts; i++) {
+            task.begin = (ulPoints * i) / parts;
+            task.end = (ulPoints * (i + 1)) / parts;
+            tasks.push_back(task);
+        }
+        MeshBuilder_Run(tasks, &MeshBuilder_Assign);
+        for (int i = 0; i < parts; i++)
+            tasks[i].part = i;
+        MeshBuilder_Run(tasks, &MeshBuilder_Build);
+
+        // The lowest point within the tolerance is searched in several threads, no matter if
+        // it is kept itself. The points near other points come in clusters, so the search is
+        // split into more ranges than threads.
+        tasks.clear();
+        int ranges = (parts > 1) ? 4 * parts : 1;
+        unsigned long ulNew = ulPoints - _ptIdx;
+        for (int i = 0; i < ranges; i++) {
+            task.begin = _ptIdx + (ulNew * i) / ranges;
+            task.end = _ptIdx + (ulNew * (i + 1)) / ranges;
+            tasks.push_back(task);
+        }
+        MeshBuilder_Run(tasks, &MeshBuilder_FindLower);
 
-        for (int i = 0; i < 3; i++)
+        // If the lowest point is kept it's also the lowest kept point. Only if it has been merged
+        // itself, which needs points closer than the tolerance in a row, the kept points must be
+        // searched again. This depends on the points before and is done in order.
+        for (unsigned long i = _ptIdx; i < ulPoints; i++)
         {
-            Edge edge(mf._aulPoints[i], mf._aulPoints[(i+1)%3], facetIdx);
-            std::set<Edge>::iterator e = edges.find(edge);
-            if (e != edges.end())
-            { // edge exists, set neighbourhood
-                MeshFacet& mf1 = _meshKernel._aclFacetArray[e->facetIdx];
-                if (mf1._aulPoints[0] == edge.pt1)
-                {
-                    if (mf1._aulPoints[1] == edge.pt2)
-                        mf1._aulNeighbours[0] = facetIdx;
-                    else
-                        mf1._aulNeighbours[2] = facetIdx;
-                }
-                else if (mf1._aulPoints[0] == edge.pt2)
-                {
-                    if (mf1._aulPoints[1] == edge.pt1)
-                        mf1._aulNeighbours[0] = facetIdx;
-                    else
-                        mf1._aulNeighbours[2] = facetIdx;
-                }
-                else
-                    mf1._aulNeighbours[1] = facetIdx;
+            unsigned long ulFound = index[i];
+            if (ulFound == i || index[ulFound] == ulFound)
+                continue;
+            ulFound = hash.FindLower(i, &index);
+            index[i] = (ulFound == ULONG_MAX) ? i : ulFound;
+        }
+    }
 
-                mf._aulNeighbours[i] = e->facetIdx;
-            }
-            else
-            {  // new edge
-                edges.insert(edge);
-            }
+    // Number the points in the order they were added first and append the new ones to the
+    // kernel. As a merged point always refers to a point added before the index can be
+    // replaced in place.
+    unsigned long ulCount = 0;
+    for (unsigned long i = 0; i < index.size(); i++)
+    {
+        if (index[i] == i)
+            ulCount++;
+    }
+    _meshKernel._aclPointArray.reserve(ulCount);
+
+    ulCount = 0;
+    for (unsigned long i = 0; i < index.size(); i++)
+    {
+        if (index[i] == i)
+        {
+            index[i] = ulCount++;
+            if (i >= _ptIdx)
+                _meshKernel._aclPointArray.push_back(_points[i]);
+        }
+        else
+        {
+            index[i] = index[index[i]];
         }
+    }
+
+    { std::vector<Base::Vector3f>().swap(_points); }
+}
 
-        facetIdx++;
+void MeshBuilder::SetPointIndices (const std::vector<unsigned long>& index)
+{
+    // the facets of the kernel already refer to the final indices
+    MeshFacetArray::_TIterator beg = _meshKernel._aclFacetArray.begin() + _facetIdx;
+    for (MeshFacetArray::_TIterator it = beg; it != _meshKernel._aclFacetArray.end(); ++it)
+    {
+        for (int i = 0; i < 3; i++)
+            it->_aulPoints[i] = index[it->_aulPoints[i]];
+    }
+}
+
+void MeshBuilder::RemoveDegeneratedFacets()
+{
+    // check the new facets for degenerated ones (one edge has length 0)
+    MeshFacetArray& rFacets = _meshKernel._aclFacetArray;
+    MeshFacetArray::_TIterator jt = rFacets.begin() + _facetIdx;
+    for (MeshFacetArray::_TIterator it = jt; it != rFacets.end(); ++it)
+    {
+        if ((it->_aulPoints[0] == it->_aulPoints[1]) || (it->_aulPoints[0] == it->_aulPoints[2]) || (it->_aulPoints[1] == it->_aulPoints[2]))
+            continue;
+        *jt++ = *it;
     }
+    rFacets.erase(jt, rFacets.end());
 }
 
 void MeshBuilder::RemoveUnreferencedPoints()
@@ -213,19 +452,16 @@ void MeshBuilder::RemoveUnreferencedPoints()
 
 void MeshBuilder::Finish (bool freeMemory)
 {
-    // now we can resize the vertex array to the exact size and copy the vertices with their correct positions in the array
-    unsigned long i=0;
-    _meshKernel._aclPointArray.resize(_pointsIterator.size());
-    for ( std::vector<MeshPointIterator>::iterator it = _pointsIterator.begin(); it != _pointsIterator.end(); ++it)
-        _meshKernel._aclPointArray[i++] = *(it->first);
-
-    // free all memory of the internal structures
-    // Note: this scope is needed to free memory immediately
-    { std::vector<MeshPointIterator>().swap(_pointsIterator); }
-    _points.clear();
-
-    SetNeighbourhood();
+    // merge the equal points and let the facets refer to the merged points
+    std::vector<unsigned long> index;
+    MergePoints(index);
+    SetPointIndices(index);
+    { std::vector<unsigned long>().swap(index); }
+
+    RemoveDegeneratedFacets();
+    _meshKernel.RebuildNeighbours();
     RemoveUnreferencedPoints();
+    _meshKernel.ClearIndex();
 
     // if AddFacet() has been called more often (or even less) as specified in Initialize() we have a wastage of memory
     if ( freeMemory )
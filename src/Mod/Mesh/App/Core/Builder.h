@@ -99,15 +99,19 @@ private:
     //@}
 
     MeshKernel& _meshKernel;
-    std::set<MeshPoint> _points;
     Base::SequencerLauncher* _seq;
 
-    // keep an array of iterators pointing to the vertex inside the set to save memory
-    typedef std::pair<std::set<MeshPoint>::iterator, bool> MeshPointIterator;
-    std::vector<MeshPointIterator> _pointsIterator;
-    unsigned long				_ptIdx; 
-
-    void SetNeighbourhood  ();
+    // The corner points of all facets are only collected when adding the facets. Finish()
+    // merges equal points at once through a spatial hash which is much faster than looking
+    // up every corner in an ordered set. For large inputs the hash is split by cell and built
+    // and searched in several threads.
+    std::vector<Base::Vector3f> _points;
+    unsigned long               _ptIdx; /**< Number of points the kernel had before. */
+    unsigned long               _facetIdx; /**< Number of facets the kernel had before. */
+
+    void MergePoints       (std::vector<unsigned long>& index);
+    void SetPointIndices   (const std::vector<unsigned long>& index);
+    void RemoveDegeneratedFacets();
     // As it's forbidden to insert a degenerated facet but insert its vertices anyway we must remove them 
     void RemoveUnreferencedPoints();
 
@@ -23,6 +23,7 @@
 #include "PreCompiled.h"
 #ifndef _PreComp_
 # include <algorithm>
+# include <memory>
 #endif
 
 #include <QFuture>
@@ -30,10 +31,13 @@
 #include <QtConcurrentMap>
 #include <boost/bind.hpp>
 
+#include <Mod/Mesh/App/WildMagic4/Wm4Matrix2.h>
+#include <Mod/Mesh/App/WildMagic4/Wm4Matrix3.h>
+#include <Mod/Mesh/App/WildMagic4/Wm4Vector2.h>
 #include <Mod/Mesh/App/WildMagic4/Wm4Vector3.h>
-#include <Mod/Mesh/App/WildMagic4/Wm4MeshCurvature.h>
 
 #include "Curvature.h"
+#include "Adjacency.h"
 #include "Algorithm.h"
 #include "Approximation.h"
 #include "MeshKernel.h"
@@ -44,15 +48,128 @@
 
 using namespace MeshCore;
 
+namespace MeshCore {
+/**
+ * Estimates the curvature at a point from the derivatives of the point normals along its
+ * edges, in the same way as Wm4::MeshCurvature. The facets around the point are taken from
+ * the adjacency instead of running over all facets, so each point is computed on its own.
+ */
+class VertexCurvature
+{
+public:
+    VertexCurvature(const std::vector< Wm4::Vector3<double> >& points,
+                    const std::vector< Wm4::Vector3<double> >& normals,
+                    const MeshFacetArray& facets, const MeshAdjacency& search)
+      : myPoints(points), myNormals(normals), myFacets(facets), mySearch(search)
+    {
+    }
+    CurvatureInfo Compute(unsigned long index) const;
+
+private:
+    void AddEdge(unsigned long p0, unsigned long p1,
+                 Wm4::Matrix3<double>& rkWWTrn, Wm4::Matrix3<double>& rkDWTrn) const;
+    static Wm4::Vector3<double> Direction(const Wm4::Matrix2<double>& rkS, double fCurvature,
+                                          const Wm4::Vector3<double>& rkU, const Wm4::Vector3<double>& rkV);
+
+    const std::vector< Wm4::Vector3<double> >& myPoints;
+    const std::vector< Wm4::Vector3<double> >& myNormals;
+    const MeshFacetArray& myFacets;
+    const MeshAdjacency& mySearch;
+};
+}
+
+void VertexCurvature::AddEdge(unsigned long p0, unsigned long p1,
+                              Wm4::Matrix3<double>& rkWWTrn, Wm4::Matrix3<double>& rkDWTrn) const
+{
+    // project the edge to the tangent plane of the point and compute the difference of the normals
+    const Wm4::Vector3<double>& kN = myNormals[p0];
+    Wm4::Vector3<double> kE = myPoints[p1] - myPoints[p0];
+    Wm4::Vector3<double> kW = kE - (kE.Dot(kN))*kN;
+    Wm4::Vector3<double> kD = myNormals[p1] - kN;
+    for (int iRow = 0; iRow < 3; iRow++) {
+        for (int iCol = 0; iCol < 3; iCol++) {
+            rkWWTrn[iRow][iCol] += kW[iRow]*kW[iCol];
+            rkDWTrn[iRow][iCol] += kD[iRow]*kW[iCol];
+        }
+    }
+}
+
+Wm4::Vector3<double> VertexCurvature::Direction(const Wm4::Matrix2<double>& rkS, double fCurvature,
+                                                const Wm4::Vector3<double>& rkU, const Wm4::Vector3<double>& rkV)
+{
+    // the eigenvector of S, mapped back into the tangent plane
+    Wm4::Vector2<double> kW0(rkS[0][1],fCurvature-rkS[0][0]);
+    Wm4::Vector2<double> kW1(fCurvature-rkS[1][1],rkS[1][0]);
+    if (kW0.SquaredLength() >= kW1.SquaredLength()) {
+        kW0.Normalize();
+        return kW0.X()*rkU + kW0.Y()*rkV;
+    }
+    else {
+        kW1.Normalize();
+        return kW1.X()*rkU + kW1.Y()*rkV;
+    }
+}
+
+CurvatureInfo VertexCurvature::Compute(unsigned long index) const
+{
+    // the facets are visited in the same order as by Wm4::MeshCurvature so that the sums are equal
+    Wm4::Matrix3<double> kWWTrn, kDWTrn;
+    MeshAdjacency::Range facets = mySearch.PointFacets(index);
+    for (MeshAdjacency::Range::const_iterator it = facets.begin(); it != facets.end(); ++it) {
+        const unsigned long* v = myFacets[*it]._aulPoints;
+        for (int j = 0; j < 3; j++) {
+            if (v[j] == index) {
+                AddEdge(index, v[(j+1)%3], kWWTrn, kDWTrn);
+                AddEdge(index, v[(j+2)%3], kWWTrn, kDWTrn);
+            }
+        }
+    }
+
+    // add N*N^T to W*W^T for numerical stability and compute the matrix of normal derivatives
+    const Wm4::Vector3<double>& kN = myNormals[index];
+    for (int iRow = 0; iRow < 3; iRow++) {
+        for (int iCol = 0; iCol < 3; iCol++) {
+            kWWTrn[iRow][iCol] = 0.5*kWWTrn[iRow][iCol] + kN[iRow]*kN[iCol];
+            kDWTrn[iRow][iCol] *= 0.5;
+        }
+    }
+    Wm4::Matrix3<double> kDNormal = kDWTrn*kWWTrn.Inverse();
+
+    // the principal curvatures are the eigenvalues of the shape matrix S = J^T * dN/dX * J
+    // with J = [U | V], S is made symmetric because dN/dX is only estimated
+    Wm4::Vector3<double> kU, kV;
+    Wm4::Vector3<double>::GenerateComplementBasis(kU,kV,kN);
+    double fSAvr = 0.5*(kU.Dot(kDNormal*kV)+kV.Dot(kDNormal*kU));
+    Wm4::Matrix2<double> kS(kU.Dot(kDNormal*kU), fSAvr, fSAvr, kV.Dot(kDNormal*kV));
+
+    double fTrace = kS[0][0] + kS[1][1];
+    double fDet = kS[0][0]*kS[1][1] - kS[0][1]*kS[1][0];
+    double fDiscr = fTrace*fTrace - 4.0*fDet;
+    double fRootDiscr = Wm4::Math<double>::Sqrt(Wm4::Math<double>::FAbs(fDiscr));
+    double fMinCurv = 0.5*(fTrace - fRootDiscr);
+    double fMaxCurv = 0.5*(fTrace + fRootDiscr);
+    Wm4::Vector3<double> kMinDir = Direction(kS, fMinCurv, kU, kV);
+    Wm4::Vector3<double> kMaxDir = Direction(kS, fMaxCurv, kU, kV);
+
+    CurvatureInfo ci;
+    ci.cMaxCurvDir = Base::Vector3f((float)kMaxDir.X(), (float)kMaxDir.Y(), (float)kMaxDir.Z());
+    ci.cMinCurvDir = Base::Vector3f((float)kMinDir.X(), (float)kMinDir.Y(), (float)kMinDir.Z());
+    ci.fMaxCurvature = (float)fMaxCurv;
+    ci.fMinCurvature = (float)fMinCurv;
+    return ci;
+}
+
+// --------------------------------------------------------
+
 MeshCurvature::MeshCurvature(const MeshKernel& kernel)
-  : myKernel(kernel), myMinPoints(20), myRadius(0.5f)
+  : myKernel(kernel), myAdjacency(0), myMinPoints(20), myRadius(0.5f)
 {
     mySegment.resize(kernel.CountFacets());
     std::generate(mySegment.begin(), mySegment.end(), Base::iotaGen<unsigned long>(0));
 }
 
 MeshCurvature::MeshCurvature(const MeshKernel& kernel, const std::vector<unsigned long>& segm)
-  : myKernel(kernel), myMinPoints(20), myRadius(0.5f), mySegment(segm)
+  : myKernel(kernel), myAdjacency(0), myMinPoints(20), myRadius(0.5f), mySegment(segm)
 {
 }
 
@@ -61,8 +178,10 @@ void MeshCurvature::ComputePerFace(bool parallel)
     Base::Vector3f rkDir0, rkDir1, rkPnt;
     Base::Vector3f rkNormal;
     myCurvature.clear();
-    MeshRefPointToFacets search(myKernel);
-    FacetCurvature face(myKernel, search, myRadius, myMinPoints);
+    std::auto_ptr<MeshAdjacency> search;
+    if (!myAdjacency)
+        search.reset(new MeshAdjacency(myKernel));
+    FacetCurvature face(myKernel, myAdjacency ? *myAdjacency : *search, myRadius, myMinPoints);
 
     if (!parallel) {
         Base::SequencerLauncher seq("Curvature estimation", mySegment.size());
@@ -87,6 +206,9 @@ void MeshCurvature::ComputePerFace(bool parallel)
 void MeshCurvature::ComputePerVertex()
 {
     myCurvature.clear();
+    std::auto_ptr<MeshAdjacency> search;
+    if (!myAdjacency)
+        search.reset(new MeshAdjacency(myKernel));
 
     // get all points
     std::vector< Wm4::Vector3<double> > aPnts;
@@ -97,33 +219,31 @@ void MeshCurvature::ComputePerVertex()
         aPnts.push_back(cP);
     }
 
-    // get all point connections
-    std::vector<int> aIdx;
-    aIdx.reserve(3*myKernel.CountFacets());
+    // compute the normal vectors, the length of the facet normals provides a weighted sum
+    std::vector< Wm4::Vector3<double> > aNormals(aPnts.size(), Wm4::Vector3<double>(0.0, 0.0, 0.0));
     const MeshFacetArray& raFts = myKernel.GetFacets();
     for (MeshFacetArray::const_iterator jt = raFts.begin(); jt != raFts.end(); ++jt) {
-        for (int i=0; i<3; i++) {
-            aIdx.push_back((int)jt->_aulPoints[i]);
-        }
+        const unsigned long* v = jt->_aulPoints;
+        Wm4::Vector3<double> kNormal = (aPnts[v[1]] - aPnts[v[0]]).Cross(aPnts[v[2]] - aPnts[v[0]]);
+        for (int i=0; i<3; i++)
+            aNormals[v[i]] += kNormal;
     }
+    for (std::vector< Wm4::Vector3<double> >::iterator it = aNormals.begin(); it != aNormals.end(); ++it)
+        it->Normalize();
 
-    // compute vertex based curvatures
-    Wm4::MeshCurvature<double> meshCurv(myKernel.CountPoints(), &(aPnts[0]), myKernel.CountFacets(), &(aIdx[0]));
-
-    // get curvature information now
-    const Wm4::Vector3<double>* aMaxCurvDir = meshCurv.GetMaxDirections();
-    const Wm4::Vector3<double>* aMinCurvDir = meshCurv.GetMinDirections();
-    const double* aMaxCurv = meshCurv.GetMaxCurvatures();
-    const double* aMinCurv = meshCurv.GetMinCurvatures();
+    // the points only need the facets around them, so they can be computed in parallel
+    VertexCurvature vertex(aPnts, aNormals, raFts, myAdjacency ? *myAdjacency : *search);
+    std::vector<unsigned long> aIndices(aPnts.size());
+    std::generate(aIndices.begin(), aIndices.end(), Base::iotaGen<unsigned long>(0));
+    QFuture<CurvatureInfo> future = QtConcurrent::mapped
+        (aIndices, boost::bind(&VertexCurvature::Compute, &vertex, _1));
+    QFutureWatcher<CurvatureInfo> watcher;
+    watcher.setFuture(future);
+    watcher.waitForFinished();
 
-    myCurvature.reserve(myKernel.CountPoints());
-    for (unsigned long i=0; i<myKernel.CountPoints(); i++) {
-        CurvatureInfo ci;
-        ci.cMaxCurvDir = Base::Vector3f((float)aMaxCurvDir[i].X(), (float)aMaxCurvDir[i].Y(), (float)aMaxCurvDir[i].Z());
-        ci.cMinCurvDir = Base::Vector3f((float)aMinCurvDir[i].X(), (float)aMinCurvDir[i].Y(), (float)aMinCurvDir[i].Z());
-        ci.fMaxCurvature = (float)aMaxCurv[i];
-        ci.fMinCurvature = (float)aMinCurv[i];
-        myCurvature.push_back(ci);
+    myCurvature.reserve(aPnts.size());
+    for (QFuture<CurvatureInfo>::const_iterator it = future.begin(); it != future.end(); ++it) {
+        myCurvature.push_back(*it);
     }
 }
 
@@ -150,7 +270,7 @@ private:
 
 // --------------------------------------------------------
 
-FacetCurvature::FacetCurvature(const MeshKernel& kernel, const MeshRefPointToFacets& search, float r, unsigned long pt)
+FacetCurvature::FacetCurvature(const MeshKernel& kernel, const MeshAdjacency& search, float r, unsigned long pt)
   : myKernel(kernel), mySearch(search), myMinPoints(pt), myRadius(r)
 {
 }
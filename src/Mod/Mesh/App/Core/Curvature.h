@@ -29,7 +29,7 @@
 namespace MeshCore {
 
 class MeshKernel;
-class MeshRefPointToFacets;
+class MeshAdjacency;
 
 /** Curvature information. */
 struct MeshExport CurvatureInfo
@@ -41,12 +41,12 @@ struct MeshExport CurvatureInfo
 class MeshExport FacetCurvature
 {
 public:
-    FacetCurvature(const MeshKernel& kernel, const MeshRefPointToFacets& search, float, unsigned long);
+    FacetCurvature(const MeshKernel& kernel, const MeshAdjacency& search, float, unsigned long);
     CurvatureInfo Compute(unsigned long index) const;
 
 private:
     const MeshKernel& myKernel;
-    const MeshRefPointToFacets& mySearch;
+    const MeshAdjacency& mySearch;
     unsigned long myMinPoints;
     float myRadius;
 };
@@ -58,12 +58,15 @@ public:
     MeshCurvature(const MeshKernel& kernel, const std::vector<unsigned long>& segm);
     float GetRadius() const { return myRadius; }
     void SetRadius(float r) { myRadius = r; }
+    /** Uses the adjacency \a adj of the mesh in ComputePerFace() and ComputePerVertex() instead of building it. */
+    void SetAdjacency(const MeshAdjacency* adj) { myAdjacency = adj; }
     void ComputePerFace(bool parallel);
     void ComputePerVertex();
     const std::vector<CurvatureInfo>& GetCurvature() const { return myCurvature; }
 
 private:
     const MeshKernel& myKernel;
+    const MeshAdjacency* myAdjacency;
     unsigned long myMinPoints;
     float myRadius;
     std::vector<unsigned long> mySegment;
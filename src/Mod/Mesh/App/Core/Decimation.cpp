@@ -0,0 +1,698 @@
+/***************************************************************************
+ *   Copyright (c) 2026 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <algorithm>
+# include <cfloat>
+# include <climits>
+# include <cmath>
+# include <functional>
+# include <iterator>
+# include <queue>
+# include <vector>
+#endif
+
+#include <QThread>
+#include <QtConcurrentMap>
+
+#include "Decimation.h"
+#include "Definitions.h"
+#include "MeshKernel.h"
+#include "Elements.h"
+#include "TopoAlgorithm.h"
+
+#include <Base/Vector3D.h>
+
+using namespace MeshCore;
+
+namespace {
+
+// Meshes with less facets are decimated in one piece
+const unsigned long MinParallelSize = 100000;
+// Minimum number of facets a slab must keep
+const unsigned long MinSlabSize = 2000;
+// Number of slabs per thread, more slabs balance the load better but have more borders
+const int SlabsPerThread = 4;
+// The slabs keep this multiple of their share of the target size so that the last step
+// can balance the density between the slabs and along their borders
+const double LastStepShare = 1.25;
+// A collapse is rejected if the normal of a remaining facet turns by more than about 78 degree
+const double MinNormalCosine = 0.2;
+// or if it gets a facet of worse quality than this
+const double MinQuality = 0.001;
+
+// 1 for an equilateral triangle, 0 for a degenerated one, n is the normal of the triangle
+double Quality(const Base::Vector3d v[3], const Base::Vector3d& n)
+{
+    double sum = Base::DistanceP2(v[0], v[1]) + Base::DistanceP2(v[1], v[2]) +
+                 Base::DistanceP2(v[2], v[0]);
+    return sum > 0.0 ? 2.0 * sqrt(3.0) * n.Length() / sum : 0.0;
+}
+
+/* Symmetric 4x4 matrix that sums up the squared distances to a set of planes. */
+struct Quadric
+{
+    double a[10]; // xx xy xz xw yy yz yw zz zw ww
+
+    Quadric()
+    {
+        std::fill(a, a + 10, 0.0);
+    }
+    void AddPlane(const Base::Vector3d& n, double d)
+    {
+        a[0] += n.x*n.x; a[1] += n.x*n.y; a[2] += n.x*n.z; a[3] += n.x*d;
+        a[4] += n.y*n.y; a[5] += n.y*n.z; a[6] += n.y*d;
+        a[7] += n.z*n.z; a[8] += n.z*d;
+        a[9] += d*d;
+    }
+    Quadric& operator += (const Quadric& q)
+    {
+        for (int i = 0; i < 10; i++)
+            a[i] += q.a[i];
+        return *this;
+    }
+    double Error(const Base::Vector3d& p) const
+    {
+        double x = p.x, y = p.y, z = p.z;
+        return a[0]*x*x + 2.0*a[1]*x*y + 2.0*a[2]*x*z + 2.0*a[3]*x
+             + a[4]*y*y + 2.0*a[5]*y*z + 2.0*a[6]*y
+             + a[7]*z*z + 2.0*a[8]*z + a[9];
+    }
+    // The position with the least error, false if the matrix is (nearly) singular
+    bool Optimum(Base::Vector3d& p) const
+    {
+        double c00 = a[4]*a[7] - a[5]*a[5];
+        double c01 = a[2]*a[5] - a[1]*a[7];
+        double c02 = a[1]*a[5] - a[2]*a[4];
+        double det = a[0]*c00 + a[1]*c01 + a[2]*c02;
+        double trace = a[0] + a[4] + a[7];
+        if (std::fabs(det) <= 1.0e-6 * trace * trace * trace)
+            return false;
+        double c11 = a[0]*a[7] - a[2]*a[2];
+        double c12 = a[1]*a[2] - a[0]*a[5];
+        double c22 = a[0]*a[4] - a[1]*a[1];
+        p.x = -(c00*a[3] + c01*a[6] + c02*a[8]) / det;
+        p.y = -(c01*a[3] + c11*a[6] + c12*a[8]) / det;
+        p.z = -(c02*a[3] + c12*a[6] + c22*a[8]) / det;
+        return true;
+    }
+};
+
+/* An edge in the queue. It is outdated if one of its points has changed since. */
+struct Collapse
+{
+    double cost;
+    unsigned long p0, p1;
+    unsigned int stamp0, stamp1;
+};
+
+struct Collapse_Greater : public std::binary_function<const Collapse&, const Collapse&, bool>
+{
+    bool operator()(const Collapse& x, const Collapse& y) const
+    {
+        return x.cost > y.cost;
+    }
+};
+
+typedef std::priority_queue<Collapse, std::vector<Collapse>, Collapse_Greater> CollapseQueue;
+
+/* Buffers of a collapse, one per thread */
+struct Scratch
+{
+    std::vector<unsigned long> ring0, ring1, ring, common, opposite;
+    std::vector<unsigned long> removed, kept;
+    EdgeCollapse collapse;
+};
+
+class Decimator
+{
+public:
+    Decimator(MeshKernel& mesh, MeshTopoAlgorithm& topalg)
+      : _mesh(mesh), _topalg(topalg), _maxCost(DBL_MAX)
+    {
+    }
+
+    void Setup(bool keepBoundary, float featureAngle, float maxError);
+    /* Sorts the facets into \a slabs slabs along the longest side of the bounding box.
+     * A point belongs to a slab if all its facets do, otherwise it's at the border. With
+     * an \a offset of 0.5 the borders are in the middle of the slabs of offset 0 and
+     * there is one slab more. Returns false if the mesh is flat. */
+    bool SetupSlabs(int slabs, float offset);
+    /* Collapses edges of the slab or of the whole mesh if \a slab is negative
+     * until \a goal facets are removed and returns the number of removed facets. */
+    unsigned long CollapseEdges(int slab, unsigned long goal);
+
+    int CountSlabs() const
+    { return static_cast<int>(_slabFacets.size()); }
+    /* The number of facets of the slab before the decimation */
+    unsigned long CountSlabFacets(int slab) const
+    { return _slabFacets[slab]; }
+    /* The number of facets of the slab that are left */
+    unsigned long CountValidSlabFacets(int slab) const
+    { return _slabValidFacets[slab]; }
+
+private:
+    Base::Vector3d Point(unsigned long p) const
+    {
+        const MeshPoint& pt = _mesh.GetPoints()[p];
+        return Base::Vector3d(pt.x, pt.y, pt.z);
+    }
+    Base::Vector3d Normal(unsigned long f) const
+    {
+        const MeshFacet& face = _mesh.GetFacets()[f];
+        Base::Vector3d p0 = Point(face._aulPoints[0]);
+        return (Point(face._aulPoints[1]) - p0) % (Point(face._aulPoints[2]) - p0);
+    }
+    bool IsEligible(unsigned long p, int slab) const
+    {
+        return slab < 0 || _pointSlab[p] == slab;
+    }
+    void AddEdgePlane(unsigned long f, unsigned short side);
+    void GetRing(unsigned long p, std::vector<unsigned long>& ring) const;
+    bool Placement(unsigned long p0, unsigned long p1, Base::Vector3d& pos,
+                   unsigned long& from, unsigned long& to, double& cost) const;
+    void Push(CollapseQueue& queue, unsigned long p0, unsigned long p1) const;
+    unsigned long TryCollapse(unsigned long p0, unsigned long p1, int slab,
+                              CollapseQueue& queue, Scratch& s);
+
+private:
+    MeshKernel& _mesh;
+    MeshTopoAlgorithm& _topalg;
+    double _maxCost;
+    std::vector<Quadric> _quadrics;
+    std::vector<std::vector<unsigned long> > _pointFacets;
+    std::vector<unsigned int> _stamps;
+    std::vector<char> _boundary;
+    std::vector<char> _locked;
+    std::vector<char> _rejected;
+    std::vector<float> _facetCenter;
+    std::vector<int> _facetSlab;
+    std::vector<int> _pointSlab;
+    std::vector<std::vector<unsigned long> > _slabPoints;
+    std::vector<unsigned long> _slabFacets;
+    std::vector<unsigned long> _slabValidFacets;
+};
+
+void Decimator::AddEdgePlane(unsigned long f, unsigned short side)
+{
+    // plane through the edge and perpendicular to the facet
+    const MeshFacet& face = _mesh.GetFacets()[f];
+    unsigned long p0 = face._aulPoints[side];
+    unsigned long p1 = face._aulPoints[(side+1)%3];
+    Base::Vector3d base = Point(p0);
+    Base::Vector3d normal = (Point(p1) - base) % Normal(f);
+    double len = normal.Length();
+    if (len <= 0.0)
+        return;
+    normal = normal / len;
+    double d = -(normal * base);
+    _quadrics[p0].AddPlane(normal, d);
+    _quadrics[p1].AddPlane(normal, d);
+}
+
+void Decimator::Setup(bool keepBoundary, float featureAngle, float maxError)
+{
+    const MeshFacetArray& facets = _mesh.GetFacets();
+    unsigned long countPoints = _mesh.CountPoints();
+    unsigned long countFacets = facets.size();
+    if (maxError >= 0.0f)
+        _maxCost = static_cast<double>(maxError) * static_cast<double>(maxError);
+
+    _quadrics.resize(countPoints);
+    _stamps.resize(countPoints, 0);
+    _boundary.resize(countPoints, 0);
+    _rejected.resize(countPoints, 0);
+
+    std::vector<unsigned long> valence(countPoints, 0);
+    for (unsigned long f = 0; f < countFacets; f++) {
+        for (int i = 0; i < 3; i++)
+            valence[facets[f]._aulPoints[i]]++;
+    }
+    _pointFacets.resize(countPoints);
+    for (unsigned long p = 0; p < countPoints; p++)
+        _pointFacets[p].reserve(valence[p]);
+
+    double cosFeature = cos(featureAngle);
+    bool features = featureAngle > 0.0f && featureAngle < F_PI;
+    for (unsigned long f = 0; f < countFacets; f++) {
+        const MeshFacet& face = facets[f];
+        for (int i = 0; i < 3; i++)
+            _pointFacets[face._aulPoints[i]].push_back(f);
+
+        Base::Vector3d normal = Normal(f);
+        double len = normal.Length();
+        if (len > 0.0) {
+            normal = normal / len;
+            double d = -(normal * Point(face._aulPoints[0]));
+            for (int i = 0; i < 3; i++)
+                _quadrics[face._aulPoints[i]].AddPlane(normal, d);
+        }
+
+        for (unsigned short i = 0; i < 3; i++) {
+            unsigned long n = face._aulNeighbours[i];
+            if (n == ULONG_MAX) {
+                _boundary[face._aulPoints[i]] = 1;
+                _boundary[face._aulPoints[(i+1)%3]] = 1;
+                AddEdgePlane(f, i);
+            }
+            else if (features && n > f) {
+                Base::Vector3d n0 = Normal(f), n1 = Normal(n);
+                double l = n0.Length() * n1.Length();
+                if (l > 0.0 && n0 * n1 < cosFeature * l) {
+                    AddEdgePlane(f, i);
+                    AddEdgePlane(n, facets[n].Side(face));
+                }
+            }
+        }
+    }
+
+    if (keepBoundary)
+        _locked = _boundary;
+    else
+        _locked.resize(countPoints, 0);
+
+    _pointSlab.resize(countPoints, 0);
+}
+
+bool Decimator::SetupSlabs(int slabs, float offset)
+{
+    const MeshFacetArray& facets = _mesh.GetFacets();
+    unsigned long countPoints = _mesh.CountPoints();
+    unsigned long countFacets = facets.size();
+
+    // the position of the facet centers along the longest side of the bounding box,
+    // they are kept from the first call because the points move during the decimation
+    if (_facetCenter.empty()) {
+        Base::BoundBox3f box = _mesh.GetBoundBox();
+        int axis = 0;
+        float len = box.LengthX();
+        if (box.LengthY() > len) {
+            axis = 1;
+            len = box.LengthY();
+        }
+        if (box.LengthZ() > len) {
+            axis = 2;
+            len = box.LengthZ();
+        }
+        if (len <= 0.0f)
+            return false;
+
+        float minValue = axis == 0 ? box.MinX : (axis == 1 ? box.MinY : box.MinZ);
+        _facetCenter.resize(countFacets);
+        for (unsigned long f = 0; f < countFacets; f++) {
+            const MeshFacet& face = facets[f];
+            double center = (Point(face._aulPoints[0])[axis] + Point(face._aulPoints[1])[axis] +
+                             Point(face._aulPoints[2])[axis]) / 3.0;
+            _facetCenter[f] = static_cast<float>((center - minValue) / len);
+        }
+    }
+
+    int count = offset > 0.0f ? slabs + 1 : slabs;
+    _facetSlab.resize(countFacets);
+    _slabFacets.assign(count, 0);
+    _slabValidFacets.assign(count, 0);
+    for (unsigned long f = 0; f < countFacets; f++) {
+        int slab = static_cast<int>(_facetCenter[f] * slabs + offset);
+        slab = std::max<int>(0, std::min<int>(count - 1, slab));
+        _facetSlab[f] = slab;
+        _slabFacets[slab]++;
+        if (facets[f].IsValid())
+            _slabValidFacets[slab]++;
+    }
+
+    _slabPoints.assign(count, std::vector<unsigned long>());
+    for (unsigned long p = 0; p < countPoints; p++) {
+        int slab = -1;
+        const std::vector<unsigned long>& faces = _pointFacets[p];
+        for (std::vector<unsigned long>::const_iterator it = faces.begin(); it != faces.end(); ++it) {
+            if (!facets[*it].IsValid())
+                continue;
+            if (slab < 0) {
+                slab = _facetSlab[*it];
+            }
+            else if (_facetSlab[*it] != slab) {
+                slab = -1;
+                break;
+            }
+        }
+        _pointSlab[p] = slab;
+        if (slab >= 0)
+            _slabPoints[slab].push_back(p);
+    }
+
+    return true;
+}
+
+void Decimator::GetRing(unsigned long p, std::vector<unsigned long>& ring) const
+{
+    const MeshFacetArray& facets = _mesh.GetFacets();
+    ring.clear();
+    const std::vector<unsigned long>& faces = _pointFacets[p];
+    for (std::vector<unsigned long>::const_iterator it = faces.begin(); it != faces.end(); ++it) {
+        const MeshFacet& face = facets[*it];
+        if (!face.IsValid())
+            continue;
+        for (int i = 0; i < 3; i++) {
+            if (face._aulPoints[i] != p)
+                ring.push_back(face._aulPoints[i]);
+        }
+    }
+    std::sort(ring.begin(), ring.end());
+    ring.erase(std::unique(ring.begin(), ring.end()), ring.end());
+}
+
+bool Decimator::Placement(unsigned long p0, unsigned long p1, Base::Vector3d& pos,
+                          unsigned long& from, unsigned long& to, double& cost) const
+{
+    if (_locked[p0] && _locked[p1])
+        return false;
+
+    Quadric q = _quadrics[p0];
+    q += _quadrics[p1];
+    Base::Vector3d v0 = Point(p0);
+    Base::Vector3d v1 = Point(p1);
+    if (_locked[p1]) {
+        to = p1; from = p0;
+        pos = v1;
+    }
+    else {
+        to = p0; from = p1;
+        if (_locked[p0]) {
+            pos = v0;
+        }
+        else {
+            Base::Vector3d mid = 0.5 * (v0 + v1);
+            double e0 = q.Error(v0), e1 = q.Error(v1), em = q.Error(mid);
+            double best = em;
+            pos = mid;
+            if (e0 < best) {
+                best = e0;
+                pos = v0;
+            }
+            if (e1 < best) {
+                best = e1;
+                pos = v1;
+            }
+            // Take the optimum only if it's clearly better. In flat regions or along
+            // feature edges it's not unique and may be far away from the edge.
+            Base::Vector3d opt;
+            if (q.Optimum(opt) && Base::DistanceP2(opt, mid) <= Base::DistanceP2(v0, v1)) {
+                double eo = std::max<double>(0.0, q.Error(opt));
+                if (eo < 0.999 * best)
+                    pos = opt;
+            }
+        }
+    }
+
+    cost = std::max<double>(0.0, q.Error(pos));
+    return true;
+}
+
+void Decimator::Push(CollapseQueue& queue, unsigned long p0, unsigned long p1) const
+{
+    Base::Vector3d pos;
+    unsigned long from, to;
+    Collapse c;
+    if (Placement(p0, p1, pos, from, to, c.cost) && c.cost <= _maxCost) {
+        c.p0 = p0;
+        c.p1 = p1;
+        c.stamp0 = _stamps[p0];
+        c.stamp1 = _stamps[p1];
+        queue.push(c);
+    }
+}
+
+unsigned long Decimator::TryCollapse(unsigned long p0, unsigned long p1, int slab,
+                                     CollapseQueue& queue, Scratch& s)
+{
+    const MeshFacetArray& facets = _mesh.GetFacets();
+    Base::Vector3d pos;
+    unsigned long from, to;
+    double cost;
+    if (!Placement(p0, p1, pos, from, to, cost))
+        return 0;
+
+    // the facets of the edge are removed, the others are kept
+    s.removed.clear();
+    s.kept.clear();
+    const std::vector<unsigned long>& faces0 = _pointFacets[p0];
+    for (std::vector<unsigned long>::const_iterator it = faces0.begin(); it != faces0.end(); ++it) {
+        const MeshFacet& face = facets[*it];
+        if (!face.IsValid())
+            continue;
+        if (face.HasPoint(p1))
+            s.removed.push_back(*it);
+        else
+            s.kept.push_back(*it);
+    }
+    const std::vector<unsigned long>& faces1 = _pointFacets[p1];
+    for (std::vector<unsigned long>::const_iterator it = faces1.begin(); it != faces1.end(); ++it) {
+        const MeshFacet& face = facets[*it];
+        if (face.IsValid() && !face.HasPoint(p0))
+            s.kept.push_back(*it);
+    }
+
+    // An interior edge between two boundary points would pinch the mesh
+    if (s.removed.empty() || s.removed.size() > 2)
+        return 0;
+    if (s.removed.size() == 2 && _boundary[p0] && _boundary[p1])
+        return 0;
+
+    // Link condition: the only common neighbours of both points are the opposite
+    // points of the removed facets, otherwise the mesh becomes non-manifold
+    GetRing(p0, s.ring0);
+    GetRing(p1, s.ring1);
+    s.common.clear();
+    std::set_intersection(s.ring0.begin(), s.ring0.end(), s.ring1.begin(), s.ring1.end(),
+                          std::back_inserter(s.common));
+    s.opposite.clear();
+    for (std::vector<unsigned long>::iterator it = s.removed.begin(); it != s.removed.end(); ++it) {
+        const MeshFacet& face = facets[*it];
+        for (int i = 0; i < 3; i++) {
+            if (face._aulPoints[i] != p0 && face._aulPoints[i] != p1)
+                s.opposite.push_back(face._aulPoints[i]);
+        }
+    }
+    std::sort(s.opposite.begin(), s.opposite.end());
+    if (s.common != s.opposite)
+        return 0;
+
+    s.ring.clear();
+    std::set_union(s.ring0.begin(), s.ring0.end(), s.ring1.begin(), s.ring1.end(),
+                   std::back_inserter(s.ring));
+    s.ring.erase(std::remove(s.ring.begin(), s.ring.end(), p0), s.ring.end());
+    s.ring.erase(std::remove(s.ring.begin(), s.ring.end(), p1), s.ring.end());
+    // e.g. a tetrahedron would collapse into two coincident facets
+    if (s.ring.size() < 3)
+        return 0;
+
+    // none of the remaining facets may flip or degenerate
+    for (std::vector<unsigned long>::iterator it = s.kept.begin(); it != s.kept.end(); ++it) {
+        const MeshFacet& face = facets[*it];
+        Base::Vector3d v0[3], v1[3];
+        for (int i = 0; i < 3; i++) {
+            unsigned long p = face._aulPoints[i];
+            v0[i] = Point(p);
+            v1[i] = (p == p0 || p == p1) ? pos : v0[i];
+        }
+        Base::Vector3d n0 = (v0[1] - v0[0]) % (v0[2] - v0[0]);
+        Base::Vector3d n1 = (v1[1] - v1[0]) % (v1[2] - v1[0]);
+        if (n0 * n1 < MinNormalCosine * n0.Length() * n1.Length())
+            return 0;
+        double q1 = Quality(v1, n1);
+        if (q1 < MinQuality && q1 < Quality(v0, n0))
+            return 0;
+    }
+
+    EdgeCollapse& ec = s.collapse;
+    ec._fromPoint = from;
+    ec._toPoint = to;
+    ec._removeFacets = s.removed;
+    ec._changeFacets.clear();
+    for (std::vector<unsigned long>::iterator it = s.kept.begin(); it != s.kept.end(); ++it) {
+        if (facets[*it].HasPoint(from))
+            ec._changeFacets.push_back(*it);
+    }
+    // the slabs are decimated in parallel and must not write to the shared state of
+    // the topology algorithm, Decimate() cleans up the mesh in any case
+    if (slab < 0)
+        _topalg.CollapseEdge(ec);
+    else
+        MeshTopoAlgorithm::CollapseEdge(_mesh, ec);
+    _mesh.SetPoint(to, Base::Vector3f(static_cast<float>(pos.x),
+                                      static_cast<float>(pos.y),
+                                      static_cast<float>(pos.z)));
+
+    _quadrics[to] += _quadrics[from];
+    _boundary[to] = _boundary[p0] || _boundary[p1];
+    _pointFacets[to].swap(s.kept);
+    std::vector<unsigned long>().swap(_pointFacets[from]);
+    _stamps[to]++;
+    _stamps[from]++;
+
+    // A collapse of an edge at a neighbour that was rejected before may be legal now
+    for (std::vector<unsigned long>::iterator it = s.ring.begin(); it != s.ring.end(); ++it) {
+        if (!IsEligible(*it, slab))
+            continue;
+        if (_rejected[*it]) {
+            _rejected[*it] = 0;
+            _stamps[*it]++;
+            GetRing(*it, s.ring0);
+            for (std::vector<unsigned long>::iterator jt = s.ring0.begin(); jt != s.ring0.end(); ++jt) {
+                if (IsEligible(*jt, slab))
+                    Push(queue, *it, *jt);
+            }
+        }
+        else {
+            Push(queue, to, *it);
+        }
+    }
+
+    return s.removed.size();
+}
+
+unsigned long Decimator::CollapseEdges(int slab, unsigned long goal)
+{
+    const MeshPointArray& points = _mesh.GetPoints();
+    CollapseQueue queue;
+    Scratch s;
+
+    unsigned long count = slab < 0 ? points.size() : _slabPoints[slab].size();
+    for (unsigned long i = 0; i < count; i++) {
+        unsigned long p = slab < 0 ? i : _slabPoints[slab][i];
+        if (!points[p].IsValid())
+            continue;
+        GetRing(p, s.ring);
+        for (std::vector<unsigned long>::iterator it = s.ring.begin(); it != s.ring.end(); ++it) {
+            if (*it > p && IsEligible(*it, slab))
+                Push(queue, p, *it);
+        }
+    }
+
+    unsigned long removed = 0;
+    while (!queue.empty() && removed < goal) {
+        Collapse c = queue.top();
+        queue.pop();
+        if (c.stamp0 != _stamps[c.p0] || c.stamp1 != _stamps[c.p1])
+            continue; // outdated
+        if (!points[c.p0].IsValid() || !points[c.p1].IsValid())
+            continue;
+        unsigned long facets = TryCollapse(c.p0, c.p1, slab, queue, s);
+        if (facets == 0) {
+            _rejected[c.p0] = 1;
+            _rejected[c.p1] = 1;
+        }
+        removed += facets;
+    }
+
+    return removed;
+}
+
+struct SlabTask
+{
+    Decimator* decimator;
+    int slab;
+    unsigned long goal;
+    unsigned long removed;
+};
+
+void DecimateSlab(SlabTask& task)
+{
+    task.removed = task.decimator->CollapseEdges(task.slab, task.goal);
+}
+
+} // namespace
+
+MeshDecimation::MeshDecimation(MeshKernel& mesh)
+  : _mesh(mesh), _targetSize(0), _maxError(-1.0f), _keepBoundary(true),
+    _featureAngle(F_PI/3.0f), _parallel(true)
+{
+}
+
+MeshDecimation::~MeshDecimation()
+{
+}
+
+unsigned long MeshDecimation::Decimate()
+{
+    unsigned long countFacets = _mesh.CountFacets();
+    if (countFacets <= _targetSize)
+        return 0;
+
+    // Narrow slabs with only a few facets left would get elongated facets because no
+    // edge crosses their borders
+    int slabs = 1;
+    int threads = QThread::idealThreadCount();
+    if (_parallel && threads > 1 && countFacets >= MinParallelSize) {
+        slabs = SlabsPerThread * threads;
+        if (_targetSize > 0)
+            slabs = static_cast<int>(std::min<unsigned long>(slabs, _targetSize / MinSlabSize));
+    }
+
+    unsigned long removed = 0;
+    {
+        MeshTopoAlgorithm topalg(_mesh);
+        Decimator decimator(_mesh, topalg);
+        decimator.Setup(_keepBoundary, _featureAngle, _maxError);
+
+        // The slabs are decimated in two rounds with shifted borders, the first removes
+        // half of the share of each slab. So the edges at the borders of the first round
+        // are collapsed in the second one. The last step runs over the whole mesh.
+        double keep = static_cast<double>(_targetSize) / static_cast<double>(countFacets);
+        for (int round = 0; round < 2 && slabs > 1; round++) {
+            if (!decimator.SetupSlabs(slabs, round == 0 ? 0.0f : 0.5f))
+                break;
+            std::vector<SlabTask> tasks(decimator.CountSlabs());
+            for (int i = 0; i < decimator.CountSlabs(); i++) {
+                tasks[i].decimator = &decimator;
+                tasks[i].slab = i;
+                tasks[i].goal = ULONG_MAX;
+                tasks[i].removed = 0;
+                if (_targetSize > 0) {
+                    double all = static_cast<double>(decimator.CountSlabFacets(i));
+                    double left = static_cast<double>(decimator.CountValidSlabFacets(i));
+                    double goal = round == 0 ? 0.5 * (1.0 - keep) * all : left - LastStepShare * keep * all;
+                    tasks[i].goal = static_cast<unsigned long>(std::max<double>(0.0, goal));
+                }
+            }
+            QtConcurrent::blockingMap(tasks, &DecimateSlab);
+            for (std::vector<SlabTask>::iterator it = tasks.begin(); it != tasks.end(); ++it)
+                removed += it->removed;
+        }
+
+        unsigned long goal = ULONG_MAX;
+        if (_targetSize > 0)
+            goal = countFacets - removed > _targetSize ? countFacets - removed - _targetSize : 0;
+        if (goal > 0)
+            removed += decimator.CollapseEdges(-1, goal);
+
+        topalg.Cleanup();
+    }
+
+    // CollapseEdge() doesn't keep the neighbourhood
+    _mesh.RebuildNeighbours();
+    _mesh.RecalcBoundBox();
+    return removed;
+}
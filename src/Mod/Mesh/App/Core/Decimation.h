@@ -0,0 +1,102 @@
+/***************************************************************************
+ *   Copyright (c) 2026 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef MESHCORE_DECIMATION_H
+#define MESHCORE_DECIMATION_H
+
+namespace MeshCore {
+
+class MeshKernel;
+
+/**
+ * The MeshDecimation class reduces the number of facets of a mesh by collapsing edges
+ * in the order of the quadric error metric of Garland and Heckbert. Each point carries
+ * a quadric that sums up the squared distances to the planes of its original facets.
+ * An edge is collapsed into the position that minimizes the sum of the quadrics of its
+ * two points and the edges with the least error are collapsed first. The collapses are
+ * done with MeshTopoAlgorithm::CollapseEdge(). Collapses that would make the mesh
+ * non-manifold or flip a facet are rejected.
+ *
+ * Boundary edges and feature edges, i.e. edges whose facets enclose an angle above a
+ * limit, add planes perpendicular to their facets to the quadrics of their points so
+ * that moving the points away from these edges is penalized. Optionally the points at
+ * the boundary are not touched at all.
+ *
+ * Large meshes are split into slabs that are decimated in parallel first. In this step
+ * only edges whose points have all their facets in the same slab are collapsed. The
+ * remaining edges along the borders of the slabs are handled afterwards.
+ */
+class MeshExport MeshDecimation
+{
+public:
+    /// Construction
+    MeshDecimation(MeshKernel& mesh);
+    /// Destruction
+    ~MeshDecimation();
+
+    /** @name Settings */
+    //@{
+    /** Stops when the mesh has \a count facets or less. With 0, the default, only
+     * the maximum error limits the decimation.
+     */
+    void SetTargetSize(unsigned long count)
+    { _targetSize = count; }
+    /** Doesn't collapse edges whose error exceeds \a dist. The error is the square root
+     * of the quadric error, i.e. roughly the distance to the planes of the original facets.
+     * A negative value, the default, means no limit.
+     */
+    void SetMaxError(float dist)
+    { _maxError = dist; }
+    /** If true, the default, the points at the boundary are neither moved nor removed. */
+    void SetKeepBoundary(bool on)
+    { _keepBoundary = on; }
+    /** Edges whose facets enclose an angle of more than \a angle (radian) are preserved
+     * like boundary edges. The default is 60 degree.
+     */
+    void SetFeatureAngle(float angle)
+    { _featureAngle = angle; }
+    /** If true, the default, the slabs of large meshes are decimated in several threads. */
+    void SetParallel(bool on)
+    { _parallel = on; }
+    //@}
+
+    /** Decimates the mesh and returns the number of removed facets. Afterwards the mesh
+     * structure is cleaned up and the neighbourhood is rebuilt.
+     */
+    unsigned long Decimate();
+
+private:
+    MeshDecimation(const MeshDecimation&);
+    void operator = (const MeshDecimation&);
+
+    MeshKernel& _mesh;
+    unsigned long _targetSize;
+    float _maxError;
+    bool _keepBoundary;
+    float _featureAngle;
+    bool _parallel;
+};
+
+} // namespace MeshCore
+
+#endif // MESHCORE_DECIMATION_H
@@ -37,6 +37,7 @@
 #include "Info.h"
 #include "Grid.h"
 #include "TopoAlgorithm.h"
+#include "Parallel.h"
 
 #include <boost/math/special_functions/fpclassify.hpp>
 #include <Base/Sequencer.h>
@@ -139,7 +140,8 @@ bool MeshEvalDuplicatePoints::Evaluate()
     }
 
     // if there are two adjacent vertices which have the same coordinates
-    std::sort(vertices.begin(), vertices.end(), Vertex_Less());
+    MeshParallelSort<std::vector<VertexIterator>::iterator, Vertex_Less>::Sort
+        (vertices.begin(), vertices.end(), Vertex_Less());
     if (std::adjacent_find(vertices.begin(), vertices.end(), Vertex_EqualTo()) < vertices.end() )
         return false;
     return true;
@@ -160,7 +162,8 @@ std::vector<unsigned long> MeshEvalDuplicatePoints::GetIndices() const
     // if there are two adjacent vertices which have the same coordinates
     std::vector<unsigned long> aInds;
     Vertex_EqualTo pred;
-    std::sort(vertices.begin(), vertices.end(), Vertex_Less());
+    MeshParallelSort<std::vector<VertexIterator>::iterator, Vertex_Less>::Sort
+        (vertices.begin(), vertices.end(), Vertex_Less());
 
     std::vector<VertexIterator>::iterator vt = vertices.begin();
     while (vt < vertices.end()) {
@@ -189,7 +192,8 @@ bool MeshFixDuplicatePoints::Fixup()
 
     // get the indices of adjacent vertices which have the same coordinates
     std::vector<unsigned long> aInds;
-    std::sort(vertices.begin(), vertices.end(), Vertex_Less());
+    MeshParallelSort<std::vector<VertexIterator>::iterator, Vertex_Less>::Sort
+        (vertices.begin(), vertices.end(), Vertex_Less());
 
     Vertex_EqualTo pred;
     std::vector<VertexIterator>::iterator next = vertices.begin();
@@ -341,14 +345,21 @@ struct MeshFacet_EqualTo  : public std::binary_function<const FaceIterator&,
 
 bool MeshEvalDuplicateFacets::Evaluate()
 {
-  std::set<FaceIterator, MeshFacet_Less> aFaces;
+  // sorting a vector is much faster than inserting into a set
   const MeshFacetArray& rFaces = _rclMesh.GetFacets();
+  std::vector<FaceIterator> aFaces;
+  aFaces.reserve(rFaces.size());
   for (MeshFacetArray::_TConstIterator it = rFaces.begin(); it != rFaces.end(); ++it)
+    aFaces.push_back(it);
+
+  // two facets are duplicates if the first is not less than the second
+  MeshFacet_Less less;
+  MeshParallelSort<std::vector<FaceIterator>::iterator, MeshFacet_Less>::Sort
+      (aFaces.begin(), aFaces.end(), less);
+  for (std::vector<FaceIterator>::size_type i = 1; i < aFaces.size(); i++)
   {
-    std::pair<std::set<FaceIterator, MeshFacet_Less>::iterator, bool>
-        pI = aFaces.insert(it);
-    if (!pI.second)
-        return false;
+    if (!less(aFaces[i-1], aFaces[i]))
+      return false;
   }
 
   return true;
@@ -367,7 +378,8 @@ std::vector<unsigned long> MeshEvalDuplicateFacets::GetIndices() const
     // if there are two adjacent faces which references the same vertices
     std::vector<unsigned long> aInds;
     MeshFacet_EqualTo pred;
-    std::sort(faces.begin(), faces.end(), MeshFacet_Less());
+    MeshParallelSort<std::vector<FaceIterator>::iterator, MeshFacet_Less>::Sort
+        (faces.begin(), faces.end(), MeshFacet_Less());
 
     std::vector<FaceIterator>::iterator ft = faces.begin();
     while (ft < faces.end()) {
@@ -32,15 +32,26 @@
 #include <Mod/Mesh/App/WildMagic4/Wm4Vector3.h>
 
 #include "Evaluation.h"
+#include "Degeneration.h"
 #include "Iterator.h"
 #include "Algorithm.h"
 #include "Approximation.h"
 #include "MeshIO.h"
 #include "Helpers.h"
+#include "FacetBatch.h"
 #include "Grid.h"
 #include "TopoAlgorithm.h"
+#include "Parallel.h"
 #include <Base/Matrix.h>
 
+#include <QAtomicInt>
+#include <QFuture>
+#include <QList>
+#include <QThread>
+#include <QtConcurrentRun>
+#include <boost/bind.hpp>
+
+#include <Base/Exception.h>
 #include <Base/Sequencer.h>
 
 using namespace MeshCore;
@@ -350,7 +361,8 @@ bool MeshEvalTopology::Evaluate ()
     }
 
     // sort the edges
-    std::sort(edges.begin(), edges.end(), Edge_Less());
+    MeshParallelSort<std::vector<Edge_Index>::iterator, Edge_Less>::Sort
+        (edges.begin(), edges.end(), Edge_Less());
 
     // search for non-manifold edges
     unsigned long p0 = ULONG_MAX, p1 = ULONG_MAX;
@@ -587,48 +599,135 @@ bool MeshFixSingleFacet::Fixup ()
 
 // ----------------------------------------------------------------
 
-bool MeshEvalSelfIntersection::Evaluate ()
+namespace MeshCore {
+
+/*
+ * The grid cells are checked in chunks of about the same amount of work by several threads.
+ * The calling thread takes part in the computation and reports the progress. The results of
+ * each chunk are kept apart so that they can be put together in the order of the cells.
+ */
+class SelfIntersectionCheck
 {
-    // Contains bounding boxes for every facet 
-    std::vector<Base::BoundBox3f> boxes;
+public:
+    typedef std::vector<std::pair<unsigned long, unsigned long> > Pairs;
 
-    // Splits the mesh using grid for speeding up the calculation
-    MeshFacetGrid cMeshFacetGrid(_rclMesh);
-    const MeshFacetArray& rFaces = _rclMesh.GetFacets();
-    MeshGridIterator clGridIter(cMeshFacetGrid);
-    unsigned long ulGridX, ulGridY, ulGridZ;
-    cMeshFacetGrid.GetCtGrids(ulGridX, ulGridY, ulGridZ);
+    SelfIntersectionCheck(const MeshKernel& mesh, bool all)
+      : mesh(mesh), grid(mesh), all(all), nextChunk(0), doneChunks(0), found(0), canceled(0)
+    {
+        MeshFacetIterator cMFI(mesh);
+        boxes.reserve(mesh.CountFacets());
+        for (cMFI.Begin(); cMFI.More(); cMFI.Next())
+            boxes.push_back((*cMFI).GetBoundBox());
+
+        // the effort of a cell grows with the square of its elements
+        unsigned long ulGridX, ulGridY, ulGridZ;
+        grid.GetCtGrids(ulGridX, ulGridY, ulGridZ);
+        unsigned long ulCells = ulGridX * ulGridY * ulGridZ;
+        double total = 0.0;
+        std::vector<double> effort(ulCells);
+        for (unsigned long i = 0; i < ulCells; i++) {
+            unsigned long x, y, z;
+            grid.GetPositionToIndex(i, x, y, z);
+            double ct = grid.GetCtElements(x, y, z);
+            effort[i] = ct * ct;
+            total += effort[i];
+        }
 
-    MeshFacetIterator cMFI(_rclMesh);
-    for (cMFI.Begin(); cMFI.More(); cMFI.Next()) {
-        boxes.push_back((*cMFI).GetBoundBox());
+        int numChunks = 16 * std::max<int>(1, QThread::idealThreadCount());
+        double perChunk = total / numChunks;
+        double sum = 0.0;
+        chunks.push_back(0);
+        for (unsigned long i = 0; i < ulCells; i++) {
+            sum += effort[i];
+            if (sum >= perChunk && i + 1 < ulCells) {
+                chunks.push_back(i + 1);
+                sum = 0.0;
+            }
+        }
+        chunks.push_back(ulCells);
+        results.resize(chunks.size() - 1);
     }
 
-    // Calculates the intersections
-    Base::SequencerLauncher seq("Checking for self-intersections...", ulGridX*ulGridY*ulGridZ);
-    for (clGridIter.Init(); clGridIter.More(); clGridIter.Next()) {
-        //Get the facet indices, belonging to the current grid unit
-        std::vector<unsigned long> aulGridElements;
-        clGridIter.GetElements(aulGridElements);
+    int countChunks() const
+    {
+        return static_cast<int>(results.size());
+    }
+    int countDoneChunks() const
+    {
+        return (int)doneChunks;
+    }
+    bool hasIntersections() const
+    {
+        return (int)found != 0;
+    }
+    void cancel()
+    {
+        canceled = 1;
+    }
 
-        seq.next();
-        if (aulGridElements.size()==0)
-            continue;
+    /// Processes the next chunk and returns false if there is nothing left to do.
+    bool processChunk()
+    {
+        if ((int)canceled || (!all && (int)found))
+            return false;
+        int chunk = nextChunk.fetchAndAddRelaxed(1);
+        if (chunk >= countChunks())
+            return false;
+
+        std::vector<unsigned long> elements;
+        for (unsigned long cell = chunks[chunk]; cell < chunks[chunk+1]; cell++) {
+            elements.clear();
+            unsigned long x, y, z;
+            grid.GetPositionToIndex(cell, x, y, z);
+            grid.GetElements(x, y, z, elements);
+            checkCell(elements, results[chunk]);
+            if (!results[chunk].empty()) {
+                found = 1;
+                if (!all)
+                    break;
+            }
+        }
 
+        doneChunks.ref();
+        return true;
+    }
+
+    /// Worker thread
+    void run()
+    {
+        while (processChunk()) {
+        }
+    }
+
+    /// Appends the intersecting pairs of all chunks in the order of the cells.
+    void getIntersections(Pairs& intersection) const
+    {
+        for (std::vector<Pairs>::const_iterator it = results.begin(); it != results.end(); ++it)
+            intersection.insert(intersection.end(), it->begin(), it->end());
+    }
+
+private:
+    void checkCell(const std::vector<unsigned long>& aulGridElements, Pairs& pairs) const
+    {
+        const MeshFacetArray& rFaces = mesh.GetFacets();
         MeshGeomFacet facet1, facet2;
         Base::Vector3f pt1, pt2;
-        for (std::vector<unsigned long>::iterator it = aulGridElements.begin(); it != aulGridElements.end(); ++it) {
-            const Base::BoundBox3f& box1 = boxes[*it];
-            cMFI.Set(*it);
-            facet1 = *cMFI;
-            const MeshFacet& rface1 = rFaces[*it];
-            for (std::vector<unsigned long>::iterator jt = it; jt != aulGridElements.end(); ++jt) {
-                if (jt == it) // the identical facet
-                    continue;
+        // skip the pairs whose planes certainly separate them with a few SSE2 instructions
+        MeshFacetBatch batch;
+        batch.Assign(mesh, aulGridElements);
+        std::vector<unsigned long> candidates;
+        for (unsigned long i = 0; i < aulGridElements.size(); i++) {
+            unsigned long index1 = aulGridElements[i];
+            const Base::BoundBox3f& box1 = boxes[index1];
+            facet1 = mesh.GetFacet(index1);
+            const MeshFacet& rface1 = rFaces[index1];
+            batch.FilterIntersections(facet1, i + 1, candidates);
+            for (std::vector<unsigned long>::iterator jt = candidates.begin(); jt != candidates.end(); ++jt) {
+                unsigned long index2 = aulGridElements[*jt];
                 // If the facets share a common vertex we do not check for self-intersections because they 
                 // could but usually do not intersect each other and the algorithm below would detect false-positives,
                 // otherwise
-                const MeshFacet& rface2 = rFaces[*jt];
+                const MeshFacet& rface2 = rFaces[index2];
                 if (rface1._aulPoints[0] == rface2._aulPoints[0] || 
                     rface1._aulPoints[0] == rface2._aulPoints[1] ||
                     rface1._aulPoints[0] == rface2._aulPoints[2])
@@ -642,21 +741,69 @@ bool MeshEvalSelfIntersection::Evaluate ()
                     rface1._aulPoints[2] == rface2._aulPoints[2])
                     continue; // ignore facets sharing a common vertex
 
-                const Base::BoundBox3f& box2 = boxes[*jt];
+                const Base::BoundBox3f& box2 = boxes[index2];
                 if (box1 && box2) {
-                    cMFI.Set(*jt);
-                    facet2 = *cMFI;
+                    facet2 = mesh.GetFacet(index2);
                     int ret = facet1.IntersectWithFacet(facet2, pt1, pt2);
                     if (ret == 2) {
+                        pairs.push_back(std::make_pair(index1,index2));
                         // abort after the first detected self-intersection
-                        return false;
+                        if (!all)
+                            return;
                     }
                 }
             }
         }
     }
 
-    return true;
+private:
+    const MeshKernel& mesh;
+    MeshFacetGrid grid;
+    std::vector<Base::BoundBox3f> boxes;
+    std::vector<unsigned long> chunks; /**< The first cell of each chunk. */
+    std::vector<Pairs> results;
+    bool all;
+    QAtomicInt nextChunk;
+    QAtomicInt doneChunks;
+    QAtomicInt found;
+    QAtomicInt canceled;
+};
+
+void RunSelfIntersectionCheck(SelfIntersectionCheck& check, bool canAbort)
+{
+    int numThreads = std::max<int>(1, QThread::idealThreadCount());
+    numThreads = std::min<int>(numThreads, check.countChunks());
+    QList< QFuture<void> > workers;
+    for (int i = 1; i < numThreads; i++)
+        workers.append(QtConcurrent::run(boost::bind(&SelfIntersectionCheck::run, &check)));
+
+    Base::SequencerLauncher seq("Checking for self-intersections...", check.countChunks());
+    try {
+        int reported = 0;
+        while (check.processChunk()) {
+            for (int done = check.countDoneChunks(); reported < done; reported++)
+                seq.next(canAbort);
+        }
+    }
+    catch (...) {
+        check.cancel();
+        for (QList< QFuture<void> >::iterator it = workers.begin(); it != workers.end(); ++it)
+            it->waitForFinished();
+        throw;
+    }
+
+    for (QList< QFuture<void> >::iterator it = workers.begin(); it != workers.end(); ++it)
+        it->waitForFinished();
+}
+
+}
+
+bool MeshEvalSelfIntersection::Evaluate ()
+{
+    // Splits the mesh using grid for speeding up the calculation
+    SelfIntersectionCheck check(_rclMesh, false);
+    RunSelfIntersectionCheck(check, false);
+    return !check.hasIntersections();
 }
 
 void MeshEvalSelfIntersection::GetIntersections(const std::vector<std::pair<unsigned long, unsigned long> >& indices,
@@ -685,73 +832,10 @@ void MeshEvalSelfIntersection::GetIntersections(const std::vector<std::pair<unsi
 
 void MeshEvalSelfIntersection::GetIntersections(std::vector<std::pair<unsigned long, unsigned long> >& intersection) const
 {
-    // Contains bounding boxes for every facet 
-    std::vector<Base::BoundBox3f> boxes;
-    //intersection.clear();
-
     // Splits the mesh using grid for speeding up the calculation
-    MeshFacetGrid cMeshFacetGrid(_rclMesh);
-    const MeshFacetArray& rFaces = _rclMesh.GetFacets();
-    MeshGridIterator clGridIter(cMeshFacetGrid);
-    unsigned long ulGridX, ulGridY, ulGridZ;
-    cMeshFacetGrid.GetCtGrids(ulGridX, ulGridY, ulGridZ);
-
-    MeshFacetIterator cMFI(_rclMesh);
-    for(cMFI.Begin(); cMFI.More(); cMFI.Next()) {
-        boxes.push_back((*cMFI).GetBoundBox());
-    }
-
-    // Calculates the intersections
-    Base::SequencerLauncher seq("Checking for self-intersections...", ulGridX*ulGridY*ulGridZ);
-    for (clGridIter.Init(); clGridIter.More(); clGridIter.Next()) {
-        //Get the facet indices, belonging to the current grid unit
-        std::vector<unsigned long> aulGridElements;
-        clGridIter.GetElements(aulGridElements);
-
-        seq.next(true);
-        if (aulGridElements.size()==0)
-            continue;
-
-        MeshGeomFacet facet1, facet2;
-        Base::Vector3f pt1, pt2;
-        for (std::vector<unsigned long>::iterator it = aulGridElements.begin(); it != aulGridElements.end(); ++it) {
-            const Base::BoundBox3f& box1 = boxes[*it];
-            cMFI.Set(*it);
-            facet1 = *cMFI;
-            const MeshFacet& rface1 = rFaces[*it];
-            for (std::vector<unsigned long>::iterator jt = it; jt != aulGridElements.end(); ++jt) {
-                if (jt == it) // the identical facet
-                    continue;
-                // If the facets share a common vertex we do not check for self-intersections because they 
-                // could but usually do not intersect each other and the algorithm below would detect false-positives,
-                // otherwise
-                const MeshFacet& rface2 = rFaces[*jt];
-                if (rface1._aulPoints[0] == rface2._aulPoints[0] || 
-                    rface1._aulPoints[0] == rface2._aulPoints[1] ||
-                    rface1._aulPoints[0] == rface2._aulPoints[2])
-                    continue; // ignore facets sharing a common vertex
-                if (rface1._aulPoints[1] == rface2._aulPoints[0] || 
-                    rface1._aulPoints[1] == rface2._aulPoints[1] ||
-                    rface1._aulPoints[1] == rface2._aulPoints[2])
-                    continue; // ignore facets sharing a common vertex
-                if (rface1._aulPoints[2] == rface2._aulPoints[0] || 
-                    rface1._aulPoints[2] == rface2._aulPoints[1] ||
-                    rface1._aulPoints[2] == rface2._aulPoints[2])
-                    continue; // ignore facets sharing a common vertex
-
-                const Base::BoundBox3f& box2 = boxes[*jt];
-                if (box1 && box2) {
-                    cMFI.Set(*jt);
-                    facet2 = *cMFI;
-                    int ret = facet1.IntersectWithFacet(facet2, pt1, pt2);
-                    if (ret == 2) {
-                        intersection.push_back(std::make_pair
-                            <unsigned long, unsigned long>(*it,*jt));
-                    }
-                }
-            }
-        }
-    }
+    SelfIntersectionCheck check(_rclMesh, true);
+    RunSelfIntersectionCheck(check, true);
+    check.getIntersections(intersection);
 }
 
 bool MeshFixSelfIntersection::Fixup()
@@ -941,75 +1025,109 @@ bool MeshFixNeighbourhood::Fixup()
     return true;
 }
 
-void MeshKernel::RebuildNeighbours (unsigned long index)
-{
-    std::vector<Edge_Index> edges;
-    edges.reserve(3 * (this->_aclFacetArray.size() - index));
+namespace MeshCore {
 
-    // build up an array of edges
-    MeshFacetArray::_TConstIterator pI;
-    MeshFacetArray::_TConstIterator pB = this->_aclFacetArray.begin();
-    for (pI = pB + index; pI != this->_aclFacetArray.end(); pI++) {
-        for (int i = 0; i < 3; i++) {
-            Edge_Index item;
-            item.p0 = std::min<unsigned long>(pI->_aulPoints[i], pI->_aulPoints[(i+1)%3]);
-            item.p1 = std::max<unsigned long>(pI->_aulPoints[i], pI->_aulPoints[(i+1)%3]);
-            item.f  = pI - pB;
-            edges.push_back(item);
+// A part of the facets whose edges are collected or a part of the sorted edges whose
+// neighbourhood is set. The parts are processed in several threads.
+struct Edge_Part
+{
+    MeshFacetArray* facets;
+    Edge_Index* edges;
+    unsigned long begin, end, offset;
+};
+
+static void Edge_Collect(Edge_Part& part)
+{
+    const MeshFacetArray& rFacets = *part.facets;
+    Edge_Index* item = part.edges + 3 * (part.begin - part.offset);
+    for (unsigned long f = part.begin; f < part.end; f++) {
+        const MeshFacet& rFace = rFacets[f];
+        for (int i = 0; i < 3; i++, item++) {
+            item->p0 = std::min<unsigned long>(rFace._aulPoints[i], rFace._aulPoints[(i+1)%3]);
+            item->p1 = std::max<unsigned long>(rFace._aulPoints[i], rFace._aulPoints[(i+1)%3]);
+            item->f  = f;
         }
     }
+}
 
-    // sort the edges
-    std::sort(edges.begin(), edges.end(), Edge_Less());
-
-    unsigned long p0 = ULONG_MAX, p1 = ULONG_MAX;
-    unsigned long f0 = ULONG_MAX, f1 = ULONG_MAX;
-    int count = 0;
-    std::vector<Edge_Index>::iterator pE;
-    for (pE = edges.begin(); pE != edges.end(); pE++) {
-        if (p0 == pE->p0 && p1 == pE->p1) {
-            f1 = pE->f;
-            count++;
+static void Edge_Connect(Edge_Part& part)
+{
+    MeshFacetArray& rFacets = *part.facets;
+    Edge_Index* pE = part.edges + part.begin;
+    Edge_Index* pEnd = part.edges + part.end;
+    while (pE != pEnd) {
+        Edge_Index* pN = pE + 1;
+        while (pN != pEnd && pN->p0 == pE->p0 && pN->p1 == pE->p1)
+            pN++;
+
+        // we handle only the cases for 1 and 2, for all higher
+        // values we have a non-manifold that is ignorned here
+        if (pN - pE == 2) {
+            MeshFacet& rFace0 = rFacets[pE[0].f];
+            MeshFacet& rFace1 = rFacets[pE[1].f];
+            unsigned short side0 = rFace0.Side(pE->p0,pE->p1);
+            unsigned short side1 = rFace1.Side(pE->p0,pE->p1);
+            rFace0._aulNeighbours[side0] = pE[1].f;
+            rFace1._aulNeighbours[side1] = pE[0].f;
         }
-        else {
-            // we handle only the cases for 1 and 2, for all higher
-            // values we have a non-manifold that is ignorned here
-            if (count == 2) {
-                MeshFacet& rFace0 = this->_aclFacetArray[f0];
-                MeshFacet& rFace1 = this->_aclFacetArray[f1];
-                unsigned short side0 = rFace0.Side(p0,p1);
-                unsigned short side1 = rFace1.Side(p0,p1);
-                rFace0._aulNeighbours[side0] = f1;
-                rFace1._aulNeighbours[side1] = f0;
-            }
-            else if (count == 1) {
-                MeshFacet& rFace = this->_aclFacetArray[f0];
-                unsigned short side = rFace.Side(p0,p1);
-                rFace._aulNeighbours[side] = ULONG_MAX;
-            }
-
-            p0 = pE->p0;
-            p1 = pE->p1;
-            f0 = pE->f;
-            count = 1;
+        else if (pN - pE == 1) {
+            MeshFacet& rFace = rFacets[pE->f];
+            unsigned short side = rFace.Side(pE->p0,pE->p1);
+            rFace._aulNeighbours[side] = ULONG_MAX;
         }
+
+        pE = pN;
     }
+}
 
-    // we handle only the cases for 1 and 2, for all higher
-    // values we have a non-manifold that is ignorned here
-    if (count == 2) {
-        MeshFacet& rFace0 = this->_aclFacetArray[f0];
-        MeshFacet& rFace1 = this->_aclFacetArray[f1];
-        unsigned short side0 = rFace0.Side(p0,p1);
-        unsigned short side1 = rFace1.Side(p0,p1);
-        rFace0._aulNeighbours[side0] = f1;
-        rFace1._aulNeighbours[side1] = f0;
+}
+
+void MeshKernel::RebuildNeighbours (unsigned long index)
+{
+    ClearIndex();
+    unsigned long ulCtFacets = this->_aclFacetArray.size();
+    if (index >= ulCtFacets)
+        return;
+
+    // split the work into parts for several threads
+    unsigned long ulCtEdges = 3 * (ulCtFacets - index);
+    unsigned long ulParts = (ulCtEdges < 0x10000) ? 1 : std::max<int>(1, QThread::idealThreadCount());
+    std::vector<Edge_Index> edges(ulCtEdges);
+    std::vector<Edge_Part> parts(ulParts);
+    for (unsigned long i = 0; i < ulParts; i++) {
+        parts[i].facets = &this->_aclFacetArray;
+        parts[i].edges = &edges[0];
+        parts[i].begin = index + ((ulCtFacets - index) * i) / ulParts;
+        parts[i].end = index + ((ulCtFacets - index) * (i + 1)) / ulParts;
+        parts[i].offset = index;
     }
-    else if (count == 1) {
-        MeshFacet& rFace = this->_aclFacetArray[f0];
-        unsigned short side = rFace.Side(p0,p1);
-        rFace._aulNeighbours[side] = ULONG_MAX;
+
+    // build up an array of edges
+    if (ulParts > 1)
+        QtConcurrent::blockingMap(parts, &Edge_Collect);
+    else
+        Edge_Collect(parts.front());
+
+    // sort the edges
+    MeshParallelSort<std::vector<Edge_Index>::iterator, Edge_Less>::Sort
+        (edges.begin(), edges.end(), Edge_Less());
+
+    // each part must start with a new edge so that the parts can be handled independently
+    for (unsigned long i = 0; i < ulParts; i++) {
+        unsigned long pos = (ulCtEdges * i) / ulParts;
+        while (pos > 0 && pos < ulCtEdges &&
+               edges[pos].p0 == edges[pos-1].p0 && edges[pos].p1 == edges[pos-1].p1)
+            pos++;
+        parts[i].begin = pos;
+        if (i > 0)
+            parts[i-1].end = pos;
     }
+    parts.back().end = ulCtEdges;
+
+    if (ulParts > 1)
+        QtConcurrent::blockingMap(parts, &Edge_Connect);
+    else
+        Edge_Connect(parts.front());
 }
 
 void MeshKernel::RebuildNeighbours (void)
@@ -1161,3 +1279,127 @@ void MeshEigensystem::CalculateLocalSystem()
     if ((_cU%_cV)*_cW < 0.0f)
         _cW = -_cW; // make a right-handed system
 }
+
+// ----------------------------------------------------------------
+
+MeshEvalAll::Report::Report()
+  : complete(false), indices(false), orientation(false), nonManifolds(false), degenerations(false)
+  , duplicatedFacets(false), duplicatedPoints(false), selfIntersections(false), folds(false)
+{
+}
+
+namespace MeshCore {
+
+// A check of MeshEvalAll that runs in a thread of its own
+struct EvalAll_Task
+{
+    bool (*check)(const MeshKernel&);
+    const MeshKernel* mesh;
+    bool* result;
+    std::string* error;
+};
+
+void EvalAll_Fail(EvalAll_Task& task, const char* msg)
+{
+    *task.result = false;
+    *task.error = (msg && *msg) ? msg : "Unknown exception";
+}
+
+void EvalAll_Run(EvalAll_Task& task)
+{
+    // exceptions must not leave the worker thread, they are recorded in the report
+    try {
+        *task.result = task.check(*task.mesh);
+    }
+    catch (const Base::Exception& e) {
+        EvalAll_Fail(task, e.what());
+    }
+    catch (const std::exception& e) {
+        EvalAll_Fail(task, e.what());
+    }
+    catch (...) {
+        EvalAll_Fail(task, 0);
+    }
+}
+
+bool EvalAll_Indices(const MeshKernel& mesh)
+{
+    return MeshEvalRangeFacet(mesh).Evaluate() && MeshEvalRangePoint(mesh).Evaluate() &&
+           MeshEvalCorruptedFacets(mesh).Evaluate() && MeshEvalNeighbourhood(mesh).Evaluate();
+}
+
+bool EvalAll_Orientation(const MeshKernel& mesh)
+{
+    return MeshEvalOrientation(mesh).Evaluate();
+}
+
+bool EvalAll_NonManifolds(const MeshKernel& mesh)
+{
+    bool ok1 = MeshEvalTopology(mesh).Evaluate();
+    bool ok2 = MeshEvalPointManifolds(mesh).Evaluate();
+    return ok1 && ok2;
+}
+
+bool EvalAll_Degenerations(const MeshKernel& mesh)
+{
+    return MeshEvalDegeneratedFacets(mesh).Evaluate();
+}
+
+bool EvalAll_DuplicatedFacets(const MeshKernel& mesh)
+{
+    return MeshEvalDuplicateFacets(mesh).Evaluate();
+}
+
+bool EvalAll_DuplicatedPoints(const MeshKernel& mesh)
+{
+    return MeshEvalDuplicatePoints(mesh).Evaluate();
+}
+
+bool EvalAll_SelfIntersections(const MeshKernel& mesh)
+{
+    return MeshEvalSelfIntersection(mesh).Evaluate();
+}
+
+bool EvalAll_Folds(const MeshKernel& mesh)
+{
+    bool ok1 = MeshEvalFoldsOnSurface(mesh).Evaluate();
+    bool ok2 = MeshEvalFoldsOnBoundary(mesh).Evaluate();
+    bool ok3 = MeshEvalFoldOversOnSurface(mesh).Evaluate();
+    return ok1 && ok2 && ok3;
+}
+
+}
+
+bool MeshEvalAll::Evaluate ()
+{
+    _report = Report();
+
+    // The checks running in the worker threads must not drive the progress bar,
+    // their sequencers are ignored as long as this one is active
+    Base::SequencerLauncher seq("Checking mesh...", 0);
+
+    // all other checks rely on valid indices
+    EvalAll_Task indices = { &EvalAll_Indices, &_rclMesh, &_report.indices, &_report.errors[Indices] };
+    EvalAll_Run(indices);
+    if (!_report.indices)
+        return false;
+
+    // the most expensive checks come first
+    std::string* errors = _report.errors;
+    EvalAll_Task tasks[] = {
+        { &EvalAll_SelfIntersections, &_rclMesh, &_report.selfIntersections, &errors[SelfIntersections] },
+        { &EvalAll_DuplicatedPoints,  &_rclMesh, &_report.duplicatedPoints,  &errors[DuplicatedPoints]  },
+        { &EvalAll_NonManifolds,      &_rclMesh, &_report.nonManifolds,      &errors[NonManifolds]      },
+        { &EvalAll_DuplicatedFacets,  &_rclMesh, &_report.duplicatedFacets,  &errors[DuplicatedFacets]  },
+        { &EvalAll_Folds,             &_rclMesh, &_report.folds,             &errors[Folds]             },
+        { &EvalAll_Orientation,       &_rclMesh, &_report.orientation,       &errors[Orientation]       },
+        { &EvalAll_Degenerations,     &_rclMesh, &_report.degenerations,     &errors[Degenerations]     }
+    };
+    std::vector<EvalAll_Task> checks(tasks, tasks + sizeof(tasks) / sizeof(tasks[0]));
+    QtConcurrent::blockingMap(checks, &EvalAll_Run);
+
+    _report.complete = true;
+    return _report.orientation && _report.nonManifolds && _report.degenerations &&
+           _report.duplicatedFacets && _report.duplicatedPoints &&
+           _report.selfIntersections && _report.folds;
+}
@@ -26,6 +26,7 @@
 
 #include <list>
 #include <cmath>
+#include <string>
 
 #include "MeshKernel.h"
 #include "Visitor.h"
@@ -379,6 +380,57 @@ private:
   float _fU, _fV, _fW; /**< Expansion in \a u, \a v, and \a w direction of the transformed mesh. */
 };
 
+// ----------------------------------------------------
+
+/**
+ * The MeshEvalAll class runs the checks of the evaluate and repair tools at the same
+ * time in several threads and collects their results in a single report. Only the
+ * Evaluate() methods of the checks are used because unlike some of the GetIndices()
+ * methods they don't change any flags of the mesh.
+ */
+class MeshExport MeshEvalAll : public MeshEvaluation
+{
+public:
+  enum Check { Indices, Orientation, NonManifolds, Degenerations, DuplicatedFacets,
+               DuplicatedPoints, SelfIntersections, Folds, CountChecks };
+
+  /** The results of the checks, true means the mesh passed the check. */
+  struct Report
+  {
+    Report();
+    /** Returns true if \a check stopped with an exception instead of finding a defect. */
+    bool hasError(Check check) const
+    { return !errors[check].empty(); }
+    bool complete;          /**< False if the checks were skipped because of invalid indices. */
+    bool indices;           /**< MeshEvalRangeFacet, MeshEvalRangePoint, MeshEvalCorruptedFacets, MeshEvalNeighbourhood */
+    bool orientation;       /**< MeshEvalOrientation */
+    bool nonManifolds;      /**< MeshEvalTopology, MeshEvalPointManifolds */
+    bool degenerations;     /**< MeshEvalDegeneratedFacets */
+    bool duplicatedFacets;  /**< MeshEvalDuplicateFacets */
+    bool duplicatedPoints;  /**< MeshEvalDuplicatePoints */
+    bool selfIntersections; /**< MeshEvalSelfIntersection */
+    bool folds;             /**< MeshEvalFoldsOnSurface, MeshEvalFoldsOnBoundary, MeshEvalFoldOversOnSurface */
+    /** The message of the exception a check stopped with, e.g. if memory ran out. The check
+     * counts as failed, so the message is the only way to tell it from a defect of the mesh. */
+    std::string errors[CountChecks];
+  };
+
+  MeshEvalAll (const MeshKernel &rclB) : MeshEvaluation(rclB) {}
+  virtual ~MeshEvalAll () {}
+  /**
+   * Runs all checks and returns true if the mesh passed all of them. The indices are
+   * checked first because all other checks rely on them. If they are invalid the other
+   * checks are skipped.
+   */
+  bool Evaluate ();
+  /** Returns the results of the last run. */
+  const Report& GetReport() const
+  { return _report; }
+
+private:
+  Report _report;
+};
+
 } // namespace MeshCore
 
 #endif // MESH_EVALUATION_H
@@ -0,0 +1,498 @@
+/***************************************************************************
+ *   Copyright (c) 2026 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <algorithm>
+# include <cmath>
+# include <limits>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_MSC_VER) && defined(_M_IX86))
+# define MESH_FACETBATCH_SSE2
+# include <emmintrin.h>
+# if defined(_MSC_VER)
+#  include <intrin.h>
+# elif defined(__i386__)
+#  include <cpuid.h>
+# endif
+#endif
+
+#include "FacetBatch.h"
+#include "Elements.h"
+#include "Iterator.h"
+#include "MeshKernel.h"
+
+using namespace MeshCore;
+
+namespace {
+
+/** Shorter lists are passed through, collecting the points wouldn't pay off. */
+const unsigned long MinBatchSize = 8;
+
+/** Same epsilon as in tritritest.h. */
+const float TriTriEpsilon = 0.000001f;
+/** Same epsilon as in MeshGeomFacet::Foraminate(), halved for the filter. */
+const float ParallelEpsilon = 0.5e-06f;
+/** Relative rounding errors tolerated by the line and the distance filter. Both are far
+ * above the errors of the single precision formulas of the filters and the exact methods.
+ */
+const float LineTolerance = 1.0e-05f;
+const float DistanceTolerance = 1.0e-05f;
+/** Minimum of the squared sine of the angle at the first corner of a facet. */
+const float DegeneratedTolerance = 1.0e-04f;
+
+bool HasSSE2()
+{
+#if !defined(MESH_FACETBATCH_SSE2)
+    return false;
+#elif defined(_M_X64) || defined(_M_AMD64) || defined(__x86_64__)
+    return true;
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[3] & (1 << 26)) != 0;
+#elif defined(__i386__)
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return false;
+    return (edx & bit_SSE2) != 0;
+#else
+    return true;
+#endif
+}
+
+const bool CpuHasSSE2 = HasSSE2();
+
+#if defined(MESH_FACETBATCH_SSE2)
+
+inline __m128 Dot(__m128 ax, __m128 ay, __m128 az, __m128 bx, __m128 by, __m128 bz)
+{
+    // same order of the operations as the DOT macro of tritritest.h
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)), _mm_mul_ps(az, bz));
+}
+
+inline __m128 Select(__m128 mask, __m128 a, __m128 b)
+{
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+inline __m128 Abs(__m128 a)
+{
+    return _mm_andnot_ps(_mm_set1_ps(-0.0f), a);
+}
+
+inline __m128 Negate(__m128 a)
+{
+    return _mm_xor_ps(_mm_set1_ps(-0.0f), a);
+}
+
+/** Zeroes the distances below the epsilon like the coplanarity check of tritritest.h. */
+inline __m128 ZeroSmall(__m128 d)
+{
+    return _mm_andnot_ps(_mm_cmple_ps(Abs(d), _mm_set1_ps(TriTriEpsilon)), d);
+}
+
+/** Returns the mask of the lanes where all three distances have the same sign and are not zero. */
+inline __m128 SameSide(__m128 d0, __m128 d1, __m128 d2)
+{
+    __m128 zero = _mm_setzero_ps();
+    return _mm_and_ps(_mm_cmpgt_ps(_mm_mul_ps(d0, d1), zero),
+                      _mm_cmpgt_ps(_mm_mul_ps(d0, d2), zero));
+}
+
+#endif
+
+} // namespace
+
+bool MeshFacetBatch::_enabled = true;
+
+MeshFacetBatch::MeshFacetBatch()
+  : _count(0), _stride(0)
+{
+}
+
+MeshFacetBatch::~MeshFacetBatch()
+{
+}
+
+bool MeshFacetBatch::IsAccelerated()
+{
+    return _enabled && CpuHasSSE2;
+}
+
+void MeshFacetBatch::SetAccelerated(bool on)
+{
+    _enabled = on;
+}
+
+void MeshFacetBatch::Assign(const MeshKernel& mesh, std::vector<unsigned long>::const_iterator first,
+                            std::vector<unsigned long>::const_iterator last)
+{
+    if (!Resize(static_cast<unsigned long>(last - first)))
+        return;
+
+    const MeshPointArray& rPoints = mesh.GetPoints();
+    const MeshFacetArray& rFacets = mesh.GetFacets();
+    for (unsigned long i = 0; i < _count; i++) {
+        const MeshFacet& face = rFacets[first[i]];
+        for (int j = 0; j < 3; j++)
+            SetPoint(i, j, rPoints[face._aulPoints[j]]);
+    }
+    Pad();
+}
+
+void MeshFacetBatch::Assign(MeshFacetIterator& iter, const std::vector<unsigned long>& indices)
+{
+    if (!Resize(static_cast<unsigned long>(indices.size())))
+        return;
+
+    for (unsigned long i = 0; i < _count; i++) {
+        iter.Set(indices[i]);
+        for (int j = 0; j < 3; j++)
+            SetPoint(i, j, iter->_aclPoints[j]);
+    }
+    Pad();
+}
+
+bool MeshFacetBatch::Resize(unsigned long count)
+{
+    _count = count;
+    _stride = 0;
+    _coords.clear();
+    if (_count < MinBatchSize || !IsAccelerated())
+        return false;
+
+    _stride = (_count + 3) & ~3UL;
+    _coords.resize(9 * _stride);
+    return true;
+}
+
+void MeshFacetBatch::SetPoint(unsigned long pos, int corner, const Base::Vector3f& p)
+{
+    _coords[(3 * corner + 0) * _stride + pos] = p.x;
+    _coords[(3 * corner + 1) * _stride + pos] = p.y;
+    _coords[(3 * corner + 2) * _stride + pos] = p.z;
+}
+
+void MeshFacetBatch::Pad()
+{
+    // repeat the last facet so that all lanes hold valid numbers
+    for (unsigned long i = 0; i < 9; i++) {
+        float* plane = &_coords[i * _stride];
+        std::fill(plane + _count, plane + _stride, plane[_count - 1]);
+    }
+}
+
+void MeshFacetBatch::AllPositions(unsigned long first, std::vector<unsigned long>& positions) const
+{
+    positions.clear();
+    for (unsigned long i = first; i < _count; i++)
+        positions.push_back(i);
+}
+
+void MeshFacetBatch::FilterIntersections(const MeshGeomFacet& facet, unsigned long first,
+                                         std::vector<unsigned long>& positions) const
+{
+#if defined(MESH_FACETBATCH_SSE2)
+    if (_coords.empty() || !IsAccelerated()) {
+        AllPositions(first, positions);
+        return;
+    }
+
+    positions.clear();
+    if (first >= _count)
+        return;
+
+    // plane of the facet, see tri_tri_intersect_with_isectline()
+    float V[3][3];
+    for (int i = 0; i < 3; i++) {
+        V[i][0] = facet._aclPoints[i].x;
+        V[i][1] = facet._aclPoints[i].y;
+        V[i][2] = facet._aclPoints[i].z;
+    }
+    float E1[3], E2[3], N1[3];
+    for (int i = 0; i < 3; i++) {
+        E1[i] = V[1][i] - V[0][i];
+        E2[i] = V[2][i] - V[0][i];
+    }
+    N1[0] = E1[1] * E2[2] - E1[2] * E2[1];
+    N1[1] = E1[2] * E2[0] - E1[0] * E2[2];
+    N1[2] = E1[0] * E2[1] - E1[1] * E2[0];
+    float d1 = -(N1[0] * V[0][0] + N1[1] * V[0][1] + N1[2] * V[0][2]);
+
+    __m128 n1x = _mm_set1_ps(N1[0]), n1y = _mm_set1_ps(N1[1]), n1z = _mm_set1_ps(N1[2]);
+    __m128 d1v = _mm_set1_ps(d1);
+    __m128 v[3][3];
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++)
+            v[i][j] = _mm_set1_ps(V[i][j]);
+    }
+
+    const float* c = &_coords[0];
+    for (unsigned long i = first & ~3UL; i < _count; i += 4) {
+        __m128 u[3][3];
+        for (int j = 0; j < 3; j++) {
+            for (int k = 0; k < 3; k++)
+                u[j][k] = _mm_loadu_ps(c + (3 * j + k) * _stride + i);
+        }
+
+        // signed distances of the points of the other facet to the plane of this facet
+        __m128 du0 = ZeroSmall(_mm_add_ps(Dot(n1x, n1y, n1z, u[0][0], u[0][1], u[0][2]), d1v));
+        __m128 du1 = ZeroSmall(_mm_add_ps(Dot(n1x, n1y, n1z, u[1][0], u[1][1], u[1][2]), d1v));
+        __m128 du2 = ZeroSmall(_mm_add_ps(Dot(n1x, n1y, n1z, u[2][0], u[2][1], u[2][2]), d1v));
+        __m128 separated = SameSide(du0, du1, du2);
+
+        // and the other way round
+        __m128 e1x = _mm_sub_ps(u[1][0], u[0][0]);
+        __m128 e1y = _mm_sub_ps(u[1][1], u[0][1]);
+        __m128 e1z = _mm_sub_ps(u[1][2], u[0][2]);
+        __m128 e2x = _mm_sub_ps(u[2][0], u[0][0]);
+        __m128 e2y = _mm_sub_ps(u[2][1], u[0][1]);
+        __m128 e2z = _mm_sub_ps(u[2][2], u[0][2]);
+        __m128 n2x = _mm_sub_ps(_mm_mul_ps(e1y, e2z), _mm_mul_ps(e1z, e2y));
+        __m128 n2y = _mm_sub_ps(_mm_mul_ps(e1z, e2x), _mm_mul_ps(e1x, e2z));
+        __m128 n2z = _mm_sub_ps(_mm_mul_ps(e1x, e2y), _mm_mul_ps(e1y, e2x));
+        __m128 d2v = Negate(Dot(n2x, n2y, n2z, u[0][0], u[0][1], u[0][2]));
+        __m128 dv0 = ZeroSmall(_mm_add_ps(Dot(n2x, n2y, n2z, v[0][0], v[0][1], v[0][2]), d2v));
+        __m128 dv1 = ZeroSmall(_mm_add_ps(Dot(n2x, n2y, n2z, v[1][0], v[1][1], v[1][2]), d2v));
+        __m128 dv2 = ZeroSmall(_mm_add_ps(Dot(n2x, n2y, n2z, v[2][0], v[2][1], v[2][2]), d2v));
+        separated = _mm_or_ps(separated, SameSide(dv0, dv1, dv2));
+
+        int mask = _mm_movemask_ps(separated);
+        for (unsigned long k = 0; k < 4; k++) {
+            unsigned long pos = i + k;
+            if (pos >= first && pos < _count && !(mask & (1 << k)))
+                positions.push_back(pos);
+        }
+    }
+#else
+    (void)facet;
+    AllPositions(first, positions);
+#endif
+}
+
+void MeshFacetBatch::FilterLineIntersections(const Base::Vector3f& pt, const Base::Vector3f& dir,
+                                             std::vector<unsigned long>& positions) const
+{
+#if defined(MESH_FACETBATCH_SSE2)
+    if (_coords.empty() || !IsAccelerated()) {
+        AllPositions(0, positions);
+        return;
+    }
+
+    positions.clear();
+    __m128 px = _mm_set1_ps(pt.x), py = _mm_set1_ps(pt.y), pz = _mm_set1_ps(pt.z);
+    __m128 rx = _mm_set1_ps(dir.x), ry = _mm_set1_ps(dir.y), rz = _mm_set1_ps(dir.z);
+    __m128 dd = _mm_set1_ps(dir * dir);
+    __m128 parEps = _mm_set1_ps(ParallelEpsilon);
+    __m128 tolFactor = _mm_set1_ps(LineTolerance);
+
+    const float* c = &_coords[0];
+    for (unsigned long i = 0; i < _count; i += 4) {
+        __m128 ax = _mm_loadu_ps(c + 0 * _stride + i);
+        __m128 ay = _mm_loadu_ps(c + 1 * _stride + i);
+        __m128 az = _mm_loadu_ps(c + 2 * _stride + i);
+        __m128 ux = _mm_sub_ps(_mm_loadu_ps(c + 3 * _stride + i), ax);
+        __m128 uy = _mm_sub_ps(_mm_loadu_ps(c + 4 * _stride + i), ay);
+        __m128 uz = _mm_sub_ps(_mm_loadu_ps(c + 5 * _stride + i), az);
+        __m128 vx = _mm_sub_ps(_mm_loadu_ps(c + 6 * _stride + i), ax);
+        __m128 vy = _mm_sub_ps(_mm_loadu_ps(c + 7 * _stride + i), ay);
+        __m128 vz = _mm_sub_ps(_mm_loadu_ps(c + 8 * _stride + i), az);
+
+        // the line mustn't be parallel to the facet, degenerated facets fail here too
+        __m128 nx = _mm_sub_ps(_mm_mul_ps(uy, vz), _mm_mul_ps(uz, vy));
+        __m128 ny = _mm_sub_ps(_mm_mul_ps(uz, vx), _mm_mul_ps(ux, vz));
+        __m128 nz = _mm_sub_ps(_mm_mul_ps(ux, vy), _mm_mul_ps(uy, vx));
+        __m128 nn = Dot(nx, ny, nz, nx, ny, nz);
+        __m128 nd = Dot(nx, ny, nz, rx, ry, rz);
+        __m128 parallel = _mm_cmple_ps(_mm_mul_ps(nd, nd), _mm_mul_ps(parEps, _mm_mul_ps(dd, nn)));
+
+        // intersection with the plane relative to the first corner
+        __m128 w0x = _mm_sub_ps(px, ax);
+        __m128 w0y = _mm_sub_ps(py, ay);
+        __m128 w0z = _mm_sub_ps(pz, az);
+        __m128 r = _mm_div_ps(Negate(Dot(nx, ny, nz, w0x, w0y, w0z)), nd);
+        __m128 wx = _mm_add_ps(w0x, _mm_mul_ps(r, rx));
+        __m128 wy = _mm_add_ps(w0y, _mm_mul_ps(r, ry));
+        __m128 wz = _mm_add_ps(w0z, _mm_mul_ps(r, rz));
+
+        // barycentric test as in MeshGeomFacet::Foraminate()
+        __m128 uu = Dot(ux, uy, uz, ux, uy, uz);
+        __m128 uv = Dot(ux, uy, uz, vx, vy, vz);
+        __m128 vv = Dot(vx, vy, vz, vx, vy, vz);
+        __m128 wu = Dot(wx, wy, wz, ux, uy, uz);
+        __m128 wv = Dot(wx, wy, wz, vx, vy, vz);
+        __m128 det = Abs(_mm_sub_ps(_mm_mul_ps(uu, vv), _mm_mul_ps(uv, uv)));
+        __m128 s = _mm_sub_ps(_mm_mul_ps(vv, wu), _mm_mul_ps(uv, wv));
+        __m128 t = _mm_sub_ps(_mm_mul_ps(uu, wv), _mm_mul_ps(uv, wu));
+
+        // the rounding errors grow with the size of the facet and the distance of the points
+        __m128 m = _mm_add_ps(uu, vv);
+        __m128 ww = _mm_add_ps(Dot(w0x, w0y, w0z, w0x, w0y, w0z), _mm_mul_ps(_mm_mul_ps(r, r), dd));
+        __m128 tol = _mm_mul_ps(tolFactor, _mm_add_ps(_mm_mul_ps(m, m),
+                                _mm_mul_ps(m, _mm_sqrt_ps(_mm_mul_ps(m, ww)))));
+        __m128 negTol = Negate(tol);
+        __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(s, negTol), _mm_cmpge_ps(t, negTol)),
+                                   _mm_cmple_ps(_mm_add_ps(s, t), _mm_add_ps(det, tol)));
+        // keep the lanes whose numbers went wrong
+        inside = _mm_or_ps(inside, _mm_cmpunord_ps(_mm_add_ps(s, t), tol));
+        __m128 candidate = _mm_andnot_ps(parallel, inside);
+
+        int mask = _mm_movemask_ps(candidate);
+        for (unsigned long k = 0; k < 4; k++) {
+            unsigned long pos = i + k;
+            if (pos < _count && (mask & (1 << k)))
+                positions.push_back(pos);
+        }
+    }
+#else
+    (void)pt;
+    (void)dir;
+    AllPositions(0, positions);
+#endif
+}
+
+void MeshFacetBatch::FilterNearestToPoint(const Base::Vector3f& pt, float maxDist,
+                                          std::vector<unsigned long>& positions) const
+{
+#if defined(MESH_FACETBATCH_SSE2)
+    if (_coords.empty() || !IsAccelerated()) {
+        AllPositions(0, positions);
+        return;
+    }
+
+    // closest point on the facet after Ericson, Real-Time Collision Detection, 5.1.5,
+    // evaluated for all Voronoi regions and merged with masks
+    std::vector<float> lower(_stride), upper(_stride);
+    __m128 px = _mm_set1_ps(pt.x), py = _mm_set1_ps(pt.y), pz = _mm_set1_ps(pt.z);
+    __m128 zero = _mm_setzero_ps();
+    __m128 one = _mm_set1_ps(1.0f);
+    __m128 infinity = _mm_set1_ps(std::numeric_limits<float>::infinity());
+    __m128 tolFactor = _mm_set1_ps(DistanceTolerance);
+    __m128 degFactor = _mm_set1_ps(DegeneratedTolerance);
+
+    const float* c = &_coords[0];
+    for (unsigned long i = 0; i < _stride; i += 4) {
+        __m128 ax = _mm_loadu_ps(c + 0 * _stride + i);
+        __m128 ay = _mm_loadu_ps(c + 1 * _stride + i);
+        __m128 az = _mm_loadu_ps(c + 2 * _stride + i);
+        __m128 bx = _mm_loadu_ps(c + 3 * _stride + i);
+        __m128 by = _mm_loadu_ps(c + 4 * _stride + i);
+        __m128 bz = _mm_loadu_ps(c + 5 * _stride + i);
+        __m128 cx = _mm_loadu_ps(c + 6 * _stride + i);
+        __m128 cy = _mm_loadu_ps(c + 7 * _stride + i);
+        __m128 cz = _mm_loadu_ps(c + 8 * _stride + i);
+
+        __m128 abx = _mm_sub_ps(bx, ax), aby = _mm_sub_ps(by, ay), abz = _mm_sub_ps(bz, az);
+        __m128 acx = _mm_sub_ps(cx, ax), acy = _mm_sub_ps(cy, ay), acz = _mm_sub_ps(cz, az);
+        __m128 apx = _mm_sub_ps(px, ax), apy = _mm_sub_ps(py, ay), apz = _mm_sub_ps(pz, az);
+        __m128 bpx = _mm_sub_ps(px, bx), bpy = _mm_sub_ps(py, by), bpz = _mm_sub_ps(pz, bz);
+        __m128 cpx = _mm_sub_ps(px, cx), cpy = _mm_sub_ps(py, cy), cpz = _mm_sub_ps(pz, cz);
+
+        __m128 d1 = Dot(abx, aby, abz, apx, apy, apz);
+        __m128 d2 = Dot(acx, acy, acz, apx, apy, apz);
+        __m128 d3 = Dot(abx, aby, abz, bpx, bpy, bpz);
+        __m128 d4 = Dot(acx, acy, acz, bpx, bpy, bpz);
+        __m128 d5 = Dot(abx, aby, abz, cpx, cpy, cpz);
+        __m128 d6 = Dot(acx, acy, acz, cpx, cpy, cpz);
+        __m128 va = _mm_sub_ps(_mm_mul_ps(d3, d6), _mm_mul_ps(d5, d4));
+        __m128 vb = _mm_sub_ps(_mm_mul_ps(d5, d2), _mm_mul_ps(d1, d6));
+        __m128 vc = _mm_sub_ps(_mm_mul_ps(d1, d4), _mm_mul_ps(d3, d2));
+
+        // the closest point is a + s * ab + t * ac, start with the interior and let the
+        // regions of higher priority overwrite it
+        __m128 denom = _mm_div_ps(one, _mm_add_ps(_mm_add_ps(va, vb), vc));
+        __m128 s = _mm_mul_ps(vb, denom);
+        __m128 t = _mm_mul_ps(vc, denom);
+
+        __m128 d43 = _mm_sub_ps(d4, d3);
+        __m128 d56 = _mm_sub_ps(d5, d6);
+        __m128 inBC = _mm_and_ps(_mm_cmple_ps(va, zero),
+                      _mm_and_ps(_mm_cmpge_ps(d43, zero), _mm_cmpge_ps(d56, zero)));
+        __m128 wBC = _mm_div_ps(d43, _mm_add_ps(d43, d56));
+        s = Select(inBC, _mm_sub_ps(one, wBC), s);
+        t = Select(inBC, wBC, t);
+
+        __m128 inAC = _mm_and_ps(_mm_cmple_ps(vb, zero),
+                      _mm_and_ps(_mm_cmpge_ps(d2, zero), _mm_cmple_ps(d6, zero)));
+        s = Select(inAC, zero, s);
+        t = Select(inAC, _mm_div_ps(d2, _mm_sub_ps(d2, d6)), t);
+
+        __m128 inC = _mm_and_ps(_mm_cmpge_ps(d6, zero), _mm_cmple_ps(d5, d6));
+        s = Select(inC, zero, s);
+        t = Select(inC, one, t);
+
+        __m128 inAB = _mm_and_ps(_mm_cmple_ps(vc, zero),
+                      _mm_and_ps(_mm_cmpge_ps(d1, zero), _mm_cmple_ps(d3, zero)));
+        s = Select(inAB, _mm_div_ps(d1, _mm_sub_ps(d1, d3)), s);
+        t = Select(inAB, zero, t);
+
+        __m128 inB = _mm_and_ps(_mm_cmpge_ps(d3, zero), _mm_cmple_ps(d4, d3));
+        s = Select(inB, one, s);
+        t = Select(inB, zero, t);
+
+        __m128 inA = _mm_and_ps(_mm_cmple_ps(d1, zero), _mm_cmple_ps(d2, zero));
+        s = Select(inA, zero, s);
+        t = Select(inA, zero, t);
+
+        // vector from the closest point to the point
+        __m128 qx = _mm_sub_ps(apx, _mm_add_ps(_mm_mul_ps(s, abx), _mm_mul_ps(t, acx)));
+        __m128 qy = _mm_sub_ps(apy, _mm_add_ps(_mm_mul_ps(s, aby), _mm_mul_ps(t, acy)));
+        __m128 qz = _mm_sub_ps(apz, _mm_add_ps(_mm_mul_ps(s, abz), _mm_mul_ps(t, acz)));
+        __m128 dist2 = Dot(qx, qy, qz, qx, qy, qz);
+
+        // the squared distances of the exact method suffer from cancellation, so the
+        // error depends on the distance to the corner and the size of the facet
+        __m128 aa = Dot(abx, aby, abz, abx, aby, abz);
+        __m128 bb = Dot(acx, acy, acz, acx, acy, acz);
+        __m128 err = _mm_mul_ps(tolFactor, _mm_add_ps(Dot(apx, apy, apz, apx, apy, apz), _mm_add_ps(aa, bb)));
+        __m128 lo = _mm_sqrt_ps(_mm_max_ps(_mm_sub_ps(dist2, err), zero));
+        __m128 hi = _mm_sqrt_ps(_mm_add_ps(dist2, err));
+
+        // the exact method isn't reliable for (nearly) degenerated facets, so always keep
+        // them and don't let them restrict the other facets, the same for invalid numbers
+        __m128 ab = Dot(abx, aby, abz, acx, acy, acz);
+        __m128 det = _mm_sub_ps(_mm_mul_ps(aa, bb), _mm_mul_ps(ab, ab));
+        __m128 degenerated = _mm_cmpngt_ps(det, _mm_mul_ps(degFactor, _mm_mul_ps(aa, bb)));
+        __m128 invalid = _mm_or_ps(_mm_cmpunord_ps(lo, hi), degenerated);
+        lo = Select(invalid, zero, lo);
+        hi = Select(invalid, infinity, hi);
+        _mm_storeu_ps(&lower[i], lo);
+        _mm_storeu_ps(&upper[i], hi);
+    }
+
+    // a facet whose lower bound exceeds the smallest upper bound can't be the nearest
+    float bound = std::min<float>(maxDist, *std::min_element(upper.begin(), upper.begin() + _count));
+    positions.clear();
+    for (unsigned long i = 0; i < _count; i++) {
+        if (lower[i] <= bound)
+            positions.push_back(i);
+    }
+#else
+    (void)pt;
+    (void)maxDist;
+    AllPositions(0, positions);
+#endif
+}
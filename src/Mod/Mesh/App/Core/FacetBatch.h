@@ -0,0 +1,112 @@
+/***************************************************************************
+ *   Copyright (c) 2026 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef MESHCORE_FACETBATCH_H
+#define MESHCORE_FACETBATCH_H
+
+#include <vector>
+#include <Base/Vector3D.h>
+
+namespace MeshCore {
+
+class MeshKernel;
+class MeshGeomFacet;
+class MeshFacetIterator;
+
+/**
+ * The MeshFacetBatch class holds the corner points of a list of facets as separate
+ * coordinate arrays so that several facets can be tested at once with SSE2 instructions.
+ *
+ * The tests are filters for the exact but more expensive methods of MeshGeomFacet: they
+ * return the positions of all facets that may pass the exact test and skip only those that
+ * certainly fail it. The caller runs the exact test on the returned positions, which are in
+ * ascending order, so the overall result doesn't change.
+ *
+ * Whether SSE2 is available is checked once at runtime. If it isn't, or the list is too
+ * short to gain anything, the filters return all positions.
+ */
+class MeshExport MeshFacetBatch
+{
+public:
+    /// Construction
+    MeshFacetBatch();
+    /// Destruction
+    ~MeshFacetBatch();
+
+    /// Sets the facets of \a mesh with the indices in [\a first, \a last).
+    void Assign(const MeshKernel& mesh, std::vector<unsigned long>::const_iterator first,
+                std::vector<unsigned long>::const_iterator last);
+    /// Sets the facets of \a mesh with the indices \a indices.
+    void Assign(const MeshKernel& mesh, const std::vector<unsigned long>& indices)
+    { Assign(mesh, indices.begin(), indices.end()); }
+    /// Sets the facets with the indices \a indices as returned by \a iter, i.e. transformed.
+    void Assign(MeshFacetIterator& iter, const std::vector<unsigned long>& indices);
+    /// Returns the number of facets.
+    unsigned long Size() const
+    { return _count; }
+
+    /** Collects the positions from \a first on of the facets that \a facet may intersect.
+     * Skipped are the facets that MeshGeomFacet::IntersectWithFacet() rejects because the
+     * plane of one of the two facets doesn't separate the points of the other facet.
+     * The plane test is computed exactly as in the scalar code.
+     */
+    void FilterIntersections(const MeshGeomFacet& facet, unsigned long first,
+                             std::vector<unsigned long>& positions) const;
+    /** Collects the positions of the facets that the line through \a pt with the direction
+     * \a dir may pierce, see MeshGeomFacet::Foraminate().
+     */
+    void FilterLineIntersections(const Base::Vector3f& pt, const Base::Vector3f& dir,
+                                 std::vector<unsigned long>& positions) const;
+    /** Collects the positions of the facets that may have the minimum distance to \a pt,
+     * if this distance is less than \a maxDist, see MeshGeomFacet::DistanceToPoint().
+     */
+    void FilterNearestToPoint(const Base::Vector3f& pt, float maxDist,
+                              std::vector<unsigned long>& positions) const;
+
+    /// Returns true if the filters use SSE2 instructions.
+    static bool IsAccelerated();
+    /// Allows to switch off the SSE2 instructions, e.g. to compare the results.
+    static void SetAccelerated(bool on);
+
+private:
+    bool Resize(unsigned long count);
+    void SetPoint(unsigned long pos, int corner, const Base::Vector3f& p);
+    void Pad();
+    void AllPositions(unsigned long first, std::vector<unsigned long>& positions) const;
+
+private:
+    MeshFacetBatch(const MeshFacetBatch&);
+    void operator = (const MeshFacetBatch&);
+
+    unsigned long _count;
+    unsigned long _stride;
+    /** The x, y and z coordinates of the first, second and third corner of all facets,
+     * each of them padded to a multiple of four. Empty if the facets aren't tested in batches.
+     */
+    std::vector<float> _coords;
+    static bool _enabled;
+};
+
+} // namespace MeshCore
+
+#endif // MESHCORE_FACETBATCH_H
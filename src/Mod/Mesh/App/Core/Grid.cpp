@@ -27,7 +27,11 @@
 # include <algorithm>
 #endif
 
+#include <QtConcurrentMap>
+#include <boost/bind.hpp>
+
 #include "Grid.h"
+#include "FacetBatch.h"
 #include "Iterator.h"
 
 #include "MeshKernel.h"
@@ -62,7 +66,8 @@ void MeshGrid::Attach (const MeshKernel &rclM)
 
 void MeshGrid::Clear (void)
 {
-  _aulGrid.clear();
+  _aulGridOffsets.clear();
+  _aulGridElements.clear();
   _pclMesh = NULL;  
 }
 
@@ -93,8 +98,6 @@ void MeshGrid::InitGrid (void)
 {
   assert(_pclMesh != NULL);
 
-  unsigned long i, j;
-
   // Grid Laengen berechnen wenn nicht initialisiert
   //
   if ((_ulCtGridsX == 0) || (_ulCtGridsX == 0) || (_ulCtGridsX == 0))
@@ -128,13 +131,60 @@ void MeshGrid::InitGrid (void)
   }
 
   // Daten-Struktur anlegen
-  _aulGrid.clear();
-  _aulGrid.resize(_ulCtGridsX);
-  for (i = 0; i < _ulCtGridsX; i++)
+  _aulGridOffsets.assign(_ulCtGridsX * _ulCtGridsY * _ulCtGridsZ + 1, 0);
+  std::vector<unsigned long>().swap(_aulGridElements);
+}
+
+void MeshGrid::FillGrid (void)
+{
+  unsigned long ulCtElements = HasElements();
+
+  // split the elements into blocks that are sorted into the grids independently
+  std::vector<GridBlock> aclBlocks((ulCtElements + MESH_CT_GRID_BLOCK - 1) / MESH_CT_GRID_BLOCK);
+  for (std::vector<GridBlock>::size_type i = 0; i < aclBlocks.size(); i++)
+  {
+    aclBlocks[i].ulBegin = i * MESH_CT_GRID_BLOCK;
+    aclBlocks[i].ulEnd = std::min<unsigned long>(ulCtElements, (i + 1) * MESH_CT_GRID_BLOCK);
+  }
+
+  if (aclBlocks.size() > 1)
+    QtConcurrent::blockingMap(aclBlocks, boost::bind(&MeshGrid::CollectBlock, this, _1));
+  else if (aclBlocks.size() == 1)
+    CollectBlock(aclBlocks.front());
+
+  BuildGrid(aclBlocks);
+}
+
+void MeshGrid::CollectBlock (GridBlock &rclBlock) const
+{
+  CollectElements(rclBlock.ulBegin, rclBlock.ulEnd, rclBlock.aclEntries);
+}
+
+void MeshGrid::BuildGrid (std::vector<GridBlock> &raclBlocks)
+{
+  std::vector<GridBlock>::iterator it;
+  GridEntries::const_iterator jt;
+
+  // first pass: count the elements of each grid
+  std::fill(_aulGridOffsets.begin(), _aulGridOffsets.end(), 0);
+  for (it = raclBlocks.begin(); it != raclBlocks.end(); ++it)
+  {
+    for (jt = it->aclEntries.begin(); jt != it->aclEntries.end(); ++jt)
+      _aulGridOffsets[jt->first + 1]++;
+  }
+
+  for (std::vector<unsigned long>::size_type i = 1; i < _aulGridOffsets.size(); i++)
+    _aulGridOffsets[i] += _aulGridOffsets[i-1];
+
+  // second pass: copy the element indices to their grids, as the blocks are in order
+  // the indices of each grid are sorted afterwards
+  std::vector<unsigned long> aulPos(_aulGridOffsets.begin(), _aulGridOffsets.end() - 1);
+  _aulGridElements.resize(_aulGridOffsets.back());
+  for (it = raclBlocks.begin(); it != raclBlocks.end(); ++it)
   {
-    _aulGrid[i].resize(_ulCtGridsY);
-    for (j = 0; j < _ulCtGridsY; j++)
-      _aulGrid[i][j].resize(_ulCtGridsZ);
+    for (jt = it->aclEntries.begin(); jt != it->aclEntries.end(); ++jt)
+      _aulGridElements[aulPos[jt->first]++] = jt->second;
+    GridEntries().swap(it->aclEntries);
   }
 }
 
@@ -155,7 +205,7 @@ unsigned long MeshGrid::Inside (const Base::BoundBox3f &rclBB, std::vector<unsig
     {
       for (k = ulMinZ; k <= ulMaxZ; k++)
       {
-        raulElements.insert(raulElements.end(), _aulGrid[i][j][k].begin(), _aulGrid[i][j][k].end());
+        raulElements.insert(raulElements.end(), GridBegin(i, j, k), GridEnd(i, j, k));
       }
     }
   }  
@@ -190,7 +240,7 @@ unsigned long MeshGrid::Inside (const Base::BoundBox3f &rclBB, std::vector<unsig
       for (k = ulMinZ; k <= ulMaxZ; k++)
       {
         if (Base::DistanceP2(GetBoundBox(i, j, k).CalcCenter(), rclOrg) < fMinDistP2)
-          raulElements.insert(raulElements.end(), _aulGrid[i][j][k].begin(), _aulGrid[i][j][k].end());
+          raulElements.insert(raulElements.end(), GridBegin(i, j, k), GridEnd(i, j, k));
       }
     }
   }  
@@ -221,7 +271,7 @@ unsigned long MeshGrid::Inside (const Base::BoundBox3f &rclBB, std::set<unsigned
     {
       for (k = ulMinZ; k <= ulMaxZ; k++)
       {
-        raulElements.insert(_aulGrid[i][j][k].begin(), _aulGrid[i][j][k].end());
+        raulElements.insert(GridBegin(i, j, k), GridEnd(i, j, k));
       }
     }
   }  
@@ -451,7 +501,7 @@ void MeshGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt, std::set<uns
           for (unsigned long i = 0; i < _ulCtGridsY; i++)
           {
             for (unsigned long j = 0; j < _ulCtGridsZ; j++)
-              raclInd.insert(_aulGrid[nX][i][j].begin(), _aulGrid[nX][i][j].end());
+              raclInd.insert(GridBegin(nX, i, j), GridEnd(nX, i, j));
           }
           nX++;
         }
@@ -465,7 +515,7 @@ void MeshGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt, std::set<uns
           for (unsigned long i = 0; i < _ulCtGridsY; i++)
           {
             for (unsigned long j = 0; j < _ulCtGridsZ; j++)
-              raclInd.insert(_aulGrid[nX][i][j].begin(), _aulGrid[nX][i][j].end());
+              raclInd.insert(GridBegin(nX, i, j), GridEnd(nX, i, j));
           }
           nX++;
         }
@@ -479,7 +529,7 @@ void MeshGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt, std::set<uns
           for (unsigned long i = 0; i < _ulCtGridsX; i++)
           {
             for (unsigned long j = 0; j < _ulCtGridsZ; j++)
-              raclInd.insert(_aulGrid[i][nY][j].begin(), _aulGrid[i][nY][j].end());
+              raclInd.insert(GridBegin(i, nY, j), GridEnd(i, nY, j));
           }
           nY++;
         }
@@ -493,7 +543,7 @@ void MeshGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt, std::set<uns
           for (unsigned long i = 0; i < _ulCtGridsX; i++)
           {
             for (unsigned long j = 0; j < _ulCtGridsZ; j++)
-              raclInd.insert(_aulGrid[i][nY][j].begin(), _aulGrid[i][nY][j].end());
+              raclInd.insert(GridBegin(i, nY, j), GridEnd(i, nY, j));
           }
           nY--;
         }
@@ -507,7 +557,7 @@ void MeshGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt, std::set<uns
           for (unsigned long i = 0; i < _ulCtGridsX; i++)
           {
             for (unsigned long j = 0; j < _ulCtGridsY; j++)
-              raclInd.insert(_aulGrid[i][j][nZ].begin(), _aulGrid[i][j][nZ].end());
+              raclInd.insert(GridBegin(i, j, nZ), GridEnd(i, j, nZ));
           }
           nZ++;
         }
@@ -521,7 +571,7 @@ void MeshGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt, std::set<uns
           for (unsigned long i = 0; i < _ulCtGridsX; i++)
           {
             for (unsigned long j = 0; j < _ulCtGridsY; j++)
-              raclInd.insert(_aulGrid[i][j][nZ].begin(), _aulGrid[i][j][nZ].end());
+              raclInd.insert(GridBegin(i, j, nZ), GridEnd(i, j, nZ));
           }
           nZ--;
         }
@@ -587,11 +637,12 @@ void MeshGrid::GetHull (unsigned long ulX, unsigned long ulY, unsigned long ulZ,
 unsigned long MeshGrid::GetElements (unsigned long ulX, unsigned long ulY, unsigned long ulZ,  
                                      std::set<unsigned long> &raclInd) const
 {
-  const std::set<unsigned long> &rclSet = _aulGrid[ulX][ulY][ulZ];
-  if (rclSet.size() > 0)
+  std::vector<unsigned long>::const_iterator pBegin = GridBegin(ulX, ulY, ulZ);
+  std::vector<unsigned long>::const_iterator pEnd = GridEnd(ulX, ulY, ulZ);
+  if (pBegin != pEnd)
   {
-    raclInd.insert(rclSet.begin(), rclSet.end());
-    return rclSet.size();
+    raclInd.insert(pBegin, pEnd);
+    return pEnd - pBegin;
   }
 
   return 0;
@@ -603,9 +654,7 @@ unsigned long MeshGrid::GetElements(const Base::Vector3f &rclPoint, std::vector<
   if (!CheckPosition(rclPoint, ulX, ulY, ulZ))
     return 0;
 
-  aulFacets.resize(_aulGrid[ulX][ulY][ulZ].size());
-
-  std::copy(_aulGrid[ulX][ulY][ulZ].begin(), _aulGrid[ulX][ulY][ulZ].end(), aulFacets.begin());
+  aulFacets.assign(GridBegin(ulX, ulY, ulZ), GridEnd(ulX, ulY, ulZ));
   return aulFacets.size();
 }
 
@@ -710,15 +759,18 @@ void MeshFacetGrid::RebuildGrid (void)
   InitGrid();
  
   // Daten-Struktur fuellen
-  MeshFacetIterator clFIter(*_pclMesh);
+  FillGrid();
+}
 
-  unsigned long i = 0;
-  for (clFIter.Init(); clFIter.More(); clFIter.Next())
+void MeshFacetGrid::CollectElements (unsigned long ulBegin, unsigned long ulEnd, GridEntries &raclEntries) const
+{
+  // each thread needs its own iterator
+  MeshFacetIterator clFIter(*_pclMesh);
+  for (unsigned long i = ulBegin; i < ulEnd; i++)
   {
-//    AddFacet(*clFIter, i++, 2.0f);
-    AddFacet(*clFIter, i++);
+    clFIter.Set(i);
+    AddFacet(*clFIter, i, raclEntries);
   }
-
 }
 
 unsigned long MeshFacetGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt) const
@@ -919,14 +971,22 @@ void MeshFacetGrid::SearchNearestFacetInGrid(unsigned long ulX, unsigned long ul
                                              const Base::Vector3f &rclPt, float &rfMinDist,
                                              unsigned long &rulFacetInd) const
 {
-  const std::set<unsigned long> &rclSet = _aulGrid[ulX][ulY][ulZ];
-  for (std::set<unsigned long>::const_iterator pI = rclSet.begin(); pI != rclSet.end(); pI++)
+  std::vector<unsigned long>::const_iterator pBegin = GridBegin(ulX, ulY, ulZ);
+  std::vector<unsigned long>::const_iterator pEnd = GridEnd(ulX, ulY, ulZ);
+
+  // compute the exact distance only for facets that may be nearer than the current minimum
+  MeshFacetBatch clBatch;
+  clBatch.Assign(*_pclMesh, pBegin, pEnd);
+  std::vector<unsigned long> aulPositions;
+  clBatch.FilterNearestToPoint(rclPt, rfMinDist, aulPositions);
+  for (std::vector<unsigned long>::iterator pP = aulPositions.begin(); pP != aulPositions.end(); pP++)
   {
-    float fDist = _pclMesh->GetFacet(*pI).DistanceToPoint(rclPt);
+    unsigned long ulFacet = pBegin[*pP];
+    float fDist = _pclMesh->GetFacet(ulFacet).DistanceToPoint(rclPt);
     if (fDist < rfMinDist)
     {
       rfMinDist   = fDist;
-      rulFacetInd = *pI;
+      rulFacetInd = ulFacet;
     }
   }
 }
@@ -965,12 +1025,12 @@ MeshPointGrid::MeshPointGrid (const MeshKernel &rclM, float fGridLen)
           std::max<unsigned long>((unsigned long)(clBBMesh.LengthZ() / fGridLen), 1));
 }
 
-void MeshPointGrid::AddPoint (const MeshPoint &rclPt, unsigned long ulPtIndex, float fEpsilon)
+void MeshPointGrid::AddPoint (const MeshPoint &rclPt, unsigned long ulPtIndex, GridEntries &raclEntries) const
 {
   unsigned long ulX, ulY, ulZ;
   Pos(Base::Vector3f(rclPt.x, rclPt.y, rclPt.z), ulX, ulY, ulZ);
   if ( (ulX < _ulCtGridsX) && (ulY < _ulCtGridsY) && (ulZ < _ulCtGridsZ) )
-    _aulGrid[ulX][ulY][ulZ].insert(ulPtIndex);
+    raclEntries.push_back(std::make_pair(GridIndex(ulX, ulY, ulZ), ulPtIndex));
 }
 
 void MeshPointGrid::Validate (const MeshKernel &rclMesh)
@@ -1021,14 +1081,14 @@ void MeshPointGrid::RebuildGrid (void)
   InitGrid();
  
   // Daten-Struktur fuellen
+  FillGrid();
+}
 
-  MeshPointIterator cPIter(*_pclMesh);
-
-  unsigned long i = 0;
-  for (cPIter.Init(); cPIter.More(); cPIter.Next())
-  {
-    AddPoint(*cPIter, i++);
-  }
+void MeshPointGrid::CollectElements (unsigned long ulBegin, unsigned long ulEnd, GridEntries &raclEntries) const
+{
+  const MeshPointArray& rclPoints = _pclMesh->GetPoints();
+  for (unsigned long i = ulBegin; i < ulEnd; i++)
+    AddPoint(rclPoints[i], i, raclEntries);
 }
 
 void MeshPointGrid::Pos (const Base::Vector3f &rclPoint, unsigned long &rulX, unsigned long &rulY, unsigned long &rulZ) const
@@ -1090,7 +1150,7 @@ bool MeshGridIterator::InitOnRay (const Base::Vector3f &rclPt, const Base::Vecto
   if ((_rclGrid.GetBoundBox().IsInBox(rclPt)) == true)
   {  // Voxel bestimmen, indem der Startpunkt liegt
     _rclGrid.Position(rclPt, _ulX, _ulY, _ulZ);
-    raulElements.insert(raulElements.end(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].begin(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].end());
+    raulElements.insert(raulElements.end(), _rclGrid.GridBegin(_ulX, _ulY, _ulZ), _rclGrid.GridEnd(_ulX, _ulY, _ulZ));
     _bValidRay = true;
   }
   else
@@ -1103,7 +1163,7 @@ bool MeshGridIterator::InitOnRay (const Base::Vector3f &rclPt, const Base::Vecto
       else
         _rclGrid.Position(cP1, _ulX, _ulY, _ulZ);
 
-      raulElements.insert(raulElements.end(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].begin(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].end());
+      raulElements.insert(raulElements.end(), _rclGrid.GridBegin(_ulX, _ulY, _ulZ), _rclGrid.GridEnd(_ulX, _ulY, _ulZ));
       _bValidRay = true;
     }
   }
@@ -1154,7 +1214,7 @@ bool MeshGridIterator::NextOnRay (std::vector<unsigned long> &raulElements)
   if ((_bValidRay == true) && (_rclGrid.CheckPos(_ulX, _ulY, _ulZ) == true))
   {
     GridElement pos(_ulX, _ulY, _ulZ); _cSearchPositions.insert(pos);
-    raulElements.insert(raulElements.end(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].begin(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].end()); 
+    raulElements.insert(raulElements.end(), _rclGrid.GridBegin(_ulX, _ulY, _ulZ), _rclGrid.GridEnd(_ulX, _ulY, _ulZ)); 
   }
   else
     _bValidRay = false;  // Strahl ausgetreten
@@ -25,6 +25,8 @@
 #define MESH_GRID_H
 
 #include <set>
+#include <vector>
+#include <utility>
 
 #include "MeshKernel.h"
 #include <Base/Vector3D.h>
@@ -33,6 +35,7 @@
 #define  MESH_CT_GRID          256     // Default value for number of elements per grid
 #define  MESH_MAX_GRIDS        100000  // Default value for maximum number of grids
 #define  MESH_CT_GRID_PER_AXIS 20
+#define  MESH_CT_GRID_BLOCK    65536   // Number of elements a thread sorts into the grid at once
 
 
 namespace MeshCore {
@@ -51,6 +54,11 @@ class MeshGrid;
  *
  * Grids can be used within algorithms to avoid to iterate through all elements,
  * so grids can speed up algorithms dramatically.
+ *
+ * The element indices of all grids are kept in one contiguous array sorted by
+ * grid, an offset array points to the first index of each grid. The structure
+ * is filled in two counting passes, for large meshes the elements are sorted
+ * into the grids in parallel.
  */
 class MeshExport MeshGrid
 {
@@ -96,6 +104,9 @@ public:
   /** Returns the indices of the elements in the given grid. */
   unsigned long GetElements (unsigned long ulX, unsigned long ulY, unsigned long ulZ,  std::set<unsigned long> &raclInd) const;
   unsigned long GetElements (const Base::Vector3f &rclPoint, std::vector<unsigned long>& aulFacets) const;
+  /** Appends the indices of the elements in the given grid in the order they are stored. */
+  void GetElements (unsigned long ulX, unsigned long ulY, unsigned long ulZ, std::vector<unsigned long> &raulInd) const
+  { raulInd.insert(raulInd.end(), GridBegin(ulX, ulY, ulZ), GridEnd(ulX, ulY, ulZ)); }
   //@}
 
   /** Returns the lengths of the grid elements in x,y and z direction. */
@@ -125,7 +136,7 @@ public:
   bool GetPositionToIndex(unsigned long id, unsigned long& ulX, unsigned long& ulY, unsigned long& ulZ) const;
   /** Returns the number of elements in a given grid. */
   unsigned long GetCtElements(unsigned long ulX, unsigned long ulY, unsigned long ulZ) const
-  { return _aulGrid[ulX][ulY][ulZ].size(); }
+  { unsigned long ulIndex = GridIndex(ulX, ulY, ulZ); return _aulGridOffsets[ulIndex+1] - _aulGridOffsets[ulIndex]; }
   /** Validates the grid structure and rebuilds it if needed. Must be implemented in sub-classes. */
   virtual void Validate (const MeshKernel &rclM) = 0;
   /** Verifies the grid structure and returns false if inconsistencies are found. */
@@ -156,8 +167,39 @@ protected:
   /** Returns the number of stored elements. Must be implemented in sub-classes. */
   virtual unsigned long HasElements (void) const = 0;
 
+  /** @name Grid storage */
+  //@{
+  /// Pairs of grid index and element index
+  typedef std::vector<std::pair<unsigned long, unsigned long> > GridEntries;
+  /// The grid entries of a range of elements
+  struct GridBlock
+  {
+    unsigned long ulBegin, ulEnd;
+    GridEntries   aclEntries;
+  };
+  /** Collects the grid entries of the elements in the range [\a ulBegin, \a ulEnd). This method
+   * may be called from several threads at the same time. Must be implemented in sub-classes. */
+  virtual void CollectElements (unsigned long ulBegin, unsigned long ulEnd, GridEntries &raclEntries) const = 0;
+  /** Fills the grid structure with all elements. InitGrid() must have been called before. */
+  void FillGrid (void);
+  /** Returns the index of a grid in the flat storage. */
+  inline unsigned long GridIndex (unsigned long ulX, unsigned long ulY, unsigned long ulZ) const
+  { return (ulZ * _ulCtGridsY + ulY) * _ulCtGridsX + ulX; }
+  /** Returns the first element index of a grid. */
+  inline std::vector<unsigned long>::const_iterator GridBegin (unsigned long ulX, unsigned long ulY, unsigned long ulZ) const
+  { return _aulGridElements.begin() + _aulGridOffsets[GridIndex(ulX, ulY, ulZ)]; }
+  /** Returns the position after the last element index of a grid. */
+  inline std::vector<unsigned long>::const_iterator GridEnd (unsigned long ulX, unsigned long ulY, unsigned long ulZ) const
+  { return _aulGridElements.begin() + _aulGridOffsets[GridIndex(ulX, ulY, ulZ)+1]; }
+  //@}
+
+private:
+  void CollectBlock (GridBlock &rclBlock) const;
+  void BuildGrid (std::vector<GridBlock> &raclBlocks);
+
 protected:
-  std::vector<std::vector<std::vector<std::set<unsigned long> > > >  _aulGrid;   /**< Grid data structure. */
+  std::vector<unsigned long> _aulGridOffsets;  /**< Start of each grid in _aulGridElements, with one additional end entry. */
+  std::vector<unsigned long> _aulGridElements; /**< Element indices of all grids. */
   const MeshKernel* _pclMesh;     /**< The mesh kernel. */
   unsigned long     _ulCtElements;/**< Number of grid elements for validation issues. */
   unsigned long     _ulCtGridsX;  /**< Number of grid elements in z. */
@@ -224,13 +266,15 @@ protected:
   inline void Pos (const Base::Vector3f &rclPoint, unsigned long &rulX, unsigned long &rulY, unsigned long &rulZ) const;
   /** Returns the grid numbers to the given point \a rclPoint. */
   inline void PosWithCheck (const Base::Vector3f &rclPoint, unsigned long &rulX, unsigned long &rulY, unsigned long &rulZ) const;
-  /** Adds a new facet element to the grid structure. \a rclFacet is the geometric facet and \a ulFacetIndex 
+  /** Adds a new facet element to the grid entries. \a rclFacet is the geometric facet and \a ulFacetIndex 
    * the corresponding index in the mesh kernel. The facet is added to each grid element that intersects 
    * the facet. */
-  inline void AddFacet (const MeshGeomFacet &rclFacet, unsigned long ulFacetIndex, float fEpsilon = 0.0f);
+  inline void AddFacet (const MeshGeomFacet &rclFacet, unsigned long ulFacetIndex, GridEntries &raclEntries) const;
   /** Returns the number of stored elements. */
   unsigned long HasElements (void) const
   { return _pclMesh->CountFacets(); }
+  /** Collects the grid entries of the given range of facets. */
+  virtual void CollectElements (unsigned long ulBegin, unsigned long ulEnd, GridEntries &raclEntries) const;
   /** Rebuilds the grid structure. */
   virtual void RebuildGrid (void);
 };
@@ -268,14 +312,16 @@ public:
   virtual bool Verify() const;
 
 protected:
-  /** Adds a new point element to the grid structure. \a rclPt is the geometric point and \a ulPtIndex 
+  /** Adds a new point element to the grid entries. \a rclPt is the geometric point and \a ulPtIndex 
    * the corresponding index in the mesh kernel. */
-  void AddPoint (const MeshPoint &rclPt, unsigned long ulPtIndex, float fEpsilon = 0.0f);
+  void AddPoint (const MeshPoint &rclPt, unsigned long ulPtIndex, GridEntries &raclEntries) const;
   /** Returns the grid numbers to the given point \a rclPoint. */
   void Pos(const Base::Vector3f &rclPoint, unsigned long &rulX, unsigned long &rulY, unsigned long &rulZ) const;
   /** Returns the number of stored elements. */
   unsigned long HasElements (void) const
   { return _pclMesh->CountPoints(); }
+  /** Collects the grid entries of the given range of points. */
+  virtual void CollectElements (unsigned long ulBegin, unsigned long ulEnd, GridEntries &raclEntries) const;
   /** Rebuilds the grid structure. */
   virtual void RebuildGrid (void);
 };
@@ -295,7 +341,7 @@ public:
   /** Returns indices of the elements in the current grid. */
   void GetElements (std::vector<unsigned long> &raulElements) const
   {
-    raulElements.insert(raulElements.end(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].begin(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].end());
+    raulElements.insert(raulElements.end(), _rclGrid.GridBegin(_ulX, _ulY, _ulZ), _rclGrid.GridEnd(_ulX, _ulY, _ulZ));
   }
   /** Returns the number of elements in the current grid. */
   unsigned long GetCtElements() const
@@ -434,38 +480,8 @@ inline void MeshFacetGrid::PosWithCheck (const Base::Vector3f &rclPoint, unsigne
   assert((rulX < _ulCtGridsX) && (rulY < _ulCtGridsY) && (rulZ < _ulCtGridsZ));
 }
 
-inline void MeshFacetGrid::AddFacet (const MeshGeomFacet &rclFacet, unsigned long ulFacetIndex, float fEpsilon)
+inline void MeshFacetGrid::AddFacet (const MeshGeomFacet &rclFacet, unsigned long ulFacetIndex, GridEntries &raclEntries) const
 {
-#if 0
-  unsigned long  i, ulX, ulY, ulZ, ulX1, ulY1, ulZ1, ulX2, ulY2, ulZ2;
-  
-  ulX1 = ulY1 = ulZ1 = ULONG_MAX;
-  ulX2 = ulY2 = ulZ2 = 0;
-
-  for (i = 0; i < 3; i++)
-  {
-    Pos(rclFacet._aclPoints[i], ulX, ulY, ulZ);
-    _aulGrid[ulX][ulY][ulZ].insert(ulFacetIndex);
-    ulX1 = RSmin<unsigned long>(ulX1, ulX); ulY1 = RSmin<unsigned long>(ulY1, ulY); ulZ1 = RSmin<unsigned long>(ulZ1, ulZ);
-    ulX2 = RSmax<unsigned long>(ulX2, ulX); ulY2 = RSmax<unsigned long>(ulY2, ulY); ulZ2 = RSmax<unsigned long>(ulZ2, ulZ);
-  }
-  
-  // falls Facet ueber mehrere BB reicht
-  if ((ulX1 < ulX2) || (ulY1 < ulY2) || (ulZ1 < ulZ2))
-  {
-    for (ulX = ulX1; ulX <= ulX2; ulX++)
-    {
-      for (ulY = ulY1; ulY <= ulY2; ulY++)
-      {
-        for (ulZ = ulZ1; ulZ <= ulZ2; ulZ++)
-        {
-          if (CMeshFacetFunc::BBoxContainFacet(GetBoundBox(ulX, ulY, ulZ), rclFacet) == TRUE)
-            _aulGrid[ulX][ulY][ulZ].insert(ulFacetIndex);
-        }
-      }
-    }
-  }
-#else
   unsigned long ulX, ulY, ulZ;
 
   unsigned long ulX1, ulY1, ulZ1, ulX2, ulY2, ulZ2;
@@ -476,22 +492,8 @@ inline void MeshFacetGrid::AddFacet (const MeshGeomFacet &rclFacet, unsigned lon
   clBB &= rclFacet._aclPoints[1];
   clBB &= rclFacet._aclPoints[2];
 
-  //float fDiagonalLength = clBB.CalcDiagonalLength();
-
-  //clBB.Enlarge(fEpsilon*fDiagonalLength);
-
   Pos(Base::Vector3f(clBB.MinX,clBB.MinY,clBB.MinZ), ulX1, ulY1, ulZ1);
   Pos(Base::Vector3f(clBB.MaxX,clBB.MaxY,clBB.MaxZ), ulX2, ulY2, ulZ2);
-  
-  /*
-  if (ulX1 > 0) ulX1--;
-  if (ulY1 > 0) ulY1--;
-  if (ulZ1 > 0) ulZ1--;
-  
-  if (ulX2 < (_ulCtGridsX-1)) ulX2++;
-  if (ulY2 < (_ulCtGridsY-1)) ulY2++;
-  if (ulZ2 < (_ulCtGridsZ-1)) ulZ2++;
-  */
 
   // falls Facet ueber mehrere BB reicht
   if ((ulX1 < ulX2) || (ulY1 < ulY2) || (ulZ1 < ulZ2))
@@ -503,15 +505,13 @@ inline void MeshFacetGrid::AddFacet (const MeshGeomFacet &rclFacet, unsigned lon
         for (ulZ = ulZ1; ulZ <= ulZ2; ulZ++)
         {
           if ( rclFacet.IntersectBoundingBox( GetBoundBox(ulX, ulY, ulZ) ) )
-            _aulGrid[ulX][ulY][ulZ].insert(ulFacetIndex);
+            raclEntries.push_back(std::make_pair(GridIndex(ulX, ulY, ulZ), ulFacetIndex));
         }
       }
     }
   }
   else
-    _aulGrid[ulX1][ulY1][ulZ1].insert(ulFacetIndex);
-
-#endif
+    raclEntries.push_back(std::make_pair(GridIndex(ulX1, ulY1, ulZ1), ulFacetIndex));
 }
 
 } // namespace MeshCore
@@ -29,6 +29,7 @@
 #include "MeshIO.h"
 #include "Builder.h"
 
+#include <Base/AsciiParser.h>
 #include <Base/Console.h>
 #include <Base/Exception.h>
 #include <Base/Reader.h>
@@ -36,14 +37,18 @@
 #include <Base/FileInfo.h>
 #include <Base/Sequencer.h>
 #include <Base/Stream.h>
+#include <Base/Swap.h>
 #include <Base/Placement.h>
 #include <zipios++/gzipoutputstream.h>
 
 #include <cmath>
+#include <cstring>
 #include <sstream>
 #include <iomanip>
 #include <boost/regex.hpp>
 #include <boost/algorithm/string.hpp>
+#include <QThread>
+#include <QtConcurrentMap>
 
 
 using namespace MeshCore;
@@ -408,8 +413,175 @@ bool MeshInput::LoadSTL (std::istream &rstrIn)
     return true;
 }
 
-/** Loads an OBJ file. */
-bool MeshInput::LoadOBJ (std::istream &rstrIn)
+// --------------------------------------------------------------
+
+Base::AsciiParser::Mode MeshInput::asciiMode = Base::AsciiParser::Parallel;
+
+void MeshInput::SetAsciiParserMode(Base::AsciiParser::Mode mode)
+{
+    asciiMode = mode;
+}
+
+Base::AsciiParser::Mode MeshInput::GetAsciiParserMode()
+{
+    return asciiMode;
+}
+
+namespace MeshCore {
+namespace AsciiReader {
+
+typedef std::pair<const char*, const char*> TextRange;
+
+// Splits a block of an ASCII file into the pieces to be parsed by the threads
+void splitBlock(const char* begin, const char* end, std::vector<TextRange>& ranges)
+{
+    int parts = 1;
+    if (MeshInput::GetAsciiParserMode() == Base::AsciiParser::Parallel && end - begin > 0x40000)
+        parts = std::max<int>(1, QThread::idealThreadCount());
+    Base::AsciiParser::splitLines(begin, end, parts, ranges);
+}
+
+template <class Piece>
+void parsePieces(std::vector<Piece>& pieces, void (*parse)(Piece&))
+{
+    if (pieces.size() > 1)
+        QtConcurrent::blockingMap(pieces, parse);
+    else if (!pieces.empty())
+        parse(pieces.front());
+}
+
+void addPolygon(const std::vector<unsigned long>& poly, unsigned long segment, std::vector<MeshFacet>& facets)
+{
+    MeshFacet item;
+    item.SetProperty(segment);
+    if (poly.size() == 4) {
+        item.SetVertices(poly[0],poly[1],poly[2]);
+        facets.push_back(item);
+        item.SetVertices(poly[2],poly[3],poly[0]);
+        facets.push_back(item);
+    }
+    else {
+        for (std::size_t i = 2; i < poly.size(); i++) {
+            item.SetVertices(poly[0],poly[i-1],poly[i]);
+            facets.push_back(item);
+        }
+    }
+}
+
+// Points and facets of a piece of an OBJ file
+struct ObjPiece
+{
+    ObjPiece(const TextRange& r)
+      : range(r), segment(0), firstIsFace(false), hasFaces(false), readVertices(false)
+    {
+    }
+
+    TextRange range;
+    std::vector<Base::Vector3f> points;
+    std::vector<MeshFacet> facets; /**< Segments are numbered relative to the piece. */
+    unsigned long segment;         /**< Number of segments started in the piece. */
+    bool firstIsFace;              /**< A face comes before any vertex. */
+    bool hasFaces;
+    bool readVertices;             /**< Vertices follow the last face. */
+};
+
+// Reads the point indices of a face, e.g. "1 2 3" or "1/1/1 2/2/2 3/3/3"
+bool readObjFace(const char* pos, const char* end, std::vector<unsigned long>& poly)
+{
+    poly.clear();
+    for (;;) {
+        pos = Base::AsciiParser::skipBlanks(pos, end);
+        if (pos == end)
+            return poly.size() >= 3;
+
+        unsigned long index;
+        pos = Base::AsciiParser::parseUnsigned(pos, end, index);
+        if (!pos)
+            return false;
+        poly.push_back(index-1);
+
+        // skip texture and normal indices
+        for (int i=0; i<2 && pos != end && *pos == '/'; i++) {
+            ++pos;
+            while (pos != end && *pos >= '0' && *pos <= '9')
+                ++pos;
+        }
+        if (pos != end && *pos != ' ' && *pos != '\t' && *pos != '\r')
+            return false;
+    }
+}
+
+void parseObjPiece(ObjPiece& piece)
+{
+    std::vector<unsigned long> poly;
+    bool seenVertex = false;
+    const char* end = piece.range.second;
+    for (const char* line = piece.range.first; line != end; ) {
+        const char* eol = Base::AsciiParser::lineEnd(line, end);
+        const char* pos = Base::AsciiParser::skipBlanks(line, eol);
+        line = (eol != end) ? eol + 1 : end;
+        if (eol - pos < 2 || (pos[1] != ' ' && pos[1] != '\t'))
+            continue;
+
+        if (*pos == 'v' || *pos == 'V') {
+            Base::Vector3f pt;
+            const char* p = pos + 1;
+            if ((p = Base::AsciiParser::parseFloat(p, eol, pt.x)) &&
+                (p = Base::AsciiParser::parseFloat(p, eol, pt.y)) &&
+                (p = Base::AsciiParser::parseFloat(p, eol, pt.z))) {
+                piece.points.push_back(pt);
+                piece.readVertices = true;
+                seenVertex = true;
+            }
+        }
+        else if ((*pos == 'f' || *pos == 'F') && readObjFace(pos + 1, eol, poly)) {
+            // starts a new segment
+            if (piece.readVertices) {
+                piece.readVertices = false;
+                piece.segment++;
+            }
+            if (!seenVertex && !piece.hasFaces)
+                piece.firstIsFace = true;
+            piece.hasFaces = true;
+            addPolygon(poly, piece.segment, piece.facets);
+        }
+    }
+}
+
+void readOBJ(std::istream& str, MeshPointArray& meshPoints, MeshFacetArray& meshFacets)
+{
+    unsigned long segment = 0;
+    bool readvertices = false;
+    std::vector<TextRange> ranges;
+    Base::AsciiBlockReader reader(str);
+    while (reader.next()) {
+        splitBlock(reader.begin(), reader.end(), ranges);
+        std::vector<ObjPiece> pieces(ranges.begin(), ranges.end());
+        parsePieces(pieces, parseObjPiece);
+
+        // append the pieces in file order and make the segments global
+        for (std::vector<ObjPiece>::iterator it = pieces.begin(); it != pieces.end(); ++it) {
+            for (std::vector<Base::Vector3f>::iterator jt = it->points.begin(); jt != it->points.end(); ++jt)
+                meshPoints.push_back(MeshPoint(*jt));
+
+            unsigned long offset = segment;
+            if (readvertices && it->firstIsFace)
+                offset++;
+            for (std::vector<MeshFacet>::iterator jt = it->facets.begin(); jt != it->facets.end(); ++jt) {
+                jt->_ulProp += offset;
+                meshFacets.push_back(*jt);
+            }
+
+            segment = offset + it->segment;
+            if (it->hasFaces)
+                readvertices = it->readVertices;
+            else
+                readvertices = readvertices || it->readVertices;
+        }
+    }
+}
+
+void readOBJWithRegex(std::istream& rstrIn, MeshPointArray& meshPoints, MeshFacetArray& meshFacets)
 {
     boost::regex rx_p("^v\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
                         "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
@@ -424,22 +596,12 @@ bool MeshInput::LoadOBJ (std::istream &rstrIn)
     boost::cmatch what;
 
     unsigned long segment=0;
-    MeshPointArray meshPoints;
-    MeshFacetArray meshFacets;
 
     std::string line;
     float fX, fY, fZ;
     unsigned int  i1=1,i2=1,i3=1,i4=1;
-    MeshGeomFacet clFacet;
     MeshFacet item;
 
-    if (!rstrIn || rstrIn.bad() == true)
-        return false;
-
-    std::streambuf* buf = rstrIn.rdbuf();
-    if (!buf)
-        return false;
-
     bool readvertices=false;
     while (std::getline(rstrIn, line)) {
         for (std::string::iterator it = line.begin(); it != line.end(); ++it)
@@ -488,6 +650,164 @@ bool MeshInput::LoadOBJ (std::istream &rstrIn)
             meshFacets.push_back(item);
         }
     }
+}
+
+// The numbers of each line of a piece of an OFF file
+struct OffPiece
+{
+    OffPiece(const TextRange& r) : range(r)
+    {
+    }
+
+    TextRange range;
+    std::vector<double> values;
+    std::vector<std::size_t> counts; /**< Number of values per line. */
+};
+
+void parseOffPiece(OffPiece& piece)
+{
+    const char* end = piece.range.second;
+    for (const char* line = piece.range.first; line != end; ) {
+        const char* eol = Base::AsciiParser::lineEnd(line, end);
+        const char* pos = Base::AsciiParser::skipBlanks(line, eol);
+        line = (eol != end) ? eol + 1 : end;
+        if (pos == eol || *pos == '#')
+            continue;
+
+        std::size_t count = 0;
+        double value;
+        while ((pos = Base::AsciiParser::parseDouble(pos, eol, value)) != 0) {
+            piece.values.push_back(value);
+            count++;
+        }
+        if (count > 0)
+            piece.counts.push_back(count);
+    }
+}
+
+void readOFF(std::istream& str, int numPoints, int numFaces,
+             MeshPointArray& meshPoints, MeshFacetArray& meshFacets)
+{
+    int cntPoints = 0;
+    int cntFaces = 0;
+    std::vector<unsigned long> poly;
+    std::vector<TextRange> ranges;
+    Base::AsciiBlockReader reader(str);
+    while ((cntPoints < numPoints || cntFaces < numFaces) && reader.next()) {
+        splitBlock(reader.begin(), reader.end(), ranges);
+        std::vector<OffPiece> pieces(ranges.begin(), ranges.end());
+        parsePieces(pieces, parseOffPiece);
+
+        for (std::vector<OffPiece>::iterator it = pieces.begin(); it != pieces.end(); ++it) {
+            const double* v = it->values.empty() ? 0 : &it->values[0];
+            for (std::vector<std::size_t>::iterator jt = it->counts.begin(); jt != it->counts.end(); ++jt) {
+                std::size_t count = *jt;
+                if (cntPoints < numPoints) {
+                    if (count >= 3) {
+                        meshPoints.push_back(MeshPoint(Base::Vector3f((float)v[0], (float)v[1], (float)v[2])));
+                        cntPoints++;
+                    }
+                }
+                else if (cntFaces < numFaces) {
+                    // number of corners followed by the point indices and an optional color
+                    std::size_t corners = v[0] > 0 ? (std::size_t)v[0] : 0;
+                    if (corners >= 3 && (double)corners == v[0] && count > corners) {
+                        poly.clear();
+                        for (std::size_t i=1; i<=corners; i++)
+                            poly.push_back(v[i] >= 0 ? (unsigned long)v[i] : ULONG_MAX);
+                        addPolygon(poly, 0, meshFacets);
+                        cntFaces++;
+                    }
+                }
+                v += count;
+            }
+        }
+    }
+}
+
+void readOFFWithRegex(std::istream& rstrIn, int numPoints, int numFaces,
+                      MeshPointArray& meshPoints, MeshFacetArray& meshFacets)
+{
+    boost::regex rx_p("^\\s*([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
+                       "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
+                       "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)\\s*$");
+    boost::regex rx_f3("^\\s*([0-9]+)\\s+([0-9]+)\\s+([0-9]+)\\s+([0-9]+)\\s*$");
+    boost::regex rx_f4("^\\s*([0-9]+)\\s+([0-9]+)\\s+([0-9]+)\\s+([0-9]+)\\s+([0-9]+)\\s*$");
+
+    boost::cmatch what;
+
+    std::string line;
+    float fX, fY, fZ;
+    unsigned int  i1=1,i2=1,i3=1,i4=1;
+    MeshFacet item;
+
+    int cntPoints = 0;
+    while (cntPoints < numPoints) {
+        if (!std::getline(rstrIn, line))
+            break;
+        if (boost::regex_match(line.c_str(), what, rx_p)) {
+            fX = (float)std::atof(what[1].first);
+            fY = (float)std::atof(what[4].first);
+            fZ = (float)std::atof(what[7].first);
+            meshPoints.push_back(MeshPoint(Base::Vector3f(fX, fY, fZ)));
+            cntPoints++;
+        }
+    }
+
+    int cntFaces = 0;
+    while (cntFaces < numFaces) {
+        if (!std::getline(rstrIn, line))
+            break;
+        if (boost::regex_match(line.c_str(), what, rx_f3)) {
+            // 3-vertex face
+            if (std::atoi(what[1].first) == 3) {
+                i1 = std::atoi(what[2].first);
+                i2 = std::atoi(what[3].first);
+                i3 = std::atoi(what[4].first);
+                item.SetVertices(i1,i2,i3);
+                meshFacets.push_back(item);
+                cntFaces++;
+            }
+        }
+        else if (boost::regex_match(line.c_str(), what, rx_f4)) {
+            // 4-vertex face
+            if (std::atoi(what[1].first) == 4) {
+                i1 = std::atoi(what[2].first);
+                i2 = std::atoi(what[3].first);
+                i3 = std::atoi(what[4].first);
+                i4 = std::atoi(what[5].first);
+
+                item.SetVertices(i1,i2,i3);
+                meshFacets.push_back(item);
+
+                item.SetVertices(i3,i4,i1);
+                meshFacets.push_back(item);
+                cntFaces++;
+            }
+        }
+    }
+}
+
+} // namespace AsciiReader
+} // namespace MeshCore
+
+/** Loads an OBJ file. */
+bool MeshInput::LoadOBJ (std::istream &rstrIn)
+{
+    MeshPointArray meshPoints;
+    MeshFacetArray meshFacets;
+
+    if (!rstrIn || rstrIn.bad() == true)
+        return false;
+
+    std::streambuf* buf = rstrIn.rdbuf();
+    if (!buf)
+        return false;
+
+    if (asciiMode == Base::AsciiParser::Regex)
+        AsciiReader::readOBJWithRegex(rstrIn, meshPoints, meshFacets);
+    else
+        AsciiReader::readOBJ(rstrIn, meshPoints, meshFacets);
 
     this->_rclMesh.Clear(); // remove all data before
     // Don't use Assign() because Merge() checks which points are really needed.
@@ -521,11 +841,6 @@ bool MeshInput::LoadOBJ (std::istream &rstrIn)
 bool MeshInput::LoadOFF (std::istream &rstrIn)
 {
     boost::regex rx_n("^\\s*([0-9]+)\\s+([0-9]+)\\s+([0-9]+)\\s*$");
-    boost::regex rx_p("^\\s*([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
-                       "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
-                       "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)\\s*$");
-    boost::regex rx_f3("^\\s*([0-9]+)\\s+([0-9]+)\\s+([0-9]+)\\s+([0-9]+)\\s*$");
-    boost::regex rx_f4("^\\s*([0-9]+)\\s+([0-9]+)\\s+([0-9]+)\\s+([0-9]+)\\s+([0-9]+)\\s*$");
 
     boost::cmatch what;
 
@@ -533,10 +848,6 @@ bool MeshInput::LoadOFF (std::istream &rstrIn)
     MeshFacetArray meshFacets;
 
     std::string line;
-    float fX, fY, fZ;
-    unsigned int  i1=1,i2=1,i3=1,i4=1;
-    MeshGeomFacet clFacet;
-    MeshFacet item;
 
     if (!rstrIn || rstrIn.bad() == true)
         return false;
@@ -566,51 +877,10 @@ bool MeshInput::LoadOFF (std::istream &rstrIn)
     meshPoints.reserve(numPoints);
     meshFacets.reserve(numFaces);
 
-    int cntPoints = 0;
-    while (cntPoints < numPoints) {
-        if (!std::getline(rstrIn, line))
-            break;
-        if (boost::regex_match(line.c_str(), what, rx_p)) {
-            fX = (float)std::atof(what[1].first);
-            fY = (float)std::atof(what[4].first);
-            fZ = (float)std::atof(what[7].first);
-            meshPoints.push_back(MeshPoint(Base::Vector3f(fX, fY, fZ)));
-            cntPoints++;
-        }
-    }
-
-    int cntFaces = 0;
-    while (cntFaces < numFaces) {
-        if (!std::getline(rstrIn, line))
-            break;
-        if (boost::regex_match(line.c_str(), what, rx_f3)) {
-            // 3-vertex face
-            if (std::atoi(what[1].first) == 3) {
-                i1 = std::atoi(what[2].first);
-                i2 = std::atoi(what[3].first);
-                i3 = std::atoi(what[4].first);
-                item.SetVertices(i1,i2,i3);
-                meshFacets.push_back(item);
-                cntFaces++;
-            }
-        }
-        else if (boost::regex_match(line.c_str(), what, rx_f4)) {
-            // 4-vertex face
-            if (std::atoi(what[1].first) == 4) {
-                i1 = std::atoi(what[2].first);
-                i2 = std::atoi(what[3].first);
-                i3 = std::atoi(what[4].first);
-                i4 = std::atoi(what[5].first);
-
-                item.SetVertices(i1,i2,i3);
-                meshFacets.push_back(item);
-
-                item.SetVertices(i3,i4,i1);
-                meshFacets.push_back(item);
-                cntFaces++;
-            }
-        }
-    }
+    if (asciiMode == Base::AsciiParser::Regex)
+        AsciiReader::readOFFWithRegex(rstrIn, numPoints, numFaces, meshPoints, meshFacets);
+    else
+        AsciiReader::readOFF(rstrIn, numPoints, numFaces, meshPoints, meshFacets);
 
     this->_rclMesh.Clear(); // remove all data before
     // Don't use Assign() because Merge() checks which points are really needed.
@@ -1047,7 +1317,6 @@ bool MeshInput::LoadBinarySTL (std::istream &rstrIn)
 {
     char szInfo[80];
     Base::Vector3f clVects[4];
-    uint16_t usAtt; 
     uint32_t ulCt;
 
     if (!rstrIn || rstrIn.bad() == true)
@@ -1080,15 +1349,31 @@ bool MeshInput::LoadBinarySTL (std::istream &rstrIn)
     MeshBuilder builder(this->_rclMesh);
     builder.Initialize(ulCt);
 
-    for (uint32_t i = 0; i < ulCt; i++) {
-        // read normal, points
-        rstrIn.read((char*)&clVects, sizeof(clVects));
-
-        std::swap(clVects[0], clVects[3]);
-        builder.AddFacet(clVects);
+    // read the records of 50 bytes in large blocks, the data is stored in little endian
+    const uint32_t ulRecord = 50;
+    const uint32_t ulBlock = 0x10000;
+    bool swap = (Base::SwapOrder() != LOW_ENDIAN);
+    std::vector<char> block(std::min<uint32_t>(ulCt, ulBlock) * ulRecord);
+    for (uint32_t i = 0; i < ulCt; i += ulBlock) {
+        uint32_t ulCount = std::min<uint32_t>(ulCt - i, ulBlock);
+        if (!rstrIn.read(&block[0], ulCount * ulRecord))
+            return false;
+
+        const char* record = &block[0];
+        for (uint32_t j = 0; j < ulCount; j++, record += ulRecord) {
+            // read normal, points and skip the 2 bytes attribute
+            std::memcpy(clVects, record, sizeof(clVects));
+            if (swap) {
+                for (int k = 0; k < 4; k++) {
+                    Base::SwapEndian(clVects[k].x);
+                    Base::SwapEndian(clVects[k].y);
+                    Base::SwapEndian(clVects[k].z);
+                }
+            }
 
-        // overread 2 bytes attribute
-        rstrIn.read((char*)&usAtt, sizeof(usAtt));
+            std::swap(clVects[0], clVects[3]);
+            builder.AddFacet(clVects);
+        }
     }
 
     builder.Finish();
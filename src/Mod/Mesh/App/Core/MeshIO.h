@@ -27,6 +27,7 @@
 #include "MeshKernel.h"
 #include <Base/Vector3D.h>
 #include <Base/Matrix.h>
+#include <Base/AsciiParser.h>
 #include <App/Material.h>
 
 namespace Base {
@@ -82,6 +83,12 @@ public:
         : _rclMesh(rclM), _material(m){}
     virtual ~MeshInput (void) { }
 
+    /** Sets how OBJ and OFF files are parsed. By default the files are parsed
+     * by several threads.
+     */
+    static void SetAsciiParserMode(Base::AsciiParser::Mode);
+    static Base::AsciiParser::Mode GetAsciiParserMode();
+
     /// Loads the file, decided by extension
     bool LoadAny(const char* FileName);
     /** Loads an STL file either in binary or ASCII format. 
@@ -112,6 +119,7 @@ public:
 protected:
     MeshKernel &_rclMesh;   /**< reference to mesh data structure */
     Material* _material;
+    static Base::AsciiParser::Mode asciiMode;
 };
 
 /**
@@ -28,8 +28,13 @@
 # include <stdexcept>
 # include <map>
 # include <queue>
+# include <climits>
+# include <cmath>
 #endif
 
+#include <boost/unordered_map.hpp>
+#include <boost/functional/hash.hpp>
+
 #include <Base/Exception.h>
 #include <Base/Sequencer.h>
 #include <Base/Stream.h>
@@ -46,13 +51,228 @@
 
 using namespace MeshCore;
 
+namespace MeshCore {
+
+/**
+ * The MeshWeldIndex class is used by MeshKernel::AddFacet() to find an existing point
+ * and the neighbour facets of a new facet without searching the whole point and facet
+ * arrays. The points are stored in a spatial hash with cells of the size of the
+ * tolerance, so that all points that are equal to a given point lie in the 27 cells
+ * around it. The edges are stored in a hash map with the directed edge as key.
+ * The index only stores the indices of points and facets and thus must be rebuilt
+ * as soon as the mesh is modified in any other way.
+ */
+class MeshWeldIndex
+{
+public:
+    MeshWeldIndex(const MeshPointArray& rPoints, const MeshFacetArray& rFacets);
+
+    /** Checks whether the index still describes the given arrays. */
+    bool IsValid(const MeshPointArray& rPoints, const MeshFacetArray& rFacets) const;
+    /** Returns the lowest index of a point that is equal to \a rPoint, or ULONG_MAX.
+     * This is the same point that MeshPointArray::Get() would find.
+     */
+    unsigned long FindPoint(const MeshPointArray& rPoints, const Base::Vector3f& rPoint) const;
+    /** Adds the point with index \a ulIndex to the index. */
+    void AddPoint(const MeshPointArray& rPoints, unsigned long ulIndex);
+    /** Sets the neighbours of the new facet \a rFacet that will get the index \a ulIndex
+     * and updates the neighbours of the adjacent facets.
+     */
+    void SetNeighbours(MeshFacetArray& rFacets, MeshFacet& rFacet, unsigned long ulIndex) const;
+    /** Adds the edges of the facet with index \a ulIndex to the index. */
+    void AddFacet(const MeshFacetArray& rFacets, unsigned long ulIndex);
+
+private:
+    struct Cell {
+        long long x, y, z;
+        bool operator == (const Cell& c) const
+        { return x == c.x && y == c.y && z == c.z; }
+    };
+    struct CellHash {
+        std::size_t operator () (const Cell& c) const
+        {
+            std::size_t seed = 0;
+            boost::hash_combine(seed, c.x);
+            boost::hash_combine(seed, c.y);
+            boost::hash_combine(seed, c.z);
+            return seed;
+        }
+    };
+    typedef std::pair<unsigned long, unsigned long> Edge;
+    // The maps hold the first element of a list that continues in _nextPoint or _nextSide
+    typedef boost::unordered_map<Cell, unsigned long, CellHash> CellMap;
+    typedef boost::unordered_map<Edge, unsigned long, boost::hash<Edge> > EdgeMap;
+
+    long long GetCoordinate(float fValue) const;
+    Cell GetCell(const Base::Vector3f& rPoint) const;
+
+    float _fTolerance;  /**< The tolerance the index was built for. */
+    float _fCellSize;
+    CellMap _cells;
+    EdgeMap _edges;
+    std::vector<unsigned long> _nextPoint; /**< The next point in the same cell. */
+    std::vector<unsigned long> _nextSide;  /**< The next facet side (3 * facet + side) with the same edge. */
+};
+
+} // namespace MeshCore
+
+MeshWeldIndex::MeshWeldIndex(const MeshPointArray& rPoints, const MeshFacetArray& rFacets)
+  : _fTolerance(MeshDefinitions::_fMinPointDistanceP2)
+{
+    // make the cells a bit larger so that rounding errors of the distance can't matter
+    _fCellSize = 1.01f * std::sqrt(_fTolerance);
+    if (!(_fCellSize > 0.0f))
+        _fCellSize = 1.0f; // no points are equal at all
+
+    _cells.rehash(rPoints.size());
+    _nextPoint.reserve(rPoints.size());
+    for (unsigned long i = 0; i < rPoints.size(); i++)
+        AddPoint(rPoints, i);
+
+    _edges.rehash(3 * rFacets.size() / 2);
+    _nextSide.reserve(3 * rFacets.size());
+    for (unsigned long i = 0; i < rFacets.size(); i++)
+        AddFacet(rFacets, i);
+}
+
+bool MeshWeldIndex::IsValid(const MeshPointArray& rPoints, const MeshFacetArray& rFacets) const
+{
+    return (_nextPoint.size() == rPoints.size() &&
+            _nextSide.size() == 3 * rFacets.size() &&
+            _fTolerance == MeshDefinitions::_fMinPointDistanceP2);
+}
+
+long long MeshWeldIndex::GetCoordinate(float fValue) const
+{
+    // very large or invalid coordinates share the outermost cells
+    const double limit = 4.0e18;
+    double cell = std::floor(double(fValue) / double(_fCellSize));
+    if (!(cell > -limit))
+        cell = -limit;
+    else if (cell > limit)
+        cell = limit;
+    return static_cast<long long>(cell);
+}
+
+MeshWeldIndex::Cell MeshWeldIndex::GetCell(const Base::Vector3f& rPoint) const
+{
+    Cell cell;
+    cell.x = GetCoordinate(rPoint.x);
+    cell.y = GetCoordinate(rPoint.y);
+    cell.z = GetCoordinate(rPoint.z);
+    return cell;
+}
+
+unsigned long MeshWeldIndex::FindPoint(const MeshPointArray& rPoints, const Base::Vector3f& rPoint) const
+{
+    unsigned long ulFound = ULONG_MAX;
+    Cell center = GetCell(rPoint);
+    Cell cell;
+    for (cell.x = center.x - 1; cell.x <= center.x + 1; cell.x++) {
+        for (cell.y = center.y - 1; cell.y <= center.y + 1; cell.y++) {
+            for (cell.z = center.z - 1; cell.z <= center.z + 1; cell.z++) {
+                CellMap::const_iterator it = _cells.find(cell);
+                if (it == _cells.end())
+                    continue;
+                for (unsigned long i = it->second; i != ULONG_MAX; i = _nextPoint[i]) {
+                    if (i < ulFound && rPoints[i] == rPoint)
+                        ulFound = i;
+                }
+            }
+        }
+    }
+
+    return ulFound;
+}
+
+void MeshWeldIndex::AddPoint(const MeshPointArray& rPoints, unsigned long ulIndex)
+{
+    std::pair<CellMap::iterator, bool> it = _cells.insert(std::make_pair(GetCell(rPoints[ulIndex]), ulIndex));
+    if (it.second) {
+        _nextPoint.push_back(ULONG_MAX);
+    }
+    else {
+        _nextPoint.push_back(it.first->second);
+        it.first->second = ulIndex;
+    }
+}
+
+void MeshWeldIndex::SetNeighbours(MeshFacetArray& rFacets, MeshFacet& rFacet, unsigned long ulIndex) const
+{
+    const unsigned long* p = rFacet._aulPoints;
+    for (int i = 0; i < 3; i++) {
+        // an adjacent facet has the same edge in the opposite direction
+        Edge edge(p[(i+1)%3], p[i]);
+
+        // for degenerated facets an edge is only handled for the first side it appears
+        if ((i > 0 && edge == Edge(p[1], p[0])) || (i > 1 && edge == Edge(p[2], p[1])))
+            continue;
+
+        EdgeMap::const_iterator it = _edges.find(edge);
+        if (it == _edges.end())
+            continue;
+
+        // the list starts with the facet that was added last
+        rFacet._aulNeighbours[i] = it->second / 3;
+        for (unsigned long side = it->second; side != ULONG_MAX; side = _nextSide[side])
+            rFacets[side / 3]._aulNeighbours[side % 3] = ulIndex;
+    }
+}
+
+void MeshWeldIndex::AddFacet(const MeshFacetArray& rFacets, unsigned long ulIndex)
+{
+    const MeshFacet& rFacet = rFacets[ulIndex];
+    for (int i = 0; i < 3; i++) {
+        unsigned long side = 3 * ulIndex + i;
+        Edge edge(rFacet._aulPoints[i], rFacet._aulPoints[(i+1)%3]);
+        std::pair<EdgeMap::iterator, bool> it = _edges.insert(std::make_pair(edge, side));
+        if (it.second) {
+            _nextSide.push_back(ULONG_MAX);
+        }
+        else {
+            _nextSide.push_back(it.first->second);
+            it.first->second = side;
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+namespace MeshCore {
+
+// The arrays of the binary format are read and written in blocks of this number of values
+// instead of streaming every single value
+const unsigned long MeshKernel_BlockSize = 0x30000;
+
+template <class T>
+void MeshKernel_ReadBlock(std::istream& rclIn, std::vector<T>& rBlock, unsigned long ulCount, bool bSwap)
+{
+    rBlock.resize(ulCount);
+    if (ulCount > 0 && !rclIn.read(reinterpret_cast<char*>(&rBlock[0]), ulCount * sizeof(T)))
+        throw Base::Exception("Reading from stream failed");
+    if (bSwap) {
+        for (typename std::vector<T>::iterator it = rBlock.begin(); it != rBlock.end(); ++it)
+            Base::SwapEndian(*it);
+    }
+}
+
+template <class T>
+void MeshKernel_WriteBlock(std::ostream& rclOut, const std::vector<T>& rBlock)
+{
+    if (!rBlock.empty())
+        rclOut.write(reinterpret_cast<const char*>(&rBlock[0]), rBlock.size() * sizeof(T));
+}
+
+}
+
 MeshKernel::MeshKernel (void)
-: _bValid(true)
+: _bValid(true), _pclIndex(0)
 {
     _clBoundBox.Flush();
 }
 
 MeshKernel::MeshKernel (const MeshKernel &rclMesh)
+: _pclIndex(0)
 {
     *this = rclMesh;
 }
@@ -60,6 +280,7 @@ MeshKernel::MeshKernel (const MeshKernel &rclMesh)
 MeshKernel& MeshKernel::operator = (const MeshKernel &rclMesh)
 {
     if (this != &rclMesh) { // must be a different instance
+        ClearIndex();
         this->_aclPointArray  = rclMesh._aclPointArray;
         this->_aclFacetArray  = rclMesh._aclFacetArray;
         this->_clBoundBox     = rclMesh._clBoundBox;
@@ -83,6 +304,7 @@ MeshKernel& MeshKernel::operator = (const std::vector<MeshGeomFacet> &rclFAry)
 
 void MeshKernel::Assign(const MeshPointArray& rPoints, const MeshFacetArray& rFacets, bool checkNeighbourHood)
 {
+    ClearIndex();
     _aclPointArray = rPoints;
     _aclFacetArray = rFacets;
     RecalcBoundBox();
@@ -92,6 +314,7 @@ void MeshKernel::Assign(const MeshPointArray& rPoints, const MeshFacetArray& rFa
 
 void MeshKernel::Adopt(MeshPointArray& rPoints, MeshFacetArray& rFacets, bool checkNeighbourHood)
 {
+    ClearIndex();
     _aclPointArray.swap(rPoints);
     _aclFacetArray.swap(rFacets);
     RecalcBoundBox();
@@ -101,6 +324,8 @@ void MeshKernel::Adopt(MeshPointArray& rPoints, MeshFacetArray& rFacets, bool ch
 
 void MeshKernel::Swap(MeshKernel& mesh)
 {
+    this->ClearIndex();
+    mesh.ClearIndex();
     this->_aclPointArray.swap(mesh._aclPointArray);
     this->_aclFacetArray.swap(mesh._aclFacetArray);
     this->_clBoundBox = mesh._clBoundBox;
@@ -117,10 +342,22 @@ void MeshKernel::AddFacet(const MeshGeomFacet &rclSFacet)
     unsigned long i;
     MeshFacet clFacet;
 
+    // (re)build the index if the mesh was modified in the meantime
+    if (!_pclIndex || !_pclIndex->IsValid(_aclPointArray, _aclFacetArray)) {
+        ClearIndex();
+        _pclIndex = new MeshWeldIndex(_aclPointArray, _aclFacetArray);
+    }
+
     // set corner points
     for (i = 0; i < 3; i++) {
         _clBoundBox &= rclSFacet._aclPoints[i];
-        clFacet._aulPoints[i] = _aclPointArray.GetOrAddIndex(rclSFacet._aclPoints[i]);
+        unsigned long ulIndex = _pclIndex->FindPoint(_aclPointArray, rclSFacet._aclPoints[i]);
+        if (ulIndex == ULONG_MAX) {
+            ulIndex = _aclPointArray.size();
+            _aclPointArray.push_back(rclSFacet._aclPoints[i]);
+            _pclIndex->AddPoint(_aclPointArray, ulIndex);
+        }
+        clFacet._aulPoints[i] = ulIndex;
     }
 
     // adjust orientation to normal
@@ -129,31 +366,21 @@ void MeshKernel::AddFacet(const MeshGeomFacet &rclSFacet)
     unsigned long ulCt = _aclFacetArray.size();
 
     // set neighbourhood
-    unsigned long ulP0 = clFacet._aulPoints[0];
-    unsigned long ulP1 = clFacet._aulPoints[1];
-    unsigned long ulP2 = clFacet._aulPoints[2];
-    unsigned long ulCC = 0;
-    for (TMeshFacetArray::iterator pF = _aclFacetArray.begin(); pF != _aclFacetArray.end(); pF++, ulCC++) {
-        for (int i=0; i<3;i++) {
-            unsigned long ulP = pF->_aulPoints[i];
-            unsigned long ulQ = pF->_aulPoints[(i+1)%3];
-            if (ulQ == ulP0 && ulP == ulP1) {
-                clFacet._aulNeighbours[0] = ulCC;
-                pF->_aulNeighbours[i] = ulCt;
-            }
-            else if (ulQ == ulP1 && ulP == ulP2) {
-                clFacet._aulNeighbours[1] = ulCC;
-                pF->_aulNeighbours[i] = ulCt;
-            }
-            else if (ulQ == ulP2 && ulP == ulP0) {
-                clFacet._aulNeighbours[2] = ulCC;
-                pF->_aulNeighbours[i] = ulCt;
-            }
-        }
-    }
+    _pclIndex->SetNeighbours(_aclFacetArray, clFacet, ulCt);
 
     // insert facet into array
     _aclFacetArray.push_back(clFacet);
+    _pclIndex->AddFacet(_aclFacetArray, ulCt);
+}
+
+void MeshKernel::ClearIndex ()
+{
+    // only write the member if there is an index, so that algorithms running
+    // in several threads can call this without a data race
+    if (_pclIndex) {
+        delete _pclIndex;
+        _pclIndex = 0;
+    }
 }
 
 MeshKernel& MeshKernel::operator += (const std::vector<MeshGeomFacet> &rclFAry)
@@ -174,6 +401,7 @@ void MeshKernel::AddFacets(const std::vector<MeshGeomFacet> &rclFAry)
 
 unsigned long MeshKernel::AddFacets(const std::vector<MeshFacet> &rclFAry)
 {
+    ClearIndex();
     // Build map of edges of the referencing facets we want to append
 #ifdef FC_DEBUG
     unsigned long countPoints = CountPoints();
@@ -317,6 +545,7 @@ unsigned long MeshKernel::AddFacets(const std::vector<MeshFacet> &rclFAry)
 
 unsigned long MeshKernel::AddFacets(const std::vector<MeshFacet> &rclFAry, const std::vector<Base::Vector3f>& rclPAry)
 {
+    ClearIndex();
     for (std::vector<Base::Vector3f>::const_iterator it = rclPAry.begin(); it != rclPAry.end(); ++it)
         _clBoundBox &= *it;
     this->_aclPointArray.insert(this->_aclPointArray.end(), rclPAry.begin(), rclPAry.end());
@@ -334,6 +563,7 @@ void MeshKernel::Merge(const MeshKernel& rKernel)
 
 void MeshKernel::Merge(const MeshPointArray& rPoints, const MeshFacetArray& rFaces)
 {
+    ClearIndex();
     if (rPoints.empty() || rFaces.empty())
         return; // nothing to do
     std::vector<unsigned long> increments(rPoints.size());
@@ -387,6 +617,7 @@ void MeshKernel::Merge(const MeshPointArray& rPoints, const MeshFacetArray& rFac
 
 void MeshKernel::Clear (void)
 {
+    ClearIndex();
     _aclPointArray.clear();
     _aclFacetArray.clear();
 
@@ -399,6 +630,7 @@ void MeshKernel::Clear (void)
 
 bool MeshKernel::DeleteFacet (const MeshFacetIterator &rclIter)
 {
+    ClearIndex();
     unsigned long i, j, ulNFacet, ulInd;
 
     if (rclIter._clIter >= _aclFacetArray.end())
@@ -448,6 +680,7 @@ bool MeshKernel::DeleteFacet (unsigned long ulInd)
 
 void MeshKernel::DeleteFacets (const std::vector<unsigned long> &raulFacets)
 {
+    ClearIndex();
     _aclPointArray.SetProperty(0);
 
     // number of referencing facets per point
@@ -491,6 +724,7 @@ bool MeshKernel::DeletePoint (unsigned long ulInd)
 
 bool MeshKernel::DeletePoint (const MeshPointIterator &rclIter)
 {
+    ClearIndex();
     MeshFacetIterator pFIter(*this), pFEnd(*this);
     std::vector<MeshFacetIterator>  clToDel; 
     unsigned long i, ulInd;
@@ -522,6 +756,7 @@ bool MeshKernel::DeletePoint (const MeshPointIterator &rclIter)
 
 void MeshKernel::DeletePoints (const std::vector<unsigned long> &raulPoints)
 {
+    ClearIndex();
     _aclPointArray.ResetInvalid();
     for (std::vector<unsigned long>::const_iterator pI = raulPoints.begin(); pI != raulPoints.end(); pI++)
         _aclPointArray[*pI].SetInvalid();
@@ -602,6 +837,7 @@ void MeshKernel::ErasePoint (unsigned long ulIndex, unsigned long ulFacetIndex,
 
 void MeshKernel::RemoveInvalids ()
 {
+    ClearIndex();
     std::vector<unsigned long> aulDecrements;
     std::vector<unsigned long>::iterator pDIter;
     unsigned long ulDec, i, k;
@@ -777,19 +1013,35 @@ void MeshKernel::Write (std::ostream &rclOut) const
     // write the number of points and facets
     str << (uint32_t)CountPoints() << (uint32_t)CountFacets();
 
-    // write the data
+    // write the data in blocks, the stream writes in native byte order, too
+    std::vector<float> points;
+    points.reserve(3 * std::min<unsigned long>(CountPoints(), MeshKernel_BlockSize));
     for (MeshPointArray::_TConstIterator it = _aclPointArray.begin(); it != _aclPointArray.end(); ++it) {
-        str << it->x << it->y << it->z;
+        points.push_back(it->x);
+        points.push_back(it->y);
+        points.push_back(it->z);
+        if (points.size() == 3 * MeshKernel_BlockSize) {
+            MeshKernel_WriteBlock(rclOut, points);
+            points.clear();
+        }
     }
+    MeshKernel_WriteBlock(rclOut, points);
 
+    std::vector<uint32_t> facets;
+    facets.reserve(6 * std::min<unsigned long>(CountFacets(), MeshKernel_BlockSize));
     for (MeshFacetArray::_TConstIterator it = _aclFacetArray.begin(); it != _aclFacetArray.end(); ++it) {
-        str << (uint32_t)it->_aulPoints[0] 
-            << (uint32_t)it->_aulPoints[1] 
-            << (uint32_t)it->_aulPoints[2];
-        str << (uint32_t)it->_aulNeighbours[0] 
-            << (uint32_t)it->_aulNeighbours[1] 
-            << (uint32_t)it->_aulNeighbours[2];
+        facets.push_back((uint32_t)it->_aulPoints[0]);
+        facets.push_back((uint32_t)it->_aulPoints[1]);
+        facets.push_back((uint32_t)it->_aulPoints[2]);
+        facets.push_back((uint32_t)it->_aulNeighbours[0]);
+        facets.push_back((uint32_t)it->_aulNeighbours[1]);
+        facets.push_back((uint32_t)it->_aulNeighbours[2]);
+        if (facets.size() == 6 * MeshKernel_BlockSize) {
+            MeshKernel_WriteBlock(rclOut, facets);
+            facets.clear();
+        }
     }
+    MeshKernel_WriteBlock(rclOut, facets);
 
     str << _clBoundBox.MinX << _clBoundBox.MaxX;
     str << _clBoundBox.MinY << _clBoundBox.MaxY;
@@ -798,6 +1050,7 @@ void MeshKernel::Write (std::ostream &rclOut) const
 
 void MeshKernel::Read (std::istream &rclIn)
 {
+    ClearIndex();
     if (!rclIn || rclIn.bad())
         return;
 
@@ -829,27 +1082,35 @@ void MeshKernel::Read (std::istream &rclIn)
         str >> uCtPts >> uCtFts;
 
         try {
-            // read the data
+            // read the data in blocks
+            bool swap = (str.byteOrder() == Base::Stream::BigEndian);
             MeshPointArray pointArray;
             pointArray.resize(uCtPts);
-            for (MeshPointArray::_TIterator it = pointArray.begin(); it != pointArray.end(); ++it) {
-                str >> it->x >> it->y >> it->z;
+            std::vector<float> points;
+            for (unsigned long i = 0; i < uCtPts; i += MeshKernel_BlockSize) {
+                unsigned long ulCount = std::min<unsigned long>(uCtPts - i, MeshKernel_BlockSize);
+                MeshKernel_ReadBlock(rclIn, points, 3 * ulCount, swap);
+                for (unsigned long j = 0; j < ulCount; j++)
+                    pointArray[i + j].Set(points[3*j], points[3*j+1], points[3*j+2]);
             }
-          
+            std::vector<float>().swap(points);
+
             MeshFacetArray facetArray;
             facetArray.resize(uCtFts);
-
-            uint32_t v1, v2, v3;
-            for (MeshFacetArray::_TIterator it = facetArray.begin(); it != facetArray.end(); ++it) {
-                str >> v1 >> v2 >> v3;
-                it->_aulPoints[0] = v1;
-                it->_aulPoints[1] = v2;
-                it->_aulPoints[2] = v3;
-
-                str >> v1 >> v2 >> v3;
-                it->_aulNeighbours[0] = v1;
-                it->_aulNeighbours[1] = v2;
-                it->_aulNeighbours[2] = v3;
+            std::vector<uint32_t> facets;
+            for (unsigned long i = 0; i < uCtFts; i += MeshKernel_BlockSize) {
+                unsigned long ulCount = std::min<unsigned long>(uCtFts - i, MeshKernel_BlockSize);
+                MeshKernel_ReadBlock(rclIn, facets, 6 * ulCount, swap);
+                for (unsigned long j = 0; j < ulCount; j++) {
+                    MeshFacet& face = facetArray[i + j];
+                    const uint32_t* v = &facets[6*j];
+                    face._aulPoints[0] = v[0];
+                    face._aulPoints[1] = v[1];
+                    face._aulPoints[2] = v[2];
+                    // open edges are stored as 32 bit value
+                    for (int k = 0; k < 3; k++)
+                        face._aulNeighbours[k] = (v[3+k] == 0xFFFFFFFF) ? ULONG_MAX : v[3+k];
+                }
             }
 
             str >> _clBoundBox.MinX >> _clBoundBox.MaxX;
@@ -892,6 +1153,7 @@ void MeshKernel::Transform (const Base::Matrix4D &rclMat)
     MeshPointArray::_TIterator  clPIter = _aclPointArray.begin(), clPEIter = _aclPointArray.end();
     Base::Matrix4D clMatrix(rclMat);
 
+    ClearIndex();
     _clBoundBox.Flush();
     while (clPIter < clPEIter) {
         *clPIter *= clMatrix;
@@ -902,6 +1164,7 @@ void MeshKernel::Transform (const Base::Matrix4D &rclMat)
 
 void MeshKernel::Smooth(int iterations, float stepsize)
 {
+    ClearIndex();
     LaplaceSmoothing(*this).Smooth(iterations);
 }
 
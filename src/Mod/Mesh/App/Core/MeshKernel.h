@@ -49,6 +49,7 @@ class MeshFacet;
 class MeshFacetVisitor;
 class MeshPointVisitor;
 class MeshFacetGrid;
+class MeshWeldIndex;
 
 
 /** 
@@ -254,12 +255,15 @@ public:
 
     /** @name Modification */
     //@{
-    /** Adds a single facet to the data structure. This method is very slow and should
-     * be called occassionally only.
+    /** Adds a single facet to the data structure. Corner points that are closer than
+     * MeshDefinitions::_fMinPointDistance to an existing point are welded with this point.
+     * The first call builds a spatial hash of the points and a map of the edges that is
+     * kept as long as the mesh is modified by this method only, so that adding many facets
+     * one after another takes linear time. Adding a whole array of facets at once with
+     * AddFacets() is still faster.
      */
     MeshKernel& operator += (const MeshGeomFacet &rclSFacet);
-    /** Adds a single facet to the data structure. This method is very slow and should
-     * be called occassionally only. This does the same as the += operator above.
+    /** Adds a single facet to the data structure. This does the same as the += operator above.
      */
     void AddFacet(const MeshGeomFacet &rclSFacet);
     /** Adds an array of facets to the data structure. This method keeps temporarily 
@@ -415,6 +419,11 @@ protected:
      */
     void ErasePoint (unsigned long ulIndex, unsigned long ulFacetIndex, bool bOnlySetInvalid = false);
 
+    /** Removes the index that is used by AddFacet(). Every method and every friend class
+     * that modifies the points or the topology other than through AddFacet() must call this.
+     */
+    void ClearIndex ();
+
     /** Adjusts the facet's orierntation to the given normal direction. */
     inline void AdjustNormal (MeshFacet &rclFacet, const Base::Vector3f &rclNormal);
     /** Calculates the normal to the given facet. */
@@ -426,6 +435,7 @@ protected:
     MeshFacetArray   _aclFacetArray; /**< Holds the array of facets. */
     Base::BoundBox3f _clBoundBox;    /**< The current calculated bounding box. */
     bool            _bValid; /**< Current state of validality. */
+    MeshWeldIndex*   _pclIndex;      /**< Point and edge index of AddFacet(). */
 
     // friends
     friend class MeshPointIterator;
@@ -494,16 +504,22 @@ inline void MeshKernel::GetFacetNeighbours (unsigned long ulIndex, unsigned long
 inline void MeshKernel::MovePoint (unsigned long ulPtIndex, const Base::Vector3f &rclTrans)
 {
     _aclPointArray[ulPtIndex] += rclTrans;
+    if (_pclIndex)
+        ClearIndex();
 }
 
 inline void MeshKernel::SetPoint (unsigned long ulPtIndex, const Base::Vector3f &rPoint)
 {
     _aclPointArray[ulPtIndex] = rPoint;
+    if (_pclIndex)
+        ClearIndex();
 }
 
 inline void MeshKernel::SetPoint (unsigned long ulPtIndex, float x, float y, float z)
 {
     _aclPointArray[ulPtIndex].Set(x,y,z);
+    if (_pclIndex)
+        ClearIndex();
 }
 
 inline void MeshKernel::AdjustNormal (MeshFacet &rclFacet, const Base::Vector3f &rclNormal)
@@ -0,0 +1,559 @@
+/***************************************************************************
+ *   Copyright (c) 2026 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <algorithm>
+# include <cmath>
+# include <cstring>
+# include <memory>
+#endif
+
+#include "MeshStream.h"
+#include "MeshKernel.h"
+#include "Builder.h"
+#include "Degeneration.h"
+#include "Elements.h"
+#include "Smoothing.h"
+
+#include <Base/Exception.h>
+#include <Base/FileInfo.h>
+#include <Base/Sequencer.h>
+#include <Base/Stream.h>
+#include <Base/Swap.h>
+
+using namespace MeshCore;
+
+namespace {
+
+const std::size_t RecordSize = 50;      // size of a facet record of a binary STL file
+const std::size_t BlockFacets = 0x10000; // number of records read or written at once
+const std::size_t MaxTiles = 4096;
+// Approximate peak memory per facet while a tile is smoothed: the kernel itself, the
+// builder and the point-to-point and point-to-facet references of the smoothing
+const double BytesPerFacet = 400.0;
+
+// Reads the header of a binary STL file and returns the number of facets
+uint32_t ReadHeader(std::istream& str, const char* name)
+{
+    char szInfo[80];
+    uint32_t ulCt = 0;
+    str.read(szInfo, sizeof(szInfo));
+    str.read((char*)&ulCt, sizeof(ulCt));
+    if (!str)
+        throw Base::FileException("Cannot read binary STL file", name);
+    if (Base::SwapOrder() != LOW_ENDIAN)
+        Base::SwapEndian(ulCt);
+
+    // the file must be large enough to hold all records
+    std::streamoff ulCurr = str.tellg();
+    str.seekg(0, std::ios::end);
+    std::streamoff ulSize = str.tellg();
+    str.seekg(ulCurr, std::ios::beg);
+    if (ulSize < ulCurr || std::streamoff(ulCt) > (ulSize - ulCurr) / std::streamoff(RecordSize))
+        throw Base::Exception("Only binary STL files can be processed tile by tile");
+    return ulCt;
+}
+
+// Reads the next block of at most BlockFacets records
+uint32_t ReadBlock(std::istream& str, uint32_t left, std::vector<char>& block, const char* name)
+{
+    uint32_t count = std::min<uint32_t>(left, BlockFacets);
+    block.resize(count * RecordSize);
+    if (count > 0 && !str.read(&block[0], count * RecordSize))
+        throw Base::FileException("Cannot read binary STL file", name);
+    return count;
+}
+
+// Extracts the three corners of a record, the normal is ignored
+void DecodeRecord(const char* record, bool swap, Base::Vector3f* points)
+{
+    float coords[9];
+    std::memcpy(coords, record + 3 * sizeof(float), sizeof(coords));
+    if (swap) {
+        for (int i = 0; i < 9; i++)
+            Base::SwapEndian(coords[i]);
+    }
+    for (int i = 0; i < 3; i++)
+        points[i].Set(coords[3*i], coords[3*i+1], coords[3*i+2]);
+}
+
+void EncodeRecord(const Base::Vector3f* points, bool swap, char* record)
+{
+    Base::Vector3f normal = (points[1] - points[0]) % (points[2] - points[0]);
+    normal.Normalize();
+
+    float coords[12] = {
+        normal.x, normal.y, normal.z,
+        points[0].x, points[0].y, points[0].z,
+        points[1].x, points[1].y, points[1].z,
+        points[2].x, points[2].y, points[2].z
+    };
+    if (swap) {
+        for (int i = 0; i < 12; i++)
+            Base::SwapEndian(coords[i]);
+    }
+    std::memcpy(record, coords, sizeof(coords));
+    record[48] = 0; // attribute
+    record[49] = 0;
+}
+
+}
+
+bool MeshStreamProcessor::VectorLess::operator()(const Base::Vector3f& a, const Base::Vector3f& b) const
+{
+    if (a.x != b.x)
+        return a.x < b.x;
+    if (a.y != b.y)
+        return a.y < b.y;
+    return a.z < b.z;
+}
+
+MeshStreamProcessor::MeshStreamProcessor()
+  : _memoryBudget(0x20000000), _smoothing(None), _iterations(0), _lambda(0.6307), _micro(0.0424)
+  , _evaluate(false), _maxEdge(0.0f), _meanEdge(0.0f), _margin(0.0f), _flushSize(0)
+  , _countFacets(0), _countTiles(0), _countWritten(0), _countDuplicatedPoints(0), _countDegeneratedFacets(0)
+{
+    _grid[0] = _grid[1] = _grid[2] = 1;
+    _cellSize[0] = _cellSize[1] = _cellSize[2] = 1.0f;
+}
+
+MeshStreamProcessor::~MeshStreamProcessor()
+{
+    RemoveTiles();
+}
+
+void MeshStreamProcessor::SetMemoryBudget(unsigned long bytes)
+{
+    _memoryBudget = std::max<unsigned long>(bytes, 0x100000);
+}
+
+void MeshStreamProcessor::SetSmoothing(Smoothing type, unsigned int iterations, double lambda, double micro)
+{
+    _smoothing = type;
+    _iterations = iterations;
+    _lambda = lambda;
+    _micro = micro;
+}
+
+void MeshStreamProcessor::SetTransform(const Base::Matrix4D& mat)
+{
+    _transform = mat;
+}
+
+void MeshStreamProcessor::Process(const char* input, const char* output)
+{
+    RemoveTiles();
+    _seamPoints.clear();
+    _countFacets = 0;
+    _countTiles = 0;
+    _countWritten = 0;
+    _countDuplicatedPoints = 0;
+    _countDegeneratedFacets = 0;
+
+    ScanInput(input);
+    SetupTiles();
+    SplitInput(input);
+
+    std::auto_ptr<Base::ofstream> out;
+    if (output) {
+        out.reset(new Base::ofstream(Base::FileInfo(output), std::ios::out | std::ios::binary));
+        if (!*out)
+            throw Base::FileException("Cannot open file", output);
+
+        // the number of facets is written at the end
+        std::string header = "MESH-MESH-MESH-MESH-MESH-MESH-MESH-MESH-"
+                             "MESH-MESH-MESH-MESH-MESH-MESH-MESH-MESH\n";
+        uint32_t ulCt = 0;
+        out->write(header.c_str(), 80);
+        out->write((const char*)&ulCt, sizeof(ulCt));
+    }
+
+    Base::SequencerLauncher seq("Processing tiles...", _tileFiles.size());
+    for (std::size_t i = 0; i < _tileFiles.size(); i++) {
+        ProcessTile(i, out.get());
+        seq.next(true); // allow to cancel
+    }
+
+    if (out.get()) {
+        uint32_t ulCt = (uint32_t)_countWritten;
+        if (Base::SwapOrder() != LOW_ENDIAN)
+            Base::SwapEndian(ulCt);
+        out->seekp(80, std::ios::beg);
+        out->write((const char*)&ulCt, sizeof(ulCt));
+        out->close();
+        if (out->fail())
+            throw Base::FileException("Cannot write file", output);
+    }
+
+    RemoveTiles();
+    _seamPoints.clear();
+}
+
+void MeshStreamProcessor::ScanInput(const char* input)
+{
+    Base::ifstream str(Base::FileInfo(input), std::ios::in | std::ios::binary);
+    if (!str)
+        throw Base::FileException("Cannot open file", input);
+
+    uint32_t ulCt = ReadHeader(str, input);
+    _countFacets = ulCt;
+    _bbox = Base::BoundBox3f();
+    _maxEdge = 0.0f;
+
+    bool swap = (Base::SwapOrder() != LOW_ENDIAN);
+    double sumEdges = 0.0;
+    std::vector<char> block;
+    Base::Vector3f points[3];
+
+    Base::SequencerLauncher seq("Reading mesh...", ulCt / BlockFacets + 1);
+    for (uint32_t left = ulCt; left > 0; ) {
+        uint32_t count = ReadBlock(str, left, block, input);
+        left -= count;
+        for (uint32_t i = 0; i < count; i++) {
+            DecodeRecord(&block[i * RecordSize], swap, points);
+            for (int j = 0; j < 3; j++) {
+                _bbox.Add(points[j]);
+                float len = Base::Distance(points[j], points[(j+1)%3]);
+                sumEdges += len;
+                _maxEdge = std::max<float>(_maxEdge, len);
+            }
+        }
+        seq.next(true);
+    }
+
+    _meanEdge = ulCt > 0 ? float(sumEdges / (3.0 * ulCt)) : 0.0f;
+}
+
+void MeshStreamProcessor::SetupTiles()
+{
+    // number of tiles so that a tile of average density fits into the budget
+    double tiles = std::ceil(double(_countFacets) * BytesPerFacet / double(_memoryBudget));
+    tiles = std::min<double>(std::max<double>(tiles, 1.0), double(MaxTiles));
+
+    // split the longest side of the cells until there are enough tiles
+    float length[3] = { 0.0f, 0.0f, 0.0f };
+    if (_bbox.IsValid()) {
+        length[0] = _bbox.LengthX();
+        length[1] = _bbox.LengthY();
+        length[2] = _bbox.LengthZ();
+    }
+    _grid[0] = _grid[1] = _grid[2] = 1;
+    while (double(_grid[0]) * _grid[1] * _grid[2] < tiles) {
+        int axis = 0;
+        for (int i = 1; i < 3; i++) {
+            if (length[i] / _grid[i] > length[axis] / _grid[axis])
+                axis = i;
+        }
+        if (length[axis] <= 0.0f)
+            break;
+        _grid[axis]++;
+    }
+
+    float minCell = FLOAT_MAX;
+    for (int i = 0; i < 3; i++) {
+        _cellSize[i] = length[i] > 0.0f ? length[i] / _grid[i] : 1.0f;
+        minCell = std::min<float>(minCell, _cellSize[i]);
+    }
+
+    // The halo must contain all facets around the points of the owned facets, so that
+    // the seam points can be detected. For smoothing it's extended to get the same
+    // result near the tile borders as in the inside, but limited to half a cell.
+    _margin = 1.01f * _maxEdge;
+    if (_smoothing != None)
+        _margin += std::min<float>(_iterations * _meanEdge, 0.5f * minCell);
+
+    std::size_t count = std::size_t(_grid[0]) * _grid[1] * _grid[2];
+    _countTiles = count;
+    _tileFiles.resize(count);
+    for (std::size_t i = 0; i < count; i++)
+        _tileFiles[i] = Base::FileInfo::getTempFileName("MeshTile");
+
+    // the buffers of all tiles together may use a quarter of the budget
+    std::size_t flush = _memoryBudget / (4 * count);
+    flush = std::min<std::size_t>(std::max<std::size_t>(flush, 0x100 * RecordSize), BlockFacets * RecordSize);
+    _flushSize = (flush / RecordSize) * RecordSize;
+    _tileBuffers.resize(count);
+}
+
+int MeshStreamProcessor::TileIndex(float value, int axis) const
+{
+    float min = axis == 0 ? _bbox.MinX : (axis == 1 ? _bbox.MinY : _bbox.MinZ);
+    float index = std::floor((value - min) / _cellSize[axis]);
+    if (index < 0.0f)
+        return 0;
+    if (index >= float(_grid[axis]))
+        return _grid[axis] - 1;
+    return int(index);
+}
+
+void MeshStreamProcessor::SplitInput(const char* input)
+{
+    Base::ifstream str(Base::FileInfo(input), std::ios::in | std::ios::binary);
+    if (!str)
+        throw Base::FileException("Cannot open file", input);
+
+    uint32_t ulCt = ReadHeader(str, input);
+    bool swap = (Base::SwapOrder() != LOW_ENDIAN);
+    std::vector<char> block;
+    Base::Vector3f points[3];
+
+    Base::SequencerLauncher seq("Splitting mesh...", ulCt / BlockFacets + 1);
+    for (uint32_t left = ulCt; left > 0; ) {
+        uint32_t count = ReadBlock(str, left, block, input);
+        left -= count;
+        for (uint32_t i = 0; i < count; i++) {
+            char* record = &block[i * RecordSize];
+            DecodeRecord(record, swap, points);
+
+            Base::Vector3f center = (points[0] + points[1] + points[2]) / 3.0f;
+            float pmin[3], pmax[3];
+            int owner[3], lower[3], upper[3];
+            for (int k = 0; k < 3; k++) {
+                float c0 = k == 0 ? points[0].x : (k == 1 ? points[0].y : points[0].z);
+                float c1 = k == 0 ? points[1].x : (k == 1 ? points[1].y : points[1].z);
+                float c2 = k == 0 ? points[2].x : (k == 1 ? points[2].y : points[2].z);
+                pmin[k] = std::min<float>(c0, std::min<float>(c1, c2));
+                pmax[k] = std::max<float>(c0, std::max<float>(c1, c2));
+                owner[k] = TileIndex(k == 0 ? center.x : (k == 1 ? center.y : center.z), k);
+                lower[k] = std::min<int>(TileIndex(pmin[k] - _margin, k), owner[k]);
+                upper[k] = std::max<int>(TileIndex(pmax[k] + _margin, k), owner[k]);
+            }
+
+            // the attribute of the record tells whether the tile owns the facet
+            for (int z = lower[2]; z <= upper[2]; z++) {
+                for (int y = lower[1]; y <= upper[1]; y++) {
+                    for (int x = lower[0]; x <= upper[0]; x++) {
+                        std::size_t tile = (std::size_t(z) * _grid[1] + y) * _grid[0] + x;
+                        bool owned = (x == owner[0] && y == owner[1] && z == owner[2]);
+                        std::vector<char>& buffer = _tileBuffers[tile];
+                        buffer.insert(buffer.end(), record, record + RecordSize - 2);
+                        buffer.push_back(owned ? 1 : 0);
+                        buffer.push_back(0);
+                        if (buffer.size() >= _flushSize)
+                            FlushTile(tile);
+                    }
+                }
+            }
+        }
+        seq.next(true);
+    }
+
+    for (std::size_t i = 0; i < _tileBuffers.size(); i++)
+        FlushTile(i);
+    std::vector<std::vector<char> >().swap(_tileBuffers);
+}
+
+void MeshStreamProcessor::FlushTile(std::size_t tile)
+{
+    std::vector<char>& buffer = _tileBuffers[tile];
+    if (buffer.empty())
+        return;
+
+    Base::ofstream str(Base::FileInfo(_tileFiles[tile]), std::ios::out | std::ios::binary | std::ios::app);
+    str.write(&buffer[0], buffer.size());
+    if (!str)
+        throw Base::FileException("Cannot write temporary file", _tileFiles[tile].c_str());
+    buffer.clear();
+}
+
+void MeshStreamProcessor::LoadTile(std::size_t tile, MeshKernel& kernel, bool raw) const
+{
+    Base::FileInfo fi(_tileFiles[tile]);
+    Base::ifstream str(fi, std::ios::in | std::ios::binary);
+    if (!str)
+        throw Base::FileException("Cannot open temporary file", fi);
+
+    str.seekg(0, std::ios::end);
+    std::streamoff size = str.tellg();
+    str.seekg(0, std::ios::beg);
+    uint32_t ulCt = uint32_t(size / std::streamoff(RecordSize));
+
+    // The records are still in the byte order of the input file, the ownership is stored
+    // in the attribute. Without the builder only the points with exactly the same
+    // coordinates are shared and all facets are kept.
+    MeshBuilder builder(kernel);
+    MeshPointArray points;
+    MeshFacetArray facets;
+    std::map<Base::Vector3f, unsigned long, VectorLess> pointIndex;
+    if (raw)
+        facets.reserve(ulCt);
+    else
+        builder.Initialize(ulCt);
+
+    bool swap = (Base::SwapOrder() != LOW_ENDIAN);
+    std::vector<char> block;
+    Base::Vector3f corners[4];
+    for (uint32_t left = ulCt; left > 0; ) {
+        uint32_t count = ReadBlock(str, left, block, _tileFiles[tile].c_str());
+        left -= count;
+        for (uint32_t i = 0; i < count; i++) {
+            const char* record = &block[i * RecordSize];
+            DecodeRecord(record, swap, corners);
+            if (raw) {
+                MeshFacet facet;
+                for (int j = 0; j < 3; j++) {
+                    std::pair<std::map<Base::Vector3f, unsigned long, VectorLess>::iterator, bool> it =
+                        pointIndex.insert(std::make_pair(corners[j], static_cast<unsigned long>(points.size())));
+                    if (it.second)
+                        points.push_back(corners[j]);
+                    facet._aulPoints[j] = it.first->second;
+                }
+                facet._ulProp = record[48] ? 1 : 0;
+                facets.push_back(facet);
+            }
+            else {
+                corners[3] = (corners[1] - corners[0]) % (corners[2] - corners[0]);
+                builder.AddFacet(corners, 0, record[48] ? 1 : 0);
+            }
+        }
+    }
+
+    if (raw)
+        kernel.Adopt(points, facets, true);
+    else
+        builder.Finish();
+}
+
+void MeshStreamProcessor::EvaluateTile(std::size_t tile, const MeshKernel& raw)
+{
+    const MeshPointArray& points = raw.GetPoints();
+    const MeshFacetArray& facets = raw.GetFacets();
+
+    // a point is counted by the tile that contains it
+    int cell[3];
+    cell[0] = int(tile % _grid[0]);
+    cell[1] = int((tile / _grid[0]) % _grid[1]);
+    cell[2] = int(tile / (std::size_t(_grid[0]) * _grid[1]));
+
+    std::vector<unsigned long> indices = MeshEvalDuplicatePoints(raw).GetIndices();
+    for (std::vector<unsigned long>::iterator it = indices.begin(); it != indices.end(); ++it) {
+        const MeshPoint& pt = points[*it];
+        if (TileIndex(pt.x, 0) == cell[0] && TileIndex(pt.y, 1) == cell[1] && TileIndex(pt.z, 2) == cell[2])
+            _countDuplicatedPoints++;
+    }
+
+    indices = MeshEvalDegeneratedFacets(raw).GetIndices();
+    for (std::vector<unsigned long>::iterator it = indices.begin(); it != indices.end(); ++it) {
+        if (facets[*it]._ulProp)
+            _countDegeneratedFacets++;
+    }
+}
+
+void MeshStreamProcessor::ProcessTile(std::size_t tile, std::ostream* out)
+{
+    if (_evaluate) {
+        // the builder would already merge the duplicated points and drop the degenerated facets
+        MeshKernel raw;
+        LoadTile(tile, raw, true);
+        EvaluateTile(tile, raw);
+    }
+
+    MeshKernel kernel;
+    LoadTile(tile, kernel, false);
+    Base::FileInfo(_tileFiles[tile]).deleteFile();
+    _tileFiles[tile].clear();
+    if (kernel.CountFacets() == 0)
+        return;
+
+    const MeshPointArray& points = kernel.GetPoints();
+    const MeshFacetArray& facets = kernel.GetFacets();
+
+    // 1: the point is used by an owned facet, 2: it is used by a facet of the halo
+    std::vector<unsigned char> usage(points.size(), 0);
+    for (MeshFacetArray::_TConstIterator it = facets.begin(); it != facets.end(); ++it) {
+        unsigned char bit = it->_ulProp ? 1 : 2;
+        for (int i = 0; i < 3; i++)
+            usage[it->_aulPoints[i]] |= bit;
+    }
+
+    if (_smoothing != None && _iterations > 0) {
+        // points on the seam to already processed tiles are kept fixed
+        std::vector<unsigned long> movable;
+        std::vector<std::pair<unsigned long, Base::Vector3f> > seam;
+        movable.reserve(points.size());
+        for (unsigned long i = 0; i < points.size(); i++) {
+            if (usage[i] == 3) {
+                SeamMap::iterator it = _seamPoints.find(points[i]);
+                if (it != _seamPoints.end()) {
+                    kernel.SetPoint(i, it->second);
+                    continue;
+                }
+                seam.push_back(std::make_pair(i, Base::Vector3f(points[i])));
+            }
+            movable.push_back(i);
+        }
+
+        if (_smoothing == Laplace) {
+            LaplaceSmoothing smooth(kernel);
+            smooth.SetLambda(_lambda);
+            smooth.SmoothPoints(_iterations, movable);
+        }
+        else {
+            TaubinSmoothing smooth(kernel);
+            smooth.SetLambda(_lambda);
+            smooth.SetMicro(_micro);
+            smooth.SmoothPoints(_iterations, movable);
+        }
+
+        for (std::vector<std::pair<unsigned long, Base::Vector3f> >::iterator it = seam.begin(); it != seam.end(); ++it)
+            _seamPoints[it->second] = points[it->first];
+    }
+
+    if (!out)
+        return;
+
+    bool swap = (Base::SwapOrder() != LOW_ENDIAN);
+    std::vector<char> block;
+    block.reserve(BlockFacets * RecordSize);
+    Base::Vector3f corners[3];
+    for (MeshFacetArray::_TConstIterator it = facets.begin(); it != facets.end(); ++it) {
+        if (!it->_ulProp)
+            continue;
+        for (int i = 0; i < 3; i++)
+            corners[i] = _transform * points[it->_aulPoints[i]];
+        block.resize(block.size() + RecordSize);
+        EncodeRecord(corners, swap, &block[block.size() - RecordSize]);
+        _countWritten++;
+        if (block.size() == BlockFacets * RecordSize) {
+            out->write(&block[0], block.size());
+            block.clear();
+        }
+    }
+
+    if (!block.empty())
+        out->write(&block[0], block.size());
+    if (!*out)
+        throw Base::FileException("Cannot write file");
+}
+
+void MeshStreamProcessor::RemoveTiles()
+{
+    for (std::vector<std::string>::iterator it = _tileFiles.begin(); it != _tileFiles.end(); ++it) {
+        if (!it->empty())
+            Base::FileInfo(*it).deleteFile();
+    }
+    _tileFiles.clear();
+    std::vector<std::vector<char> >().swap(_tileBuffers);
+}
@@ -0,0 +1,150 @@
+/***************************************************************************
+ *   Copyright (c) 2026 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef MESHCORE_MESHSTREAM_H
+#define MESHCORE_MESHSTREAM_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include <Base/Vector3D.h>
+#include <Base/BoundBox.h>
+#include <Base/Matrix.h>
+
+namespace MeshCore {
+
+class MeshKernel;
+
+/**
+ * The MeshStreamProcessor class processes binary STL files that are too large to be
+ * loaded into a MeshKernel as a whole. The file is read twice: the first pass determines
+ * the bounding box, the number of facets and the edge lengths, the second pass sorts the
+ * facets into spatial tiles that are written to temporary files. Afterwards each tile is
+ * loaded together with a halo of the surrounding facets into a MeshKernel of its own,
+ * processed and the facets it owns are appended to the output file. So, only one tile
+ * must be kept in memory at a time.
+ *
+ * A facet is owned by the tile that contains its center of gravity. Points shared by the
+ * facets of several tiles are smoothed only by the first tile that processes them and
+ * are kept fixed by the others, so that there are no gaps between the tiles.
+ */
+class MeshExport MeshStreamProcessor
+{
+public:
+    enum Smoothing {
+        None,    /**< No smoothing */
+        Laplace, /**< LaplaceSmoothing */
+        Taubin   /**< TaubinSmoothing */
+    };
+
+    /// Construction
+    MeshStreamProcessor();
+    /// Destruction, removes all temporary files
+    ~MeshStreamProcessor();
+
+    /** @name Settings */
+    //@{
+    /** Sets the number of bytes a tile may use. The number of tiles is chosen so that
+     * a tile of average density fits into the budget. The default is 512 MB.
+     */
+    void SetMemoryBudget(unsigned long bytes);
+    unsigned long GetMemoryBudget() const
+    { return _memoryBudget; }
+    /** Smoothes the mesh with the given algorithm and number of iterations. */
+    void SetSmoothing(Smoothing type, unsigned int iterations, double lambda = 0.6307, double micro = 0.0424);
+    /** Transforms the points with \a mat before they are written. */
+    void SetTransform(const Base::Matrix4D& mat);
+    /** If enabled the duplicated points and degenerated facets of the input are counted.
+     * They are counted on the records as they are in the file, before the points get merged.
+     */
+    void SetEvaluation(bool on)
+    { _evaluate = on; }
+    //@}
+
+    /** Reads the binary STL file \a input, processes it tile by tile and writes the result
+     * as binary STL file to \a output. If \a output is 0 nothing is written which is useful
+     * for evaluation only. A Base::FileException is thrown if one of the files cannot be
+     * opened and a Base::Exception if the input is not a binary STL file.
+     */
+    void Process(const char* input, const char* output);
+
+    /** @name Statistics of the last run */
+    //@{
+    unsigned long CountFacets() const
+    { return _countFacets; }
+    unsigned long CountTiles() const
+    { return _countTiles; }
+    unsigned long CountDuplicatedPoints() const
+    { return _countDuplicatedPoints; }
+    unsigned long CountDegeneratedFacets() const
+    { return _countDegeneratedFacets; }
+    //@}
+
+private:
+    struct VectorLess {
+        bool operator()(const Base::Vector3f& a, const Base::Vector3f& b) const;
+    };
+    typedef std::map<Base::Vector3f, Base::Vector3f, VectorLess> SeamMap;
+
+    void ScanInput(const char* input);
+    void SetupTiles();
+    void SplitInput(const char* input);
+    void ProcessTile(std::size_t tile, std::ostream* out);
+    void LoadTile(std::size_t tile, MeshKernel& kernel, bool raw) const;
+    void EvaluateTile(std::size_t tile, const MeshKernel& raw);
+    void FlushTile(std::size_t tile);
+    int TileIndex(float value, int axis) const;
+    void RemoveTiles();
+
+private:
+    MeshStreamProcessor(const MeshStreamProcessor&);
+    void operator = (const MeshStreamProcessor&);
+
+    unsigned long _memoryBudget;
+    Smoothing _smoothing;
+    unsigned int _iterations;
+    double _lambda, _micro;
+    Base::Matrix4D _transform;
+    bool _evaluate;
+
+    // tiling
+    Base::BoundBox3f _bbox;
+    float _maxEdge, _meanEdge, _margin;
+    int _grid[3];
+    float _cellSize[3];
+    std::vector<std::string> _tileFiles;
+    std::vector<std::vector<char> > _tileBuffers;
+    std::size_t _flushSize;
+    SeamMap _seamPoints;
+
+    // statistics
+    unsigned long _countFacets;
+    unsigned long _countTiles;
+    unsigned long _countWritten;
+    unsigned long _countDuplicatedPoints;
+    unsigned long _countDegeneratedFacets;
+};
+
+} // namespace MeshCore
+
+#endif // MESHCORE_MESHSTREAM_H
@@ -0,0 +1,101 @@
+/***************************************************************************
+ *   Copyright (c) 2026 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef MESHCORE_PARALLEL_H
+#define MESHCORE_PARALLEL_H
+
+#include <algorithm>
+#include <vector>
+#include <QThread>
+#include <QtConcurrentMap>
+
+namespace MeshCore {
+
+/**
+ * Helper to sort large arrays in several threads. The array is split into one part
+ * per thread, every part is sorted with std::sort and afterwards neighbouring parts
+ * are merged pairwise until a single sorted range is left. Each round of merging
+ * runs in several threads, too.
+ */
+template <class RandomIt, class Compare>
+class MeshParallelSort
+{
+public:
+    /** Sorts the range [first, last). Ranges with less than \a minSize elements
+     * are sorted with std::sort directly.
+     */
+    static void Sort(RandomIt first, RandomIt last, Compare comp,
+                     std::size_t minSize = 0x10000)
+    {
+        std::size_t size = last - first;
+        int parts = QThread::idealThreadCount();
+        if (parts < 2 || size < minSize) {
+            std::sort(first, last, comp);
+            return;
+        }
+
+        std::vector<Part> ranges;
+        ranges.reserve(parts);
+        for (int i = 0; i < parts; i++) {
+            RandomIt begin = first + (size * i) / parts;
+            RandomIt end = first + (size * (i + 1)) / parts;
+            ranges.push_back(Part(begin, begin, end, comp));
+        }
+        QtConcurrent::blockingMap(ranges, &MeshParallelSort::SortPart);
+
+        while (ranges.size() > 1) {
+            std::vector<Part> merged;
+            for (std::size_t i = 0; i + 1 < ranges.size(); i += 2) {
+                merged.push_back(Part(ranges[i].first, ranges[i].last,
+                                      ranges[i + 1].last, comp));
+            }
+            QtConcurrent::blockingMap(merged, &MeshParallelSort::MergePart);
+            if (ranges.size() % 2)
+                merged.push_back(ranges.back());
+            ranges.swap(merged);
+        }
+    }
+
+private:
+    struct Part
+    {
+        Part(RandomIt f, RandomIt m, RandomIt l, const Compare& c)
+          : first(f), middle(m), last(l), comp(c)
+        {
+        }
+        RandomIt first, middle, last;
+        Compare comp;
+    };
+    static void SortPart(Part& part)
+    {
+        std::sort(part.first, part.last, part.comp);
+    }
+    static void MergePart(Part& part)
+    {
+        std::inplace_merge(part.first, part.middle, part.last, part.comp);
+    }
+};
+
+} // namespace MeshCore
+
+#endif // MESHCORE_PARALLEL_H
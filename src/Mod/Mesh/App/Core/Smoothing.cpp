@@ -26,6 +26,7 @@
 #endif
 
 #include "Smoothing.h"
+#include "Adjacency.h"
 #include "MeshKernel.h"
 #include "Algorithm.h"
 #include "Elements.h"
@@ -36,12 +37,32 @@
 using namespace MeshCore;
 
 
-AbstractSmoothing::AbstractSmoothing(MeshKernel& m) : kernel(m)
+AbstractSmoothing::AbstractSmoothing(MeshKernel& m)
+  : kernel(m), adjacency(0), ownAdjacency(0)
 {
 }
 
 AbstractSmoothing::~AbstractSmoothing()
 {
+    delete ownAdjacency;
+}
+
+void AbstractSmoothing::SetAdjacency(const MeshAdjacency* adj)
+{
+    this->adjacency = adj;
+}
+
+const MeshAdjacency& AbstractSmoothing::GetAdjacency()
+{
+    if (this->adjacency)
+        return *this->adjacency;
+
+    // smoothing only moves points so the structure stays valid between the iterations
+    if (!this->ownAdjacency)
+        this->ownAdjacency = new MeshAdjacency(kernel);
+    else if (!this->ownAdjacency->IsValid())
+        this->ownAdjacency->Rebuild();
+    return *this->ownAdjacency;
 }
 
 void AbstractSmoothing::initialize(Component comp, Continuity cont)
@@ -65,7 +86,7 @@ void PlaneFitSmoothing::Smooth(unsigned int iterations)
     MeshCore::MeshPointArray PointArray = kernel.GetPoints();
 
     MeshCore::MeshPointIterator v_it(kernel);
-    MeshCore::MeshRefPointToPoints vv_it(kernel);
+    const MeshCore::MeshAdjacency& adj = GetAdjacency();
     MeshCore::MeshPointArray::_TConstIterator v_beg = kernel.GetPoints().begin();
 
     for (unsigned int i=0; i<iterations; i++) {
@@ -74,11 +95,11 @@ void PlaneFitSmoothing::Smooth(unsigned int iterations)
             MeshCore::PlaneFit pf;
             pf.AddPoint(*v_it);
             center = *v_it;
-            const std::set<unsigned long>& cv = vv_it[v_it.Position()];
+            MeshCore::MeshAdjacency::Range cv = adj.PointPoints(v_it.Position());
             if (cv.size() < 3)
                 continue;
 
-            std::set<unsigned long>::const_iterator cv_it;
+            MeshCore::MeshAdjacency::Range::const_iterator cv_it;
             for (cv_it = cv.begin(); cv_it !=cv.end(); ++cv_it) {
                 pf.AddPoint(v_beg[*cv_it]);
                 center += v_beg[*cv_it];
@@ -118,7 +139,7 @@ void PlaneFitSmoothing::SmoothPoints(unsigned int iterations, const std::vector<
     MeshCore::MeshPointArray PointArray = kernel.GetPoints();
 
     MeshCore::MeshPointIterator v_it(kernel);
-    MeshCore::MeshRefPointToPoints vv_it(kernel);
+    const MeshCore::MeshAdjacency& adj = GetAdjacency();
     MeshCore::MeshPointArray::_TConstIterator v_beg = kernel.GetPoints().begin();
 
     for (unsigned int i=0; i<iterations; i++) {
@@ -128,11 +149,11 @@ void PlaneFitSmoothing::SmoothPoints(unsigned int iterations, const std::vector<
             MeshCore::PlaneFit pf;
             pf.AddPoint(*v_it);
             center = *v_it;
-            const std::set<unsigned long>& cv = vv_it[v_it.Position()];
+            MeshCore::MeshAdjacency::Range cv = adj.PointPoints(v_it.Position());
             if (cv.size() < 3)
                 continue;
 
-            std::set<unsigned long>::const_iterator cv_it;
+            MeshCore::MeshAdjacency::Range::const_iterator cv_it;
             for (cv_it = cv.begin(); cv_it !=cv.end(); ++cv_it) {
                 pf.AddPoint(v_beg[*cv_it]);
                 center += v_beg[*cv_it];
@@ -175,8 +196,7 @@ LaplaceSmoothing::~LaplaceSmoothing()
 {
 }
 
-void LaplaceSmoothing::Umbrella(const MeshRefPointToPoints& vv_it,
-                                const MeshRefPointToFacets& vf_it, double stepsize)
+void LaplaceSmoothing::Umbrella(const MeshAdjacency& adj, double stepsize)
 {
     const MeshCore::MeshPointArray& points = kernel.GetPoints();
     MeshCore::MeshPointArray::_TConstIterator v_it,
@@ -184,10 +204,10 @@ void LaplaceSmoothing::Umbrella(const MeshRefPointToPoints& vv_it,
 
     unsigned long pos = 0;
     for (v_it = points.begin(); v_it != v_end; ++v_it,++pos) {
-        const std::set<unsigned long>& cv = vv_it[pos];
+        MeshAdjacency::Range cv = adj.PointPoints(pos);
         if (cv.size() < 3)
             continue;
-        if (cv.size() != vf_it[pos].size()) {
+        if (adj.IsBoundaryPoint(pos)) {
             // do nothing for border points
             continue;
         }
@@ -197,7 +217,7 @@ void LaplaceSmoothing::Umbrella(const MeshRefPointToPoints& vv_it,
         w=1.0/double(n_count);
 
         double delx=0.0,dely=0.0,delz=0.0;
-        std::set<unsigned long>::const_iterator cv_it;
+        MeshCore::MeshAdjacency::Range::const_iterator cv_it;
         for (cv_it = cv.begin(); cv_it !=cv.end(); ++cv_it) {
             delx += w*((v_beg[*cv_it]).x-v_it->x);
             dely += w*((v_beg[*cv_it]).y-v_it->y);
@@ -211,18 +231,17 @@ void LaplaceSmoothing::Umbrella(const MeshRefPointToPoints& vv_it,
     }
 }
 
-void LaplaceSmoothing::Umbrella(const MeshRefPointToPoints& vv_it,
-                                const MeshRefPointToFacets& vf_it, double stepsize,
+void LaplaceSmoothing::Umbrella(const MeshAdjacency& adj, double stepsize,
                                 const std::vector<unsigned long>& point_indices)
 {
     const MeshCore::MeshPointArray& points = kernel.GetPoints();
     MeshCore::MeshPointArray::_TConstIterator v_beg = points.begin();
 
     for (std::vector<unsigned long>::const_iterator pos = point_indices.begin(); pos != point_indices.end(); ++pos) {
-        const std::set<unsigned long>& cv = vv_it[*pos];
+        MeshAdjacency::Range cv = adj.PointPoints(*pos);
         if (cv.size() < 3)
             continue;
-        if (cv.size() != vf_it[*pos].size()) {
+        if (adj.IsBoundaryPoint(*pos)) {
             // do nothing for border points
             continue;
         }
@@ -232,7 +251,7 @@ void LaplaceSmoothing::Umbrella(const MeshRefPointToPoints& vv_it,
         w=1.0/double(n_count);
 
         double delx=0.0,dely=0.0,delz=0.0;
-        std::set<unsigned long>::const_iterator cv_it;
+        MeshCore::MeshAdjacency::Range::const_iterator cv_it;
         for (cv_it = cv.begin(); cv_it !=cv.end(); ++cv_it) {
             delx += w*((v_beg[*cv_it]).x-(v_beg[*pos]).x);
             dely += w*((v_beg[*cv_it]).y-(v_beg[*pos]).y);
@@ -248,21 +267,19 @@ void LaplaceSmoothing::Umbrella(const MeshRefPointToPoints& vv_it,
 
 void LaplaceSmoothing::Smooth(unsigned int iterations)
 {
-    MeshCore::MeshRefPointToPoints vv_it(kernel);
-    MeshCore::MeshRefPointToFacets vf_it(kernel);
+    const MeshCore::MeshAdjacency& adj = GetAdjacency();
 
     for (unsigned int i=0; i<iterations; i++) {
-        Umbrella(vv_it, vf_it, lambda);
+        Umbrella(adj, lambda);
     }
 }
 
 void LaplaceSmoothing::SmoothPoints(unsigned int iterations, const std::vector<unsigned long>& point_indices)
 {
-    MeshCore::MeshRefPointToPoints vv_it(kernel);
-    MeshCore::MeshRefPointToFacets vf_it(kernel);
+    const MeshCore::MeshAdjacency& adj = GetAdjacency();
 
     for (unsigned int i=0; i<iterations; i++) {
-        Umbrella(vv_it, vf_it, lambda, point_indices);
+        Umbrella(adj, lambda, point_indices);
     }
 }
 
@@ -278,27 +295,25 @@ TaubinSmoothing::~TaubinSmoothing()
 void TaubinSmoothing::Smooth(unsigned int iterations)
 {
     MeshCore::MeshPointArray::_TConstIterator v_it;
-    MeshCore::MeshRefPointToPoints vv_it(kernel);
-    MeshCore::MeshRefPointToFacets vf_it(kernel);
+    const MeshCore::MeshAdjacency& adj = GetAdjacency();
 
     // Theoretically Taubin does not shrink the surface
     iterations = (iterations+1)/2; // two steps per iteration
     for (unsigned int i=0; i<iterations; i++) {
-        Umbrella(vv_it, vf_it, lambda);
-        Umbrella(vv_it, vf_it, -(lambda+micro));
+        Umbrella(adj, lambda);
+        Umbrella(adj, -(lambda+micro));
     }
 }
 
 void TaubinSmoothing::SmoothPoints(unsigned int iterations, const std::vector<unsigned long>& point_indices)
 {
     MeshCore::MeshPointArray::_TConstIterator v_it;
-    MeshCore::MeshRefPointToPoints vv_it(kernel);
-    MeshCore::MeshRefPointToFacets vf_it(kernel);
+    const MeshCore::MeshAdjacency& adj = GetAdjacency();
 
     // Theoretically Taubin does not shrink the surface
     iterations = (iterations+1)/2; // two steps per iteration
     for (unsigned int i=0; i<iterations; i++) {
-        Umbrella(vv_it, vf_it, lambda, point_indices);
-        Umbrella(vv_it, vf_it, -(lambda+micro), point_indices);
+        Umbrella(adj, lambda, point_indices);
+        Umbrella(adj, -(lambda+micro), point_indices);
     }
 }
@@ -29,8 +29,7 @@
 namespace MeshCore
 {
 class MeshKernel;
-class MeshRefPointToPoints;
-class MeshRefPointToFacets;
+class MeshAdjacency;
 
 /** Base class for smoothing algorithms. */
 class MeshExport AbstractSmoothing
@@ -51,17 +50,33 @@ public:
     AbstractSmoothing(MeshKernel&);
     virtual ~AbstractSmoothing();
     void initialize(Component comp, Continuity cont);
+    /** Uses the adjacency \a adj instead of building it for the mesh. It must have been
+     * built for the same mesh kernel. Passing null resets to the default behaviour.
+     */
+    void SetAdjacency(const MeshAdjacency* adj);
 
     /** Smooth the triangle mesh. */
     virtual void Smooth(unsigned int) = 0;
     virtual void SmoothPoints(unsigned int, const std::vector<unsigned long>&) = 0;
 
+protected:
+    /** Returns the adjacency set with SetAdjacency() or otherwise builds it. */
+    const MeshAdjacency& GetAdjacency();
+
+private:
+    AbstractSmoothing(const AbstractSmoothing&);
+    void operator = (const AbstractSmoothing&);
+
 protected:
     MeshKernel& kernel;
 
     float tolerance;
     Component   component;
     Continuity  continuity;
+
+private:
+    const MeshAdjacency* adjacency;
+    MeshAdjacency* ownAdjacency;
 };
 
 class MeshExport PlaneFitSmoothing : public AbstractSmoothing
@@ -83,10 +98,8 @@ public:
     void SetLambda(double l) { lambda = l;}
 
 protected:
-    void Umbrella(const MeshRefPointToPoints&,
-                  const MeshRefPointToFacets&, double);
-    void Umbrella(const MeshRefPointToPoints&,
-                  const MeshRefPointToFacets&, double,
+    void Umbrella(const MeshAdjacency&, double);
+    void Umbrella(const MeshAdjacency&, double,
                   const std::vector<unsigned long>&);
 
 protected:
@@ -25,6 +25,7 @@
 
 #ifndef _PreComp_
 # include <algorithm>
+# include <memory>
 # include <utility>
 # include <queue>
 #endif
@@ -36,6 +37,7 @@
 #include "Iterator.h"
 #include "MeshKernel.h"
 #include "Algorithm.h"
+#include "Adjacency.h"
 #include "Evaluation.h"
 #include "Triangulation.h"
 #include <Base/Console.h>
@@ -45,6 +47,8 @@ using namespace MeshCore;
 MeshTopoAlgorithm::MeshTopoAlgorithm (MeshKernel &rclM)
 : _rclMesh(rclM), _needsCleanup(false), _cache(0)
 {
+  // the topology gets modified directly
+  _rclMesh.ClearIndex();
 }
 
 MeshTopoAlgorithm::~MeshTopoAlgorithm (void)
@@ -52,10 +56,12 @@ MeshTopoAlgorithm::~MeshTopoAlgorithm (void)
   if ( _needsCleanup )
     Cleanup();
   EndCache();
+  _rclMesh.ClearIndex();
 }
 
 bool MeshTopoAlgorithm::InsertVertex(unsigned long ulFacetPos, const Base::Vector3f&  rclPoint)
 {
+  _rclMesh.ClearIndex();
   MeshFacet& rclF = _rclMesh._aclFacetArray[ulFacetPos];
   MeshFacet  clNewFacet1, clNewFacet2;
 
@@ -102,6 +108,7 @@ bool MeshTopoAlgorithm::InsertVertex(unsigned long ulFacetPos, const Base::Vecto
 
 bool MeshTopoAlgorithm::SnapVertex(unsigned long ulFacetPos, const Base::Vector3f& rP)
 {
+  _rclMesh.ClearIndex();
   MeshFacet& rFace = _rclMesh._aclFacetArray[ulFacetPos];
   if (!rFace.HasOpenEdge())
     return false;
@@ -642,6 +649,7 @@ bool MeshTopoAlgorithm::ShouldSwapEdge(unsigned long ulFacetPos, unsigned long u
 
 void MeshTopoAlgorithm::SwapEdge(unsigned long ulFacetPos, unsigned long ulNeighbour)
 {
+  _rclMesh.ClearIndex();
   MeshFacet& rclF = _rclMesh._aclFacetArray[ulFacetPos];
   MeshFacet& rclN = _rclMesh._aclFacetArray[ulNeighbour];
 
@@ -668,6 +676,7 @@ void MeshTopoAlgorithm::SwapEdge(unsigned long ulFacetPos, unsigned long ulNeigh
 
 bool MeshTopoAlgorithm::SplitEdge(unsigned long ulFacetPos, unsigned long ulNeighbour, const Base::Vector3f& rP)
 {
+  _rclMesh.ClearIndex();
   MeshFacet& rclF = _rclMesh._aclFacetArray[ulFacetPos];
   MeshFacet& rclN = _rclMesh._aclFacetArray[ulNeighbour];
 
@@ -722,6 +731,7 @@ bool MeshTopoAlgorithm::SplitEdge(unsigned long ulFacetPos, unsigned long ulNeig
 
 void MeshTopoAlgorithm::SplitOpenEdge(unsigned long ulFacetPos, unsigned short uSide, const Base::Vector3f& rP)
 {
+  _rclMesh.ClearIndex();
   MeshFacet& rclF = _rclMesh._aclFacetArray[ulFacetPos];
   if (rclF._aulNeighbours[uSide] != ULONG_MAX) 
     return; // not open
@@ -788,6 +798,7 @@ void MeshTopoAlgorithm::EndCache()
 
 unsigned long MeshTopoAlgorithm::GetOrAddIndex (const MeshPoint &rclPoint)
 {
+    _rclMesh.ClearIndex();
     if (!_cache)
         return _rclMesh._aclPointArray.GetOrAddIndex(rclPoint);
 
@@ -841,6 +852,7 @@ void MeshTopoAlgorithm::Cleanup()
 
 bool MeshTopoAlgorithm::CollapseEdge(unsigned long ulFacetPos, unsigned long ulNeighbour)
 {
+  _rclMesh.ClearIndex();
   MeshFacet& rclF = _rclMesh._aclFacetArray[ulFacetPos];
   MeshFacet& rclN = _rclMesh._aclFacetArray[ulNeighbour];
 
@@ -892,28 +904,34 @@ bool MeshTopoAlgorithm::CollapseEdge(unsigned long ulFacetPos, unsigned long ulN
 }
 
 bool MeshTopoAlgorithm::CollapseEdge(const EdgeCollapse& ec)
+{
+    _rclMesh.ClearIndex();
+    CollapseEdge(_rclMesh, ec);
+    _needsCleanup = true;
+    return true;
+}
+
+void MeshTopoAlgorithm::CollapseEdge(MeshKernel& rclM, const EdgeCollapse& ec)
 {
     std::vector<unsigned long>::const_iterator it;
     for (it = ec._removeFacets.begin(); it != ec._removeFacets.end(); ++it) {
-        MeshFacet& f = _rclMesh._aclFacetArray[*it];
+        MeshFacet& f = rclM._aclFacetArray[*it];
         f.SetInvalid();
     }
 
     for (it = ec._changeFacets.begin(); it != ec._changeFacets.end(); ++it) {
-        MeshFacet& f = _rclMesh._aclFacetArray[*it];
+        MeshFacet& f = rclM._aclFacetArray[*it];
 
         // The neighbourhood might be broken from now on!!!
         f.Transpose(ec._fromPoint, ec._toPoint);
     }
 
-    _rclMesh._aclPointArray[ec._fromPoint].SetInvalid();
-
-    _needsCleanup = true;
-    return true;
+    rclM._aclPointArray[ec._fromPoint].SetInvalid();
 }
 
 bool MeshTopoAlgorithm::CollapseFacet(unsigned long ulFacetPos)
 {
+    _rclMesh.ClearIndex();
     MeshFacet& rclF = _rclMesh._aclFacetArray[ulFacetPos];
     if (!rclF.IsValid())
         return false; // the facet is marked invalid from a previous run
@@ -979,6 +997,7 @@ bool MeshTopoAlgorithm::CollapseFacet(unsigned long ulFacetPos)
 /// FIXME: Implement
 void MeshTopoAlgorithm::SplitFacet(unsigned long ulFacetPos, const Base::Vector3f& rP1, const Base::Vector3f& rP2)
 {
+  _rclMesh.ClearIndex();
   float fEps = MESH_MIN_EDGE_LEN;
   MeshFacet& rFace = _rclMesh._aclFacetArray[ulFacetPos];
   MeshPoint& rVertex0 = _rclMesh._aclPointArray[rFace._aulPoints[0]];
@@ -1106,6 +1125,7 @@ void MeshTopoAlgorithm::SplitFacet(unsigned long ulFacetPos, const Base::Vector3
 
 void MeshTopoAlgorithm::SplitNeighbourFacet(unsigned long ulFacetPos, unsigned short uFSide, const Base::Vector3f rPoint)
 {
+  _rclMesh.ClearIndex();
   MeshFacet& rclF = _rclMesh._aclFacetArray[ulFacetPos];
 
   unsigned long ulNeighbour = rclF._aulNeighbours[uFSide];
@@ -1163,6 +1183,7 @@ void MeshTopoAlgorithm::SplitNeighbourFacet(unsigned long ulFacetPos, unsigned s
 
 void MeshTopoAlgorithm::RemoveDegeneratedFacet(unsigned long index)
 {
+  _rclMesh.ClearIndex();
   if (index >= _rclMesh._aclFacetArray.size()) return;
   MeshFacet& rFace = _rclMesh._aclFacetArray[index];
 
@@ -1230,6 +1251,7 @@ void MeshTopoAlgorithm::RemoveDegeneratedFacet(unsigned long index)
 
 void MeshTopoAlgorithm::RemoveCorruptedFacet(unsigned long index)
 {
+  _rclMesh.ClearIndex();
   if (index >= _rclMesh._aclFacetArray.size()) return;
   MeshFacet& rFace = _rclMesh._aclFacetArray[index];
 
@@ -1255,7 +1277,8 @@ void MeshTopoAlgorithm::RemoveCorruptedFacet(unsigned long index)
 
 void MeshTopoAlgorithm::FillupHoles(unsigned long length, int level,
                                     AbstractPolygonTriangulator& cTria,
-                                    std::list<std::vector<unsigned long> >& aFailed)
+                                    std::list<std::vector<unsigned long> >& aFailed,
+                                    const MeshAdjacency* pAdjacency)
 {
     // get the mesh boundaries as an array of point indices
     std::list<std::vector<unsigned long> > aBorders, aFillBorders;
@@ -1271,15 +1294,21 @@ void MeshTopoAlgorithm::FillupHoles(unsigned long length, int level,
     }
 
     if (!aFillBorders.empty())
-        FillupHoles(level, cTria, aFillBorders, aFailed);
+        FillupHoles(level, cTria, aFillBorders, aFailed, pAdjacency);
 }
 
 void MeshTopoAlgorithm::FillupHoles(int level, AbstractPolygonTriangulator& cTria,
                                     const std::list<std::vector<unsigned long> >& aBorders,
-                                    std::list<std::vector<unsigned long> >& aFailed)
+                                    std::list<std::vector<unsigned long> >& aFailed,
+                                    const MeshAdjacency* pAdjacency)
 {
+    _rclMesh.ClearIndex();
     // get the facets to a point
-    MeshRefPointToFacets cPt2Fac(_rclMesh);
+    std::auto_ptr<MeshAdjacency> cPt2Fac;
+    if (!pAdjacency) {
+        cPt2Fac.reset(new MeshAdjacency(_rclMesh));
+        pAdjacency = cPt2Fac.get();
+    }
     MeshAlgorithm cAlgo(_rclMesh);
 
     MeshFacetArray newFacets;
@@ -1289,7 +1318,7 @@ void MeshTopoAlgorithm::FillupHoles(int level, AbstractPolygonTriangulator& cTri
         MeshFacetArray cFacets;
         MeshPointArray cPoints;
         std::vector<unsigned long> bound = *it;
-        if (cAlgo.FillupHole(bound, cTria, cFacets, cPoints, level, &cPt2Fac)) {
+        if (cAlgo.FillupHole(bound, cTria, cFacets, cPoints, level, pAdjacency)) {
             if (bound.front() == bound.back())
                 bound.pop_back();
             // the triangulation may produce additional points which we must take into account when appending to the mesh
@@ -1379,6 +1408,7 @@ void MeshTopoAlgorithm::RemoveComponents(unsigned long count)
 
 void MeshTopoAlgorithm::HarmonizeNormals (void)
 {
+  _rclMesh.ClearIndex();
   std::vector<unsigned long> uIndices = MeshEvalOrientation(_rclMesh).GetIndices();
   for ( std::vector<unsigned long>::iterator it = uIndices.begin(); it != uIndices.end(); ++it )
     _rclMesh._aclFacetArray[*it].FlipNormal();
@@ -1386,6 +1416,7 @@ void MeshTopoAlgorithm::HarmonizeNormals (void)
 
 void MeshTopoAlgorithm::FlipNormals (void)
 {
+  _rclMesh.ClearIndex();
   for (MeshFacetArray::_TIterator i = _rclMesh._aclFacetArray.begin(); i < _rclMesh._aclFacetArray.end(); i++)
     i->FlipNormal();
 }
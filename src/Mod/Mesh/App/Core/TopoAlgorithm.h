@@ -138,6 +138,13 @@ public:
      * Convenience function that passes already all needed information.
      */
     bool CollapseEdge(const EdgeCollapse& ec);
+    /**
+     * Does the same as CollapseEdge(const EdgeCollapse&) but neither clears the index of
+     * \a rclM nor marks it for Cleanup(). It only writes to the facets and the point that
+     * are listed in \a ec, so several threads can collapse disjoint edges of one mesh.
+     * The caller must call Cleanup() afterwards.
+     */
+    static void CollapseEdge(MeshKernel& rclM, const EdgeCollapse& ec);
     /**
      * Removes the facet with index \a ulFacetPos and all its neighbour facets.
      * The three vertices that are referenced by this facet are replaced by its
@@ -234,17 +241,20 @@ public:
      * Closes holes in the mesh that consists of up to \a length edges. In case a fit 
      * needs to be done then the points of the neighbours of \a level rings will be used.
      * Holes for which the triangulation failed are returned in \a aFailed.
+     * If the adjacency \a pAdjacency of the mesh is given it's used instead of building it.
      */
     void FillupHoles(unsigned long length, int level,
         AbstractPolygonTriangulator&,
-        std::list<std::vector<unsigned long> >& aFailed);
+        std::list<std::vector<unsigned long> >& aFailed,
+        const MeshAdjacency* pAdjacency=0);
     /**
      * This is an overloaded method provided for convenience. It takes as first argument
      * the boundaries which must be filled up.
      */
     void FillupHoles(int level, AbstractPolygonTriangulator&,
         const std::list<std::vector<unsigned long> >& aBorders,
-        std::list<std::vector<unsigned long> >& aFailed);
+        std::list<std::vector<unsigned long> >& aFailed,
+        const MeshAdjacency* pAdjacency=0);
     /**
      * Find holes which consists of up to \a length edges.
      */
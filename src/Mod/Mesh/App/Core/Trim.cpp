@@ -661,6 +661,9 @@ void MeshTrimming::TrimFacets(const std::vector<unsigned long>& raulFacets, std:
     std::vector<Base::Vector3f> clIntsct;
     int iSide;
 
+    // the facets get modified directly
+    myMesh.ClearIndex();
+
     Base::SequencerLauncher seq("trimming facets...", raulFacets.size());
     for (std::vector<unsigned long>::const_iterator it=raulFacets.begin(); it!=raulFacets.end(); it++) {
         clIntsct.clear();
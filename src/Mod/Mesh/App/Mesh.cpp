@@ -27,6 +27,8 @@
 # include <sstream>
 #endif
 
+#include <QMutex>
+#include <QMutexLocker>
 #include <CXX/Objects.hxx>
 #include <Base/Builder3D.h>
 #include <Base/Console.h>
@@ -36,10 +38,14 @@
 #include <Base/Interpreter.h>
 #include <Base/Sequencer.h>
 #include <Base/ViewProj.h>
+#include <App/Application.h>
 
+#include "Core/Adjacency.h"
 #include "Core/Builder.h"
+#include "Core/Decimation.h"
 #include "Core/MeshKernel.h"
 #include "Core/Grid.h"
+#include "Core/BVH.h"
 #include "Core/Iterator.h"
 #include "Core/Info.h"
 #include "Core/TopoAlgorithm.h"
@@ -47,6 +53,7 @@
 #include "Core/Degeneration.h"
 #include "Core/Segmentation.h"
 #include "Core/SetOperations.h"
+#include "Core/Smoothing.h"
 #include "Core/Triangulation.h"
 #include "Core/Trim.h"
 #include "Core/Visitor.h"
@@ -61,23 +68,24 @@ float MeshObject::Epsilon = 1.0e-5f;
 TYPESYSTEM_SOURCE(Mesh::MeshObject, Data::ComplexGeoData);
 
 MeshObject::MeshObject()
+  : _adjacency(0)
 {
 }
 
 MeshObject::MeshObject(const MeshCore::MeshKernel& Kernel)
-  : _kernel(Kernel)
+  : _kernel(Kernel), _adjacency(0)
 {
     // copy the mesh structure
 }
 
 MeshObject::MeshObject(const MeshCore::MeshKernel& Kernel, const Base::Matrix4D &Mtrx)
-  : _Mtrx(Mtrx),_kernel(Kernel)
+  : _Mtrx(Mtrx),_kernel(Kernel),_adjacency(0)
 {
     // copy the mesh structure
 }
 
 MeshObject::MeshObject(const MeshObject& mesh)
-  : _Mtrx(mesh._Mtrx),_kernel(mesh._kernel)
+  : _Mtrx(mesh._Mtrx),_kernel(mesh._kernel),_adjacency(0)
 {
     // copy the mesh structure
     this->_segments = mesh._segments;
@@ -85,6 +93,7 @@ MeshObject::MeshObject(const MeshObject& mesh)
 
 MeshObject::~MeshObject()
 {
+    delete this->_adjacency;
 }
 
 std::vector<const char*> MeshObject::getElementTypes(void) const
@@ -163,6 +172,7 @@ void MeshObject::operator = (const MeshObject& mesh)
         setTransform(mesh._Mtrx);
         this->_kernel = mesh._kernel;
         this->_segments = mesh._segments;
+        clearAdjacency();
     }
 }
 
@@ -170,6 +180,7 @@ void MeshObject::setKernel(const MeshCore::MeshKernel& m)
 {
     this->_kernel = m;
     this->_segments.clear();
+    clearAdjacency();
 }
 
 void MeshObject::swap(MeshCore::MeshKernel& Kernel)
@@ -178,17 +189,41 @@ void MeshObject::swap(MeshCore::MeshKernel& Kernel)
     // clear the segments because we don't know how the new
     // topology looks like
     this->_segments.clear();
+    clearAdjacency();
 }
 
 void MeshObject::swap(MeshObject& mesh)
 {
     this->_kernel.Swap(mesh._kernel);
     this->_segments.swap(mesh._segments);
+    clearAdjacency();
+    mesh.clearAdjacency();
     Base::Matrix4D tmp=this->_Mtrx;
     this->_Mtrx = mesh._Mtrx;
     mesh._Mtrx = tmp;
 }
 
+// guards the lazy creation of the adjacency of all meshes
+static QMutex adjacencyMutex;
+
+const MeshCore::MeshAdjacency& MeshObject::getAdjacency() const
+{
+    QMutexLocker lock(&adjacencyMutex);
+    // only the topology is stored so that moving points keeps the structure valid
+    if (!this->_adjacency)
+        this->_adjacency = new MeshCore::MeshAdjacency(this->_kernel);
+    else if (!this->_adjacency->IsValid())
+        this->_adjacency->Rebuild();
+    return *this->_adjacency;
+}
+
+void MeshObject::clearAdjacency()
+{
+    QMutexLocker lock(&adjacencyMutex);
+    delete this->_adjacency;
+    this->_adjacency = 0;
+}
+
 std::string MeshObject::representation() const
 {
     std::stringstream str;
@@ -320,12 +355,20 @@ void MeshObject::save(std::ostream& out) const
 
 bool MeshObject::load(const char* file, MeshCore::Material* mat)
 {
+    // The parsers based on regular expressions can still be selected as fallback
+    ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath
+        ("User parameter:BaseApp/Preferences/Mod/Mesh");
+    long mode = hGrp->GetInt("AsciiParserMode", Base::AsciiParser::Parallel);
+    if (mode >= Base::AsciiParser::Regex && mode <= Base::AsciiParser::Parallel)
+        MeshCore::MeshInput::SetAsciiParserMode(static_cast<Base::AsciiParser::Mode>(mode));
+
     MeshCore::MeshKernel kernel;
     MeshCore::MeshInput aReader(kernel, mat);
     if (!aReader.LoadAny(file))
         return false;
 
     _kernel.Swap(kernel);
+    clearAdjacency();
     // Some file formats define several objects per file (e.g. OBJ).
     // Now we mark each object as an own segment so that we can break
     // the object into its orriginal objects again.
@@ -380,6 +423,7 @@ void MeshObject::load(std::istream& in)
 {
     _kernel.Read(in);
     this->_segments.clear();
+    clearAdjacency();
 
 #ifndef FC_DEBUG
     try {
@@ -405,22 +449,26 @@ void MeshObject::load(std::istream& in)
 void MeshObject::addFacet(const MeshCore::MeshGeomFacet& facet)
 {
     _kernel.AddFacet(facet);
+    clearAdjacency();
 }
 
 void MeshObject::addFacets(const std::vector<MeshCore::MeshGeomFacet>& facets)
 {
     _kernel.AddFacets(facets);
+    clearAdjacency();
 }
 
 void MeshObject::addFacets(const std::vector<MeshCore::MeshFacet> &facets)
 {
     _kernel.AddFacets(facets);
+    clearAdjacency();
 }
 
 void MeshObject::addFacets(const std::vector<MeshCore::MeshFacet> &facets,
                            const std::vector<Base::Vector3f>& points)
 {
     _kernel.AddFacets(facets, points);
+    clearAdjacency();
 }
 
 void MeshObject::addFacets(const std::vector<Data::ComplexGeoData::Facet> &facets,
@@ -444,11 +492,13 @@ void MeshObject::addFacets(const std::vector<Data::ComplexGeoData::Facet> &facet
     }
 
     _kernel.AddFacets(facet_v, point_v);
+    clearAdjacency();
 }
 
 void MeshObject::setFacets(const std::vector<MeshCore::MeshGeomFacet>& facets)
 {
     _kernel = facets;
+    clearAdjacency();
 }
 
 void MeshObject::setFacets(const std::vector<Data::ComplexGeoData::Facet> &facets,
@@ -472,16 +522,19 @@ void MeshObject::setFacets(const std::vector<Data::ComplexGeoData::Facet> &facet
     }
 
     _kernel.Adopt(point_v, facet_v, true);
+    clearAdjacency();
 }
 
 void MeshObject::addMesh(const MeshObject& mesh)
 {
     _kernel.Merge(mesh._kernel);
+    clearAdjacency();
 }
 
 void MeshObject::addMesh(const MeshCore::MeshKernel& kernel)
 {
     _kernel.Merge(kernel);
+    clearAdjacency();
 }
 
 void MeshObject::deleteFacets(const std::vector<unsigned long>& removeIndices)
@@ -494,10 +547,12 @@ void MeshObject::deletePoints(const std::vector<unsigned long>& removeIndices)
 {
     _kernel.DeletePoints(removeIndices);
     this->_segments.clear();
+    clearAdjacency();
 }
 
 void MeshObject::deletedFacets(const std::vector<unsigned long>& remFacets)
 {
+    clearAdjacency();
     if (remFacets.empty())
         return; // nothing has changed
     if (this->_segments.empty())
@@ -686,7 +741,8 @@ void MeshObject::fillupHoles(unsigned long length, int level,
 {
     std::list<std::vector<unsigned long> > aFailed;
     MeshCore::MeshTopoAlgorithm topalg(_kernel);
-    topalg.FillupHoles(length, level, cTria, aFailed);
+    topalg.FillupHoles(length, level, cTria, aFailed, &getAdjacency());
+    clearAdjacency();
 }
 
 void MeshObject::offset(float fSize)
@@ -747,6 +803,7 @@ void MeshObject::offsetSpecial2(float fSize)
     }
 
     alg.Cleanup();
+    clearAdjacency();
 
     // search for intersected facets
     MeshCore::MeshEvalSelfIntersection eval(_kernel);
@@ -778,6 +835,7 @@ void MeshObject::clear(void)
 {
     _kernel.Clear();
     this->_segments.clear();
+    clearAdjacency();
     setTransform(Base::Matrix4D());
 }
 
@@ -806,7 +864,10 @@ void MeshObject::setPoint(unsigned long index, const Base::Vector3d& p)
 
 void MeshObject::smooth(int iterations, float d_max)
 {
-    _kernel.Smooth(iterations, d_max);
+    // smoothing doesn't change the topology so that the adjacency stays valid
+    MeshCore::LaplaceSmoothing smoother(_kernel);
+    smoother.SetAdjacency(&getAdjacency());
+    smoother.Smooth(iterations);
 }
 
 Base::Vector3d MeshObject::getPointNormal(unsigned long index) const
@@ -835,6 +896,26 @@ void MeshObject::crossSections(const std::vector<MeshObject::TPlane>& planes, st
     }
 }
 
+void MeshObject::nearestFacetsOnRays(const std::vector<Base::Vector3d>& pnts, const std::vector<Base::Vector3d>& dirs,
+                                     std::vector<unsigned long>& facets, std::vector<Base::Vector3d>& points) const
+{
+    std::vector<Base::Vector3f> pts, drs, res;
+    pts.reserve(pnts.size());
+    drs.reserve(dirs.size());
+    for (std::vector<Base::Vector3d>::const_iterator it = pnts.begin(); it != pnts.end(); ++it)
+        pts.push_back(Base::convertTo<Base::Vector3f>(*it));
+    for (std::vector<Base::Vector3d>::const_iterator it = dirs.begin(); it != dirs.end(); ++it)
+        drs.push_back(Base::convertTo<Base::Vector3f>(*it));
+
+    MeshCore::MeshFacetBVH bvh(_kernel);
+    bvh.NearestFacetsOnRays(pts, drs, res, facets);
+
+    points.clear();
+    points.reserve(res.size());
+    for (std::vector<Base::Vector3f>::iterator it = res.begin(); it != res.end(); ++it)
+        points.push_back(Base::convertTo<Base::Vector3d>(*it));
+}
+
 void MeshObject::cut(const Base::Polygon2D& polygon2d,
                      const Base::ViewProjMethod& proj, MeshObject::CutType type)
 {
@@ -878,8 +959,10 @@ void MeshObject::trim(const Base::Polygon2D& polygon2d,
     trim.TrimFacets(check, triangle);
     if (!check.empty())
         this->deleteFacets(check);
-    if (!triangle.empty())
+    if (!triangle.empty()) {
         this->_kernel.AddFacets(triangle);
+        clearAdjacency();
+    }
 }
 
 MeshObject* MeshObject::unite(const MeshObject& mesh) const
@@ -961,6 +1044,7 @@ void MeshObject::refine()
     // clear the segments because we don't know how the new
     // topology looks like
     this->_segments.clear();
+    clearAdjacency();
 }
 
 void MeshObject::optimizeTopology(float fMaxAngle)
@@ -974,10 +1058,12 @@ void MeshObject::optimizeTopology(float fMaxAngle)
     // clear the segments because we don't know how the new
     // topology looks like
     this->_segments.clear();
+    clearAdjacency();
 }
 
 void MeshObject::optimizeEdges()
 {
+    clearAdjacency();
     MeshCore::MeshTopoAlgorithm topalg(_kernel);
     topalg.AdjustEdgesToCurvatureDirection();
 }
@@ -1011,22 +1097,26 @@ void MeshObject::splitEdges()
     // clear the segments because we don't know how the new
     // topology looks like
     this->_segments.clear();
+    clearAdjacency();
 }
 
 void MeshObject::splitEdge(unsigned long facet, unsigned long neighbour, const Base::Vector3f& v)
 {
+    clearAdjacency();
     MeshCore::MeshTopoAlgorithm topalg(_kernel);
     topalg.SplitEdge(facet, neighbour, v);
 }
 
 void MeshObject::splitFacet(unsigned long facet, const Base::Vector3f& v1, const Base::Vector3f& v2)
 {
+    clearAdjacency();
     MeshCore::MeshTopoAlgorithm topalg(_kernel);
     topalg.SplitFacet(facet, v1, v2);
 }
 
 void MeshObject::swapEdge(unsigned long facet, unsigned long neighbour)
 {
+    clearAdjacency();
     MeshCore::MeshTopoAlgorithm topalg(_kernel);
     topalg.SwapEdge(facet, neighbour);
 }
@@ -1062,14 +1152,34 @@ void MeshObject::collapseFacets(const std::vector<unsigned long>& facets)
     deletedFacets(facets);
 }
 
+unsigned long MeshObject::decimate(unsigned long targetSize, float maxError, float featureAngle,
+                                  bool keepBoundary, bool parallel)
+{
+    MeshCore::MeshDecimation dm(_kernel);
+    dm.SetTargetSize(targetSize);
+    dm.SetMaxError(maxError);
+    dm.SetFeatureAngle(featureAngle);
+    dm.SetKeepBoundary(keepBoundary);
+    dm.SetParallel(parallel);
+    unsigned long count = dm.Decimate();
+
+    // clear the segments because we don't know how the new
+    // topology looks like
+    this->_segments.clear();
+    clearAdjacency();
+    return count;
+}
+
 void MeshObject::insertVertex(unsigned long facet, const Base::Vector3f& v)
 {
+    clearAdjacency();
     MeshCore::MeshTopoAlgorithm topalg(_kernel);
     topalg.InsertVertex(facet, v);
 }
 
 void MeshObject::snapVertex(unsigned long facet, const Base::Vector3f& v)
 {
+    clearAdjacency();
     MeshCore::MeshTopoAlgorithm topalg(_kernel);
     topalg.SnapVertex(facet, v);
 }
@@ -1131,6 +1241,7 @@ void MeshObject::removeSelfIntersections()
         MeshCore::MeshFixSelfIntersection cMeshFix(_kernel, selfIntersections);
         cMeshFix.Fixup();
         this->_segments.clear();
+        clearAdjacency();
     }
 }
 
@@ -1155,6 +1266,7 @@ void MeshObject::removeSelfIntersections(const std::vector<unsigned long>& indic
         MeshCore::MeshFixSelfIntersection cMeshFix(_kernel, selfIntersections);
         cMeshFix.Fixup();
         this->_segments.clear();
+        clearAdjacency();
     }
 }
 
@@ -1205,6 +1317,7 @@ void MeshObject::removeInvalidPoints()
 
 void MeshObject::validateIndices()
 {
+    clearAdjacency();
     unsigned long count = _kernel.CountFacets();
 
     // for invalid neighbour indices we don't need to check first
@@ -1236,6 +1349,7 @@ void MeshObject::validateIndices()
 
 void MeshObject::validateDeformations(float fMaxAngle)
 {
+    clearAdjacency();
     unsigned long count = _kernel.CountFacets();
     MeshCore::MeshFixDeformedFacets eval(_kernel, fMaxAngle);
     eval.Fixup();
@@ -1245,6 +1359,7 @@ void MeshObject::validateDeformations(float fMaxAngle)
 
 void MeshObject::validateDegenerations()
 {
+    clearAdjacency();
     unsigned long count = _kernel.CountFacets();
     MeshCore::MeshFixDegeneratedFacets eval(_kernel);
     eval.Fixup();
@@ -1254,6 +1369,7 @@ void MeshObject::validateDegenerations()
 
 void MeshObject::removeDuplicatedPoints()
 {
+    clearAdjacency();
     unsigned long count = _kernel.CountFacets();
     MeshCore::MeshFixDuplicatePoints eval(_kernel);
     eval.Fixup();
@@ -1263,6 +1379,7 @@ void MeshObject::removeDuplicatedPoints()
 
 void MeshObject::removeDuplicatedFacets()
 {
+    clearAdjacency();
     unsigned long count = _kernel.CountFacets();
     MeshCore::MeshFixDuplicateFacets eval(_kernel);
     eval.Fixup();
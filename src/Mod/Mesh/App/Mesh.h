@@ -56,6 +56,7 @@ namespace Base {
 
 namespace MeshCore {
 class AbstractPolygonTriangulator;
+class MeshAdjacency;
 }
 
 namespace Mesh
@@ -133,10 +134,17 @@ public:
     //@}
 
     void setKernel(const MeshCore::MeshKernel& m);
+    /// Non-const access to the kernel drops the adjacency as the topology may get changed.
     MeshCore::MeshKernel& getKernel(void)
-    { return _kernel; }
+    { clearAdjacency(); return _kernel; }
     const MeshCore::MeshKernel& getKernel(void) const
     { return _kernel; }
+    /** Returns the facets and neighbour points of all points. The structure is built on
+     * first use and shared by the algorithms until the topology of the mesh changes.
+     * Several threads may call this method at the same time, but the returned structure
+     * must not be used while another thread modifies the mesh.
+     */
+    const MeshCore::MeshAdjacency& getAdjacency() const;
 
     virtual Base::BoundBox3d getBoundBox(void)const;
 
@@ -206,6 +214,11 @@ public:
     Base::Vector3d getPointNormal(unsigned long) const;
     void crossSections(const std::vector<TPlane>&, std::vector<TPolylines> &sections,
                        float fMinEps = 1.0e-2f, bool bConnectPolygons = false) const;
+    /** Casts a ray for each pair of base point and direction and returns the index of the nearest
+     * facet hit and the intersection point. For rays that miss the mesh the index is ULONG_MAX.
+     */
+    void nearestFacetsOnRays(const std::vector<Base::Vector3d>& pnts, const std::vector<Base::Vector3d>& dirs,
+                             std::vector<unsigned long>& facets, std::vector<Base::Vector3d>& points) const;
     void cut(const Base::Polygon2D& polygon, const Base::ViewProjMethod& proj, CutType);
     void trim(const Base::Polygon2D& polygon, const Base::ViewProjMethod& proj, CutType);
     //@}
@@ -247,6 +260,11 @@ public:
     void collapseEdge(unsigned long, unsigned long);
     void collapseFacet(unsigned long);
     void collapseFacets(const std::vector<unsigned long>&);
+    /** Reduces the number of facets by edge collapses in the order of the quadric error metric
+     * and returns the number of removed facets. See MeshCore::MeshDecimation for the parameters.
+     */
+    unsigned long decimate(unsigned long targetSize, float maxError, float featureAngle,
+                           bool keepBoundary, bool parallel);
     void insertVertex(unsigned long, const Base::Vector3f& v);
     void snapVertex(unsigned long, const Base::Vector3f& v);
     //@}
@@ -359,6 +377,7 @@ public:
     friend class Segment;
 
 private:
+    void clearAdjacency();
     void deletedFacets(const std::vector<unsigned long>& remFacets);
     void updateMesh(const std::vector<unsigned long>&);
     void updateMesh();
@@ -367,6 +386,7 @@ private:
     Base::Matrix4D _Mtrx;
     MeshCore::MeshKernel _kernel;
     std::vector<Segment> _segments;
+    mutable MeshCore::MeshAdjacency* _adjacency;
     static float Epsilon;
 };
 
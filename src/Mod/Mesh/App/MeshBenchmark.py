@@ -0,0 +1,47 @@
+#   (c) FreeCAD Developers 2026      LGPL
+
+import FreeCAD, Mesh, os, time, tempfile, unittest
+
+
+#---------------------------------------------------------------------------
+# timings of building the mesh structure, i.e. merging the points of
+# MeshBuilder and connecting the facets, for spheres of growing size.
+# Run them with TestApp.testMeshBenchmark(), the largest sphere has two
+# million facets which is too slow for the regular mesh tests.
+#---------------------------------------------------------------------------
+
+
+class MeshBuilderBenchmark(unittest.TestCase):
+    # sampling of the spheres, the number of facets grows quadratically
+    Samplings = [100, 300, 1000]
+
+    def setUp(self):
+        self.fileName = tempfile.gettempdir() + os.sep + "MeshBenchmark.stl"
+
+    def testLoadSTL(self):
+        # every corner of a binary STL file is stored once per facet and must be merged
+        for sampling in self.Samplings:
+            sphere = Mesh.createSphere(10.0, sampling)
+            sphere.write(self.fileName)
+            start = time.time()
+            mesh = Mesh.Mesh()
+            mesh.read(self.fileName)
+            elapsed = max(time.time() - start, 1e-6)
+            FreeCAD.Console.PrintMessage("Loading %d facets: %.3fs (%.0f facets/s)\n"
+                % (mesh.CountFacets, elapsed, mesh.CountFacets / elapsed))
+            self.failUnless(mesh.CountPoints == sphere.CountPoints)
+            self.failUnless(mesh.CountFacets == sphere.CountFacets)
+
+    def testRebuildNeighbours(self):
+        for sampling in self.Samplings:
+            mesh = Mesh.createSphere(10.0, sampling)
+            start = time.time()
+            mesh.rebuildNeighbourHood()
+            elapsed = max(time.time() - start, 1e-6)
+            FreeCAD.Console.PrintMessage("Rebuilding neighbours of %d facets: %.3fs (%.0f facets/s)\n"
+                % (mesh.CountFacets, elapsed, mesh.CountFacets / elapsed))
+            self.failUnless(mesh.isSolid())
+
+    def tearDown(self):
+        if os.path.exists(self.fileName):
+            os.remove(self.fileName)
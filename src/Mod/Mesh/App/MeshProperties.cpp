@@ -23,6 +23,7 @@
 
 #include "PreCompiled.h"
 #ifndef _PreComp_
+# include <boost/bind.hpp>
 #endif
 
 #include <CXX/Objects.hxx>
@@ -451,6 +452,7 @@ void PropertyMeshKernel::setValuePtr(MeshObject* mesh)
     // before calling hasSetValue()
     Base::Reference<MeshObject> tmp(_meshObject);
     aboutToSetValue();
+    _deferred.clear();
     _meshObject = mesh;
     hasSetValue();
 }
@@ -458,6 +460,7 @@ void PropertyMeshKernel::setValuePtr(MeshObject* mesh)
 void PropertyMeshKernel::setValue(const MeshObject& mesh)
 {
     aboutToSetValue();
+    _deferred.clear();
     *_meshObject = mesh;
     hasSetValue();
 }
@@ -465,12 +468,14 @@ void PropertyMeshKernel::setValue(const MeshObject& mesh)
 void PropertyMeshKernel::setValue(const MeshCore::MeshKernel& mesh)
 {
     aboutToSetValue();
+    _deferred.clear();
     _meshObject->setKernel(mesh);
     hasSetValue();
 }
 
 void PropertyMeshKernel::swapMesh(MeshObject& mesh)
 {
+    restoreDeferred();
     aboutToSetValue();
     _meshObject->swap(mesh);
     hasSetValue();
@@ -478,6 +483,7 @@ void PropertyMeshKernel::swapMesh(MeshObject& mesh)
 
 void PropertyMeshKernel::swapMesh(MeshCore::MeshKernel& mesh)
 {
+    restoreDeferred();
     aboutToSetValue();
     _meshObject->swap(mesh);
     hasSetValue();
@@ -485,21 +491,25 @@ void PropertyMeshKernel::swapMesh(MeshCore::MeshKernel& mesh)
 
 const MeshObject& PropertyMeshKernel::getValue(void)const 
 {
+    restoreDeferred();
     return *_meshObject;
 }
 
 const MeshObject* PropertyMeshKernel::getValuePtr(void)const 
 {
+    restoreDeferred();
     return (MeshObject*)_meshObject;
 }
 
 const Data::ComplexGeoData* PropertyMeshKernel::getComplexData() const
 {
+    restoreDeferred();
     return (MeshObject*)_meshObject;
 }
 
 Base::BoundBox3d PropertyMeshKernel::getBoundingBox() const
 {
+    restoreDeferred();
     return _meshObject->getBoundBox();
 }
 
@@ -507,6 +517,7 @@ void PropertyMeshKernel::getFaces(std::vector<Base::Vector3d> &aPoints,
                                   std::vector<Data::ComplexGeoData::Facet> &aTopo,
                                   float accuracy, uint16_t flags) const
 {
+    restoreDeferred();
     _meshObject->getFaces(aPoints, aTopo, accuracy, flags);
 }
 
@@ -520,6 +531,7 @@ unsigned int PropertyMeshKernel::getMemSize (void) const
 
 MeshObject* PropertyMeshKernel::startEditing()
 {
+    restoreDeferred();
     aboutToSetValue();
     return (MeshObject*)_meshObject;
 }
@@ -531,6 +543,7 @@ void PropertyMeshKernel::finishEditing()
 
 void PropertyMeshKernel::transformGeometry(const Base::Matrix4D &rclMat)
 {
+    restoreDeferred();
     aboutToSetValue();
     _meshObject->transformGeometry(rclMat);
     hasSetValue();
@@ -538,6 +551,7 @@ void PropertyMeshKernel::transformGeometry(const Base::Matrix4D &rclMat)
 
 void PropertyMeshKernel::setPointIndices(const std::vector<std::pair<unsigned long, Base::Vector3f> >& inds)
 {
+    restoreDeferred();
     aboutToSetValue();
     MeshCore::MeshKernel& kernel = _meshObject->getKernel();
     for (std::vector<std::pair<unsigned long, Base::Vector3f> >::const_iterator it = inds.begin(); it != inds.end(); ++it)
@@ -547,6 +561,7 @@ void PropertyMeshKernel::setPointIndices(const std::vector<std::pair<unsigned lo
 
 PyObject *PropertyMeshKernel::getPyObject(void)
 {
+    restoreDeferred();
     if (!meshPyObject) {
         meshPyObject = new MeshPy(&*_meshObject);
         meshPyObject->setConst(); // set immutable
@@ -582,6 +597,7 @@ void PropertyMeshKernel::setPyObject(PyObject *value)
 
 void PropertyMeshKernel::Save (Base::Writer &writer) const
 {
+    restoreDeferred();
     if (writer.isForceXML()) {
         writer.Stream() << writer.ind() << "<Mesh>" << std::endl;
         MeshCore::MeshOutput saver(_meshObject->getKernel());
@@ -595,6 +611,7 @@ void PropertyMeshKernel::Save (Base::Writer &writer) const
 
 void PropertyMeshKernel::Restore(Base::XMLReader &reader)
 {
+    _deferred.clear();
     reader.readElement("Mesh");
     std::string file (reader.getAttribute("file") );
     
@@ -621,6 +638,7 @@ void PropertyMeshKernel::Restore(Base::XMLReader &reader)
 
 void PropertyMeshKernel::SaveDocFile (Base::Writer &writer) const
 {
+    restoreDeferred();
     _meshObject->save(writer.Stream());
 }
 
@@ -631,9 +649,23 @@ void PropertyMeshKernel::RestoreDocFile(Base::Reader &reader)
     hasSetValue();
 }
 
+void PropertyMeshKernel::setDeferredDocFile(const Base::DeferredFile &file)
+{
+    _deferred = file;
+}
+
+void PropertyMeshKernel::restoreDeferred() const
+{
+    // The mesh is only read in, this is not a modification. So, unlike
+    // RestoreDocFile() no change notification is sent.
+    if (_deferred.isPending())
+        _deferred.restore(boost::bind(&MeshObject::load, &*_meshObject, _1));
+}
+
 App::Property *PropertyMeshKernel::Copy(void) const
 {
     // Note: Copy the content, do NOT reference the same mesh object
+    restoreDeferred();
     PropertyMeshKernel *prop = new PropertyMeshKernel();
     *(prop->_meshObject) = *(this->_meshObject);
     return prop;
@@ -644,6 +676,8 @@ void PropertyMeshKernel::Paste(const App::Property &from)
     // Note: Copy the content, do NOT reference the same mesh object
     aboutToSetValue();
     const PropertyMeshKernel& prop = dynamic_cast<const PropertyMeshKernel&>(from);
+    prop.restoreDeferred();
+    _deferred.clear();
     *(this->_meshObject) = *(prop._meshObject);
     hasSetValue();
 }
@@ -85,6 +85,7 @@ public:
     virtual void Restore(Base::XMLReader &reader);
 
     virtual void SaveDocFile (Base::Writer &writer) const;
+    virtual bool isSaveDocFileThreadSafe (void) const { return true; }
     virtual void RestoreDocFile(Base::Reader &reader);
 
     virtual App::Property *Copy(void) const;
@@ -141,6 +142,7 @@ public:
     void Restore(Base::XMLReader &reader);
 
     void SaveDocFile (Base::Writer &writer) const;
+    virtual bool isSaveDocFileThreadSafe (void) const { return true; }
     void RestoreDocFile(Base::Reader &reader);
 
     /** @name Python interface */
@@ -239,14 +241,22 @@ public:
     void Restore(Base::XMLReader &reader);
 
     void SaveDocFile (Base::Writer &writer) const;
+    virtual bool isSaveDocFileThreadSafe (void) const { return true; }
     void RestoreDocFile(Base::Reader &reader);
+    virtual bool isRestoreDocFileDeferrable (void) const { return true; }
+    void setDeferredDocFile(const Base::DeferredFile &file);
 
     App::Property *Copy(void) const;
     void Paste(const App::Property &from);
     //@}
 
+private:
+    /// reads the mesh if its file has been deferred when restoring the document
+    void restoreDeferred() const;
+
 private:
     Base::Reference<MeshObject> _meshObject;
+    mutable Base::DeferredFile _deferred;
     MeshPy* meshPyObject;
 };
 
@@ -39,6 +39,7 @@
 #include "Core/Iterator.h"
 #include "Core/Degeneration.h"
 #include "Core/Elements.h"
+#include "Core/Evaluation.h"
 #include "Core/Grid.h"
 #include "Core/MeshKernel.h"
 #include "Core/Segmentation.h"
@@ -783,6 +784,73 @@ PyObject*  MeshPy::hasSelfIntersections(PyObject *args)
     return Py_BuildValue("O", (ok ? Py_True : Py_False)); 
 }
 
+PyObject*  MeshPy::getSelfIntersections(PyObject *args)
+{
+    if (!PyArg_ParseTuple(args, ""))
+        return NULL;
+
+    try {
+        // a pair is found in each grid element that both facets share
+        std::vector<std::pair<unsigned long, unsigned long> > pairs;
+        MeshCore::MeshEvalSelfIntersection eval(getMeshObjectPtr()->getKernel());
+        eval.GetIntersections(pairs);
+        for (std::vector<std::pair<unsigned long, unsigned long> >::iterator it = pairs.begin(); it != pairs.end(); ++it) {
+            if (it->first > it->second)
+                std::swap(it->first, it->second);
+        }
+        std::sort(pairs.begin(), pairs.end());
+        pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+        Py::List list;
+        for (std::vector<std::pair<unsigned long, unsigned long> >::iterator it = pairs.begin(); it != pairs.end(); ++it) {
+            Py::Tuple tuple(2);
+            tuple.setItem(0, Py::Int((int)it->first));
+            tuple.setItem(1, Py::Int((int)it->second));
+            list.append(tuple);
+        }
+        return Py::new_reference_to(list);
+    }
+    catch (const Base::Exception& e) {
+        PyErr_SetString(PyExc_Exception, e.what());
+        return NULL;
+    }
+}
+
+PyObject*  MeshPy::evaluateAll(PyObject *args)
+{
+    if (!PyArg_ParseTuple(args, ""))
+        return NULL;
+
+    try {
+        MeshCore::MeshEvalAll eval(getMeshObjectPtr()->getKernel());
+        eval.Evaluate();
+        const MeshCore::MeshEvalAll::Report& report = eval.GetReport();
+
+        static const char* names[MeshCore::MeshEvalAll::CountChecks] = {
+            "Indices", "Orientation", "NonManifolds", "Degenerations", "DuplicatedFacets",
+            "DuplicatedPoints", "SelfIntersections", "Folds"
+        };
+        bool results[MeshCore::MeshEvalAll::CountChecks] = {
+            report.indices, report.orientation, report.nonManifolds, report.degenerations,
+            report.duplicatedFacets, report.duplicatedPoints, report.selfIntersections, report.folds
+        };
+
+        Py::Dict dict;
+        Py::Dict errors;
+        dict.setItem("Complete", Py::Boolean(report.complete));
+        for (int i = 0; i < MeshCore::MeshEvalAll::CountChecks; i++) {
+            dict.setItem(names[i], Py::Boolean(results[i]));
+            if (report.hasError(MeshCore::MeshEvalAll::Check(i)))
+                errors.setItem(names[i], Py::String(report.errors[i]));
+        }
+        dict.setItem("Errors", errors);
+        return Py::new_reference_to(dict);
+    }
+    catch (const Py::Exception&) {
+        return 0;
+    }
+}
+
 PyObject*  MeshPy::fixSelfIntersections(PyObject *args)
 {
     if (!PyArg_ParseTuple(args, ""))
@@ -1243,11 +1311,37 @@ PyObject*  MeshPy::collapseFacets(PyObject *args)
     Py_Return; 
 }
 
+PyObject*  MeshPy::decimate(PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"targetSize", "maxError", "featureAngle", "keepBoundary", "parallel", NULL};
+    unsigned long targetSize = 0;
+    float maxError = -1.0f;
+    float featureAngle = F_PI/3.0f;
+    PyObject* keepBoundary = Py_True;
+    PyObject* parallel = Py_True;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|kffO!O!", kwlist,
+        &targetSize, &maxError, &featureAngle,
+        &(PyBool_Type), &keepBoundary,
+        &(PyBool_Type), &parallel))
+        return NULL;
+
+    unsigned long count = 0;
+    PY_TRY {
+        MeshPropertyLock lock(this->parentProperty);
+        count = getMeshObjectPtr()->decimate(targetSize, maxError, featureAngle,
+            PyObject_IsTrue(keepBoundary) ? true : false,
+            PyObject_IsTrue(parallel) ? true : false);
+    } PY_CATCH;
+
+    return Py_BuildValue("k", count);
+}
+
 PyObject*  MeshPy::foraminate(PyObject *args)
 {
     PyObject* pnt_p;
     PyObject* dir_p;
-    if (!PyArg_ParseTuple(args, "OO", &pnt_p, &dir_p))
+    PyObject* grid_p = Py_False;
+    if (!PyArg_ParseTuple(args, "OO|O!", &pnt_p, &dir_p, &PyBool_Type, &grid_p))
         return NULL;
 
     try {
@@ -1387,14 +1481,16 @@ PyObject* MeshPy::nearestFacetOnRay(PyObject *args)
         Base::Vector3f res;
         MeshCore::MeshAlgorithm alg(getMeshObjectPtr()->getKernel());
 
-#if 0 // for testing only
-        MeshCore::MeshFacetGrid grid(getMeshObjectPtr()->getKernel(),10);
-        // With grids we might search in the opposite direction, too
-        if (alg.NearestFacetOnRay(pnt,  dir, grid, res, index) ||
-            alg.NearestFacetOnRay(pnt, -dir, grid, res, index)) {
-#else
-        if (alg.NearestFacetOnRay(pnt, dir, res, index)) {
-#endif
+        bool found;
+        if (grid_p == Py_True) {
+            MeshCore::MeshFacetGrid grid(getMeshObjectPtr()->getKernel());
+            found = alg.NearestFacetOnRay(pnt, dir, grid, res, index);
+        }
+        else {
+            found = alg.NearestFacetOnRay(pnt, dir, res, index);
+        }
+
+        if (found) {
             Py::Tuple tuple(3);
             tuple.setItem(0, Py::Float(res.x));
             tuple.setItem(1, Py::Float(res.y));
@@ -1402,24 +1498,37 @@ PyObject* MeshPy::nearestFacetOnRay(PyObject *args)
             dict.setItem(Py::Int((int)index), tuple);
         }
 
-#if 0 // for testing only
-        char szBuf[200];
-        std::ofstream str("grid_test.iv");
-        Base::InventorBuilder builder(str);
-        MeshCore::MeshGridIterator g_it(grid);
-        for (g_it.Init(); g_it.More(); g_it.Next()) {
-            Base::BoundBox3f box = g_it.GetBoundBox();
-            unsigned long uX,uY,uZ;
-            g_it.GetGridPos(uX,uY,uZ);
-            builder.addBoundingBox(Base::Vector3f(box.MinX,box.MinY, box.MinZ),
-                                   Base::Vector3f(box.MaxX,box.MaxY, box.MaxZ));
-            sprintf(szBuf, "(%lu,%lu,%lu)", uX, uY, uZ);
-            builder.addText(box.CalcCenter(), szBuf);
+        return Py::new_reference_to(dict);
+    }
+    catch (const Py::Exception&) {
+        return 0;
+    }
+}
+
+PyObject* MeshPy::nearestFacetToPoint(PyObject *args)
+{
+    PyObject* pnt_p;
+    if (!PyArg_ParseTuple(args, "O", &pnt_p))
+        return NULL;
+
+    try {
+        Py::Tuple pnt_t(pnt_p);
+        Py::Dict dict;
+        Base::Vector3f pnt((float)Py::Float(pnt_t.getItem(0)),
+                           (float)Py::Float(pnt_t.getItem(1)),
+                           (float)Py::Float(pnt_t.getItem(2)));
+
+        unsigned long index = 0;
+        Base::Vector3f res;
+        MeshCore::MeshAlgorithm alg(getMeshObjectPtr()->getKernel());
+        MeshCore::MeshFacetGrid grid(getMeshObjectPtr()->getKernel());
+        if (alg.NearestPointFromPoint(pnt, grid, index, res)) {
+            Py::Tuple tuple(3);
+            tuple.setItem(0, Py::Float(res.x));
+            tuple.setItem(1, Py::Float(res.y));
+            tuple.setItem(2, Py::Float(res.z));
+            dict.setItem(Py::Int((int)index), tuple);
         }
-        builder.addSingleArrow(pnt-20.0f*dir, pnt+10.0f*dir);
-        builder.close();
-        str.close();
-#endif
 
         return Py::new_reference_to(dict);
     }
@@ -1428,6 +1537,61 @@ PyObject* MeshPy::nearestFacetOnRay(PyObject *args)
     }
 }
 
+PyObject* MeshPy::nearestFacetsOnRays(PyObject *args)
+{
+    PyObject* pnts_p;
+    PyObject* dirs_p;
+    if (!PyArg_ParseTuple(args, "OO", &pnts_p, &dirs_p))
+        return NULL;
+
+    try {
+        Py::Sequence pnts_s(pnts_p);
+        Py::Sequence dirs_s(dirs_p);
+        if (pnts_s.size() != dirs_s.size()) {
+            PyErr_SetString(PyExc_ValueError, "Number of points and directions must be equal");
+            return NULL;
+        }
+
+        std::vector<Base::Vector3d> pnts, dirs;
+        pnts.reserve(pnts_s.size());
+        dirs.reserve(dirs_s.size());
+        for (Py::Sequence::iterator it = pnts_s.begin(); it != pnts_s.end(); ++it) {
+            Py::Tuple t(*it);
+            pnts.push_back(Base::Vector3d((double)Py::Float(t.getItem(0)),
+                                          (double)Py::Float(t.getItem(1)),
+                                          (double)Py::Float(t.getItem(2))));
+        }
+        for (Py::Sequence::iterator it = dirs_s.begin(); it != dirs_s.end(); ++it) {
+            Py::Tuple t(*it);
+            dirs.push_back(Base::Vector3d((double)Py::Float(t.getItem(0)),
+                                          (double)Py::Float(t.getItem(1)),
+                                          (double)Py::Float(t.getItem(2))));
+        }
+
+        std::vector<unsigned long> facets;
+        std::vector<Base::Vector3d> res;
+        getMeshObjectPtr()->nearestFacetsOnRays(pnts, dirs, facets, res);
+
+        Py::List list;
+        for (std::size_t i = 0; i < facets.size(); i++) {
+            Py::Dict dict;
+            if (facets[i] != ULONG_MAX) {
+                Py::Tuple tuple(3);
+                tuple.setItem(0, Py::Float(res[i].x));
+                tuple.setItem(1, Py::Float(res[i].y));
+                tuple.setItem(2, Py::Float(res[i].z));
+                dict.setItem(Py::Int((int)facets[i]), tuple);
+            }
+            list.append(dict);
+        }
+
+        return Py::new_reference_to(list);
+    }
+    catch (const Py::Exception&) {
+        return 0;
+    }
+}
+
 PyObject*  MeshPy::getPlanarSegments(PyObject *args)
 {
     float dev;
@@ -1458,9 +1622,11 @@ PyObject*  MeshPy::getSegmentsByCurvature(PyObject *args)
     if (!PyArg_ParseTuple(args, "O",&l))
         return NULL;
 
-    const MeshCore::MeshKernel& kernel = getMeshObjectPtr()->getKernel();
+    const MeshObject* mesh = getMeshObjectPtr();
+    const MeshCore::MeshKernel& kernel = mesh->getKernel();
     MeshCore::MeshSegmentAlgorithm finder(kernel);
     MeshCore::MeshCurvature meshCurv(kernel);
+    meshCurv.SetAdjacency(&mesh->getAdjacency());
     meshCurv.ComputePerVertex();
 
     Py::Sequence func(l);
@@ -1,7 +1,7 @@
 #   (c) Juergen Riegel (juergen.riegel@web.de) 2007      LGPL
 
-import FreeCAD, os, sys, unittest, Mesh
-import thread, time, tempfile
+import FreeCAD, os, sys, unittest, Mesh, math
+import thread, time, tempfile, random
 
 
 #---------------------------------------------------------------------------
@@ -71,6 +71,40 @@ class MeshGeoTestCases(unittest.TestCase):
 		res=f1.intersect(f2)
 		self.failUnless(len(res) == 0)
 
+	def testCrossSectionFineMesh(self):
+		# enough facets to fill the grid in several blocks
+		mesh = Mesh.createSphere(10.0, 200)
+		self.failUnless(mesh.CountFacets > 65536)
+		sections = mesh.crossSections([((0.0,0.0,0.5),(0.0,0.0,1.0))])
+		self.failUnless(len(sections) == 1)
+		self.failUnless(len(sections[0]) > 0)
+		radius = math.sqrt(100.0 - 0.25)
+		for polyline in sections[0]:
+			for p in polyline:
+				self.failUnless(abs(p.z - 0.5) < 0.001)
+				self.failUnless(abs(math.sqrt(p.x*p.x + p.y*p.y) - radius) < 0.01)
+
+	def testNearestFacetsOnRays(self):
+		mesh = Mesh.createSphere(10.0, 50)
+		pnts = []
+		dirs = []
+		for i in range(20):
+			a = 2.0 * math.pi * (i + 0.37) / 20
+			pnts.append((20.0*math.cos(a), 20.0*math.sin(a), 1.0))
+			dirs.append((-math.cos(a), -math.sin(a), 0.0))
+		# a ray pointing away from the sphere
+		pnts.append((20.0, 0.0, 0.0))
+		dirs.append((1.0, 0.0, 0.0))
+		res = mesh.nearestFacetsOnRays(pnts, dirs)
+		self.failUnless(len(res) == len(pnts))
+		for i in range(20):
+			self.failUnless(len(res[i]) == 1)
+			single = mesh.nearestFacetOnRay(pnts[i], dirs[i])
+			self.failUnless(res[i].keys() == single.keys())
+			p = res[i].values()[0]
+			self.failUnless(abs(math.sqrt(p[0]*p[0] + p[1]*p[1] + p[2]*p[2]) - 10.0) < 0.1)
+		self.failUnless(len(res[20]) == 0)
+
 class PivyTestCases(unittest.TestCase):
 	def setUp(self):
 		# set up a planar face with 2 triangles
@@ -163,3 +197,341 @@ class LoadMeshInThreadsCases(unittest.TestCase):
 
     def tearDown(self):
         pass
+
+class LoadMeshDeferredCases(unittest.TestCase):
+
+    def setUp(self):
+        self.grp = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Document")
+        self.lazy = self.grp.GetBool("LazyLoading", False)
+        self.fileName = tempfile.gettempdir() + os.sep + "MeshDeferred.FCStd"
+        doc = FreeCAD.newDocument("MeshDeferred")
+        obj = doc.addObject("Mesh::Feature","Sphere")
+        obj.Mesh = Mesh.createSphere(10.0,50)
+        self.count = obj.Mesh.CountFacets
+        doc.saveAs(self.fileName)
+        FreeCAD.closeDocument(doc.Name)
+
+    def testDeferredMesh(self):
+        self.grp.SetBool("LazyLoading", True)
+        # save without accessing the mesh, the data must not get lost
+        doc = FreeCAD.openDocument(self.fileName)
+        doc.save()
+        FreeCAD.closeDocument(doc.Name)
+        doc = FreeCAD.openDocument(self.fileName)
+        self.failUnless(doc.Sphere.Mesh.CountFacets == self.count)
+        FreeCAD.closeDocument(doc.Name)
+
+    def tearDown(self):
+        self.grp.SetBool("LazyLoading", self.lazy)
+        os.remove(self.fileName)
+
+class LoadAsciiCases(unittest.TestCase):
+
+    def setUp(self):
+        self.mesh = Mesh.createSphere(10.0,50)
+
+    def testOBJ(self):
+        name = tempfile.gettempdir() + os.sep + "MeshAscii.obj"
+        self.mesh.write(name)
+        mesh = Mesh.Mesh()
+        mesh.read(name)
+        os.remove(name)
+        self.failUnless(mesh.CountPoints == self.mesh.CountPoints)
+        self.failUnless(mesh.CountFacets == self.mesh.CountFacets)
+
+    def testOFF(self):
+        name = tempfile.gettempdir() + os.sep + "MeshAscii.off"
+        self.mesh.write(name)
+        mesh = Mesh.Mesh()
+        mesh.read(name)
+        os.remove(name)
+        self.failUnless(mesh.CountPoints == self.mesh.CountPoints)
+        self.failUnless(mesh.CountFacets == self.mesh.CountFacets)
+
+    def testOBJPolygons(self):
+        name = tempfile.gettempdir() + os.sep + "MeshPolygons.obj"
+        f = open(name, "wb")
+        f.write("# a quad and a pentagon\r\n")
+        f.write("v 0 0 0\r\nv 1.0 0 0\r\nv 1 1e0 0\r\nV 0 1 0\r\n")
+        f.write("vn 0 0 1\r\n")
+        f.write("f 1/1/1 2/2/1 3/3/1 4/4/1\r\n")
+        f.write("v 0 0 1\r\nv 1 0 1\r\nv 1 1 1\r\nv 0 1 1\r\nv -.5 0.5 +1\r\n")
+        f.write("f 5//1 6//1 7//1 8//1 9//1")
+        f.close()
+        mesh = Mesh.Mesh()
+        mesh.read(name)
+        os.remove(name)
+        self.failUnless(mesh.CountPoints == 9)
+        self.failUnless(mesh.CountFacets == 5)
+
+    def readWithParser(self, name, mode):
+        grp = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Mod/Mesh")
+        old = grp.GetInt("AsciiParserMode", 2)
+        grp.SetInt("AsciiParserMode", mode)
+        try:
+            mesh = Mesh.Mesh()
+            mesh.read(name)
+        finally:
+            grp.SetInt("AsciiParserMode", old)
+        return mesh.Topology
+
+    def checkParsers(self, name):
+        # the sphere is large enough to be split among the threads of the parallel parser
+        Mesh.createSphere(10.0,200).write(name)
+        try:
+            points, facets = self.readWithParser(name, 0)
+            for mode in [1, 2]:
+                other = self.readWithParser(name, mode)
+                self.failUnless(other[1] == facets)
+                self.failUnless(len(other[0]) == len(points))
+                for p, q in zip(points, other[0]):
+                    self.failUnless((p - q).Length < 1e-5)
+        finally:
+            os.remove(name)
+
+    def testOBJParsers(self):
+        self.checkParsers(tempfile.gettempdir() + os.sep + "MeshParsers.obj")
+
+    def testOFFParsers(self):
+        self.checkParsers(tempfile.gettempdir() + os.sep + "MeshParsers.off")
+
+
+class AddFacetCases(unittest.TestCase):
+
+    def testFacetByFacet(self):
+        sphere = Mesh.createSphere(10.0,50)
+        mesh = Mesh.Mesh()
+        for f in sphere.Facets:
+            p = f.Points
+            mesh.addFacet(*(p[0] + p[1] + p[2]))
+        self.failUnless(mesh.CountPoints == sphere.CountPoints)
+        self.failUnless(mesh.CountFacets == sphere.CountFacets)
+        self.failUnless(mesh.isSolid())
+        self.failUnless(not mesh.hasNonManifolds())
+
+class MergePointsCases(unittest.TestCase):
+
+    def testOrderOfCoordinates(self):
+        # q lies between p and r in x, but r is still within the tolerance of p
+        p = FreeCAD.Vector(0,0,0)
+        q = FreeCAD.Vector(1e-7,5,0)
+        r = FreeCAD.Vector(2e-7,0,0)
+        mesh = Mesh.Mesh([[p, q, FreeCAD.Vector(0,0,5)],
+                          [r, FreeCAD.Vector(5,0,0), FreeCAD.Vector(0,0,-5)]])
+        self.failUnless(mesh.CountFacets == 2)
+        self.failUnless(mesh.CountPoints == 5)
+        facets = mesh.Topology[1]
+        self.failUnless(len(set(facets[0]) & set(facets[1])) == 1)
+
+class LoadBinaryCases(unittest.TestCase):
+
+    def setUp(self):
+        self.mesh = Mesh.createSphere(10.0,50)
+
+    def testSTL(self):
+        name = tempfile.gettempdir() + os.sep + "MeshBinary.stl"
+        self.mesh.write(name)
+        mesh = Mesh.Mesh()
+        mesh.read(name)
+        os.remove(name)
+        self.failUnless(mesh.CountPoints == self.mesh.CountPoints)
+        self.failUnless(mesh.CountFacets == self.mesh.CountFacets)
+        self.failUnless(mesh.isSolid())
+
+    def testBMS(self):
+        name = tempfile.gettempdir() + os.sep + "MeshBinary.bms"
+        self.mesh.write(name)
+        mesh = Mesh.Mesh()
+        mesh.read(name)
+        os.remove(name)
+        self.failUnless(mesh.CountPoints == self.mesh.CountPoints)
+        self.failUnless(mesh.CountFacets == self.mesh.CountFacets)
+        self.failUnless(mesh.Points[7].Vector == self.mesh.Points[7].Vector)
+        self.failUnless(mesh.isSolid())
+
+class OutOfCoreCases(unittest.TestCase):
+
+    def testSmoothTiles(self):
+        mesh = Mesh.createSphere(10.0,100)
+        name = tempfile.gettempdir() + os.sep + "MeshTiles.stl"
+        mesh.write(name)
+        info = Mesh.processOutOfCore(name, name + ".out", 1, "Laplace", 3)
+        os.remove(name)
+        name = name + ".out"
+        self.failUnless(info["Tiles"] > 1)
+        self.failUnless(info["Facets"] == mesh.CountFacets)
+        result = Mesh.Mesh()
+        result.read(name)
+        os.remove(name)
+        self.failUnless(result.CountFacets == mesh.CountFacets)
+        self.failUnless(result.CountPoints == mesh.CountPoints)
+        self.failUnless(result.isSolid())
+
+class DecimationCases(unittest.TestCase):
+
+    def testSphere(self):
+        mesh = Mesh.createSphere(10.0,100)
+        count = mesh.CountFacets
+        removed = mesh.decimate(count / 10)
+        self.failUnless(removed == count - mesh.CountFacets)
+        self.failUnless(mesh.CountFacets <= count / 10)
+        self.failUnless(mesh.isSolid())
+        self.failUnless(not mesh.hasNonManifolds())
+        for p in mesh.Points:
+            self.failUnless(abs(p.Vector.Length - 10.0) < 0.1)
+
+    def testBox(self):
+        # the fine box gets its eight corners back
+        mesh = Mesh.createBox(1.0, 1.0, 1.0, 0.05)
+        self.failUnless(mesh.CountFacets > 12)
+        mesh.decimate(maxError=0.001)
+        self.failUnless(mesh.isSolid())
+        self.failUnless(mesh.CountPoints == 8)
+
+    def testParallel(self):
+        # the sphere is large enough to be split into slabs, the result must be as good
+        # as the one of the serial path
+        serial = Mesh.createSphere(10.0,250)
+        count = serial.CountFacets
+        self.failUnless(count > 100000)
+        parallel = serial.copy()
+        serial.decimate(count / 10, parallel=False)
+        parallel.decimate(count / 10, parallel=True)
+        for mesh in [serial, parallel]:
+            self.failUnless(mesh.CountFacets <= count / 10)
+            self.failUnless(mesh.CountFacets > count / 20)
+            self.failUnless(mesh.isSolid())
+            self.failUnless(not mesh.hasNonManifolds())
+            self.failUnless(not mesh.hasSelfIntersections())
+        def deviation(mesh):
+            return max([abs(p.Vector.Length - 10.0) for p in mesh.Points])
+        self.failUnless(deviation(serial) < 0.1)
+        self.failUnless(deviation(parallel) < 0.1)
+        self.failUnless(abs(serial.Area - parallel.Area) < 0.01 * serial.Area)
+
+class AdjacencyCases(unittest.TestCase):
+
+    def testSmoothAndFill(self):
+        # smoothing keeps the adjacency while removing facets must rebuild it
+        mesh = Mesh.createSphere(10.0,50)
+        count = mesh.CountFacets
+        mesh.smooth()
+        mesh.removeFacets([0, 100])
+        self.failUnless(not mesh.isSolid())
+        mesh.smooth()
+        mesh.fillupHoles(10)
+        self.failUnless(mesh.isSolid())
+        self.failUnless(mesh.CountFacets == count)
+        self.failUnless(not mesh.hasNonManifolds())
+
+class AcceleratedFilterCases(unittest.TestCase):
+
+    def setUp(self):
+        # a soup of small random triangles intersects itself in many places
+        rand = random.Random(4711)
+        triangles = []
+        for i in range(2000):
+            base = [rand.uniform(0.0, 10.0) for j in range(3)]
+            for k in range(3):
+                triangles.append([c + rand.uniform(-0.5, 0.5) for c in base])
+        self.mesh = Mesh.Mesh(triangles)
+        self.points = []
+        self.dirs = []
+        for i in range(200):
+            self.points.append(tuple([rand.uniform(-1.0, 11.0) for j in range(3)]))
+            self.dirs.append(tuple([rand.uniform(-1.0, 1.0) for j in range(3)]))
+        self.accelerated = Mesh.isAccelerated()
+
+    def query(self):
+        result = {}
+        result["SelfIntersections"] = self.mesh.getSelfIntersections()
+        # the grid searches the facets along the ray and around the point in batches
+        result["Rays"] = [self.mesh.nearestFacetOnRay(p, d, True) for p, d in zip(self.points, self.dirs)]
+        result["Points"] = [self.mesh.nearestFacetToPoint(p) for p in self.points]
+        try:
+            import Inspection
+        except ImportError:
+            pass
+        else:
+            vectors = [FreeCAD.Vector(p[0], p[1], p[2]) for p in self.points]
+            result["Distances"] = Inspection.fastMeshDistances(self.mesh, vectors, 1.0)
+        return result
+
+    def testSameResults(self):
+        Mesh.setAccelerated(True)
+        accelerated = self.query()
+        Mesh.setAccelerated(False)
+        self.failUnless(not Mesh.isAccelerated())
+        plain = self.query()
+        self.failUnless(len(plain["SelfIntersections"]) > 0)
+        self.failUnless(len([r for r in plain["Rays"] if r]) > 0)
+        for key in plain.keys():
+            self.failUnless(accelerated[key] == plain[key], key)
+
+    def tearDown(self):
+        Mesh.setAccelerated(self.accelerated)
+
+class EvaluateAllCases(unittest.TestCase):
+
+    def serialIntersections(self, mesh):
+        # every pair of facets that don't share a point and whose bounding boxes overlap
+        facets = mesh.Facets
+        corners = [set(f.PointIndices) for f in facets]
+        boxes = []
+        for f in facets:
+            p = f.Points
+            boxes.append(([min([q[k] for q in p]) for k in range(3)], [max([q[k] for q in p]) for k in range(3)]))
+        pairs = []
+        for i in range(len(facets)):
+            for j in range(i + 1, len(facets)):
+                if corners[i] & corners[j]:
+                    continue
+                b1 = boxes[i]
+                b2 = boxes[j]
+                if [k for k in range(3) if b1[0][k] > b2[1][k] or b2[0][k] > b1[1][k]]:
+                    continue
+                if len(facets[i].intersect(facets[j])) == 2:
+                    pairs.append((i, j))
+        return pairs
+
+    def testSelfIntersections(self):
+        # two overlapping spheres intersect each other along a circle
+        mesh = Mesh.createSphere(1.0,10)
+        other = mesh.copy()
+        other.translate(0.5,0.0,0.0)
+        report = mesh.evaluateAll()
+        self.failUnless(report["Complete"])
+        self.failUnless(report["SelfIntersections"])
+        mesh.addMesh(other)
+
+        pairs = self.serialIntersections(mesh)
+        self.failUnless(len(pairs) > 0)
+        self.failUnless(mesh.getSelfIntersections() == pairs)
+        report = mesh.evaluateAll()
+        self.failUnless(report["Errors"] == {})
+        self.failUnless(report["Complete"])
+        self.failUnless(not report["SelfIntersections"])
+
+    def testDuplicates(self):
+        # the mesh is large enough to sort the points and facets in several threads
+        mesh = Mesh.createSphere(10.0,300)
+        self.failUnless(mesh.CountPoints > 0x10000)
+        report = mesh.evaluateAll()
+        self.failUnless(report["DuplicatedPoints"])
+        self.failUnless(report["DuplicatedFacets"])
+
+        # a facet added twice and a point moved onto another one
+        p = mesh.Facets[0].Points
+        mesh.addFacet(p[0][0],p[0][1],p[0][2],p[1][0],p[1][1],p[1][2],p[2][0],p[2][1],p[2][2])
+        mesh.setPoint(mesh.CountPoints / 2, mesh.Points[mesh.CountPoints / 3].Vector)
+
+        points, facets = mesh.Topology
+        coords = set([(v.x, v.y, v.z) for v in points])
+        corners = set([tuple(sorted(f)) for f in facets])
+        self.failUnless(len(coords) < len(points))
+        self.failUnless(len(corners) < len(facets))
+        report = mesh.evaluateAll()
+        self.failUnless(report["Errors"] == {})
+        self.failUnless(report["Complete"])
+        self.failUnless(not report["DuplicatedPoints"])
+        self.failUnless(not report["DuplicatedFacets"])
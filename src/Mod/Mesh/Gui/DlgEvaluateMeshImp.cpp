@@ -274,6 +274,80 @@ void DlgEvaluateMeshImp::removeViewProviders()
     d->vp.clear();
 }
 
+void DlgEvaluateMeshImp::showNoFlippedNormals()
+{
+    checkOrientationButton->setText(tr("No flipped normals"));
+    checkOrientationButton->setChecked(false);
+    repairOrientationButton->setEnabled(false);
+    removeViewProvider("MeshGui::ViewProviderMeshOrientation");
+}
+
+void DlgEvaluateMeshImp::showNoDuplicatedFaces()
+{
+    checkDuplicatedFacesButton->setText(tr("No duplicated faces"));
+    checkDuplicatedFacesButton->setChecked(false);
+    repairDuplicatedFacesButton->setEnabled(false);
+    removeViewProvider("MeshGui::ViewProviderMeshDuplicatedFaces");
+}
+
+void DlgEvaluateMeshImp::showNoDuplicatedPoints()
+{
+    checkDuplicatedPointsButton->setText(tr("No duplicated points"));
+    checkDuplicatedPointsButton->setChecked(false);
+    repairDuplicatedPointsButton->setEnabled(false);
+    removeViewProvider("MeshGui::ViewProviderMeshDuplicatedPoints");
+}
+
+void DlgEvaluateMeshImp::showNoNonManifolds()
+{
+    checkNonmanifoldsButton->setText(tr("No non-manifolds"));
+    checkNonmanifoldsButton->setChecked(false);
+    repairNonmanifoldsButton->setEnabled(false);
+    removeViewProvider("MeshGui::ViewProviderMeshNonManifolds");
+}
+
+void DlgEvaluateMeshImp::showNoDegenerations()
+{
+    checkDegenerationButton->setText(tr("No degenerations"));
+    checkDegenerationButton->setChecked(false);
+    repairDegeneratedButton->setEnabled(false);
+    removeViewProvider("MeshGui::ViewProviderMeshDegenerations");
+}
+
+void DlgEvaluateMeshImp::showNoInvalidIndices()
+{
+    checkIndicesButton->setText(tr("No invalid indices"));
+    checkIndicesButton->setChecked(false);
+    repairIndicesButton->setEnabled(false);
+    removeViewProvider("MeshGui::ViewProviderMeshIndices");
+}
+
+void DlgEvaluateMeshImp::showNoSelfIntersections()
+{
+    checkSelfIntersectionButton->setText(tr("No self-intersections"));
+    checkSelfIntersectionButton->setChecked(false);
+    repairSelfIntersectionButton->setEnabled(false);
+    removeViewProvider("MeshGui::ViewProviderMeshSelfIntersections");
+}
+
+void DlgEvaluateMeshImp::showNoFolds()
+{
+    checkFoldsButton->setText(tr("No folds on surface"));
+    checkFoldsButton->setChecked(false);
+    repairFoldsButton->setEnabled(false);
+    removeViewProvider("MeshGui::ViewProviderMeshFolds");
+}
+
+void DlgEvaluateMeshImp::showFailedCheck(QCheckBox* check, QPushButton* repair, const char* vp,
+                                         const std::string& error)
+{
+    check->setText(tr("Check failed"));
+    check->setChecked(false);
+    repair->setEnabled(false);
+    removeViewProvider(vp);
+    Base::Console().Error("Mesh check failed: %s\n", error.c_str());
+}
+
 void DlgEvaluateMeshImp::on_meshNameButton_activated(int i)
 {
     QString item = meshNameButton->itemData(i).toString();
@@ -416,10 +490,7 @@ void DlgEvaluateMeshImp::on_analyzeOrientationButton_clicked()
             }
         }
         else if (inds.empty()) {
-            checkOrientationButton->setText( tr("No flipped normals") );
-            checkOrientationButton->setChecked(false);
-            repairOrientationButton->setEnabled(false);
-            removeViewProvider( "MeshGui::ViewProviderMeshOrientation" );
+            showNoFlippedNormals();
         }
         else {
             checkOrientationButton->setText( tr("%1 flipped normals").arg(inds.size()) );
@@ -484,10 +555,7 @@ void DlgEvaluateMeshImp::on_analyzeNonmanifoldsButton_clicked()
         bool ok2 = p_eval.Evaluate();
     
         if (ok1 && ok2) {
-            checkNonmanifoldsButton->setText(tr("No non-manifolds"));
-            checkNonmanifoldsButton->setChecked(false);
-            repairNonmanifoldsButton->setEnabled(false);
-            removeViewProvider("MeshGui::ViewProviderMeshNonManifolds");
+            showNoNonManifolds();
         }
         else {
             checkNonmanifoldsButton->setText(tr("%1 non-manifolds").arg(f_eval.CountManifolds()+p_eval.CountManifolds()));
@@ -597,10 +665,7 @@ void DlgEvaluateMeshImp::on_analyzeIndicesButton_clicked()
             addViewProvider("MeshGui::ViewProviderMeshIndices", nb.GetIndices());
         }
         else {
-            checkIndicesButton->setText(tr("No invalid indices"));
-            checkIndicesButton->setChecked(false);
-            repairIndicesButton->setEnabled(false);
-            removeViewProvider("MeshGui::ViewProviderMeshIndices");
+            showNoInvalidIndices();
         }
 
         qApp->restoreOverrideCursor();
@@ -656,10 +721,7 @@ void DlgEvaluateMeshImp::on_analyzeDegeneratedButton_clicked()
         std::vector<unsigned long> degen = eval.GetIndices();
         
         if (degen.empty()) {
-            checkDegenerationButton->setText(tr("No degenerations"));
-            checkDegenerationButton->setChecked(false);
-            repairDegeneratedButton->setEnabled(false);
-            removeViewProvider("MeshGui::ViewProviderMeshDegenerations");
+            showNoDegenerations();
         }
         else {
             checkDegenerationButton->setText(tr("%1 degenerated faces").arg(degen.size()));
@@ -722,10 +784,7 @@ void DlgEvaluateMeshImp::on_analyzeDuplicatedFacesButton_clicked()
         std::vector<unsigned long> dupl = eval.GetIndices();
     
         if (dupl.empty()) {
-            checkDuplicatedFacesButton->setText(tr("No duplicated faces"));
-            checkDuplicatedFacesButton->setChecked(false);
-            repairDuplicatedFacesButton->setEnabled(false);
-            removeViewProvider("MeshGui::ViewProviderMeshDuplicatedFaces");
+            showNoDuplicatedFaces();
         }
         else {
             checkDuplicatedFacesButton->setText(tr("%1 duplicated faces").arg(dupl.size()));
@@ -788,10 +847,7 @@ void DlgEvaluateMeshImp::on_analyzeDuplicatedPointsButton_clicked()
         MeshEvalDuplicatePoints eval(rMesh);
     
         if (eval.Evaluate()) {
-            checkDuplicatedPointsButton->setText(tr("No duplicated points"));
-            checkDuplicatedPointsButton->setChecked(false);
-            repairDuplicatedPointsButton->setEnabled(false);
-            removeViewProvider("MeshGui::ViewProviderMeshDuplicatedPoints");
+            showNoDuplicatedPoints();
         }
         else {
             checkDuplicatedPointsButton->setText(tr("Duplicated points"));
@@ -860,10 +916,7 @@ void DlgEvaluateMeshImp::on_analyzeSelfIntersectionButton_clicked()
         }
 
         if (intersection.empty()) {
-            checkSelfIntersectionButton->setText(tr("No self-intersections"));
-            checkSelfIntersectionButton->setChecked(false);
-            repairSelfIntersectionButton->setEnabled(false);
-            removeViewProvider("MeshGui::ViewProviderMeshSelfIntersections");
+            showNoSelfIntersections();
         }
         else {
             checkSelfIntersectionButton->setText(tr("Self-intersections"));
@@ -947,10 +1000,7 @@ void DlgEvaluateMeshImp::on_analyzeFoldsButton_clicked()
         bool ok3 = f_eval.Evaluate();
     
         if (ok1 && ok2 && ok3) {
-            checkFoldsButton->setText(tr("No folds on surface"));
-            checkFoldsButton->setChecked(false);
-            repairFoldsButton->setEnabled(false);
-            removeViewProvider("MeshGui::ViewProviderMeshFolds");
+            showNoFolds();
         }
         else {
             std::vector<unsigned long> inds  = f_eval.GetIndices();
@@ -1004,14 +1054,94 @@ void DlgEvaluateMeshImp::on_repairFoldsButton_clicked()
 
 void DlgEvaluateMeshImp::on_analyzeAllTogether_clicked()
 {
-    on_analyzeOrientationButton_clicked();
-    on_analyzeDuplicatedFacesButton_clicked();
-    on_analyzeDuplicatedPointsButton_clicked();
-    on_analyzeNonmanifoldsButton_clicked();
-    on_analyzeDegeneratedButton_clicked();
-    on_analyzeIndicesButton_clicked();
-    on_analyzeSelfIntersectionButton_clicked();
-    on_analyzeFoldsButton_clicked();
+    if (!d->meshFeature)
+        return;
+
+    // run all checks at once in several threads and only look closer at the failed ones
+    MeshEvalAll::Report report;
+    {
+        Gui::WaitCursor wc;
+        const MeshKernel& rMesh = d->meshFeature->Mesh.getValue().getKernel();
+        MeshEvalAll eval(rMesh);
+        eval.Evaluate();
+        report = eval.GetReport();
+    }
+
+    if (!report.complete) {
+        on_analyzeOrientationButton_clicked();
+        on_analyzeDuplicatedFacesButton_clicked();
+        on_analyzeDuplicatedPointsButton_clicked();
+        on_analyzeNonmanifoldsButton_clicked();
+        on_analyzeDegeneratedButton_clicked();
+        if (report.hasError(MeshEvalAll::Indices))
+            showFailedCheck(checkIndicesButton, repairIndicesButton,
+                "MeshGui::ViewProviderMeshIndices", report.errors[MeshEvalAll::Indices]);
+        else
+            on_analyzeIndicesButton_clicked();
+        on_analyzeSelfIntersectionButton_clicked();
+        on_analyzeFoldsButton_clicked();
+        return;
+    }
+
+    // a check that stopped with an exception is not repeated, it would most likely fail again
+    if (report.hasError(MeshEvalAll::Orientation))
+        showFailedCheck(checkOrientationButton, repairOrientationButton,
+            "MeshGui::ViewProviderMeshOrientation", report.errors[MeshEvalAll::Orientation]);
+    else if (report.orientation)
+        showNoFlippedNormals();
+    else
+        on_analyzeOrientationButton_clicked();
+
+    if (report.hasError(MeshEvalAll::DuplicatedFacets))
+        showFailedCheck(checkDuplicatedFacesButton, repairDuplicatedFacesButton,
+            "MeshGui::ViewProviderMeshDuplicatedFaces", report.errors[MeshEvalAll::DuplicatedFacets]);
+    else if (report.duplicatedFacets)
+        showNoDuplicatedFaces();
+    else
+        on_analyzeDuplicatedFacesButton_clicked();
+
+    if (report.hasError(MeshEvalAll::DuplicatedPoints))
+        showFailedCheck(checkDuplicatedPointsButton, repairDuplicatedPointsButton,
+            "MeshGui::ViewProviderMeshDuplicatedPoints", report.errors[MeshEvalAll::DuplicatedPoints]);
+    else if (report.duplicatedPoints)
+        showNoDuplicatedPoints();
+    else
+        on_analyzeDuplicatedPointsButton_clicked();
+
+    if (report.hasError(MeshEvalAll::NonManifolds))
+        showFailedCheck(checkNonmanifoldsButton, repairNonmanifoldsButton,
+            "MeshGui::ViewProviderMeshNonManifolds", report.errors[MeshEvalAll::NonManifolds]);
+    else if (report.nonManifolds)
+        showNoNonManifolds();
+    else
+        on_analyzeNonmanifoldsButton_clicked();
+
+    if (report.hasError(MeshEvalAll::Degenerations))
+        showFailedCheck(checkDegenerationButton, repairDegeneratedButton,
+            "MeshGui::ViewProviderMeshDegenerations", report.errors[MeshEvalAll::Degenerations]);
+    else if (report.degenerations)
+        showNoDegenerations();
+    else
+        on_analyzeDegeneratedButton_clicked();
+
+    // a complete report implies valid indices
+    showNoInvalidIndices();
+
+    if (report.hasError(MeshEvalAll::SelfIntersections))
+        showFailedCheck(checkSelfIntersectionButton, repairSelfIntersectionButton,
+            "MeshGui::ViewProviderMeshSelfIntersections", report.errors[MeshEvalAll::SelfIntersections]);
+    else if (report.selfIntersections)
+        showNoSelfIntersections();
+    else
+        on_analyzeSelfIntersectionButton_clicked();
+
+    if (report.hasError(MeshEvalAll::Folds))
+        showFailedCheck(checkFoldsButton, repairFoldsButton,
+            "MeshGui::ViewProviderMeshFolds", report.errors[MeshEvalAll::Folds]);
+    else if (report.folds)
+        showNoFolds();
+    else
+        on_analyzeFoldsButton_clicked();
 }
 
 void DlgEvaluateMeshImp::on_repairAllTogether_clicked()
@@ -129,6 +129,19 @@ protected:
     void addViewProvider(const char* vp, const std::vector<unsigned long>& indices);
     void removeViewProvider(const char* vp);
     void removeViewProviders();
+    /** @name Results of checks without defects */
+    //@{
+    void showNoFlippedNormals();
+    void showNoDuplicatedFaces();
+    void showNoDuplicatedPoints();
+    void showNoNonManifolds();
+    void showNoDegenerations();
+    void showNoInvalidIndices();
+    void showNoSelfIntersections();
+    void showNoFolds();
+    //@}
+    /// Shows a check that stopped with an exception as failed
+    void showFailedCheck(QCheckBox* check, QPushButton* repair, const char* vp, const std::string& error);
     void changeEvent(QEvent *e);
 
 private:
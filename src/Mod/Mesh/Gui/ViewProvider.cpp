@@ -76,6 +76,7 @@
 #include <Gui/View3DInventor.h>
 #include <Gui/View3DInventorViewer.h>
 
+#include <Mod/Mesh/App/Core/Adjacency.h>
 #include <Mod/Mesh/App/Core/Algorithm.h>
 #include <Mod/Mesh/App/Core/Evaluation.h>
 #include <Mod/Mesh/App/Core/Grid.h>
@@ -1403,7 +1404,7 @@ void ViewProviderMesh::fillHole(unsigned long uFacet)
     std::list<unsigned long> aBorder;
     Mesh::Feature* fea = reinterpret_cast<Mesh::Feature*>(this->getObject());
     const MeshCore::MeshKernel& rKernel = fea->Mesh.getValue().getKernel();
-    MeshCore::MeshRefPointToFacets cPt2Fac(rKernel);
+    const MeshCore::MeshAdjacency& cPt2Fac = fea->Mesh.getValue().getAdjacency();
     MeshCore::MeshAlgorithm meshAlg(rKernel);
     meshAlg.GetMeshBorder(uFacet, aBorder);
     std::vector<unsigned long> boundary(aBorder.begin(), aBorder.end());
@@ -50,6 +50,7 @@
 #include "PrimitiveFeature.h"
 #include "Part2DObject.h"
 #include "CustomFeature.h"
+#include "TessellationCache.h"
 #include "TopoShapePy.h"
 #include "TopoShapeVertexPy.h"
 #include "TopoShapeFacePy.h"
@@ -236,6 +237,9 @@ void PartExport initPart()
     Part::GeomSurfaceOfRevolution ::init();
     Part::GeomSurfaceOfExtrusion  ::init();
 
+    // create the cache before any worker thread can access it
+    Part::TessellationCache::instance();
+
 
     IGESControl_Controller::Init();
     STEPControl_Controller::Init();
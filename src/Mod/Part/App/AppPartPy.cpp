@@ -119,6 +119,7 @@
 #include "ImportIges.h"
 #include "ImportStep.h"
 #include "edgecluster.h"
+#include "TessellationCache.h"
 
 #ifdef FCUseFreeType
 #  include "FT2FC.h"
@@ -1650,6 +1651,14 @@ static PyObject * cast_to_shape(PyObject *self, PyObject *args)
     return 0;
 }
 
+static PyObject * clearTessellationCache(PyObject *self, PyObject *args)
+{
+    if (!PyArg_ParseTuple(args, ""))
+        return 0;
+    TessellationCache::instance().clear();
+    Py_Return;
+}
+
 /* registration table  */
 struct PyMethodDef Part_methods[] = {
     {"open"       ,open      ,METH_VARARGS,
@@ -1766,6 +1775,9 @@ struct PyMethodDef Part_methods[] = {
     {"cast_to_shape" ,cast_to_shape,METH_VARARGS,
      "cast_to_shape(shape) -- Cast to the actual shape type"},
 
+    {"clearTessellationCache" ,clearTessellationCache,METH_VARARGS,
+     "clearTessellationCache() -- Remove all triangulations of faces that are kept for re-use"},
+
     {"getSortedClusters" ,getSortedClusters,METH_VARARGS,
     "getSortedClusters(list of edges) -- Helper method to sort and cluster a variety of edges"},
 
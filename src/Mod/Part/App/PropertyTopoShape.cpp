@@ -41,6 +41,7 @@
 # include <Standard_Failure.hxx>
 # include <gp_GTrsf.hxx>
 # include <gp_Trsf.hxx>
+# include <boost/bind.hpp>
 #endif
 
 
@@ -51,6 +52,7 @@
 #include <Base/Exception.h>
 #include <Base/FileInfo.h>
 #include <Base/Stream.h>
+#include <App/Application.h>
 #include <App/DocumentObject.h>
 
 #include "PropertyTopoShape.h"
@@ -68,7 +70,7 @@ using namespace Part;
 
 TYPESYSTEM_SOURCE(Part::PropertyPartShape , App::PropertyComplexGeoData);
 
-PropertyPartShape::PropertyPartShape()
+PropertyPartShape::PropertyPartShape() : _tessellation(this)
 {
 }
 
@@ -79,6 +81,7 @@ PropertyPartShape::~PropertyPartShape()
 void PropertyPartShape::setValue(const TopoShape& sh)
 {
     aboutToSetValue();
+    _deferred.clear();
     _Shape = sh;
     hasSetValue();
 }
@@ -86,27 +89,32 @@ void PropertyPartShape::setValue(const TopoShape& sh)
 void PropertyPartShape::setValue(const TopoDS_Shape& sh)
 {
     aboutToSetValue();
+    _deferred.clear();
     _Shape._Shape = sh;
     hasSetValue();
 }
 
 const TopoDS_Shape& PropertyPartShape::getValue(void)const 
 {
+    restoreDeferred();
     return _Shape._Shape;
 }
 
 const TopoShape& PropertyPartShape::getShape() const
 {
+    restoreDeferred();
     return this->_Shape;
 }
 
 const Data::ComplexGeoData* PropertyPartShape::getComplexData() const
 {
+    restoreDeferred();
     return &(this->_Shape);
 }
 
 Base::BoundBox3d PropertyPartShape::getBoundingBox() const
 {
+    restoreDeferred();
     Base::BoundBox3d box;
     if (_Shape._Shape.IsNull())
         return box;
@@ -135,11 +143,13 @@ void PropertyPartShape::getFaces(std::vector<Base::Vector3d> &aPoints,
                                  std::vector<Data::ComplexGeoData::Facet> &aTopo,
                                  float accuracy, uint16_t flags) const
 {
+    restoreDeferred();
     _Shape.getFaces(aPoints, aTopo, accuracy, flags);
 }
 
 void PropertyPartShape::transformGeometry(const Base::Matrix4D &rclTrf)
 {
+    restoreDeferred();
     aboutToSetValue();
     _Shape.transformGeometry(rclTrf);
     hasSetValue();
@@ -147,6 +157,7 @@ void PropertyPartShape::transformGeometry(const Base::Matrix4D &rclTrf)
 
 PyObject *PropertyPartShape::getPyObject(void)
 {
+    restoreDeferred();
     Base::PyObjectBase* prop;
     const TopoDS_Shape& sh = _Shape._Shape;
     if (sh.IsNull()) {
@@ -206,6 +217,7 @@ void PropertyPartShape::setPyObject(PyObject *value)
 
 App::Property *PropertyPartShape::Copy(void) const
 {
+    restoreDeferred();
     PropertyPartShape *prop = new PropertyPartShape();
     prop->_Shape = this->_Shape;
     if (!_Shape._Shape.IsNull()) {
@@ -219,7 +231,10 @@ App::Property *PropertyPartShape::Copy(void) const
 void PropertyPartShape::Paste(const App::Property &from)
 {
     aboutToSetValue();
-    _Shape = dynamic_cast<const PropertyPartShape&>(from)._Shape;
+    const PropertyPartShape& prop = dynamic_cast<const PropertyPartShape&>(from);
+    prop.restoreDeferred();
+    _deferred.clear();
+    _Shape = prop._Shape;
     hasSetValue();
 }
 
@@ -233,13 +248,21 @@ void PropertyPartShape::Save (Base::Writer &writer) const
     if(!writer.isForceXML()) {
         //See SaveDocFile(), RestoreDocFile()
         writer.Stream() << writer.ind() << "<Part file=\"" 
-                        << writer.addFile("PartShape.brp", this)
-                        << "\"/>" << std::endl;
+                        << writer.addFile("PartShape.brp", this) << "\"";
+        // the triangulation is optionally stored to display the shape faster after loading
+        ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath
+            ("User parameter:BaseApp/Preferences/Mod/Part");
+        if (hGrp->GetBool("SaveTessellation", false)) {
+            writer.Stream() << " tessellation=\""
+                            << writer.addFile("PartShape.tri", &_tessellation) << "\"";
+        }
+        writer.Stream() << "/>" << std::endl;
     }
 }
 
 void PropertyPartShape::Restore(Base::XMLReader &reader)
 {
+    _deferred.clear();
     reader.readElement("Part");
     std::string file (reader.getAttribute("file") );
 
@@ -247,10 +270,16 @@ void PropertyPartShape::Restore(Base::XMLReader &reader)
         // initate a file read
         reader.addFile(file.c_str(),this);
     }
+    if (reader.hasAttribute("tessellation")) {
+        std::string tri(reader.getAttribute("tessellation"));
+        if (!tri.empty())
+            reader.addFile(tri.c_str(),&_tessellation);
+    }
 }
 
 void PropertyPartShape::SaveDocFile (Base::Writer &writer) const
 {
+    restoreDeferred();
     // If the shape is empty we simply store nothing. The file size will be 0 which
     // can be checked when reading in the data.
     if (_Shape._Shape.IsNull())
@@ -305,6 +334,27 @@ void PropertyPartShape::SaveDocFile (Base::Writer &writer) const
 }
 
 void PropertyPartShape::RestoreDocFile(Base::Reader &reader)
+{
+    aboutToSetValue();
+    loadFromStream(reader);
+    hasSetValue();
+}
+
+void PropertyPartShape::setDeferredDocFile(const Base::DeferredFile &file)
+{
+    _deferred = file;
+}
+
+void PropertyPartShape::restoreDeferred() const
+{
+    // only reading in the shape is not a modification, hence no notification
+    if (_deferred.isPending()) {
+        PropertyPartShape* self = const_cast<PropertyPartShape*>(this);
+        _deferred.restore(boost::bind(&PropertyPartShape::loadFromStream, self, _1));
+    }
+}
+
+void PropertyPartShape::loadFromStream(Base::Reader &reader)
 {
     BRep_Builder builder;
 
@@ -346,7 +396,7 @@ void PropertyPartShape::RestoreDocFile(Base::Reader &reader)
     // delete the temp file
     fi.deleteFile();
 
-    setValue(shape);
+    _Shape._Shape = shape;
 }
 
 // -------------------------------------------------------------------------
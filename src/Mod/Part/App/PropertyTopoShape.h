@@ -25,6 +25,7 @@
 #define PART_PROPERTYTOPOSHAPE_H
 
 #include "TopoShape.h"
+#include "TessellationCache.h"
 #include <TopAbs_ShapeEnum.hxx>
 #include <App/DocumentObject.h>
 #include <App/PropertyGeo.h>
@@ -88,14 +89,23 @@ public:
 
     void SaveDocFile (Base::Writer &writer) const;
     void RestoreDocFile(Base::Reader &reader);
+    bool isRestoreDocFileDeferrable (void) const { return true; }
+    void setDeferredDocFile(const Base::DeferredFile &file);
 
     App::Property *Copy(void) const;
     void Paste(const App::Property &from);
     unsigned int getMemSize (void) const;
     //@}
 
+private:
+    void loadFromStream(Base::Reader &reader);
+    /// reads the shape if its file has been deferred when restoring the document
+    void restoreDeferred() const;
+
 private:
     TopoShape _Shape;
+    mutable Base::DeferredFile _deferred;
+    TessellationFile _tessellation;
 };
 
 struct PartExport ShapeHistory {
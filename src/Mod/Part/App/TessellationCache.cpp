@@ -0,0 +1,750 @@
+/***************************************************************************
+ *   Copyright (c) 2026 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <algorithm>
+# include <set>
+# include <BRep_Builder.hxx>
+# include <BRep_Tool.hxx>
+# include <BRepMesh_IncrementalMesh.hxx>
+# include <BRepTools.hxx>
+# include <Geom_Curve.hxx>
+# include <Geom_Surface.hxx>
+# include <Geom2d_Curve.hxx>
+# include <GeomAdaptor_Surface.hxx>
+# include <gp_Pnt.hxx>
+# include <gp_Pnt2d.hxx>
+# include <gp_Trsf.hxx>
+# include <Poly_Array1OfTriangle.hxx>
+# include <Poly_PolygonOnTriangulation.hxx>
+# include <Poly_Triangulation.hxx>
+# include <Standard_Failure.hxx>
+# include <Standard_Version.hxx>
+# include <TColgp_Array1OfPnt.hxx>
+# include <TColgp_Array1OfPnt2d.hxx>
+# include <TColStd_Array1OfInteger.hxx>
+# include <TColStd_Array1OfReal.hxx>
+# include <TColStd_HArray1OfReal.hxx>
+# include <TopExp.hxx>
+# include <TopExp_Explorer.hxx>
+# include <TopLoc_Location.hxx>
+# include <TopoDS.hxx>
+# include <TopoDS_Edge.hxx>
+# include <TopoDS_Face.hxx>
+# include <TopoDS_Vertex.hxx>
+# include <TopTools_IndexedMapOfShape.hxx>
+#endif
+
+#include <Base/Reader.h>
+#include <Base/Stream.h>
+#include <Base/Writer.h>
+#include <App/Application.h>
+
+#include "TessellationCache.h"
+#include "PropertyTopoShape.h"
+
+using namespace Part;
+
+namespace {
+
+/**
+ * 64-bit FNV-1a hash. The coordinates are rounded to single precision so that a shape that has
+ * been written to and read from a BRep file gives the same value.
+ */
+class GeometryHash
+{
+public:
+    GeometryHash() : value((uint64_t(0xcbf29ce4) << 32) | uint64_t(0x84222325))
+    {
+    }
+    void add(const void* data, size_t len)
+    {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        const uint64_t prime = (uint64_t(0x00000100) << 32) | uint64_t(0x000001b3);
+        for (size_t i = 0; i < len; i++) {
+            value ^= bytes[i];
+            value *= prime;
+        }
+    }
+    void add(uint64_t v)
+    {
+        add(&v, sizeof(v));
+    }
+    void add(int v)
+    {
+        int32_t i = v;
+        add(&i, sizeof(i));
+    }
+    void add(double v)
+    {
+        float f = static_cast<float>(v);
+        if (f == 0.0f)
+            f = 0.0f; // no negative zero
+        add(&f, sizeof(f));
+    }
+    void add(const gp_Pnt& p)
+    {
+        add(p.X());
+        add(p.Y());
+        add(p.Z());
+    }
+    uint64_t result() const
+    {
+        // zero is reserved for faces that cannot be cached
+        return value ? value : 1;
+    }
+
+private:
+    uint64_t value;
+};
+
+/// Hashes an edge of a face that has no location, independent of the orientation of the edge.
+uint64_t hashEdge(const TopoDS_Edge& localEdge, const TopoDS_Face& localFace)
+{
+    TopoDS_Edge edge = TopoDS::Edge(localEdge.Oriented(TopAbs_FORWARD));
+    GeometryHash hash;
+    hash.add(BRep_Tool::Degenerated(edge) ? 1 : 0);
+
+    TopoDS_Vertex v1, v2;
+    TopExp::Vertices(edge, v1, v2);
+    if (!v1.IsNull())
+        hash.add(BRep_Tool::Pnt(v1));
+    if (!v2.IsNull())
+        hash.add(BRep_Tool::Pnt(v2));
+
+    Standard_Real first, last;
+    TopLoc_Location loc;
+    Handle(Geom_Curve) curve = BRep_Tool::Curve(edge, loc, first, last);
+    if (!curve.IsNull()) {
+        hash.add(curve->Value(0.5 * (first + last)).Transformed(loc.Transformation()));
+    }
+
+    Handle(Geom2d_Curve) pcurve = BRep_Tool::CurveOnSurface(edge, localFace, first, last);
+    if (!pcurve.IsNull()) {
+        gp_Pnt2d mid = pcurve->Value(0.5 * (first + last));
+        hash.add(first);
+        hash.add(last);
+        hash.add(mid.X());
+        hash.add(mid.Y());
+    }
+
+    return hash.result();
+}
+
+bool getPolygon(const TopoDS_Edge& edge, const Handle(Poly_Triangulation)& mesh,
+                const TopLoc_Location& loc, double& deflection,
+                std::vector<int>& nodes, std::vector<double>& parameters)
+{
+    Handle(Poly_PolygonOnTriangulation) poly = BRep_Tool::PolygonOnTriangulation(edge, mesh, loc);
+    if (poly.IsNull())
+        return false;
+
+    deflection = poly->Deflection();
+    const TColStd_Array1OfInteger& indices = poly->Nodes();
+    nodes.reserve(indices.Length());
+    for (Standard_Integer i = indices.Lower(); i <= indices.Upper(); i++)
+        nodes.push_back(indices(i));
+    if (poly->HasParameters()) {
+        const TColStd_Array1OfReal& params = poly->Parameters()->Array1();
+        parameters.reserve(params.Length());
+        for (Standard_Integer i = params.Lower(); i <= params.Upper(); i++)
+            parameters.push_back(params(i));
+    }
+
+    return true;
+}
+
+Handle(Poly_PolygonOnTriangulation) makePolygon(double deflection, const std::vector<int>& nodes,
+                                                const std::vector<double>& parameters)
+{
+    TColStd_Array1OfInteger indices(1, static_cast<Standard_Integer>(nodes.size()));
+    for (std::size_t i = 0; i < nodes.size(); i++)
+        indices(static_cast<Standard_Integer>(i + 1)) = nodes[i];
+
+    Handle(Poly_PolygonOnTriangulation) poly;
+    if (parameters.size() == nodes.size()) {
+        TColStd_Array1OfReal params(1, static_cast<Standard_Integer>(parameters.size()));
+        for (std::size_t i = 0; i < parameters.size(); i++)
+            params(static_cast<Standard_Integer>(i + 1)) = parameters[i];
+        poly = new Poly_PolygonOnTriangulation(indices, params);
+    }
+    else {
+        poly = new Poly_PolygonOnTriangulation(indices);
+    }
+    poly->Deflection(deflection);
+    return poly;
+}
+
+template <class T>
+void writeArray(Base::OutputStream& str, const std::vector<T>& data)
+{
+    str << static_cast<uint32_t>(data.size());
+    for (typename std::vector<T>::const_iterator it = data.begin(); it != data.end(); ++it)
+        str << *it;
+}
+
+template <class T>
+bool readArray(Base::InputStream& str, std::istream& in, std::vector<T>& data)
+{
+    uint32_t count = 0;
+    str >> count;
+    // don't trust the count of a damaged file, stop at its end instead
+    for (uint32_t i = 0; i < count && in; i++) {
+        T value;
+        str >> value;
+        data.push_back(value);
+    }
+    return !in.fail();
+}
+
+bool checkIndices(const std::vector<int>& indices, std::size_t numNodes)
+{
+    for (std::vector<int>::const_iterator it = indices.begin(); it != indices.end(); ++it) {
+        if (*it < 1 || static_cast<std::size_t>(*it) > numNodes)
+            return false;
+    }
+    return true;
+}
+
+}
+
+// ----------------------------------------------------------------------------
+
+TessellationCache* TessellationCache::_instance = 0;
+static QMutex instanceMutex;
+
+TessellationCache& TessellationCache::instance()
+{
+    // the cache may be used first by one of the threads that tessellate shapes
+    QMutexLocker locker(&instanceMutex);
+    if (!_instance)
+        _instance = new TessellationCache();
+    return *_instance;
+}
+
+TessellationCache::TessellationCache() : size(0)
+{
+    ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath
+        ("User parameter:BaseApp/Preferences/Mod/Part");
+    long mb = hGrp->GetInt("TessellationCacheSize", 64);
+    maxSize = static_cast<unsigned long>(std::max<long>(mb, 0)) * 1024 * 1024;
+}
+
+TessellationCache::~TessellationCache()
+{
+}
+
+void TessellationCache::clear()
+{
+    QMutexLocker locker(&mutex);
+    entries.clear();
+    order.clear();
+    size = 0;
+}
+
+void TessellationCache::setMaxSize(unsigned long bytes)
+{
+    QMutexLocker locker(&mutex);
+    maxSize = bytes;
+    shrink();
+}
+
+unsigned long TessellationCache::getMemSize() const
+{
+    QMutexLocker locker(&mutex);
+    return size;
+}
+
+uint64_t TessellationCache::hashFace(const TopoDS_Face& face, std::vector<uint64_t>& edgeHashes)
+{
+    edgeHashes.clear();
+    try {
+        // work in the coordinate system of the face where its triangulation is defined
+        TopoDS_Face localFace = TopoDS::Face(face.Located(TopLoc_Location()));
+        localFace.Orientation(TopAbs_FORWARD);
+        TopLoc_Location loc;
+        Handle(Geom_Surface) surface = BRep_Tool::Surface(localFace, loc);
+        if (surface.IsNull())
+            return 0;
+
+        GeometryHash hash;
+        GeomAdaptor_Surface adapt(surface);
+        hash.add(static_cast<int>(adapt.GetType()));
+
+        Standard_Real u1, u2, v1, v2;
+        BRepTools::UVBounds(localFace, u1, u2, v1, v2);
+        hash.add(u1);
+        hash.add(u2);
+        hash.add(v1);
+        hash.add(v2);
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 3; j++) {
+                gp_Pnt pnt;
+                surface->D0(u1 + 0.5 * i * (u2 - u1), v1 + 0.5 * j * (v2 - v1), pnt);
+                hash.add(pnt);
+            }
+        }
+
+        // the edges are combined independent of their order
+        uint64_t sum = 0, bits = 0;
+        for (TopExp_Explorer xp(localFace, TopAbs_EDGE); xp.More(); xp.Next()) {
+            uint64_t edgeHash = hashEdge(TopoDS::Edge(xp.Current()), localFace);
+            edgeHashes.push_back(edgeHash);
+            sum += edgeHash;
+            bits ^= edgeHash;
+        }
+        hash.add(static_cast<int>(edgeHashes.size()));
+        hash.add(sum);
+        hash.add(bits);
+
+        return hash.result();
+    }
+    catch (Standard_Failure) {
+        edgeHashes.clear();
+        return 0;
+    }
+}
+
+bool TessellationCache::extract(const TopoDS_Face& face, const std::vector<uint64_t>& edgeHashes,
+                                Entry& entry)
+{
+    TopLoc_Location loc;
+    Handle(Poly_Triangulation) mesh = BRep_Tool::Triangulation(face, loc);
+    if (mesh.IsNull() || mesh->NbNodes() == 0 || mesh->NbTriangles() == 0)
+        return false;
+
+    entry.deflection = mesh->Deflection();
+    const TColgp_Array1OfPnt& nodes = mesh->Nodes();
+    entry.nodes.reserve(3 * nodes.Length());
+    for (Standard_Integer i = nodes.Lower(); i <= nodes.Upper(); i++) {
+        entry.nodes.push_back(nodes(i).X());
+        entry.nodes.push_back(nodes(i).Y());
+        entry.nodes.push_back(nodes(i).Z());
+    }
+    if (mesh->HasUVNodes()) {
+        const TColgp_Array1OfPnt2d& uvNodes = mesh->UVNodes();
+        entry.uvNodes.reserve(2 * uvNodes.Length());
+        for (Standard_Integer i = uvNodes.Lower(); i <= uvNodes.Upper(); i++) {
+            entry.uvNodes.push_back(uvNodes(i).X());
+            entry.uvNodes.push_back(uvNodes(i).Y());
+        }
+    }
+    const Poly_Array1OfTriangle& triangles = mesh->Triangles();
+    entry.triangles.reserve(3 * triangles.Length());
+    for (Standard_Integer i = triangles.Lower(); i <= triangles.Upper(); i++) {
+        Standard_Integer n1, n2, n3;
+        triangles(i).Get(n1, n2, n3);
+        entry.triangles.push_back(n1);
+        entry.triangles.push_back(n2);
+        entry.triangles.push_back(n3);
+    }
+
+    // a seam edge appears twice in the face and has a polygon for each orientation
+    std::map<uint64_t, TopoDS_Edge> done;
+    std::size_t index = 0;
+    for (TopExp_Explorer xp(face, TopAbs_EDGE); xp.More(); xp.Next(), index++) {
+        const TopoDS_Edge& edge = TopoDS::Edge(xp.Current());
+        uint64_t hash = edgeHashes[index];
+        std::map<uint64_t, TopoDS_Edge>::iterator it = done.find(hash);
+        if (it != done.end()) {
+            if (!it->second.IsSame(edge))
+                return false; // two different edges with the same hash
+            continue;
+        }
+        done[hash] = edge;
+
+        EdgeData data;
+        data.hash = hash;
+        data.closed = BRep_Tool::IsClosed(edge, face) ? true : false;
+        TopoDS_Edge forward = TopoDS::Edge(edge.Oriented(TopAbs_FORWARD));
+        if (!getPolygon(forward, mesh, loc, data.forward.deflection,
+                        data.forward.nodes, data.forward.parameters))
+            return false;
+        if (data.closed) {
+            TopoDS_Edge reversed = TopoDS::Edge(edge.Oriented(TopAbs_REVERSED));
+            if (!getPolygon(reversed, mesh, loc, data.reversed.deflection,
+                            data.reversed.nodes, data.reversed.parameters))
+                return false;
+        }
+        entry.edges.push_back(data);
+    }
+
+    return true;
+}
+
+bool TessellationCache::validate(const TopoDS_Face& face, const std::vector<uint64_t>& edgeHashes,
+                                 const std::map<uint64_t, const EdgeData*>& edges, const Entry& entry)
+{
+    std::size_t numNodes = entry.nodes.size() / 3;
+    if (entry.uvNodes.size() != 2 * numNodes)
+        return false;
+
+    try {
+        // the nodes are given in the coordinate system of the face without its location
+        TopoDS_Face localFace = TopoDS::Face(face.Located(TopLoc_Location()));
+        TopLoc_Location loc;
+        Handle(Geom_Surface) surface = BRep_Tool::Surface(localFace, loc);
+        if (surface.IsNull())
+            return false;
+
+        // the nodes on the edges may be off the surface by the tolerance of the edges
+        double tolerance = std::max<double>(entry.deflection, BRep_Tool::Tolerance(localFace));
+        for (TopExp_Explorer xp(localFace, TopAbs_EDGE); xp.More(); xp.Next())
+            tolerance = std::max<double>(tolerance, BRep_Tool::Tolerance(TopoDS::Edge(xp.Current())));
+        double tolerance2 = tolerance * tolerance;
+
+        gp_Trsf trsf = loc.Transformation();
+        for (std::size_t i = 0; i < numNodes; i++) {
+            gp_Pnt pnt;
+            surface->D0(entry.uvNodes[2*i], entry.uvNodes[2*i+1], pnt);
+            pnt.Transform(trsf);
+            gp_Pnt node(entry.nodes[3*i], entry.nodes[3*i+1], entry.nodes[3*i+2]);
+            if (!(pnt.SquareDistance(node) <= tolerance2))
+                return false;
+        }
+
+        // the nodes of the edges must lie on their 3D curves
+        std::size_t index = 0;
+        for (TopExp_Explorer xp(localFace, TopAbs_EDGE); xp.More(); xp.Next(), index++) {
+            const Polygon& poly = edges.find(edgeHashes[index])->second->forward;
+            if (poly.parameters.size() != poly.nodes.size())
+                continue;
+            TopoDS_Edge edge = TopoDS::Edge(xp.Current().Oriented(TopAbs_FORWARD));
+            TopLoc_Location curveLoc;
+            Standard_Real first, last;
+            Handle(Geom_Curve) curve = BRep_Tool::Curve(edge, curveLoc, first, last);
+            if (curve.IsNull())
+                continue; // degenerated edge
+            gp_Trsf curveTrsf = curveLoc.Transformation();
+            for (std::size_t j = 0; j < poly.nodes.size(); j++) {
+                int n = poly.nodes[j];
+                if (n < 1 || static_cast<std::size_t>(n) > numNodes)
+                    return false;
+                gp_Pnt pnt = curve->Value(poly.parameters[j]).Transformed(curveTrsf);
+                gp_Pnt node(entry.nodes[3*n-3], entry.nodes[3*n-2], entry.nodes[3*n-1]);
+                if (!(pnt.SquareDistance(node) <= tolerance2))
+                    return false;
+            }
+        }
+    }
+    catch (Standard_Failure) {
+        return false;
+    }
+
+    return true;
+}
+
+bool TessellationCache::apply(const TopoDS_Face& face, const std::vector<uint64_t>& edgeHashes,
+                              const Entry& entry)
+{
+    std::map<uint64_t, const EdgeData*> edges;
+    for (std::vector<EdgeData>::const_iterator it = entry.edges.begin(); it != entry.edges.end(); ++it)
+        edges[it->hash] = &(*it);
+    for (std::vector<uint64_t>::const_iterator it = edgeHashes.begin(); it != edgeHashes.end(); ++it) {
+        if (edges.find(*it) == edges.end())
+            return false;
+    }
+
+    // the hash only samples the geometry, e.g. inner poles of a B-spline surface may have been moved
+    if (!validate(face, edgeHashes, edges, entry))
+        return false;
+
+    Standard_Integer numNodes = static_cast<Standard_Integer>(entry.nodes.size() / 3);
+    Standard_Integer numTriangles = static_cast<Standard_Integer>(entry.triangles.size() / 3);
+    TColgp_Array1OfPnt nodes(1, numNodes);
+    for (Standard_Integer i = 0; i < numNodes; i++)
+        nodes(i + 1).SetCoord(entry.nodes[3*i], entry.nodes[3*i+1], entry.nodes[3*i+2]);
+    Poly_Array1OfTriangle triangles(1, numTriangles);
+    for (Standard_Integer i = 0; i < numTriangles; i++)
+        triangles(i + 1).Set(entry.triangles[3*i], entry.triangles[3*i+1], entry.triangles[3*i+2]);
+
+    Handle(Poly_Triangulation) mesh;
+    if (!entry.uvNodes.empty()) {
+        TColgp_Array1OfPnt2d uvNodes(1, numNodes);
+        for (Standard_Integer i = 0; i < numNodes; i++)
+            uvNodes(i + 1).SetCoord(entry.uvNodes[2*i], entry.uvNodes[2*i+1]);
+        mesh = new Poly_Triangulation(nodes, uvNodes, triangles);
+    }
+    else {
+        mesh = new Poly_Triangulation(nodes, triangles);
+    }
+    mesh->Deflection(entry.deflection);
+
+    // the polygons refer to the triangulation in the coordinate system of the face
+    BRep_Builder builder;
+    TopLoc_Location loc = face.Location();
+    builder.UpdateFace(face, mesh);
+
+    std::set<uint64_t> done;
+    std::size_t index = 0;
+    for (TopExp_Explorer xp(face, TopAbs_EDGE); xp.More(); xp.Next(), index++) {
+        uint64_t hash = edgeHashes[index];
+        if (!done.insert(hash).second)
+            continue;
+        const EdgeData* data = edges[hash];
+        TopoDS_Edge forward = TopoDS::Edge(xp.Current().Oriented(TopAbs_FORWARD));
+        Handle(Poly_PolygonOnTriangulation) poly1 = makePolygon(data->forward.deflection,
+            data->forward.nodes, data->forward.parameters);
+        if (data->closed) {
+            Handle(Poly_PolygonOnTriangulation) poly2 = makePolygon(data->reversed.deflection,
+                data->reversed.nodes, data->reversed.parameters);
+            builder.UpdateEdge(forward, poly1, poly2, mesh, loc);
+        }
+        else {
+            builder.UpdateEdge(forward, poly1, mesh, loc);
+        }
+    }
+
+    return true;
+}
+
+unsigned long TessellationCache::memSize(const Entry& entry)
+{
+    unsigned long bytes = sizeof(Entry) + sizeof(Key);
+    bytes += sizeof(double) * (entry.nodes.size() + entry.uvNodes.size());
+    bytes += sizeof(int) * entry.triangles.size();
+    for (std::vector<EdgeData>::const_iterator it = entry.edges.begin(); it != entry.edges.end(); ++it) {
+        bytes += sizeof(EdgeData);
+        bytes += sizeof(int) * (it->forward.nodes.size() + it->reversed.nodes.size());
+        bytes += sizeof(double) * (it->forward.parameters.size() + it->reversed.parameters.size());
+    }
+    return bytes;
+}
+
+const TessellationCache::Entry* TessellationCache::find(uint64_t hash, double deflection) const
+{
+    // the coarsest entry that is still fine enough
+    std::map<Key, Entry>::const_iterator it = entries.upper_bound(Key(hash, deflection));
+    if (it == entries.begin())
+        return 0;
+    --it;
+    if (it->first.first != hash || it->first.second < 0.5 * deflection)
+        return 0;
+    return &it->second;
+}
+
+void TessellationCache::insert(const Key& key, const Entry& entry)
+{
+    // an entry that failed the validation is replaced
+    std::map<Key, Entry>::iterator it = entries.find(key);
+    if (it != entries.end()) {
+        size -= memSize(it->second);
+        it->second = entry;
+    }
+    else {
+        entries[key] = entry;
+        order.push_back(key);
+    }
+    size += memSize(entry);
+    shrink();
+}
+
+void TessellationCache::shrink()
+{
+    while (size > maxSize && !order.empty()) {
+        std::map<Key, Entry>::iterator it = entries.find(order.front());
+        if (it != entries.end()) {
+            size -= memSize(it->second);
+            entries.erase(it);
+        }
+        order.pop_front();
+    }
+}
+
+void TessellationCache::mesh(const TopoDS_Shape& shape, double deflection)
+{
+    if (shape.IsNull() || deflection <= 0.0)
+        return;
+
+    TopTools_IndexedMapOfShape faceMap;
+    TopExp::MapShapes(shape, TopAbs_FACE, faceMap);
+    int numFaces = faceMap.Extent();
+    std::vector<uint64_t> hashes(numFaces, 0);
+    std::vector< std::vector<uint64_t> > edgeHashes(numFaces);
+
+    // take the triangulation of the known faces from the cache
+    for (int i = 0; i < numFaces; i++) {
+        const TopoDS_Face& face = TopoDS::Face(faceMap(i + 1));
+        TopLoc_Location loc;
+        Handle(Poly_Triangulation) mesh = BRep_Tool::Triangulation(face, loc);
+        if (!mesh.IsNull() && mesh->Deflection() <= deflection)
+            continue; // BRepMesh keeps it anyway
+
+        uint64_t hash = hashFace(face, edgeHashes[i]);
+        if (!hash)
+            continue;
+
+        QMutexLocker locker(&mutex);
+        const Entry* entry = find(hash, deflection);
+        if (!entry || !apply(face, edgeHashes[i], *entry))
+            hashes[i] = hash;
+    }
+
+    // mesh the rest, the edges shared with cached faces keep their nodes
+#if OCC_VERSION_HEX >= 0x060600
+    BRepMesh_IncrementalMesh myMesh(shape, deflection, Standard_False, 0.5, Standard_True);
+#else
+    BRepMesh_IncrementalMesh myMesh(shape, deflection);
+#endif
+
+    for (int i = 0; i < numFaces; i++) {
+        if (!hashes[i])
+            continue;
+        Entry entry;
+        if (extract(TopoDS::Face(faceMap(i + 1)), edgeHashes[i], entry)) {
+            QMutexLocker locker(&mutex);
+            insert(Key(hashes[i], deflection), entry);
+        }
+    }
+}
+
+void TessellationCache::save(const TopoDS_Shape& shape, std::ostream& out) const
+{
+    std::set<uint64_t> hashes;
+    if (!shape.IsNull()) {
+        TopTools_IndexedMapOfShape faceMap;
+        TopExp::MapShapes(shape, TopAbs_FACE, faceMap);
+        std::vector<uint64_t> edgeHashes;
+        for (int i = 1; i <= faceMap.Extent(); i++) {
+            uint64_t hash = hashFace(TopoDS::Face(faceMap(i)), edgeHashes);
+            if (hash)
+                hashes.insert(hash);
+        }
+    }
+
+    QMutexLocker locker(&mutex);
+    std::vector<std::map<Key, Entry>::const_iterator> found;
+    for (std::set<uint64_t>::iterator jt = hashes.begin(); jt != hashes.end(); ++jt) {
+        std::map<Key, Entry>::const_iterator it = entries.lower_bound(Key(*jt, 0.0));
+        for (; it != entries.end() && it->first.first == *jt; ++it)
+            found.push_back(it);
+    }
+
+    Base::OutputStream str(out);
+    str << static_cast<uint32_t>(found.size());
+    for (std::size_t i = 0; i < found.size(); i++) {
+        const Key& key = found[i]->first;
+        const Entry& entry = found[i]->second;
+        str << key.first << key.second << entry.deflection;
+        writeArray(str, entry.nodes);
+        writeArray(str, entry.uvNodes);
+        writeArray(str, entry.triangles);
+        str << static_cast<uint32_t>(entry.edges.size());
+        for (std::vector<EdgeData>::const_iterator it = entry.edges.begin(); it != entry.edges.end(); ++it) {
+            str << it->hash << it->closed;
+            str << it->forward.deflection;
+            writeArray(str, it->forward.nodes);
+            writeArray(str, it->forward.parameters);
+            if (it->closed) {
+                str << it->reversed.deflection;
+                writeArray(str, it->reversed.nodes);
+                writeArray(str, it->reversed.parameters);
+            }
+        }
+    }
+}
+
+void TessellationCache::restore(std::istream& in)
+{
+    Base::InputStream str(in);
+    uint32_t count = 0;
+    str >> count;
+    for (uint32_t i = 0; i < count && in; i++) {
+        Key key;
+        Entry entry;
+        str >> key.first >> key.second >> entry.deflection;
+        if (!readArray(str, in, entry.nodes) ||
+            !readArray(str, in, entry.uvNodes) ||
+            !readArray(str, in, entry.triangles))
+            break;
+
+        std::size_t numNodes = entry.nodes.size() / 3;
+        bool valid = numNodes > 0 && entry.nodes.size() == 3 * numNodes &&
+            !entry.triangles.empty() && entry.triangles.size() % 3 == 0 &&
+            (entry.uvNodes.empty() || entry.uvNodes.size() == 2 * numNodes) &&
+            checkIndices(entry.triangles, numNodes);
+
+        uint32_t numEdges = 0;
+        str >> numEdges;
+        for (uint32_t j = 0; j < numEdges && in; j++) {
+            EdgeData data;
+            str >> data.hash >> data.closed;
+            str >> data.forward.deflection;
+            readArray(str, in, data.forward.nodes);
+            readArray(str, in, data.forward.parameters);
+            valid = valid && !data.forward.nodes.empty() && checkIndices(data.forward.nodes, numNodes);
+            if (data.closed) {
+                str >> data.reversed.deflection;
+                readArray(str, in, data.reversed.nodes);
+                readArray(str, in, data.reversed.parameters);
+                valid = valid && !data.reversed.nodes.empty() &&
+                    checkIndices(data.reversed.nodes, numNodes);
+            }
+            entry.edges.push_back(data);
+        }
+
+        if (!in)
+            break;
+        if (valid && key.first != 0) {
+            QMutexLocker locker(&mutex);
+            insert(key, entry);
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+TessellationFile::TessellationFile(const PropertyPartShape* p) : prop(p)
+{
+}
+
+TessellationFile::~TessellationFile()
+{
+}
+
+unsigned int TessellationFile::getMemSize (void) const
+{
+    return 0;
+}
+
+void TessellationFile::Save (Base::Writer &writer) const
+{
+    // the file is registered by the shape property
+}
+
+void TessellationFile::Restore(Base::XMLReader &reader)
+{
+}
+
+void TessellationFile::SaveDocFile (Base::Writer &writer) const
+{
+    TessellationCache::instance().save(prop->getValue(), writer.Stream());
+}
+
+void TessellationFile::RestoreDocFile(Base::Reader &reader)
+{
+    TessellationCache::instance().restore(reader);
+}
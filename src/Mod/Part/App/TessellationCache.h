@@ -0,0 +1,153 @@
+/***************************************************************************
+ *   Copyright (c) 2026 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#ifndef PART_TESSELLATIONCACHE_H
+#define PART_TESSELLATIONCACHE_H
+
+#include <deque>
+#include <iosfwd>
+#include <map>
+#include <vector>
+#include <QMutex>
+#include <Base/Persistence.h>
+
+class TopoDS_Face;
+class TopoDS_Shape;
+
+namespace Part
+{
+
+class PropertyPartShape;
+
+/**
+ * The TessellationCache class keeps the triangulations that BRepMesh has computed for the
+ * faces of shapes. A face is identified by a hash of its surface, its parameter range and its
+ * edges in the coordinate system of the face, so a face keeps its entry when the placement of
+ * the shape changes, when a feature is recomputed with the same result or when the shape is
+ * copied or restored by undo. An entry is used for a requested deflection if it has been
+ * computed with a deflection between the half and the full value. As the hash only samples the
+ * geometry, the nodes of an entry are checked against the surface and the edge curves of the
+ * face before they are used.
+ *
+ * The cache stores plain arrays and no OCC handles, and all methods are guarded by a mutex, so
+ * it can be used from worker threads. If the cache grows beyond its maximum size the oldest
+ * entries are removed.
+ */
+class PartExport TessellationCache
+{
+public:
+    static TessellationCache& instance();
+
+    /** Triangulates the faces of \a shape with the given deflection like BRepMesh_IncrementalMesh.
+     * The faces found in the cache get their triangulation from there, the other faces are meshed
+     * by BRepMesh and then added to the cache.
+     */
+    void mesh(const TopoDS_Shape& shape, double deflection);
+    /// Removes all entries.
+    void clear();
+    /// Sets the maximum memory size of the cache in bytes.
+    void setMaxSize(unsigned long);
+    /// Returns the estimated memory size of the cached data in bytes.
+    unsigned long getMemSize() const;
+
+    /** @name Save/restore */
+    //@{
+    /// Writes the cached triangulations of the faces of \a shape in a binary format.
+    void save(const TopoDS_Shape& shape, std::ostream&) const;
+    /// Adds the triangulations written by save() to the cache.
+    void restore(std::istream&);
+    //@}
+
+private:
+    TessellationCache();
+    ~TessellationCache();
+
+    struct Polygon {
+        double deflection;
+        std::vector<int> nodes;
+        std::vector<double> parameters;
+    };
+    struct EdgeData {
+        uint64_t hash;
+        bool closed;
+        Polygon forward;
+        Polygon reversed;
+    };
+    struct Entry {
+        double deflection;
+        std::vector<double> nodes;
+        std::vector<double> uvNodes;
+        std::vector<int> triangles;
+        std::vector<EdgeData> edges;
+    };
+    typedef std::pair<uint64_t, double> Key;
+
+    static uint64_t hashFace(const TopoDS_Face&, std::vector<uint64_t>& edgeHashes);
+    static bool extract(const TopoDS_Face&, const std::vector<uint64_t>& edgeHashes, Entry&);
+    static bool validate(const TopoDS_Face&, const std::vector<uint64_t>& edgeHashes,
+                         const std::map<uint64_t, const EdgeData*>& edges, const Entry&);
+    static bool apply(const TopoDS_Face&, const std::vector<uint64_t>& edgeHashes, const Entry&);
+    static unsigned long memSize(const Entry&);
+    const Entry* find(uint64_t hash, double deflection) const;
+    void insert(const Key&, const Entry&);
+    void shrink();
+
+private:
+    std::map<Key, Entry> entries;
+    std::deque<Key> order;
+    unsigned long size;
+    unsigned long maxSize;
+    mutable QMutex mutex;
+
+    static TessellationCache* _instance;
+};
+
+/**
+ * The TessellationFile class writes the cached triangulation of a shape property into an extra
+ * file of the project, and fills the cache with it when the project is loaded.
+ * @see PropertyPartShape::Save()
+ */
+class PartExport TessellationFile : public Base::Persistence
+{
+public:
+    TessellationFile(const PropertyPartShape*);
+    ~TessellationFile();
+
+    /** @name I/O of the document */
+    //@{
+    unsigned int getMemSize (void) const;
+    void Save (Base::Writer &writer) const;
+    void Restore(Base::XMLReader &reader);
+    void SaveDocFile (Base::Writer &writer) const;
+    void RestoreDocFile(Base::Reader &reader);
+    //@}
+
+private:
+    const PropertyPartShape* prop;
+};
+
+} //namespace Part
+
+
+#endif // PART_TESSELLATIONCACHE_H
@@ -166,6 +166,7 @@
 #include "TopoShapeVertexPy.h"
 #include "ProgressIndicator.h"
 #include "modelRefine.h"
+#include "TessellationCache.h"
 #include "Tools.h"
 
 using namespace Part;
@@ -764,6 +765,8 @@ void TopoShape::exportStl(const char *filename, double deflection) const
     if (deflection > 0) {
         writer.RelativeMode() = false;
         writer.SetDeflection(deflection);
+        // the writer keeps a triangulation that is fine enough
+        TessellationCache::instance().mesh(this->_Shape, deflection);
     }
     QString fn = QString::fromUtf8(filename);
     writer.Write(this->_Shape,(const Standard_CString)fn.toLocal8Bit());
@@ -774,7 +777,7 @@ void TopoShape::exportFaceSet(double dev, double ca, std::ostream& str) const
     Base::InventorBuilder builder(str);
     TopExp_Explorer ex;
 
-    BRepMesh_IncrementalMesh MESH(this->_Shape,dev);
+    TessellationCache::instance().mesh(this->_Shape,dev);
     for (ex.Init(this->_Shape, TopAbs_FACE); ex.More(); ex.Next()) {
         // get the shape and mesh it
         const TopoDS_Face& aFace = TopoDS::Face(ex.Current());
@@ -2295,6 +2298,8 @@ void TopoShape::getFaces(std::vector<Base::Vector3d> &aPoints,
     Standard_Real x2, y2, z2;
     Standard_Real x3, y3, z3;
 
+    // the faces known by the cache are not meshed again
+    TessellationCache::instance().mesh(this->_Shape, accuracy);
     Handle_StlMesh_Mesh aMesh = new StlMesh_Mesh();
     StlTransfer::BuildIncrementalMesh(this->_Shape, accuracy,
 #if OCC_VERSION_HEX >= 0x060503
@@ -0,0 +1,385 @@
+/***************************************************************************
+ *   Copyright (c) 2026 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <climits>
+# include <set>
+# include <BRepBuilderAPI_Copy.hxx>
+# include <BRep_Tool.hxx>
+# include <gp_Trsf.hxx>
+# include <Handle_Poly_Triangulation.hxx>
+# include <Poly_Array1OfTriangle.hxx>
+# include <Poly_Polygon3D.hxx>
+# include <Poly_PolygonOnTriangulation.hxx>
+# include <Poly_Triangulation.hxx>
+# include <Standard.hxx>
+# include <TColgp_Array1OfPnt.hxx>
+# include <TColStd_Array1OfInteger.hxx>
+# include <TopExp.hxx>
+# include <TopExp_Explorer.hxx>
+# include <TopoDS.hxx>
+# include <TopoDS_Edge.hxx>
+# include <TopoDS_Face.hxx>
+# include <TopoDS_Vertex.hxx>
+# include <TopTools_IndexedMapOfShape.hxx>
+# include <Inventor/nodes/SoIndexedFaceSet.h>
+#endif
+
+#include <QtConcurrentMap>
+#include <QtConcurrentRun>
+#include <boost/bind.hpp>
+
+#include <Mod/Part/App/TessellationCache.h>
+
+#include "ShapeTessellation.h"
+
+using namespace PartGui;
+
+/**
+ * Everything that is needed to fill in the arrays of a face. It's collected beforehand so that
+ * the worker threads neither need an explorer nor copy any OCC handle.
+ */
+struct ShapeTessellation::FaceData
+{
+    int index;
+    int nodeOffset;
+    int triaOffset;
+    bool reversed;
+    bool identity;
+    gp_Trsf transform;
+    Handle(Poly_Triangulation) mesh;
+    /// The edges whose polygon is taken from this face
+    std::vector< std::pair<int, Handle(Poly_PolygonOnTriangulation)> > edges;
+};
+
+ShapeTessellation::ShapeTessellation(const TopoDS_Shape& shape, double deflection)
+  : vertexStart(0), shape(shape), deflection(deflection), valid(true)
+  , canceled(0), running(false), detached(false)
+{
+}
+
+ShapeTessellation::~ShapeTessellation()
+{
+    // a discarded object is deleted by the worker thread itself or after it has stopped
+    if (!detached)
+        future.waitForFinished();
+}
+
+void ShapeTessellation::perform()
+{
+    try {
+        compute();
+    }
+    catch (...) {
+        valid = false;
+    }
+    if (isCanceled())
+        valid = false;
+    if (!valid) {
+        points.clear();
+        normals.clear();
+        faceIndices.clear();
+        partIndices.clear();
+        lineIndices.clear();
+        vertexStart = 0;
+    }
+    edgeIndices.clear();
+}
+
+void ShapeTessellation::start()
+{
+    // The reference counting of OCC handles must be thread-safe from now on. It's never
+    // switched off again because the handles may be shared with other worker threads.
+    static bool reentrant = false;
+    if (!reentrant) {
+        Standard::SetReentrant(Standard_True);
+        reentrant = true;
+    }
+
+    shape = BRepBuilderAPI_Copy(shape).Shape();
+    running = true;
+    future = QtConcurrent::run(this, &ShapeTessellation::run);
+}
+
+void ShapeTessellation::run()
+{
+    perform();
+
+    mutex.lock();
+    running = false;
+    bool remove = detached;
+    mutex.unlock();
+    if (remove)
+        delete this;
+}
+
+void ShapeTessellation::discard()
+{
+    canceled = 1;
+
+    mutex.lock();
+    bool remove = !running;
+    detached = true;
+    mutex.unlock();
+    if (remove)
+        delete this;
+}
+
+bool ShapeTessellation::isFinished() const
+{
+    return future.isFinished();
+}
+
+void ShapeTessellation::compute()
+{
+    // create or use the mesh on the data structure, the triangulation of unchanged faces
+    // is taken from the cache
+    Part::TessellationCache::instance().mesh(shape, deflection);
+    if (isCanceled())
+        return;
+    // We must reset the location here because the transformation data
+    // are set in the placement property
+    TopLoc_Location aLoc;
+    shape.Location(aLoc);
+
+    // get an indexed map of edges
+    TopTools_IndexedMapOfShape edgeMap;
+    TopExp::MapShapes(shape, TopAbs_EDGE, edgeMap);
+    std::vector<bool> edgeDone(edgeMap.Extent() + 1, false);
+    std::set<int> faceEdges;
+
+    // count triangles and nodes in the mesh and decide which face provides the polygon of an edge
+    int numNodes = 0, numNorms = 0, numTriangles = 0;
+    std::vector<FaceData> faces;
+    TopExp_Explorer Ex;
+    for (Ex.Init(shape, TopAbs_FACE); Ex.More(); Ex.Next()) {
+        const TopoDS_Face& actFace = TopoDS::Face(Ex.Current());
+        FaceData data;
+        data.index = (int)faces.size();
+        data.nodeOffset = numNodes;
+        data.triaOffset = numTriangles;
+        data.reversed = (actFace.Orientation() != TopAbs_FORWARD);
+        data.identity = true;
+
+        TopLoc_Location faceLoc;
+        data.mesh = BRep_Tool::Triangulation(actFace, faceLoc);
+        // Note: we must also count empty faces
+        if (!data.mesh.IsNull()) {
+            numTriangles += data.mesh->NbTriangles();
+            numNodes     += data.mesh->NbNodes();
+            numNorms     += data.mesh->NbNodes();
+
+            // getting the transformation of the shape/face
+            if (!faceLoc.IsIdentity()) {
+                data.identity = false;
+                data.transform = faceLoc.Transformation();
+            }
+        }
+
+        TopExp_Explorer xp;
+        for (xp.Init(actFace, TopAbs_EDGE); xp.More(); xp.Next()) {
+            const TopoDS_Edge& curEdge = TopoDS::Edge(xp.Current());
+            faceEdges.insert(curEdge.HashCode(INT_MAX));
+            if (data.mesh.IsNull())
+                continue;
+            // the first face with a polygon of the edge provides its points
+            int edgeIndex = edgeMap.FindIndex(curEdge);
+            if (edgeDone[edgeIndex])
+                continue;
+            Handle(Poly_PolygonOnTriangulation) aPoly = BRep_Tool::PolygonOnTriangulation(curEdge, data.mesh, faceLoc);
+            if (aPoly.IsNull())
+                continue; // polygon does not exist
+            edgeDone[edgeIndex] = true;
+            data.edges.push_back(std::make_pair(edgeIndex, aPoly));
+        }
+
+        faces.push_back(data);
+    }
+
+    // handling of the free edge that are not associated to a face
+    // Note: The assumption that if for an edge BRep_Tool::Polygon3D
+    // returns a valid object is wrong. This e.g. happens for ruled
+    // surfaces which gets created by two edges or wires.
+    // So, we have to store the hashes of the edges associated to a face.
+    // If the hash of a given edge is not in this list we know it's really
+    // a free edge.
+    std::vector< std::pair<int, Handle(Poly_Polygon3D)> > freeEdges;
+    std::vector<TopLoc_Location> freeLocs;
+    for (int i=1; i <= edgeMap.Extent(); i++) {
+        const TopoDS_Edge& aEdge = TopoDS::Edge(edgeMap(i));
+        if (faceEdges.find(aEdge.HashCode(INT_MAX)) == faceEdges.end()) {
+            TopLoc_Location edgeLoc;
+            Handle(Poly_Polygon3D) aPoly = BRep_Tool::Polygon3D(aEdge, edgeLoc);
+            if (!aPoly.IsNull()) {
+                freeEdges.push_back(std::make_pair(i, aPoly));
+                freeLocs.push_back(edgeLoc);
+                numNodes += aPoly->NbNodes();
+            }
+        }
+    }
+
+    // handling of the vertices
+    TopTools_IndexedMapOfShape vertexMap;
+    TopExp::MapShapes(shape, TopAbs_VERTEX, vertexMap);
+    numNodes += vertexMap.Extent();
+
+    // create memory for the nodes and indexes
+    points.resize(numNodes);
+    normals.assign(numNorms, SbVec3f(0.0f,0.0f,0.0f));
+    faceIndices.resize(numTriangles*4);
+    partIndices.assign(faces.size(), 0);
+    edgeIndices.resize(edgeMap.Extent() + 1);
+
+    if (isCanceled())
+        return;
+
+    // the faces write to disjoint parts of the arrays
+    QtConcurrent::blockingMap(faces, boost::bind(&ShapeTessellation::fillFace, this, _1));
+
+    int nodeOffset = numNorms;
+    for (std::size_t i = 0; i < freeEdges.size(); i++) {
+        const Handle(Poly_Polygon3D)& aPoly = freeEdges[i].second;
+        Standard_Boolean identity = freeLocs[i].IsIdentity();
+        gp_Trsf myTransf;
+        if (!identity)
+            myTransf = freeLocs[i].Transformation();
+
+        const TColgp_Array1OfPnt& aNodes = aPoly->Nodes();
+        int nbNodesInEdge = aPoly->NbNodes();
+        std::vector<int32_t>& lines = edgeIndices[freeEdges[i].first];
+        for (Standard_Integer j=1;j <= nbNodesInEdge;j++) {
+            gp_Pnt pnt = aNodes(j);
+            if (!identity)
+                pnt.Transform(myTransf);
+            int index = nodeOffset+j-1;
+            points[index].setValue((float)(pnt.X()),(float)(pnt.Y()),(float)(pnt.Z()));
+            lines.push_back(index);
+        }
+
+        nodeOffset += nbNodesInEdge;
+    }
+
+    vertexStart = nodeOffset;
+    for (int i=0; i<vertexMap.Extent(); i++) {
+        const TopoDS_Vertex& aVertex = TopoDS::Vertex(vertexMap(i+1));
+        gp_Pnt pnt = BRep_Tool::Pnt(aVertex);
+        points[nodeOffset+i].setValue((float)(pnt.X()),(float)(pnt.Y()),(float)(pnt.Z()));
+    }
+
+    // the edges in the order of the edge map
+    for (std::vector< std::vector<int32_t> >::iterator it = edgeIndices.begin(); it != edgeIndices.end(); ++it) {
+        if (it->empty())
+            continue;
+        lineIndices.insert(lineIndices.end(), it->begin(), it->end());
+        lineIndices.push_back(-1);
+    }
+}
+
+void ShapeTessellation::fillFace(FaceData& data)
+{
+    if (data.mesh.IsNull() || isCanceled())
+        return;
+
+    // getting size of node and triangle array of this face
+    int nbNodesInFace = data.mesh->NbNodes();
+    int nbTriInFace   = data.mesh->NbTriangles();
+    int faceNodeOffset = data.nodeOffset;
+    int32_t* triangles = faceIndices.empty() ? 0 : &faceIndices[0] + data.triaOffset*4;
+
+    // cycling through the poly mesh
+    const Poly_Array1OfTriangle& Triangles = data.mesh->Triangles();
+    const TColgp_Array1OfPnt& Nodes = data.mesh->Nodes();
+    for (int g=1;g<=nbTriInFace;g++) {
+        // Get the triangle
+        Standard_Integer N1,N2,N3;
+        Triangles(g).Get(N1,N2,N3);
+
+        // change orientation of the triangle if the face is reversed
+        if (data.reversed) {
+            Standard_Integer tmp = N1;
+            N1 = N2;
+            N2 = tmp;
+        }
+
+        // get the 3 points of this triangle
+        gp_Pnt V1(Nodes(N1)), V2(Nodes(N2)), V3(Nodes(N3));
+
+        // transform the vertices to the place of the face
+        if (!data.identity) {
+            V1.Transform(data.transform);
+            V2.Transform(data.transform);
+            V3.Transform(data.transform);
+        }
+
+        // calculating per vertex normals
+        // Calculate triangle normal
+        gp_Vec v1(V1.X(),V1.Y(),V1.Z()),v2(V2.X(),V2.Y(),V2.Z()),v3(V3.X(),V3.Y(),V3.Z());
+        gp_Vec Normal = (v2-v1)^(v3-v1);
+
+        // add the triangle normal to the vertex normal for all points of this triangle
+        normals[faceNodeOffset+N1-1] += SbVec3f(Normal.X(),Normal.Y(),Normal.Z());
+        normals[faceNodeOffset+N2-1] += SbVec3f(Normal.X(),Normal.Y(),Normal.Z());
+        normals[faceNodeOffset+N3-1] += SbVec3f(Normal.X(),Normal.Y(),Normal.Z());
+
+        // set the vertices
+        points[faceNodeOffset+N1-1].setValue((float)(V1.X()),(float)(V1.Y()),(float)(V1.Z()));
+        points[faceNodeOffset+N2-1].setValue((float)(V2.X()),(float)(V2.Y()),(float)(V2.Z()));
+        points[faceNodeOffset+N3-1].setValue((float)(V3.X()),(float)(V3.Y()),(float)(V3.Z()));
+
+        // set the index vector with the 3 point indexes and the end delimiter
+        triangles[4*(g-1)]   = faceNodeOffset+N1-1;
+        triangles[4*(g-1)+1] = faceNodeOffset+N2-1;
+        triangles[4*(g-1)+2] = faceNodeOffset+N3-1;
+        triangles[4*(g-1)+3] = SO_END_FACE_INDEX;
+    }
+
+    partIndices[data.index] = nbTriInFace; // new part
+
+    // handling the edges lying on this face
+    for (std::size_t e = 0; e < data.edges.size(); e++) {
+        std::vector<int32_t>& lines = edgeIndices[data.edges[e].first];
+        // getting the indexes of the edge polygon
+        const TColStd_Array1OfInteger& indices = data.edges[e].second->Nodes();
+        for (Standard_Integer i=indices.Lower();i <= indices.Upper();i++) {
+            int nodeIndex = indices(i);
+            int index = faceNodeOffset+nodeIndex-1;
+            lines.push_back(index);
+
+            // usually the coordinates for this edge are already set by the
+            // triangles of the face this edge belongs to. However, there are
+            // rare cases where some points are only referenced by the polygon
+            // but not by any triangle. Thus, we must apply the coordinates to
+            // make sure that everything is properly set.
+            gp_Pnt p(Nodes(nodeIndex));
+            if (!data.identity)
+                p.Transform(data.transform);
+            points[index].setValue((float)(p.X()),(float)(p.Y()),(float)(p.Z()));
+        }
+    }
+
+    // normalize the normals of this face
+    for (int i = 0; i < nbNodesInFace; i++)
+        normals[faceNodeOffset+i].normalize();
+}
@@ -0,0 +1,109 @@
+/***************************************************************************
+ *   Copyright (c) 2026 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef PARTGUI_SHAPETESSELLATION_H
+#define PARTGUI_SHAPETESSELLATION_H
+
+#include <vector>
+#include <QAtomicInt>
+#include <QFuture>
+#include <QMutex>
+#include <TopoDS_Shape.hxx>
+#include <Inventor/SbVec3f.h>
+
+namespace PartGui {
+
+/**
+ * The ShapeTessellation class computes the triangulation of a shape and the arrays of points,
+ * normals and indices that ViewProviderPartExt displays. It doesn't touch any Inventor node so
+ * that the whole work can be done in a worker thread. The arrays of the faces are filled in
+ * parallel, the view provider only copies them into its nodes when they are ready.
+ */
+class PartGuiExport ShapeTessellation
+{
+public:
+    /// Construction
+    ShapeTessellation(const TopoDS_Shape& shape, double deflection);
+    /// Destruction, waits for the worker thread. Use discard() to abandon a running tessellation.
+    ~ShapeTessellation();
+
+    /// Computes the arrays in the calling thread.
+    void perform();
+    /** Computes the arrays in a worker thread. The thread works on a copy of the shape so that
+     * it doesn't share any data with the document.
+     * The first call switches OCC into reentrant mode, i.e. the reference counting of handles
+     * becomes thread-safe. It stays on for the rest of the session because handles created in
+     * the meantime may still be shared with worker threads.
+     */
+    void start();
+    /** Cancels the tessellation without waiting for the worker thread. The object is deleted
+     * at once if the thread isn't running, otherwise the thread deletes it when it has stopped.
+     * The object must not be used afterwards.
+     */
+    void discard();
+    /// Returns true if the worker thread has finished or hasn't been started.
+    bool isFinished() const;
+    /// Returns false if the tessellation failed.
+    bool isValid() const
+    { return valid; }
+
+    /** @name Results */
+    //@{
+    std::vector<SbVec3f> points;
+    std::vector<SbVec3f> normals;
+    /// Three point indices and -1 for each triangle
+    std::vector<int32_t> faceIndices;
+    /// Number of triangles of each face
+    std::vector<int32_t> partIndices;
+    /// Point indices of each edge, followed by -1
+    std::vector<int32_t> lineIndices;
+    /// Position of the first point that belongs to a vertex
+    int vertexStart;
+    //@}
+
+private:
+    struct FaceData;
+    void run();
+    void compute();
+    void fillFace(FaceData&);
+    bool isCanceled() const
+    { return canceled != 0; }
+
+private:
+    ShapeTessellation(const ShapeTessellation&);
+    void operator = (const ShapeTessellation&);
+
+    TopoDS_Shape shape;
+    double deflection;
+    bool valid;
+    QFuture<void> future;
+    QAtomicInt canceled;
+    QMutex mutex;
+    bool running;
+    bool detached;
+    std::vector< std::vector<int32_t> > edgeIndices;
+};
+
+} // namespace PartGui
+
+#endif // PARTGUI_SHAPETESSELLATION_H
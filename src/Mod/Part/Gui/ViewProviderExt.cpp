@@ -24,6 +24,7 @@
 #include "PreCompiled.h"
 
 #ifndef _PreComp_
+# include <memory>
 # include <sstream>
 # include <Poly_Polygon3D.hxx>
 # include <BRepBndLib.hxx>
@@ -85,6 +86,7 @@
 # include <Inventor/nodes/SoSphere.h>
 # include <Inventor/nodes/SoScale.h>
 # include <Inventor/nodes/SoLightModel.h>
+# include <Inventor/sensors/SoTimerSensor.h>
 # include <QAction>
 # include <QMenu>
 #endif
@@ -105,6 +107,7 @@
 #include <Gui/Control.h>
 
 #include "ViewProviderExt.h"
+#include "ShapeTessellation.h"
 #include "SoBrepPointSet.h"
 #include "SoBrepEdgeSet.h"
 #include "SoBrepFaceSet.h"
@@ -116,6 +119,17 @@
 
 using namespace PartGui;
 
+namespace {
+template <class Field, class Value>
+void setFieldValues(Field& field, const std::vector<Value>& values)
+{
+    int num = (int)values.size();
+    field.setNum(num);
+    if (num > 0)
+        field.setValues(0, num, &values[0]);
+}
+}
+
 PROPERTY_SOURCE(PartGui::ViewProviderPartExt, Gui::ViewProviderGeometryObject)
 
 
@@ -130,6 +144,9 @@ const char* ViewProviderPartExt::DrawStyleEnums[]= {"Solid","Dashed","Dotted","D
 ViewProviderPartExt::ViewProviderPartExt() 
 {
     VisualTouched = true;
+    pendingTessellation = 0;
+    tessellationSensor = new SoTimerSensor(tessellationCallback, this);
+    tessellationSensor->setInterval(SbTime(0.1));
 
     ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath("User parameter:BaseApp/Preferences/View");
     unsigned long lcol = hGrp->GetUnsigned("DefaultShapeLineColor",421075455UL); // dark grey (25,25,25)
@@ -206,6 +223,9 @@ ViewProviderPartExt::ViewProviderPartExt()
 
 ViewProviderPartExt::~ViewProviderPartExt()
 {
+    delete tessellationSensor;
+    if (pendingTessellation)
+        pendingTessellation->discard();
     pcShapeBind->unref();
     pcLineMaterial->unref();
     pcPointMaterial->unref();
@@ -620,6 +640,13 @@ void ViewProviderPartExt::unsetEdit(int ModNum)
 
 void ViewProviderPartExt::updateVisual(const TopoDS_Shape& inputShape)
 {
+    // a tessellation that is still running is out of date, it's dropped without waiting for it
+    if (pendingTessellation) {
+        tessellationSensor->unschedule();
+        pendingTessellation->discard();
+        pendingTessellation = 0;
+    }
+
     // Clear selection
     Gui::SoSelectionElementAction action(Gui::SoSelectionElementAction::None);
     action.apply(this->faceset);
@@ -638,10 +665,8 @@ void ViewProviderPartExt::updateVisual(const TopoDS_Shape& inputShape)
         return;
     }
 
-    // time measurement and book keeping
+    // time measurement
     Base::TimeInfo start_time;
-    int numTriangles=0,numNodes=0,numNorms=0,numFaces=0,numEdges=0,numLines=0;
-    std::set<int> faceEdges;
 
     try {
         // calculating the deflection value
@@ -653,272 +678,36 @@ void ViewProviderPartExt::updateVisual(const TopoDS_Shape& inputShape)
         Standard_Real deflection = ((xMax-xMin)+(yMax-yMin)+(zMax-zMin))/300.0 *
             Deviation.getValue();
 
-        // create or use the mesh on the data structure
-#if OCC_VERSION_HEX >= 0x060600
-        BRepMesh_IncrementalMesh myMesh(cShape,deflection,Standard_False,0.5,Standard_True);
-#else
-        BRepMesh_IncrementalMesh myMesh(cShape,deflection);
-#endif
-        // We must reset the location here because the transformation data
-        // are set in the placement property
-        TopLoc_Location aLoc;
-        cShape.Location(aLoc);
-
-        // count triangles and nodes in the mesh
-        TopExp_Explorer Ex;
-        for (Ex.Init(cShape,TopAbs_FACE);Ex.More();Ex.Next()) {
-            Handle (Poly_Triangulation) mesh = BRep_Tool::Triangulation(TopoDS::Face(Ex.Current()), aLoc);
-            // Note: we must also count empty faces
-            if (!mesh.IsNull()) {
-                numTriangles += mesh->NbTriangles();
-                numNodes     += mesh->NbNodes();
-                numNorms     += mesh->NbNodes();
-            }
-
-            TopExp_Explorer xp;
-            for (xp.Init(Ex.Current(),TopAbs_EDGE);xp.More();xp.Next())
-                faceEdges.insert(xp.Current().HashCode(INT_MAX));
-            numFaces++;
-        }
-
-        // get an indexed map of edges
-        TopTools_IndexedMapOfShape edgeMap;
-        TopExp::MapShapes(cShape, TopAbs_EDGE, edgeMap);
-
-         // key is the edge number, value the coord indexes. This is needed to keep the same order as the edges.
-        std::map<int, std::vector<int32_t> > lineSetMap;
-        std::set<int>          edgeIdxSet;
-        std::vector<int32_t>   edgeVector;
-
-        // count and index the edges
-        for (int i=1; i <= edgeMap.Extent(); i++) {
-            edgeIdxSet.insert(i);
-            numEdges++;
-
-            const TopoDS_Edge& aEdge = TopoDS::Edge(edgeMap(i));
-            TopLoc_Location aLoc;
-
-            // handling of the free edge that are not associated to a face
-            // Note: The assumption that if for an edge BRep_Tool::Polygon3D
-            // returns a valid object is wrong. This e.g. happens for ruled
-            // surfaces which gets created by two edges or wires.
-            // So, we have to store the hashes of the edges associated to a face.
-            // If the hash of a given edge is not in this list we know it's really
-            // a free edge.
-            int hash = aEdge.HashCode(INT_MAX);
-            if (faceEdges.find(hash) == faceEdges.end()) {
-                Handle(Poly_Polygon3D) aPoly = BRep_Tool::Polygon3D(aEdge, aLoc);
-                if (!aPoly.IsNull()) {
-                    int nbNodesInEdge = aPoly->NbNodes();
-                    numNodes += nbNodesInEdge;
-                }
-            }
-        }
-
-        // handling of the vertices
-        TopTools_IndexedMapOfShape vertexMap;
-        TopExp::MapShapes(cShape, TopAbs_VERTEX, vertexMap);
-        numNodes += vertexMap.Extent();
-
-        // create memory for the nodes and indexes
-        coords  ->point      .setNum(numNodes);
-        norm    ->vector     .setNum(numNorms);
-        faceset ->coordIndex .setNum(numTriangles*4);
-        faceset ->partIndex  .setNum(numFaces);
-        // get the raw memory for fast fill up
-        SbVec3f* verts = coords  ->point       .startEditing();
-        SbVec3f* norms = norm    ->vector      .startEditing();
-        int32_t* index = faceset ->coordIndex  .startEditing();
-        int32_t* parts = faceset ->partIndex   .startEditing();
-
-        // preset the normal vector with null vector
-        for (int i=0;i < numNorms;i++)
-            norms[i]= SbVec3f(0.0,0.0,0.0);
-
-        int ii = 0,faceNodeOffset=0,faceTriaOffset=0;
-        for (Ex.Init(cShape, TopAbs_FACE); Ex.More(); Ex.Next(),ii++) {
-            TopLoc_Location aLoc;
-            const TopoDS_Face &actFace = TopoDS::Face(Ex.Current());
-            // get the mesh of the shape
-            Handle (Poly_Triangulation) mesh = BRep_Tool::Triangulation(actFace,aLoc);
-            if (mesh.IsNull()) continue;
-
-            // getting the transformation of the shape/face
-            gp_Trsf myTransf;
-            Standard_Boolean identity = true;
-            if (!aLoc.IsIdentity()) {
-                identity = false;
-                myTransf = aLoc.Transformation();
-            }
-
-            // getting size of node and triangle array of this face
-            int nbNodesInFace = mesh->NbNodes();
-            int nbTriInFace   = mesh->NbTriangles();
-            // check orientation
-            TopAbs_Orientation orient = actFace.Orientation();
-
-
-            // cycling through the poly mesh
-            const Poly_Array1OfTriangle& Triangles = mesh->Triangles();
-            const TColgp_Array1OfPnt& Nodes = mesh->Nodes();
-            for (int g=1;g<=nbTriInFace;g++) {
-                // Get the triangle
-                Standard_Integer N1,N2,N3;
-                Triangles(g).Get(N1,N2,N3);
-
-                // change orientation of the triangle if the face is reversed
-                if ( orient != TopAbs_FORWARD ) {
-                    Standard_Integer tmp = N1;
-                    N1 = N2;
-                    N2 = tmp;
-                }
-
-                // get the 3 points of this triangle
-                gp_Pnt V1(Nodes(N1)), V2(Nodes(N2)), V3(Nodes(N3));
-
-                // transform the vertices to the place of the face
-                if (!identity) {
-                    V1.Transform(myTransf);
-                    V2.Transform(myTransf);
-                    V3.Transform(myTransf);
-                }
-                
-                // calculating per vertex normals
-                // Calculate triangle normal
-                gp_Vec v1(V1.X(),V1.Y(),V1.Z()),v2(V2.X(),V2.Y(),V2.Z()),v3(V3.X(),V3.Y(),V3.Z());
-                gp_Vec Normal = (v2-v1)^(v3-v1); 
-
-                // add the triangle normal to the vertex normal for all points of this triangle
-                norms[faceNodeOffset+N1-1] += SbVec3f(Normal.X(),Normal.Y(),Normal.Z());
-                norms[faceNodeOffset+N2-1] += SbVec3f(Normal.X(),Normal.Y(),Normal.Z());
-                norms[faceNodeOffset+N3-1] += SbVec3f(Normal.X(),Normal.Y(),Normal.Z());
-
-                // set the vertices
-                verts[faceNodeOffset+N1-1].setValue((float)(V1.X()),(float)(V1.Y()),(float)(V1.Z()));
-                verts[faceNodeOffset+N2-1].setValue((float)(V2.X()),(float)(V2.Y()),(float)(V2.Z()));
-                verts[faceNodeOffset+N3-1].setValue((float)(V3.X()),(float)(V3.Y()),(float)(V3.Z()));
-
-                // set the index vector with the 3 point indexes and the end delimiter
-                index[faceTriaOffset*4+4*(g-1)]   = faceNodeOffset+N1-1;
-                index[faceTriaOffset*4+4*(g-1)+1] = faceNodeOffset+N2-1;
-                index[faceTriaOffset*4+4*(g-1)+2] = faceNodeOffset+N3-1;
-                index[faceTriaOffset*4+4*(g-1)+3] = SO_END_FACE_INDEX;
-            }
-
-            parts[ii] = nbTriInFace; // new part
-
-            // handling the edges lying on this face
-            TopExp_Explorer Exp;
-            for(Exp.Init(actFace,TopAbs_EDGE);Exp.More();Exp.Next()) {
-                const TopoDS_Edge &curEdge = TopoDS::Edge(Exp.Current());
-                // get the overall index of this edge
-                int edgeIndex = edgeMap.FindIndex(curEdge);
-                edgeVector.push_back((int32_t)edgeIndex-1);
-                // already processed this index ?
-                if (edgeIdxSet.find(edgeIndex)!=edgeIdxSet.end()) {
-                    
-                    // this holds the indices of the edge's triangulation to the current polygon
-                    Handle(Poly_PolygonOnTriangulation) aPoly = BRep_Tool::PolygonOnTriangulation(curEdge, mesh, aLoc);
-                    if (aPoly.IsNull())
-                        continue; // polygon does not exist
-                    
-                    // getting the indexes of the edge polygon
-                    const TColStd_Array1OfInteger& indices = aPoly->Nodes();
-                    for (Standard_Integer i=indices.Lower();i <= indices.Upper();i++) {
-                        int nodeIndex = indices(i);
-                        int index = faceNodeOffset+nodeIndex-1;
-                        lineSetMap[edgeIndex].push_back(index);
-
-                        // usually the coordinates for this edge are already set by the
-                        // triangles of the face this edge belongs to. However, there are
-                        // rare cases where some points are only referenced by the polygon
-                        // but not by any triangle. Thus, we must apply the coordinates to
-                        // make sure that everything is properly set.
-                        gp_Pnt p(Nodes(nodeIndex));
-                        if (!identity)
-                            p.Transform(myTransf);
-                        verts[index].setValue((float)(p.X()),(float)(p.Y()),(float)(p.Z()));
-                    }
-
-                    // remove the handled edge index from the set
-                    edgeIdxSet.erase(edgeIndex);
-                }
-            }
-
-            edgeVector.push_back(-1);
-            
-            // counting up the per Face offsets
-            faceNodeOffset += nbNodesInFace;
-            faceTriaOffset += nbTriInFace;
-        }
-
-        // handling of the free edges
-        for (int i=1; i <= edgeMap.Extent(); i++) {
-            const TopoDS_Edge& aEdge = TopoDS::Edge(edgeMap(i));
-            Standard_Boolean identity = true;
-            gp_Trsf myTransf;
-            TopLoc_Location aLoc;
-
-            // handling of the free edge that are not associated to a face
-            int hash = aEdge.HashCode(INT_MAX);
-            if (faceEdges.find(hash) == faceEdges.end()) {
-                Handle(Poly_Polygon3D) aPoly = BRep_Tool::Polygon3D(aEdge, aLoc);
-                if (!aPoly.IsNull()) {
-                    if (!aLoc.IsIdentity()) {
-                        identity = false;
-                        myTransf = aLoc.Transformation();
-                    }
-
-                    const TColgp_Array1OfPnt& aNodes = aPoly->Nodes();
-                    int nbNodesInEdge = aPoly->NbNodes();
-
-                    gp_Pnt pnt;
-                    for (Standard_Integer j=1;j <= nbNodesInEdge;j++) {
-                        pnt = aNodes(j);
-                        if (!identity)
-                            pnt.Transform(myTransf);
-                        int index = faceNodeOffset+j-1;
-                        verts[index].setValue((float)(pnt.X()),(float)(pnt.Y()),(float)(pnt.Z()));
-                        lineSetMap[i].push_back(index);
-                    }
-
-                    faceNodeOffset += nbNodesInEdge;
-                }
-            }
-        }
-
-        nodeset->startIndex.setValue(faceNodeOffset);
-        for (int i=0; i<vertexMap.Extent(); i++) {
-            const TopoDS_Vertex& aVertex = TopoDS::Vertex(vertexMap(i+1));
-            gp_Pnt pnt = BRep_Tool::Pnt(aVertex);
-            verts[faceNodeOffset+i].setValue((float)(pnt.X()),(float)(pnt.Y()),(float)(pnt.Z()));
-        }
-
-        // normalize all normals 
-        for (int i = 0; i< numNorms ;i++)
-            norms[i].normalize();
-        
-        std::vector<int32_t> lineSetCoords;
-        for (std::map<int, std::vector<int32_t> >::iterator it = lineSetMap.begin(); it != lineSetMap.end(); ++it) {
-            lineSetCoords.insert(lineSetCoords.end(), it->second.begin(), it->second.end());
-            lineSetCoords.push_back(-1);
+        std::auto_ptr<ShapeTessellation> tessellation(new ShapeTessellation(cShape, deflection));
+
+        // Large shapes are tessellated in the background and meanwhile their bounding box
+        // is shown, so that the user interface doesn't freeze
+        ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath
+            ("User parameter:BaseApp/Preferences/Mod/Part");
+        int minFaces = hGrp->GetInt("AsyncTessellationFaces", 500);
+        TopTools_IndexedMapOfShape faceMap;
+        if (minFaces > 0)
+            TopExp::MapShapes(cShape, TopAbs_FACE, faceMap);
+        if (minFaces > 0 && faceMap.Extent() >= minFaces) {
+            // the placement is applied to the root node
+            TopoDS_Shape localShape(cShape);
+            localShape.Location(TopLoc_Location());
+            Bnd_Box localBounds;
+            BRepBndLib::Add(localShape, localBounds);
+            localBounds.SetGap(0.0);
+            localBounds.Get(xMin, yMin, zMin, xMax, yMax, zMax);
+            showBoundingBox(SbVec3f((float)xMin,(float)yMin,(float)zMin),
+                            SbVec3f((float)xMax,(float)yMax,(float)zMax));
+
+            tessellation->start();
+            pendingTessellation = tessellation.release();
+            tessellationSensor->schedule();
+            VisualTouched = false;
+            return;
         }
 
-        // preset the index vector size
-        numLines =  lineSetCoords.size();
-        lineset ->coordIndex .setNum(numLines);
-        int32_t* lines = lineset ->coordIndex  .startEditing();
-
-        int l=0;
-        for (std::vector<int32_t>::const_iterator it=lineSetCoords.begin();it!=lineSetCoords.end();++it,l++)
-            lines[l] = *it;
-
-        // end the editing of the nodes
-        coords  ->point       .finishEditing();
-        norm    ->vector      .finishEditing();
-        faceset ->coordIndex  .finishEditing();
-        faceset ->partIndex   .finishEditing();
-        lineset ->coordIndex  .finishEditing();
+        tessellation->perform();
+        applyTessellation(*tessellation);
     }
     catch (...) {
         Base::Console().Error("Cannot compute Inventor representation for the shape of %s.\n",pcObject->getNameInDocument());
@@ -927,7 +716,70 @@ void ViewProviderPartExt::updateVisual(const TopoDS_Shape& inputShape)
 #   ifdef FC_DEBUG
         // printing some informations
         Base::Console().Log("ViewProvider update time: %f s\n",Base::TimeInfo::diffTimeF(start_time,Base::TimeInfo()));
-        Base::Console().Log("Shape tria info: Faces:%d Edges:%d Nodes:%d Triangles:%d IdxVec:%d\n",numFaces,numEdges,numNodes,numTriangles,numLines);
 #   endif
     VisualTouched = false;
 }
+
+void ViewProviderPartExt::applyTessellation(const ShapeTessellation& mesh)
+{
+    if (!mesh.isValid())
+        Base::Console().Error("Cannot compute Inventor representation for the shape of %s.\n",pcObject->getNameInDocument());
+
+    setFieldValues(coords  ->point      , mesh.points);
+    setFieldValues(norm    ->vector     , mesh.normals);
+    setFieldValues(faceset ->coordIndex , mesh.faceIndices);
+    setFieldValues(faceset ->partIndex  , mesh.partIndices);
+    setFieldValues(lineset ->coordIndex , mesh.lineIndices);
+    nodeset ->startIndex .setValue(mesh.vertexStart);
+
+#   ifdef FC_DEBUG
+        // printing some informations
+        Base::Console().Log("Shape tria info: Faces:%d Nodes:%d Triangles:%d IdxVec:%d\n",
+            (int)mesh.partIndices.size(),(int)mesh.points.size(),
+            (int)mesh.faceIndices.size()/4,(int)mesh.lineIndices.size());
+#   endif
+}
+
+void ViewProviderPartExt::showBoundingBox(const SbVec3f& minPt, const SbVec3f& maxPt)
+{
+    coords->point.setNum(8);
+    SbVec3f* verts = coords->point.startEditing();
+    for (int i=0; i<8; i++) {
+        verts[i].setValue(i & 1 ? maxPt[0] : minPt[0],
+                          i & 2 ? maxPt[1] : minPt[1],
+                          i & 4 ? maxPt[2] : minPt[2]);
+    }
+    coords->point.finishEditing();
+
+    // the twelve edges of the box
+    static const int32_t lines[36] = {
+        0,1,-1, 2,3,-1, 4,5,-1, 6,7,-1,
+        0,2,-1, 1,3,-1, 4,6,-1, 5,7,-1,
+        0,4,-1, 1,5,-1, 2,6,-1, 3,7,-1
+    };
+    lineset ->coordIndex .setNum(36);
+    lineset ->coordIndex .setValues(0, 36, lines);
+    norm    ->vector     .setNum(0);
+    faceset ->coordIndex .setNum(0);
+    faceset ->partIndex  .setNum(0);
+    nodeset ->startIndex .setValue(8);
+}
+
+void ViewProviderPartExt::tessellationCallback(void * data, SoSensor * sensor)
+{
+    ViewProviderPartExt* self = reinterpret_cast<ViewProviderPartExt*>(data);
+    if (!self->pendingTessellation || !self->pendingTessellation->isFinished())
+        return;
+
+    static_cast<SoTimerSensor*>(sensor)->unschedule();
+    std::auto_ptr<ShapeTessellation> tessellation(self->pendingTessellation);
+    self->pendingTessellation = 0;
+    self->applyTessellation(*tessellation);
+
+    // now the colors per face can be applied
+    self->onChanged(&self->DiffuseColor);
+    if (self->faceset->partIndex.getNum() > 
+        self->pcShapeMaterial->diffuseColor.getNum()) {
+        self->pcShapeBind->value = SoMaterialBinding::OVERALL;
+    }
+}
@@ -50,12 +50,15 @@ class SoNormal;
 class SoNormalBinding;
 class SoMaterialBinding;
 class SoIndexedLineSet;
+class SoSensor;
+class SoTimerSensor;
 
 namespace PartGui {
 
 class SoBrepFaceSet;
 class SoBrepEdgeSet;
 class SoBrepPointSet;
+class ShapeTessellation;
 
 class PartGuiExport ViewProviderPartExt : public Gui::ViewProviderGeometryObject
 {
@@ -138,6 +141,15 @@ protected:
     bool VisualTouched;
 
 private:
+    void applyTessellation(const ShapeTessellation&);
+    void showBoundingBox(const SbVec3f& minPt, const SbVec3f& maxPt);
+    static void tessellationCallback(void * data, SoSensor * sensor);
+
+private:
+    /// The tessellation that is computed in a worker thread
+    ShapeTessellation* pendingTessellation;
+    SoTimerSensor* tessellationSensor;
+
     // settings stuff
     bool noPerVertexNormals;
     bool qualityNormals;
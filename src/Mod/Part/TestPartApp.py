@@ -19,7 +19,7 @@
 #   USA                                                                   *
 #**************************************************************************
 
-import FreeCAD, os, sys, unittest, Part
+import FreeCAD, os, sys, tempfile, unittest, Part
 App = FreeCAD
 
 #---------------------------------------------------------------------------
@@ -40,3 +40,81 @@ class PartTestCases(unittest.TestCase):
 		#closing doc
 		FreeCAD.closeDocument("PartTest")
 		#print ("omit clos document for debuging")
+
+
+class TessellationCacheCases(unittest.TestCase):
+	def setUp(self):
+		self.Doc = FreeCAD.newDocument("TessellationTest")
+		Part.clearTessellationCache()
+
+	def compareTessellation(self, tess, other, plm):
+		# the cached triangulation must give the same triangles in the same order
+		self.failUnless(tess[1] == other[1])
+		self.failUnless(len(tess[0]) == len(other[0]))
+		for p, q in zip(tess[0], other[0]):
+			self.failUnless((plm.multVec(p) - q).Length < 1e-6)
+
+	def testSameTriangles(self):
+		shape = Part.makeCylinder(2, 5)
+		first = shape.tessellate(0.05, True)
+		second = shape.tessellate(0.05, True)
+		self.compareTessellation(first, second, App.Placement())
+
+		# a face keeps its entry when the shape is copied and moved
+		plm = App.Placement(App.Vector(10, 20, 30), App.Rotation(App.Vector(1, 1, 0), 45))
+		copy = shape.copy()
+		copy.Placement = plm
+		moved = copy.tessellate(0.05, True)
+		self.compareTessellation(first, moved, plm)
+
+	def testEditedPole(self):
+		surf = Part.BSplineSurface()
+		surf.increaseDegree(3, 3)
+		surf.insertUKnot(0.5, 1, 1e-7)
+		surf.insertVKnot(0.5, 1, 1e-7)
+		for i in range(1, 6):
+			for j in range(1, 6):
+				surf.setPole(i, j, App.Vector(i, j, ((i + j) % 3) * 0.3))
+		old = surf.toShape().tessellate(0.01, True)
+
+		# an inner pole keeps the edges of the face but changes its surface
+		surf.setPole(3, 3, surf.getPole(3, 3) + App.Vector(0, 0, 1))
+		new = surf.toShape().tessellate(0.01, True)
+		for p in new[0]:
+			u, v = surf.parameter(p)
+			self.failUnless((surf.value(u, v) - p).Length < 1e-4)
+		moved = 0
+		for p in old[0]:
+			u, v = surf.parameter(p)
+			if (surf.value(u, v) - p).Length > 0.01:
+				moved = moved + 1
+		self.failUnless(moved > 0)
+
+	def testSaveTessellation(self):
+		grp = App.ParamGet("User parameter:BaseApp/Preferences/Mod/Part")
+		save = grp.GetBool("SaveTessellation", False)
+		grp.SetBool("SaveTessellation", True)
+		try:
+			feature = self.Doc.addObject("Part::Feature", "Sphere")
+			feature.Shape = Part.makeSphere(5)
+			fine = feature.Shape.tessellate(0.06, True)
+			fileName = tempfile.gettempdir() + os.sep + "TessellationTest.FCStd"
+			self.Doc.saveAs(fileName)
+		finally:
+			grp.SetBool("SaveTessellation", save)
+		FreeCAD.closeDocument("TessellationTest")
+
+		# a coarser deflection is meshed anew without the saved triangulation ...
+		Part.clearTessellationCache()
+		coarse = Part.makeSphere(5).tessellate(0.1, True)
+		self.failUnless(len(coarse[1]) != len(fine[1]))
+
+		# ... but takes the finer one of the file after loading the document
+		Part.clearTessellationCache()
+		self.Doc = FreeCAD.openDocument(fileName)
+		restored = self.Doc.getObject("Sphere").Shape.tessellate(0.1, True)
+		self.compareTessellation(fine, restored, App.Placement())
+
+	def tearDown(self):
+		FreeCAD.closeDocument(self.Doc.Name)
+		Part.clearTessellationCache()
@@ -33,13 +33,17 @@
 #include "PointsAlgos.h"
 #include "Points.h"
 
+#include <Base/AsciiParser.h>
 #include <Base/Exception.h>
 #include <Base/FileInfo.h>
 #include <Base/Console.h>
 #include <Base/Sequencer.h>
 #include <Base/Stream.h>
+#include <App/Application.h>
 
 #include <boost/regex.hpp>
+#include <QThread>
+#include <QtConcurrentMap>
 
 using namespace Points;
 
@@ -51,13 +55,64 @@ void PointsAlgos::Load(PointKernel &points, const char *FileName)
     if (!File.isReadable())
         throw Base::FileException("File to load not existing or not readable", FileName);
 
+    // The parser based on regular expressions can still be selected as fallback
+    ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath
+        ("User parameter:BaseApp/Preferences/Mod/Points");
+    long mode = hGrp->GetInt("AsciiParserMode", Base::AsciiParser::Parallel);
+    if (mode >= Base::AsciiParser::Regex && mode <= Base::AsciiParser::Parallel)
+        SetAsciiParserMode(static_cast<Base::AsciiParser::Mode>(mode));
+
     if (File.extension() == "asc" ||File.extension() == "ASC")
         LoadAscii(points,FileName);
     else
         throw Base::Exception("Unknown ending");
 }
 
-void PointsAlgos::LoadAscii(PointKernel &points, const char *FileName)
+Base::AsciiParser::Mode PointsAlgos::asciiMode = Base::AsciiParser::Parallel;
+
+void PointsAlgos::SetAsciiParserMode(Base::AsciiParser::Mode mode)
+{
+    asciiMode = mode;
+}
+
+Base::AsciiParser::Mode PointsAlgos::GetAsciiParserMode()
+{
+    return asciiMode;
+}
+
+namespace Points {
+
+typedef std::pair<const char*, const char*> TextRange;
+
+// The points of a piece of an ASCII file
+struct AsciiPiece
+{
+    AsciiPiece(const TextRange& r) : range(r)
+    {
+    }
+
+    TextRange range;
+    std::vector<Base::Vector3d> points;
+};
+
+// Reads all lines starting with three numbers, further columns are ignored
+void parseAsciiPiece(AsciiPiece& piece)
+{
+    const char* end = piece.range.second;
+    for (const char* line = piece.range.first; line != end; ) {
+        const char* eol = Base::AsciiParser::lineEnd(line, end);
+        const char* pos = line;
+        line = (eol != end) ? eol + 1 : end;
+
+        Base::Vector3d pt;
+        if ((pos = Base::AsciiParser::parseDouble(pos, eol, pt.x)) &&
+            (pos = Base::AsciiParser::parseDouble(pos, eol, pt.y)) &&
+            (pos = Base::AsciiParser::parseDouble(pos, eol, pt.z)))
+            piece.points.push_back(pt);
+    }
+}
+
+void loadAsciiWithRegex(PointKernel &points, const char *FileName)
 {
     boost::regex rx("^\\s*([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
                      "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
@@ -111,3 +166,47 @@ void PointsAlgos::LoadAscii(PointKernel &points, const char *FileName)
     if (LineCnt < (int)points.size())
         points.erase(LineCnt, points.size());
 }
+
+} // namespace Points
+
+void PointsAlgos::LoadAscii(PointKernel &points, const char *FileName)
+{
+    if (asciiMode == Base::AsciiParser::Regex) {
+        loadAsciiWithRegex(points, FileName);
+        return;
+    }
+
+    Base::FileInfo fi(FileName);
+    Base::ifstream file(fi, std::ios::in | std::ios::binary);
+
+    const std::size_t blockSize = 0x1000000;
+    Base::SequencerLauncher seq("Loading points...", fi.size() / blockSize + 1);
+
+    try {
+        points.clear();
+        std::vector<TextRange> ranges;
+        Base::AsciiBlockReader reader(file, blockSize);
+        while (reader.next()) {
+            // starting threads does not pay off for small files
+            int parts = 1;
+            if (asciiMode == Base::AsciiParser::Parallel && reader.end() - reader.begin() > 0x40000)
+                parts = std::max<int>(1, QThread::idealThreadCount());
+            Base::AsciiParser::splitLines(reader.begin(), reader.end(), parts, ranges);
+            std::vector<AsciiPiece> pieces(ranges.begin(), ranges.end());
+            if (pieces.size() > 1)
+                QtConcurrent::blockingMap(pieces, parseAsciiPiece);
+            else if (!pieces.empty())
+                parseAsciiPiece(pieces.front());
+
+            for (std::vector<AsciiPiece>::iterator it = pieces.begin(); it != pieces.end(); ++it) {
+                for (std::vector<Base::Vector3d>::iterator jt = it->points.begin(); jt != it->points.end(); ++jt)
+                    points.push_back(*jt);
+            }
+            seq.next();
+        }
+    }
+    catch (...) {
+        points.clear();
+        throw Base::Exception("Reading in points failed.");
+    }
+}
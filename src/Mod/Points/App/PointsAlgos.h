@@ -25,6 +25,7 @@
 #define _PointsAlgos_h_
 
 #include "Points.h"
+#include <Base/AsciiParser.h>
 
 namespace Points
 {
@@ -40,6 +41,13 @@ public:
   /** Load a point cloud
    */
   static void LoadAscii(PointKernel&, const char *FileName);
+  /** Sets how ASCII files are parsed. By default the files are parsed by several threads.
+   */
+  static void SetAsciiParserMode(Base::AsciiParser::Mode);
+  static Base::AsciiParser::Mode GetAsciiParserMode();
+
+private:
+  static Base::AsciiParser::Mode asciiMode;
 
 };
 
@@ -25,9 +25,12 @@
 
 #ifndef _PreComp_
 # include <algorithm>
+# include <cfloat>
+# include <climits>
 #endif
 
-
+#include <QtConcurrentMap>
+#include <boost/bind.hpp>
 
 #include "PointsGrid.h"
 
@@ -95,7 +98,9 @@ void PointsGrid::Attach (const PointKernel &rclM)
 
 void PointsGrid::Clear (void)
 {
-  _aulGrid.clear();
+  std::vector<unsigned long>().swap(_aulGridOffsets);
+  std::vector<unsigned long>().swap(_aulGridElements);
+  std::vector<Base::Vector3d>().swap(_aclGridPoints);
   _pclPoints = NULL;  
 }
 
@@ -126,8 +131,6 @@ void PointsGrid::InitGrid (void)
 {
   assert(_pclPoints != NULL);
 
-  unsigned long i, j;
-
   // Grid Laengen berechnen wenn nicht initialisiert
   //
   if ((_ulCtGridsX == 0) || (_ulCtGridsX == 0) || (_ulCtGridsX == 0))
@@ -163,14 +166,9 @@ void PointsGrid::InitGrid (void)
   }
 
   // Daten-Struktur anlegen
-  _aulGrid.clear();
-  _aulGrid.resize(_ulCtGridsX);
-  for (i = 0; i < _ulCtGridsX; i++)
-  {
-    _aulGrid[i].resize(_ulCtGridsY);
-    for (j = 0; j < _ulCtGridsY; j++)
-      _aulGrid[i][j].resize(_ulCtGridsZ);
-  }
+  _aulGridOffsets.assign(_ulCtGridsX * _ulCtGridsY * _ulCtGridsZ + 1, 0);
+  std::vector<unsigned long>().swap(_aulGridElements);
+  std::vector<Base::Vector3d>().swap(_aclGridPoints);
 }
 
 unsigned long PointsGrid::InSide (const Base::BoundBox3d &rclBB, std::vector<unsigned long> &raulElements, bool bDelDoubles) const
@@ -189,7 +187,7 @@ unsigned long PointsGrid::InSide (const Base::BoundBox3d &rclBB, std::vector<uns
     {
       for (k = ulMinZ; k <= ulMaxZ; k++)
       {
-        raulElements.insert(raulElements.end(), _aulGrid[i][j][k].begin(), _aulGrid[i][j][k].end());
+        raulElements.insert(raulElements.end(), GridBegin(i, j, k), GridEnd(i, j, k));
       }
     }
   }  
@@ -223,7 +221,7 @@ unsigned long PointsGrid::InSide (const Base::BoundBox3d &rclBB, std::vector<uns
       for (k = ulMinZ; k <= ulMaxZ; k++)
       {
         if (Base::DistanceP2(GetBoundBox(i, j, k).CalcCenter(), rclOrg) < fMinDistP2)
-          raulElements.insert(raulElements.end(), _aulGrid[i][j][k].begin(), _aulGrid[i][j][k].end());
+          raulElements.insert(raulElements.end(), GridBegin(i, j, k), GridEnd(i, j, k));
       }
     }
   }  
@@ -254,7 +252,7 @@ unsigned long PointsGrid::InSide (const Base::BoundBox3d &rclBB, std::set<unsign
     {
       for (k = ulMinZ; k <= ulMaxZ; k++)
       {
-        raulElements.insert(_aulGrid[i][j][k].begin(), _aulGrid[i][j][k].end());
+        raulElements.insert(GridBegin(i, j, k), GridEnd(i, j, k));
       }
     }
   }  
@@ -475,7 +473,7 @@ void PointsGrid::SearchNearestFromPoint (const Base::Vector3d &rclPt, std::set<u
           for (unsigned long i = 0; i < _ulCtGridsY; i++)
           {
             for (unsigned long j = 0; j < _ulCtGridsZ; j++)
-              raclInd.insert(_aulGrid[nX][i][j].begin(), _aulGrid[nX][i][j].end());
+              raclInd.insert(GridBegin(nX, i, j), GridEnd(nX, i, j));
           }
           nX++;
         }
@@ -489,7 +487,7 @@ void PointsGrid::SearchNearestFromPoint (const Base::Vector3d &rclPt, std::set<u
           for (unsigned long i = 0; i < _ulCtGridsY; i++)
           {
             for (unsigned long j = 0; j < _ulCtGridsZ; j++)
-              raclInd.insert(_aulGrid[nX][i][j].begin(), _aulGrid[nX][i][j].end());
+              raclInd.insert(GridBegin(nX, i, j), GridEnd(nX, i, j));
           }
           nX++;
         }
@@ -503,7 +501,7 @@ void PointsGrid::SearchNearestFromPoint (const Base::Vector3d &rclPt, std::set<u
           for (unsigned long i = 0; i < _ulCtGridsX; i++)
           {
             for (unsigned long j = 0; j < _ulCtGridsZ; j++)
-              raclInd.insert(_aulGrid[i][nY][j].begin(), _aulGrid[i][nY][j].end());
+              raclInd.insert(GridBegin(i, nY, j), GridEnd(i, nY, j));
           }
           nY++;
         }
@@ -517,7 +515,7 @@ void PointsGrid::SearchNearestFromPoint (const Base::Vector3d &rclPt, std::set<u
           for (unsigned long i = 0; i < _ulCtGridsX; i++)
           {
             for (unsigned long j = 0; j < _ulCtGridsZ; j++)
-              raclInd.insert(_aulGrid[i][nY][j].begin(), _aulGrid[i][nY][j].end());
+              raclInd.insert(GridBegin(i, nY, j), GridEnd(i, nY, j));
           }
           nY--;
         }
@@ -531,7 +529,7 @@ void PointsGrid::SearchNearestFromPoint (const Base::Vector3d &rclPt, std::set<u
           for (unsigned long i = 0; i < _ulCtGridsX; i++)
           {
             for (unsigned long j = 0; j < _ulCtGridsY; j++)
-              raclInd.insert(_aulGrid[i][j][nZ].begin(), _aulGrid[i][j][nZ].end());
+              raclInd.insert(GridBegin(i, j, nZ), GridEnd(i, j, nZ));
           }
           nZ++;
         }
@@ -545,7 +543,7 @@ void PointsGrid::SearchNearestFromPoint (const Base::Vector3d &rclPt, std::set<u
           for (unsigned long i = 0; i < _ulCtGridsX; i++)
           {
             for (unsigned long j = 0; j < _ulCtGridsY; j++)
-              raclInd.insert(_aulGrid[i][j][nZ].begin(), _aulGrid[i][j][nZ].end());
+              raclInd.insert(GridBegin(i, j, nZ), GridEnd(i, j, nZ));
           }
           nZ--;
         }
@@ -611,22 +609,213 @@ void PointsGrid::GetHull (unsigned long ulX, unsigned long ulY, unsigned long ul
 unsigned long PointsGrid::GetElements (unsigned long ulX, unsigned long ulY, unsigned long ulZ,  
                                      std::set<unsigned long> &raclInd) const
 {
-  const std::set<unsigned long> &rclSet = _aulGrid[ulX][ulY][ulZ];
-  if (rclSet.size() > 0)
+  std::vector<unsigned long>::const_iterator itBegin = GridBegin(ulX, ulY, ulZ);
+  std::vector<unsigned long>::const_iterator itEnd = GridEnd(ulX, ulY, ulZ);
+  if (itBegin != itEnd)
   {
-    raclInd.insert(rclSet.begin(), rclSet.end());
-    return rclSet.size();
+    raclInd.insert(itBegin, itEnd);
+    return itEnd - itBegin;
   }
 
   return 0;
 }
 
-void PointsGrid::AddPoint (const Base::Vector3d &rclPt, unsigned long ulPtIndex, float fEpsilon)
+void PointsGrid::AddNearest (unsigned long ulIndex, const Base::Vector3d &rclPt, unsigned long ulCount,
+                             std::vector<std::pair<double, unsigned long> > &raclHeap) const
 {
+  for (unsigned long i = _aulGridOffsets[ulIndex]; i < _aulGridOffsets[ulIndex+1]; i++)
+  {
+    double fDist = Base::DistanceP2(rclPt, _aclGridPoints[i]);
+    if (raclHeap.size() < ulCount)
+    {
+      raclHeap.push_back(std::make_pair(fDist, _aulGridElements[i]));
+      std::push_heap(raclHeap.begin(), raclHeap.end());
+    }
+    else if (fDist < raclHeap.front().first)
+    {
+      // replace the farthest of the nearest points
+      std::pop_heap(raclHeap.begin(), raclHeap.end());
+      raclHeap.back() = std::make_pair(fDist, _aulGridElements[i]);
+      std::push_heap(raclHeap.begin(), raclHeap.end());
+    }
+  }
+}
+
+unsigned long PointsGrid::SearchNearest (const Base::Vector3d &rclPt, unsigned long ulCount, std::vector<unsigned long> &raulElements,
+                                         std::vector<double> &rafDistances) const
+{
+  raulElements.clear();
+  rafDistances.clear();
+  if (ulCount == 0 || _aulGridElements.empty())
+    return 0;
+
+  std::vector<std::pair<double, unsigned long> > aclHeap;
+  aclHeap.reserve(ulCount);
+
   unsigned long ulX, ulY, ulZ;
-  Pos(Base::Vector3d(rclPt.x, rclPt.y, rclPt.z), ulX, ulY, ulZ);
-  if ( (ulX < _ulCtGridsX) && (ulY < _ulCtGridsY) && (ulZ < _ulCtGridsZ) )
-    _aulGrid[ulX][ulY][ulZ].insert(ulPtIndex);
+  Position(rclPt, ulX, ulY, ulZ);
+  long nCtX = long(_ulCtGridsX), nCtY = long(_ulCtGridsY), nCtZ = long(_ulCtGridsZ);
+  long nMaxLevel = std::max<long>(std::max<long>(nCtX, nCtY), nCtZ);
+
+  // search the hulls around the grid of the point until no grid outside can contain a nearer point
+  for (long nLevel = 0; nLevel < nMaxLevel; nLevel++)
+  {
+    long nX1 = long(ulX) - nLevel, nY1 = long(ulY) - nLevel, nZ1 = long(ulZ) - nLevel;
+    long nX2 = long(ulX) + nLevel, nY2 = long(ulY) + nLevel, nZ2 = long(ulZ) + nLevel;
+    long nMinX = std::max<long>(nX1, 0), nMaxX = std::min<long>(nX2, nCtX - 1);
+
+    for (long k = std::max<long>(nZ1, 0); k <= std::min<long>(nZ2, nCtZ - 1); k++)
+    {
+      for (long j = std::max<long>(nY1, 0); j <= std::min<long>(nY2, nCtY - 1); j++)
+      {
+        if (k == nZ1 || k == nZ2 || j == nY1 || j == nY2)
+        {
+          for (long i = nMinX; i <= nMaxX; i++)
+            AddNearest(GridIndex(i, j, k), rclPt, ulCount, aclHeap);
+        }
+        else
+        {
+          if (nX1 >= 0)
+            AddNearest(GridIndex(nX1, j, k), rclPt, ulCount, aclHeap);
+          if (nX2 < nCtX)
+            AddNearest(GridIndex(nX2, j, k), rclPt, ulCount, aclHeap);
+        }
+      }
+    }
+
+    // the distance to the nearest grid that is not yet searched
+    double fDist = DBL_MAX;
+    if (nX1 > 0)
+      fDist = std::min<double>(fDist, rclPt.x - (_fMinX + double(nX1) * _fGridLenX));
+    if (nX2 < nCtX - 1)
+      fDist = std::min<double>(fDist, (_fMinX + double(nX2 + 1) * _fGridLenX) - rclPt.x);
+    if (nY1 > 0)
+      fDist = std::min<double>(fDist, rclPt.y - (_fMinY + double(nY1) * _fGridLenY));
+    if (nY2 < nCtY - 1)
+      fDist = std::min<double>(fDist, (_fMinY + double(nY2 + 1) * _fGridLenY) - rclPt.y);
+    if (nZ1 > 0)
+      fDist = std::min<double>(fDist, rclPt.z - (_fMinZ + double(nZ1) * _fGridLenZ));
+    if (nZ2 < nCtZ - 1)
+      fDist = std::min<double>(fDist, (_fMinZ + double(nZ2 + 1) * _fGridLenZ) - rclPt.z);
+
+    if (fDist == DBL_MAX)
+      break; // all grids searched
+    if (aclHeap.size() == ulCount && fDist > 0.0 && fDist * fDist >= aclHeap.front().first)
+      break;
+  }
+
+  std::sort_heap(aclHeap.begin(), aclHeap.end());
+  raulElements.reserve(aclHeap.size());
+  rafDistances.reserve(aclHeap.size());
+  for (std::vector<std::pair<double, unsigned long> >::iterator it = aclHeap.begin(); it != aclHeap.end(); ++it)
+  {
+    raulElements.push_back(it->second);
+    rafDistances.push_back(sqrt(it->first));
+  }
+
+  return raulElements.size();
+}
+
+unsigned long PointsGrid::SearchRadius (const Base::Vector3d &rclPt, double fRadius, std::vector<unsigned long> &raulElements) const
+{
+  unsigned long j, k, ulMinX, ulMinY, ulMinZ,  ulMaxX, ulMaxY, ulMaxZ;
+
+  raulElements.clear();
+  if (fRadius < 0.0 || _aulGridElements.empty())
+    return 0;
+
+  Position(Base::Vector3d(rclPt.x - fRadius, rclPt.y - fRadius, rclPt.z - fRadius), ulMinX, ulMinY, ulMinZ);
+  Position(Base::Vector3d(rclPt.x + fRadius, rclPt.y + fRadius, rclPt.z + fRadius), ulMaxX, ulMaxY, ulMaxZ);
+
+  double fRadius2 = fRadius * fRadius;
+  for (k = ulMinZ; k <= ulMaxZ; k++)
+  {
+    for (j = ulMinY; j <= ulMaxY; j++)
+    {
+      unsigned long ulBegin = _aulGridOffsets[GridIndex(ulMinX, j, k)];
+      unsigned long ulEnd = _aulGridOffsets[GridIndex(ulMaxX, j, k) + 1];
+      for (unsigned long p = ulBegin; p < ulEnd; p++)
+      {
+        if (Base::DistanceP2(rclPt, _aclGridPoints[p]) <= fRadius2)
+          raulElements.push_back(_aulGridElements[p]);
+      }
+    }
+  }
+
+  std::sort(raulElements.begin(), raulElements.end());
+  return raulElements.size();
+}
+
+unsigned long PointsGrid::SearchNearest (const std::vector<Base::Vector3d> &raclPoints, unsigned long ulCount,
+                                         std::vector<unsigned long> &raulElements, std::vector<double> &rafDistances) const
+{
+  // there are never more neighbours than points
+  ulCount = std::min<unsigned long>(ulCount, _aulGridElements.size());
+  raulElements.assign(raclPoints.size() * ulCount, ULONG_MAX);
+  rafDistances.assign(raclPoints.size() * ulCount, DBL_MAX);
+
+  SearchBlock clBlock;
+  clBlock.paclPoints = &raclPoints;
+  clBlock.ulCount = ulCount;
+  clBlock.fRadius = 0.0;
+  clBlock.paulElements = &raulElements;
+  clBlock.pafDistances = &rafDistances;
+  clBlock.paaulElements = 0;
+  SearchBlocks(raclPoints.size(), clBlock, &PointsGrid::NearestBlock);
+  return ulCount;
+}
+
+void PointsGrid::SearchRadius (const std::vector<Base::Vector3d> &raclPoints, double fRadius,
+                               std::vector<std::vector<unsigned long> > &raulElements) const
+{
+  raulElements.clear();
+  raulElements.resize(raclPoints.size());
+
+  SearchBlock clBlock;
+  clBlock.paclPoints = &raclPoints;
+  clBlock.ulCount = 0;
+  clBlock.fRadius = fRadius;
+  clBlock.paulElements = 0;
+  clBlock.pafDistances = 0;
+  clBlock.paaulElements = &raulElements;
+  SearchBlocks(raclPoints.size(), clBlock, &PointsGrid::RadiusBlock);
+}
+
+void PointsGrid::SearchBlocks (unsigned long ulPoints, SearchBlock &rclTemplate,
+                               void (PointsGrid::*pfnSearch)(SearchBlock&) const) const
+{
+  // each block writes to its own part of the result, so the blocks can be searched in any order
+  std::vector<SearchBlock> aclBlocks;
+  for (unsigned long i = 0; i < ulPoints; i += POINTS_CT_SEARCH_BLOCK)
+  {
+    SearchBlock clBlock = rclTemplate;
+    clBlock.ulBegin = i;
+    clBlock.ulEnd = std::min<unsigned long>(i + POINTS_CT_SEARCH_BLOCK, ulPoints);
+    aclBlocks.push_back(clBlock);
+  }
+
+  if (aclBlocks.size() > 1)
+    QtConcurrent::blockingMap(aclBlocks, boost::bind(pfnSearch, this, _1));
+  else if (!aclBlocks.empty())
+    (this->*pfnSearch)(aclBlocks.front());
+}
+
+void PointsGrid::NearestBlock (SearchBlock &rclBlock) const
+{
+  std::vector<unsigned long> aulElements;
+  std::vector<double> afDistances;
+  for (unsigned long i = rclBlock.ulBegin; i < rclBlock.ulEnd; i++)
+  {
+    SearchNearest((*rclBlock.paclPoints)[i], rclBlock.ulCount, aulElements, afDistances);
+    std::copy(aulElements.begin(), aulElements.end(), rclBlock.paulElements->begin() + i * rclBlock.ulCount);
+    std::copy(afDistances.begin(), afDistances.end(), rclBlock.pafDistances->begin() + i * rclBlock.ulCount);
+  }
+}
+
+void PointsGrid::RadiusBlock (SearchBlock &rclBlock) const
+{
+  for (unsigned long i = rclBlock.ulBegin; i < rclBlock.ulEnd; i++)
+    SearchRadius((*rclBlock.paclPoints)[i], rclBlock.fRadius, (*rclBlock.paaulElements)[i]);
 }
 
 void PointsGrid::Validate (const PointKernel &rclPoints)
@@ -669,6 +858,21 @@ bool PointsGrid::Verify() const
   return true;
 }
 
+void PointsGrid::CollectBlock (const GridBlock &rclBlock, std::vector<unsigned long> &raulGrids) const
+{
+  unsigned long ulX, ulY, ulZ;
+  unsigned long ulCtGrids = _aulGridOffsets.size() - 1;
+  PointKernel::const_iterator it = _pclPoints->begin() + rclBlock.ulBegin;
+  for (unsigned long i = rclBlock.ulBegin; i < rclBlock.ulEnd; i++, ++it)
+  {
+    Pos(*it, ulX, ulY, ulZ);
+    if ( (ulX < _ulCtGridsX) && (ulY < _ulCtGridsY) && (ulZ < _ulCtGridsZ) )
+      raulGrids[i] = GridIndex(ulX, ulY, ulZ);
+    else
+      raulGrids[i] = ulCtGrids;
+  }
+}
+
 void PointsGrid::RebuildGrid (void)
 {
   _ulCtElements = _pclPoints->size();
@@ -677,10 +881,48 @@ void PointsGrid::RebuildGrid (void)
  
   // Daten-Struktur fuellen
 
-  unsigned long i = 0;
-  for (PointKernel::const_iterator it = _pclPoints->begin(); it != _pclPoints->end(); ++it )
+  // the grid of each point, large point clouds are split into blocks that are handled in parallel
+  std::vector<unsigned long> aulGrids(_ulCtElements);
+  std::vector<GridBlock> aclBlocks;
+  for (unsigned long i = 0; i < _ulCtElements; i += POINTS_CT_GRID_BLOCK)
+  {
+    GridBlock clBlock;
+    clBlock.ulBegin = i;
+    clBlock.ulEnd = std::min<unsigned long>(i + POINTS_CT_GRID_BLOCK, _ulCtElements);
+    aclBlocks.push_back(clBlock);
+  }
+
+  if (aclBlocks.size() > 1)
+    QtConcurrent::blockingMap(aclBlocks, boost::bind(&PointsGrid::CollectBlock, this, _1, boost::ref(aulGrids)));
+  else if (!aclBlocks.empty())
+    CollectBlock(aclBlocks.front(), aulGrids);
+
+  // first pass: count the points of each grid
+  unsigned long ulCtGrids = _aulGridOffsets.size() - 1;
+  std::vector<unsigned long>::iterator it;
+  for (it = aulGrids.begin(); it != aulGrids.end(); ++it)
   {
-    AddPoint(*it, i++);
+    if (*it < ulCtGrids)
+      _aulGridOffsets[*it + 1]++;
+  }
+
+  for (std::vector<unsigned long>::size_type i = 1; i < _aulGridOffsets.size(); i++)
+    _aulGridOffsets[i] += _aulGridOffsets[i-1];
+
+  // second pass: copy the point indices and the points to their grids, the indices of each grid are sorted
+  std::vector<unsigned long> aulPos(_aulGridOffsets.begin(), _aulGridOffsets.end() - 1);
+  _aulGridElements.resize(_aulGridOffsets.back());
+  _aclGridPoints.resize(_aulGridOffsets.back());
+  unsigned long ulIndex = 0;
+  for (PointKernel::const_iterator jt = _pclPoints->begin(); jt != _pclPoints->end(); ++jt, ++ulIndex)
+  {
+    unsigned long ulGrid = aulGrids[ulIndex];
+    if (ulGrid < ulCtGrids)
+    {
+      unsigned long ulPos = aulPos[ulGrid]++;
+      _aulGridElements[ulPos] = ulIndex;
+      _aclGridPoints[ulPos] = *jt;
+    }
   }
 }
 
@@ -743,7 +985,7 @@ bool PointsGridIterator::InitOnRay (const Base::Vector3d &rclPt, const Base::Vec
   if ((_rclGrid.GetBoundBox().IsInBox(rclPt)) == true)
   {  // Voxel bestimmen, indem der Startpunkt liegt
     _rclGrid.Position(rclPt, _ulX, _ulY, _ulZ);
-    raulElements.insert(raulElements.end(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].begin(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].end());
+    raulElements.insert(raulElements.end(), _rclGrid.GridBegin(_ulX, _ulY, _ulZ), _rclGrid.GridEnd(_ulX, _ulY, _ulZ));
     _bValidRay = true;
   }
   else
@@ -756,7 +998,7 @@ bool PointsGridIterator::InitOnRay (const Base::Vector3d &rclPt, const Base::Vec
       else
         _rclGrid.Position(cP1, _ulX, _ulY, _ulZ);
 
-      raulElements.insert(raulElements.end(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].begin(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].end());
+      raulElements.insert(raulElements.end(), _rclGrid.GridBegin(_ulX, _ulY, _ulZ), _rclGrid.GridEnd(_ulX, _ulY, _ulZ));
       _bValidRay = true;
     }
   }
@@ -807,7 +1049,7 @@ bool PointsGridIterator::NextOnRay (std::vector<unsigned long> &raulElements)
   if ((_bValidRay == true) && (_rclGrid.CheckPos(_ulX, _ulY, _ulZ) == true))
   {
     GridElement pos(_ulX, _ulY, _ulZ); _cSearchPositions.insert(pos);
-    raulElements.insert(raulElements.end(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].begin(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].end()); 
+    raulElements.insert(raulElements.end(), _rclGrid.GridBegin(_ulX, _ulY, _ulZ), _rclGrid.GridEnd(_ulX, _ulY, _ulZ)); 
   }
   else
     _bValidRay = false;  // Strahl ausgetreten
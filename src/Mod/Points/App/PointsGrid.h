@@ -25,6 +25,7 @@
 #define POINTS_GRID_H
 
 #include <set>
+#include <vector>
 
 #include "Points.h"
 #include <Base/Vector3D.h>
@@ -34,6 +35,8 @@
 #define  POINTS_MAX_GRIDS        100000  // Default value for maximum number of grids
 #define  POINTS_CT_GRID_PER_AXIS 20
 #define  PONTSGRID_BBOX_EXTENSION 10.0f
+#define  POINTS_CT_GRID_BLOCK    65536   // Number of points a thread sorts into the grid at once
+#define  POINTS_CT_SEARCH_BLOCK  1024    // Number of points a thread searches the neighbours for at once
 
 
 namespace Points {
@@ -44,6 +47,10 @@ class PointsGrid;
  * All grid elements in the grid structure have the same size.
  *
  * Grids can be used within algorithms to avoid to iterate through all elements, so grids can speed up algorithms dramatically.
+ *
+ * The point indices of all grids are kept in one contiguous array sorted by grid, an offset array points to the
+ * first index of each grid. A copy of the points is stored in the same order, so that the nearest neighbour and
+ * radius searches read the coordinates of a grid from consecutive memory.
  * @author Werner Mayer
  */
 class PointsExport PointsGrid
@@ -87,6 +94,21 @@ public:
                                 const Base::Vector3d &rclOrg, double fMaxDist, bool bDelDoubles = true) const;
   /** Searches for the nearest grids that contain elements from a point, the result are grid indices. */
   void SearchNearestFromPoint (const Base::Vector3d &rclPt, std::set<unsigned long> &rclInd) const;
+  /** Searches for the \a ulCount points nearest to \a rclPt. The indices are sorted by their distance which is
+   * returned in \a rafDistances. Returns the number of found points which is less than \a ulCount only if the
+   * point cloud is smaller. */
+  unsigned long SearchNearest (const Base::Vector3d &rclPt, unsigned long ulCount, std::vector<unsigned long> &raulElements,
+                               std::vector<double> &rafDistances) const;
+  /** Searches for the points with a distance to \a rclPt of at most \a fRadius. */
+  unsigned long SearchRadius (const Base::Vector3d &rclPt, double fRadius, std::vector<unsigned long> &raulElements) const;
+  /** Searches for the \a ulCount nearest points of each point of \a raclPoints in several threads. \a ulCount is
+   * limited to the number of points in the grid and the limited value is returned. The neighbours of the i-th
+   * point start at position i times this value in \a raulElements and \a rafDistances. */
+  unsigned long SearchNearest (const std::vector<Base::Vector3d> &raclPoints, unsigned long ulCount,
+                               std::vector<unsigned long> &raulElements, std::vector<double> &rafDistances) const;
+  /** Searches for the points within \a fRadius of each point of \a raclPoints in several threads. */
+  void SearchRadius (const std::vector<Base::Vector3d> &raclPoints, double fRadius,
+                     std::vector<std::vector<unsigned long> > &raulElements) const;
   //@}
 
   /** Returns the lengths of the grid elements in x,y and z direction. */
@@ -105,7 +127,7 @@ public:
   //@}
   /** Returns the number of elements in a given grid. */
   unsigned long GetCtElements(unsigned long ulX, unsigned long ulY, unsigned long ulZ) const
-  { return _aulGrid[ulX][ulY][ulZ].size(); }
+  { unsigned long ulIndex = GridIndex(ulX, ulY, ulZ); return _aulGridOffsets[ulIndex+1] - _aulGridOffsets[ulIndex]; }
   /** Finds all points that lie in the same grid as the point \a rclPoint. */
   unsigned long FindElements(const Base::Vector3d &rclPoint, std::set<unsigned long>& aulElements) const;
   /** Validates the grid structure and rebuilds it if needed. */
@@ -139,8 +161,48 @@ protected:
   /** Get the indices of all elements lying in the grids around a given grid with distance \a ulDistance. */
   void GetHull (unsigned long ulX, unsigned long ulY, unsigned long ulZ, unsigned long ulDistance, std::set<unsigned long> &raclInd) const;
 
+  /** @name Grid storage */
+  //@{
+  /** Returns the index of a grid in the flat storage. */
+  inline unsigned long GridIndex (unsigned long ulX, unsigned long ulY, unsigned long ulZ) const
+  { return (ulZ * _ulCtGridsY + ulY) * _ulCtGridsX + ulX; }
+  /** Returns the first element index of a grid. */
+  inline std::vector<unsigned long>::const_iterator GridBegin (unsigned long ulX, unsigned long ulY, unsigned long ulZ) const
+  { return _aulGridElements.begin() + _aulGridOffsets[GridIndex(ulX, ulY, ulZ)]; }
+  /** Returns the position after the last element index of a grid. */
+  inline std::vector<unsigned long>::const_iterator GridEnd (unsigned long ulX, unsigned long ulY, unsigned long ulZ) const
+  { return _aulGridElements.begin() + _aulGridOffsets[GridIndex(ulX, ulY, ulZ)+1]; }
+  //@}
+
+private:
+  /// A range of points to be sorted into the grid or searched for
+  struct GridBlock
+  {
+    unsigned long ulBegin, ulEnd;
+  };
+  /// The queries of the batched searches
+  struct SearchBlock
+  {
+    unsigned long ulBegin, ulEnd;
+    const std::vector<Base::Vector3d>* paclPoints;
+    unsigned long ulCount;
+    double fRadius;
+    std::vector<unsigned long>* paulElements;
+    std::vector<double>* pafDistances;
+    std::vector<std::vector<unsigned long> >* paaulElements;
+  };
+  void CollectBlock (const GridBlock &rclBlock, std::vector<unsigned long> &raulGrids) const;
+  void NearestBlock (SearchBlock &rclBlock) const;
+  void RadiusBlock (SearchBlock &rclBlock) const;
+  void SearchBlocks (unsigned long ulPoints, SearchBlock &rclTemplate, void (PointsGrid::*pfnSearch)(SearchBlock&) const) const;
+  /** Adds the points of a grid to the \a ulCount nearest points found so far, which are kept as heap. */
+  void AddNearest (unsigned long ulIndex, const Base::Vector3d &rclPt, unsigned long ulCount,
+                   std::vector<std::pair<double, unsigned long> > &raclHeap) const;
+
 protected:
-  std::vector<std::vector<std::vector<std::set<unsigned long> > > >  _aulGrid;   /**< Grid data structure. */
+  std::vector<unsigned long> _aulGridOffsets;  /**< Start of each grid in _aulGridElements, with one additional end entry. */
+  std::vector<unsigned long> _aulGridElements; /**< Point indices of all grids. */
+  std::vector<Base::Vector3d> _aclGridPoints;  /**< The points in the order of _aulGridElements. */
   const PointKernel* _pclPoints;  /**< The point kernel. */
   unsigned long     _ulCtElements;/**< Number of grid elements for validation issues. */
   unsigned long     _ulCtGridsX;  /**< Number of grid elements in z. */
@@ -160,9 +222,6 @@ protected:
 public:
 
 protected:
-  /** Adds a new point element to the grid structure. \a rclPt is the geometric point and \a ulPtIndex 
-   * the corresponding index in the point kernel. */
-  void AddPoint (const Base::Vector3d &rclPt, unsigned long ulPtIndex, float fEpsilon = 0.0f);
   /** Returns the grid numbers to the given point \a rclPoint. */
   void Pos(const Base::Vector3d &rclPoint, unsigned long &rulX, unsigned long &rulY, unsigned long &rulZ) const;
 };
@@ -182,7 +241,7 @@ public:
   /** Returns indices of the elements in the current grid. */
   void GetElements (std::vector<unsigned long> &raulElements) const
   {
-    raulElements.insert(raulElements.end(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].begin(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].end());
+    raulElements.insert(raulElements.end(), _rclGrid.GridBegin(_ulX, _ulY, _ulZ), _rclGrid.GridEnd(_ulX, _ulY, _ulZ));
   }
   /** @name Iteration */
   //@{
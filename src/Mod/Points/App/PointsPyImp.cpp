@@ -23,7 +23,11 @@
 
 #include "PreCompiled.h"
 
+#include <algorithm>
+#include <climits>
+
 #include "Mod/Points/App/Points.h"
+#include "Mod/Points/App/PointsGrid.h"
 #include <Base/Builder3D.h>
 #include <Base/VectorPy.h>
 #include <Base/GeometryPyCXX.h>
@@ -168,6 +172,127 @@ PyObject* PointsPy::addPoints(PyObject * args)
     Py_Return;
 }
 
+// converts a vector or a sequence of vectors or tuples into a list of points
+static bool getSearchPoints(PyObject* obj, std::vector<Base::Vector3d>& points)
+{
+    if (PyObject_TypeCheck(obj, &(Base::VectorPy::Type))) {
+        points.push_back(*static_cast<Base::VectorPy*>(obj)->getVectorPtr());
+        return true;
+    }
+
+    Py::Sequence list(obj);
+    union PyType_Object pyType = {&(Base::VectorPy::Type)};
+    Py::Type vType(pyType.o);
+    for (Py::Sequence::iterator it = list.begin(); it != list.end(); ++it) {
+        if ((*it).isType(vType)) {
+            Py::Vector p(*it);
+            points.push_back(p.toVector());
+        }
+        else {
+            Py::Tuple tuple(*it);
+            points.push_back(Base::Vector3d((double)Py::Float(tuple[0]),
+                                            (double)Py::Float(tuple[1]),
+                                            (double)Py::Float(tuple[2])));
+        }
+    }
+    return false;
+}
+
+PyObject* PointsPy::nearestPoints(PyObject * args)
+{
+    PyObject *obj;
+    int count = 1;
+    if (!PyArg_ParseTuple(args, "O|i", &obj, &count))
+        return 0;
+    if (count < 1) {
+        PyErr_SetString(PyExc_ValueError, "number of points must be positive");
+        return 0;
+    }
+
+    std::vector<Base::Vector3d> points;
+    bool single;
+    try {
+        single = getSearchPoints(obj, points);
+    }
+    catch (const Py::Exception&) {
+        PyErr_SetString(PyExc_Exception, "either expect\n"
+            "-- Vector \n"
+            "-- [Vector,...] \n"
+            "-- [(x,y,z),...]");
+        return 0;
+    }
+
+    PY_TRY {
+        std::vector<unsigned long> indices;
+        std::vector<double> distances;
+        const PointKernel* kernel = getPointKernelPtr();
+        // there are never more neighbours than points
+        unsigned long stride = std::min<unsigned long>((unsigned long)count, kernel->size());
+        if (stride > 0) {
+            PointsGrid grid(*kernel, 50);
+            stride = grid.SearchNearest(points, stride, indices, distances);
+        }
+
+        Py::List result;
+        for (std::vector<Base::Vector3d>::size_type i = 0; i < points.size(); i++) {
+            Py::List neighbours;
+            for (unsigned long j = i * stride; j < indices.size() && j < (i + 1) * stride; j++) {
+                if (indices[j] != ULONG_MAX)
+                    neighbours.append(Py::Int((long)indices[j]));
+            }
+            if (single)
+                return Py::new_reference_to(neighbours);
+            result.append(neighbours);
+        }
+        return Py::new_reference_to(result);
+    } PY_CATCH;
+
+    Py_Return;
+}
+
+PyObject* PointsPy::pointsInRadius(PyObject * args)
+{
+    PyObject *obj;
+    double radius;
+    if (!PyArg_ParseTuple(args, "Od", &obj, &radius))
+        return 0;
+
+    std::vector<Base::Vector3d> points;
+    bool single;
+    try {
+        single = getSearchPoints(obj, points);
+    }
+    catch (const Py::Exception&) {
+        PyErr_SetString(PyExc_Exception, "either expect\n"
+            "-- Vector \n"
+            "-- [Vector,...] \n"
+            "-- [(x,y,z),...]");
+        return 0;
+    }
+
+    PY_TRY {
+        std::vector<std::vector<unsigned long> > indices(points.size());
+        const PointKernel* kernel = getPointKernelPtr();
+        if (kernel->size() > 0) {
+            PointsGrid grid(*kernel, 50);
+            grid.SearchRadius(points, radius, indices);
+        }
+
+        Py::List result;
+        for (std::vector<std::vector<unsigned long> >::iterator it = indices.begin(); it != indices.end(); ++it) {
+            Py::List neighbours;
+            for (std::vector<unsigned long>::iterator jt = it->begin(); jt != it->end(); ++jt)
+                neighbours.append(Py::Int((long)*jt));
+            if (single)
+                return Py::new_reference_to(neighbours);
+            result.append(neighbours);
+        }
+        return Py::new_reference_to(result);
+    } PY_CATCH;
+
+    Py_Return;
+}
+
 Py::Int PointsPy::getCountPoints(void) const
 {
     return Py::Int((long)getPointKernelPtr()->size());
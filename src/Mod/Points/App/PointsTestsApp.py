@@ -0,0 +1,123 @@
+#   (c) FreeCAD Developers 2026      LGPL
+
+import FreeCAD, os, tempfile, unittest, Points, random
+
+
+#---------------------------------------------------------------------------
+# define the functions to test the FreeCAD points module
+#---------------------------------------------------------------------------
+
+
+class NeighbourSearchCases(unittest.TestCase):
+    def setUp(self):
+        random.seed(4711)
+        cloud = []
+        for i in range(2000):
+            cloud.append((random.uniform(-5.0, 5.0), random.uniform(-2.0, 2.0), random.uniform(0.0, 1.0)))
+        self.points = Points.Points(cloud)
+        # the kernel may round the coordinates, so the brute force search uses its points
+        self.vectors = self.points.Points
+        # query points inside and far outside of the bounding box
+        self.queries = [FreeCAD.Vector(0.0, 0.0, 0.5), FreeCAD.Vector(4.9, -1.9, 0.1),
+                        FreeCAD.Vector(20.0, 0.0, 0.5), FreeCAD.Vector(-7.0, 5.0, -3.0),
+                        FreeCAD.Vector(0.0, 0.0, 100.0)]
+        for i in range(50):
+            self.queries.append(FreeCAD.Vector(random.uniform(-6.0, 6.0), random.uniform(-3.0, 3.0), random.uniform(-1.0, 2.0)))
+
+    def distances(self, query, indices):
+        return [(self.vectors[i] - query).Length for i in indices]
+
+    def bruteNearest(self, query, count):
+        dist = self.distances(query, range(len(self.vectors)))
+        dist.sort()
+        return dist[:count]
+
+    def bruteRadius(self, query, radius):
+        return [i for i in range(len(self.vectors)) if (self.vectors[i] - query).Length <= radius]
+
+    def checkNearest(self, count):
+        result = self.points.nearestPoints(self.queries, count)
+        self.failUnless(len(result) == len(self.queries))
+        for query, indices in zip(self.queries, result):
+            expected = self.bruteNearest(query, count)
+            self.failUnless(len(indices) == len(expected))
+            for d, e in zip(self.distances(query, indices), expected):
+                self.failUnless(abs(d - e) < 1e-5)
+
+    def testNearestPoints(self):
+        self.checkNearest(1)
+        self.checkNearest(10)
+
+    def testNearestPointsSingle(self):
+        query = self.queries[2]
+        indices = self.points.nearestPoints(query, 5)
+        self.failUnless(indices == self.points.nearestPoints([query], 5)[0])
+        self.failUnless(len(indices) == 5)
+
+    def testNearestPointsMoreThanCount(self):
+        # asking for more neighbours than there are points returns all points
+        small = Points.Points(self.vectors[:7])
+        result = small.nearestPoints(self.queries, 1000)
+        for indices in result:
+            self.failUnless(sorted(indices) == range(7))
+
+    def testPointsInRadius(self):
+        for radius in [0.0, 0.3, 1.5]:
+            result = self.points.pointsInRadius(self.queries, radius)
+            self.failUnless(len(result) == len(self.queries))
+            for query, indices in zip(self.queries, result):
+                # the distances are compared with a tolerance because the grid rounds differently
+                expected = set(self.bruteRadius(query, radius + 1e-5))
+                certain = set(self.bruteRadius(query, radius - 1e-5))
+                self.failUnless(certain.issubset(set(indices)))
+                self.failUnless(set(indices).issubset(expected))
+
+    def testEmptyCloud(self):
+        empty = Points.Points()
+        self.failUnless(empty.nearestPoints(self.queries[0], 3) == [])
+        self.failUnless(empty.nearestPoints(self.queries, 3) == [[]] * len(self.queries))
+        self.failUnless(empty.pointsInRadius(self.queries[0], 1.0) == [])
+        self.failUnless(empty.pointsInRadius(self.queries, 1.0) == [[]] * len(self.queries))
+
+
+class AsciiReaderCases(unittest.TestCase):
+    def setUp(self):
+        random.seed(4711)
+        self.fileName = tempfile.gettempdir() + os.sep + "PointsParsers.asc"
+        # more than 256 kB, so that the parallel parser splits the file among the threads
+        f = open(self.fileName, "wb")
+        f.write("# a comment line is skipped\n")
+        for i in range(20000):
+            x, y, z = random.uniform(-5.0, 5.0), random.uniform(-1e3, 1e3), random.uniform(-1e-3, 1e-3)
+            if i % 3 == 0:
+                f.write("%f %f %f\n" % (x, y, z))
+            elif i % 3 == 1:
+                f.write("%+.8e\t%.8E  %g\r\n" % (x, y, z))
+            else:
+                f.write("  %.10f %.3f %.12f\n" % (x, y, z))
+        f.close()
+
+    def readWithParser(self, mode):
+        grp = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Mod/Points")
+        old = grp.GetInt("AsciiParserMode", 2)
+        grp.SetInt("AsciiParserMode", mode)
+        try:
+            points = Points.Points()
+            points.read(self.fileName)
+        finally:
+            grp.SetInt("AsciiParserMode", old)
+        return points.Points
+
+    def testParsers(self):
+        regex = self.readWithParser(0)
+        self.failUnless(len(regex) == 20000)
+        for mode in [1, 2]:
+            other = self.readWithParser(mode)
+            self.failUnless(len(other) == len(regex))
+            # the kernel keeps floats, a last digit rounded differently may change them by one ulp
+            for p, q in zip(regex, other):
+                self.failUnless((p - q).Length <= 1e-6 * max(1.0, p.Length))
+
+    def tearDown(self):
+        if os.path.exists(self.fileName):
+            os.remove(self.fileName)
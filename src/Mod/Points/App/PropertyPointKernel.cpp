@@ -27,6 +27,7 @@
 # include <cmath>
 # include <iostream>
 # include <algorithm>
+# include <boost/bind.hpp>
 #endif
 
 #include <Base/Exception.h>
@@ -54,22 +55,26 @@ PropertyPointKernel::~PropertyPointKernel()
 void PropertyPointKernel::setValue(const PointKernel& m)
 {
     aboutToSetValue();
+    _deferred.clear();
     *_cPoints = m;
     hasSetValue();
 }
 
 const PointKernel& PropertyPointKernel::getValue(void) const 
 {
+    restoreDeferred();
     return *_cPoints;
 }
 
 const Data::ComplexGeoData* PropertyPointKernel::getComplexData() const
 {
+    restoreDeferred();
     return _cPoints;
 }
 
 Base::BoundBox3d PropertyPointKernel::getBoundingBox() const
 {
+    restoreDeferred();
     Base::BoundBox3d box;
     for (PointKernel::const_iterator it = _cPoints->begin(); it != _cPoints->end(); ++it)
         box.Add(*it);
@@ -80,11 +85,13 @@ void PropertyPointKernel::getFaces(std::vector<Base::Vector3d> &Points,
                                    std::vector<Data::ComplexGeoData::Facet> &Topo,
                                    float Accuracy, uint16_t flags) const
 {
+    restoreDeferred();
     _cPoints->getFaces(Points, Topo, Accuracy, flags);
 }
 
 PyObject *PropertyPointKernel::getPyObject(void)
 {
+    restoreDeferred();
     PointsPy* points = new PointsPy(&*_cPoints);
     points->setConst(); // set immutable
     return points;
@@ -105,11 +112,13 @@ void PropertyPointKernel::setPyObject(PyObject *value)
 
 void PropertyPointKernel::Save (Base::Writer &writer) const
 {
+    restoreDeferred();
     _cPoints->Save(writer);
 }
 
 void PropertyPointKernel::Restore(Base::XMLReader &reader)
 {
+    _deferred.clear();
     reader.readElement("Points");
     std::string file (reader.getAttribute("file") );
 
@@ -141,8 +150,21 @@ void PropertyPointKernel::RestoreDocFile(Base::Reader &reader)
     hasSetValue();
 }
 
+void PropertyPointKernel::setDeferredDocFile(const Base::DeferredFile &file)
+{
+    _deferred = file;
+}
+
+void PropertyPointKernel::restoreDeferred() const
+{
+    // only reading in the points is not a modification, hence no notification
+    if (_deferred.isPending())
+        _deferred.restore(boost::bind(&PointKernel::RestoreDocFile, &*_cPoints, _1));
+}
+
 App::Property *PropertyPointKernel::Copy(void) const 
 {
+    restoreDeferred();
     PropertyPointKernel* prop = new PropertyPointKernel();
     (*prop->_cPoints) = (*this->_cPoints);
     return prop;
@@ -152,6 +174,8 @@ void PropertyPointKernel::Paste(const App::Property &from)
 {
     aboutToSetValue();
     const PropertyPointKernel& prop = dynamic_cast<const PropertyPointKernel&>(from);
+    prop.restoreDeferred();
+    _deferred.clear();
     *(this->_cPoints) = *(prop._cPoints);
     hasSetValue();
 }
@@ -163,6 +187,8 @@ unsigned int PropertyPointKernel::getMemSize (void) const
 
 void PropertyPointKernel::removeIndices( const std::vector<unsigned long>& uIndices )
 {
+    restoreDeferred();
+
     // We need a sorted array
     std::vector<unsigned long> uSortedInds = uIndices;
     std::sort(uSortedInds.begin(), uSortedInds.end());
@@ -191,6 +217,7 @@ void PropertyPointKernel::removeIndices( const std::vector<unsigned long>& uIndi
 
 void PropertyPointKernel::transformGeometry(const Base::Matrix4D &rclMat)
 {
+    restoreDeferred();
     aboutToSetValue();
     _cPoints->transformGeometry(rclMat);
     hasSetValue();
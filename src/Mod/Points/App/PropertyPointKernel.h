@@ -79,6 +79,8 @@ public:
     void Restore(Base::XMLReader &reader);
     void SaveDocFile (Base::Writer &writer) const;
     void RestoreDocFile(Base::Reader &reader);
+    bool isRestoreDocFileDeferrable (void) const { return true; }
+    void setDeferredDocFile(const Base::DeferredFile &file);
     //@}
 
     /** @name Modification */
@@ -88,8 +90,13 @@ public:
     void removeIndices( const std::vector<unsigned long>& );
     //@}
 
+private:
+    /// reads the points if their file has been deferred when restoring the document
+    void restoreDeferred() const;
+
 private:
     Base::Reference<PointKernel> _cPoints;
+    mutable Base::DeferredFile _deferred;
 };
 
 } // namespace Points
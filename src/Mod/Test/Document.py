@@ -227,9 +227,45 @@ class DocumentSaveRestoreCases(unittest.TestCase):
         # Okay, no document open
         self.failUnless(True)
 
+  def testBinarySaveAndRestore(self):
+    import zipfile
+    SaveName = self.TempPath + os.sep + "BinaryTests.FCStd"
+    XmlName = self.TempPath + os.sep + "BinaryTests2.FCStd"
+    BinName = self.TempPath + os.sep + "BinaryTests3.FCStd"
+    self.TempFiles = [SaveName, XmlName, BinName]
+    self.Doc.Label_1.String = "<a & \"b\">"
+    self.Doc.Label_1.FloatList = [1.0, 2.5]
+    self.Doc.Label_1.Enum = 2
+    self.Doc.Label_1.LinkSub = (self.Doc.Label_2,["Sub1","Sub2"])
+    grp = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Document")
+    binary = grp.GetBool("SaveBinary", False)
+    grp.SetBool("SaveBinary", True)
+    try:
+      self.Doc.saveAs(SaveName)
+    finally:
+      grp.SetBool("SaveBinary", binary)
+    FreeCAD.closeDocument("SaveRestoreTests")
+    self.failUnless(zipfile.ZipFile(SaveName).namelist()[0] == "Document.fcb")
+    # round-trip through XML
+    FreeCAD.convertDocument(SaveName, XmlName, False)
+    self.failUnless(zipfile.ZipFile(XmlName).namelist()[0] == "Document.xml")
+    FreeCAD.convertDocument(XmlName, BinName, True)
+    for name in [SaveName, XmlName, BinName]:
+      self.Doc = FreeCAD.open(name)
+      self.failUnless(self.Doc.Label_1.String == "<a & \"b\">")
+      self.failUnless(self.Doc.Label_1.FloatList == [1.0, 2.5])
+      self.failUnless(self.Doc.Label_1.Enum == "Two")
+      self.failUnless(self.Doc.Label_1.LinkSub == (self.Doc.Label_2,["Sub1","Sub2"]))
+      self.failUnless(self.Doc.Label_2.Integer == 4711)
+      FreeCAD.closeDocument(self.Doc.Name)
+    self.Doc = FreeCAD.newDocument("SaveRestoreTests")
+
   def tearDown(self):
     #closing doc
     FreeCAD.closeDocument("SaveRestoreTests")
+    for name in getattr(self, "TempFiles", []):
+      if os.path.exists(name):
+        os.remove(name)
 
 class DocumentRecomputeCases(unittest.TestCase):
   def setUp(self):
@@ -244,6 +280,66 @@ class DocumentRecomputeCases(unittest.TestCase):
     self.L1.Link = self.L2
     self.L2.Link = self.L3
 
+  def testDownstream(self):
+    self.L1.Source1 = self.L2
+    self.L2.Source1 = self.L3
+    self.Doc.recompute()
+    self.failUnless(self.L1.ExecCount == 1)
+    self.failUnless(self.L2.ExecCount == 1)
+    self.failUnless(self.L3.ExecCount == 1)
+    # only L2 and the objects depending on it must be executed
+    self.L2.Integer = 2
+    self.Doc.recompute()
+    self.failUnless(self.L1.ExecCount == 2)
+    self.failUnless(self.L2.ExecCount == 2)
+    self.failUnless(self.L3.ExecCount == 1)
+    # removing a link must be taken into account
+    self.L1.Source1 = None
+    self.Doc.recompute()
+    self.L2.Integer = 3
+    self.Doc.recompute()
+    self.failUnless(self.L1.ExecCount == 3)
+    self.failUnless(self.L2.ExecCount == 3)
+
+  def testParallelRecompute(self):
+    self.failUnless(self.Doc.ParallelRecompute == False)
+    self.L1.Source1 = self.L3
+    self.L2.Source1 = self.L3
+    self.L3.Integer = 4
+    self.Doc.ParallelRecompute = True
+    self.Doc.recompute()
+    self.failUnless(self.L1.ExecCount == 1)
+    self.failUnless(self.L2.ExecCount == 1)
+    self.failUnless(self.L3.ExecCount == 1)
+    self.failUnless(self.L1.ExecResult == "Exec")
+    self.L3.Integer = 5
+    self.Doc.recompute()
+    self.failUnless(self.L1.ExecCount == 2)
+    self.failUnless(self.L3.ExecCount == 2)
+    self.Doc.ParallelRecompute = False
+
+  def testRestoreInList(self):
+    # the in list must only contain the objects of the restored document
+    FileName = tempfile.gettempdir() + os.sep + "RecomputeTests.FCStd"
+    self.L2.Source1 = self.L3
+    self.L1.Source1 = self.L3
+    self.Doc.saveAs(FileName)
+    self.Doc.restore()
+    L1 = self.Doc.Label_1
+    L2 = self.Doc.Label_2
+    L3 = self.Doc.Label_3
+    self.failUnless(L3.InList == [L1, L2])
+    self.failUnless(L1.InList == [])
+    L3.Integer = 6
+    self.Doc.recompute()
+    self.failUnless(L1.ExecCount == 1)
+    self.failUnless(L2.ExecCount == 1)
+    self.failUnless(L3.ExecCount == 1)
+    # a link set after the restore must be taken into account
+    L2.Source1 = None
+    self.failUnless(L3.InList == [L1])
+    os.remove(FileName)
+
 
   def tearDown(self):
     #closing doc
@@ -0,0 +1,81 @@
+#***************************************************************************
+#*   (c) FreeCAD Developers 2026                                           *
+#*                                                                         *
+#*   This file is part of the FreeCAD CAx development system.              *
+#*                                                                         *
+#*   This program is free software; you can redistribute it and/or modify  *
+#*   it under the terms of the GNU Lesser General Public License (LGPL)    *
+#*   as published by the Free Software Foundation; either version 2 of     *
+#*   the License, or (at your option) any later version.                   *
+#*   for detail see the LICENCE text file.                                 *
+#*                                                                         *
+#*   FreeCAD is distributed in the hope that it will be useful,            *
+#*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+#*   GNU Library General Public License for more details.                  *
+#*                                                                         *
+#*   You should have received a copy of the GNU Library General Public     *
+#*   License along with FreeCAD; if not, write to the Free Software        *
+#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  *
+#*   USA                                                                   *
+#***************************************************************************/
+
+
+import FreeCAD, time, unittest
+
+
+#---------------------------------------------------------------------------
+# benchmarks of the FreeCAD Document code on large synthetic documents,
+# they are not part of TestApp.All() because they take a while
+#---------------------------------------------------------------------------
+
+
+class DocumentInListBenchmark(unittest.TestCase):
+  Count = 50000
+
+  def setUp(self):
+    self.Doc = FreeCAD.newDocument("InListBenchmark")
+    self.Doc.UndoMode = 0
+    self.Objs = []
+    start = time.time()
+    prev = None
+    for i in range(self.Count):
+      obj = self.Doc.addObject("App::FeatureTest","Feature")
+      if prev:
+        obj.Link = prev
+      self.Objs.append(obj)
+      prev = obj
+    FreeCAD.Console.PrintMessage("Building a chain of %d objects: %.3fs\n" % (self.Count, time.time()-start))
+
+  def testInList(self):
+    start = time.time()
+    for i in range(self.Count - 1):
+      inList = self.Objs[i].InList
+      self.failUnless(len(inList) == 1)
+      self.failUnless(inList[0] == self.Objs[i+1])
+    self.failUnless(len(self.Objs[-1].InList) == 0)
+    elapsed = time.time()-start
+    FreeCAD.Console.PrintMessage("InList of %d objects: %.3fs\n" % (self.Count, elapsed))
+    # a full scan of the document per call would take minutes here
+    self.failUnless(elapsed < 10.0, "InList lookup does not scale with the node degree")
+
+  def testRelink(self):
+    start = time.time()
+    root = self.Objs[0]
+    for obj in self.Objs[2:]:
+      obj.Link = root
+    self.failUnless(len(root.InList) == self.Count - 1)
+    self.failUnless(len(self.Objs[1].InList) == 0)
+    FreeCAD.Console.PrintMessage("Relinking %d objects: %.3fs\n" % (self.Count, time.time()-start))
+
+  def testRemoval(self):
+    start = time.time()
+    for obj in self.Objs[1::2]:
+      self.Doc.removeObject(obj.Name)
+    for obj in self.Objs[0:-1:2]:
+      self.failUnless(len(obj.InList) == 0)
+    FreeCAD.Console.PrintMessage("Removing %d objects: %.3fs\n" % (self.Count/2, time.time()-start))
+
+  def tearDown(self):
+    self.Objs = []
+    FreeCAD.closeDocument("InListBenchmark")
@@ -43,6 +43,7 @@ def All():
         suite.addTest(unittest.defaultTestLoader.loadTestsFromName("Menu") )
     # add the module tests
     suite.addTest(unittest.defaultTestLoader.loadTestsFromName("MeshTestsApp") )
+    suite.addTest(unittest.defaultTestLoader.loadTestsFromName("PointsTestsApp") )
     suite.addTest(unittest.defaultTestLoader.loadTestsFromName("TestSketcherApp") )
     suite.addTest(unittest.defaultTestLoader.loadTestsFromName("TestPartApp") )
     suite.addTest(unittest.defaultTestLoader.loadTestsFromName("TestPartDesignApp") )
@@ -75,5 +76,15 @@ def testDocument():
     suite.addTest(unittest.defaultTestLoader.loadTestsFromName("Document") )
     TestText(suite)
 
+def testDocumentBenchmark():
+    suite = unittest.TestSuite()
+    suite.addTest(unittest.defaultTestLoader.loadTestsFromName("DocumentBenchmark") )
+    TestText(suite)
+
+def testMeshBenchmark():
+    suite = unittest.TestSuite()
+    suite.addTest(unittest.defaultTestLoader.loadTestsFromName("MeshBenchmark") )
+    TestText(suite)
+
 
 
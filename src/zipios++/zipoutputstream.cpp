@@ -56,6 +56,12 @@ void ZipOutputStream::putNextEntry(const std::string& entryName) {
 }
 
 
+void ZipOutputStream::putRawEntry( const std::string &entryName, const char *data,
+                                   uint32 compressed_size, uint32 crc, uint32 size ) {
+  ozf->putRawEntry( ZipCDirEntry( entryName ), data, compressed_size, crc, size ) ;
+}
+
+
 void ZipOutputStream::setComment( const std::string &comment ) {
   ozf->setComment( comment ) ;
 }
@@ -54,6 +54,11 @@ public:
   */
   void putNextEntry(const std::string& entryName);
 
+  /** Writes an entry whose data has already been deflated, see
+      ZipOutputStreambuf::putRawEntry(). */
+  void putRawEntry( const std::string &entryName, const char *data,
+                    uint32 compressed_size, uint32 crc, uint32 size ) ;
+
   /** Sets the global comment for the Zip archive. */
   void setComment( const std::string& comment ) ;
 
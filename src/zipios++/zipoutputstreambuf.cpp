@@ -81,6 +81,29 @@ void ZipOutputStreambuf::putNextEntry( const ZipCDirEntry &entry ) {
 }
 
 
+void ZipOutputStreambuf::putRawEntry( const ZipCDirEntry &entry, const char *data,
+                                      uint32 compressed_size, uint32 crc, uint32 size ) {
+  if ( _open_entry )
+    closeEntry() ;
+
+  _entries.push_back( entry ) ;
+  ZipCDirEntry &ent = _entries.back() ;
+
+  ostream os( _outbuf ) ;
+
+  // all sizes are known, so the header can be written in its final form
+  ent.setLocalHeaderOffset( os.tellp() ) ;
+  ent.setMethod( DEFLATED ) ;
+  ent.setSize( size ) ;
+  ent.setCrc( crc ) ;
+  ent.setCompressedSize( compressed_size ) ;
+  ent.setTime( currentDosTime() ) ;
+
+  os << static_cast< ZipLocalEntry >( ent ) ;
+  os.write( data, compressed_size ) ;
+}
+
+
 void ZipOutputStreambuf::setComment( const string &comment ) {
   _zip_comment = comment ;
 }
@@ -146,6 +169,16 @@ void ZipOutputStreambuf::updateEntryHeaderInfo() {
   entry.setCompressedSize( curr_pos - entry.getLocalHeaderOffset() 
 			   - entry.getLocalHeaderSize() ) ;
 
+  entry.setTime( currentDosTime() ) ;
+
+  // write ZipLocalEntry header to header position
+  os.seekp( entry.getLocalHeaderOffset() ) ;
+  os << static_cast< ZipLocalEntry >( entry ) ;
+  os.seekp( curr_pos ) ;
+}
+
+
+int ZipOutputStreambuf::currentDosTime() {
   // Mark Donszelmann: added current date and time
   time_t ltime;
   time( &ltime );
@@ -153,12 +186,7 @@ void ZipOutputStreambuf::updateEntryHeaderInfo() {
   now = localtime( &ltime );
   int dosTime = (now->tm_year - 80) << 25 | (now->tm_mon + 1) << 21 | now->tm_mday << 16 |
               now->tm_hour << 11 | now->tm_min << 5 | now->tm_sec >> 1;
-  entry.setTime(dosTime);
-
-  // write ZipLocalEntry header to header position
-  os.seekp( entry.getLocalHeaderOffset() ) ;
-  os << static_cast< ZipLocalEntry >( entry ) ;
-  os.seekp( curr_pos ) ;
+  return dosTime;
 }
 
 
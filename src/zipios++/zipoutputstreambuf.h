@@ -49,6 +49,16 @@ public:
       entry. */
   void putNextEntry( const ZipCDirEntry &entry ) ;
 
+  /** Writes an entry whose data has already been deflated (raw deflate
+      stream without zlib header, as produced with windowBits -MAX_WBITS).
+      @param entry the entry to write.
+      @param data the compressed data.
+      @param compressed_size the number of bytes of data.
+      @param crc the crc32 of the uncompressed data.
+      @param size the size of the uncompressed data. */
+  void putRawEntry( const ZipCDirEntry &entry, const char *data,
+                    uint32 compressed_size, uint32 crc, uint32 size ) ;
+
   /** Sets the global comment for the Zip archive. */
   void setComment( const string &comment ) ;
 
@@ -68,6 +78,7 @@ protected:
 
   void setEntryClosedState() ;
   void updateEntryHeaderInfo() ;
+  static int currentDosTime() ;
 
   // Should/could be moved to zipheadio.h ?!
   static void writeCentralDirectory( const vector< ZipCDirEntry > &entries, 